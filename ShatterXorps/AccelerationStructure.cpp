@@ -0,0 +1,414 @@
+// AccelerationStructure.cpp
+#include "AccelerationStructure.h"
+#include "PhysicalDevice.h"
+#include <stdexcept>
+#include <cstring>
+#include <string>
+
+template <class T>
+static T loadDeviceFunction(VkDevice device, const char* name)
+{
+    T fn = reinterpret_cast<T>(vkGetDeviceProcAddr(device, name));
+    if (!fn) {
+        throw std::runtime_error(std::string("AccelerationStructure: missing ") + name);
+    }
+    return fn;
+}
+
+void AccelerationStructure::create(VkDevice dev, PhysicalDevice& phys)
+{
+    if (!phys.supportsRayQuery()) {
+        throw std::runtime_error("AccelerationStructure: device has no ray query support!");
+    }
+    device = dev;
+    physDevice = &phys;
+
+    // 1) Entry points. bufferDeviceAddress is core in 1.2, the KHR alias works too.
+    pfnGetBufferDeviceAddress = loadDeviceFunction<PFN_vkGetBufferDeviceAddressKHR>(device, "vkGetBufferDeviceAddress");
+    pfnCreateAccelerationStructure = loadDeviceFunction<PFN_vkCreateAccelerationStructureKHR>(device, "vkCreateAccelerationStructureKHR");
+    pfnDestroyAccelerationStructure = loadDeviceFunction<PFN_vkDestroyAccelerationStructureKHR>(device, "vkDestroyAccelerationStructureKHR");
+    pfnGetBuildSizes = loadDeviceFunction<PFN_vkGetAccelerationStructureBuildSizesKHR>(device, "vkGetAccelerationStructureBuildSizesKHR");
+    pfnGetAccelerationStructureAddress = loadDeviceFunction<PFN_vkGetAccelerationStructureDeviceAddressKHR>(device, "vkGetAccelerationStructureDeviceAddressKHR");
+    pfnCmdBuildAccelerationStructures = loadDeviceFunction<PFN_vkCmdBuildAccelerationStructuresKHR>(device, "vkCmdBuildAccelerationStructuresKHR");
+
+    // 2) Scratch buffers must be aligned to this
+    VkPhysicalDeviceAccelerationStructurePropertiesKHR accelProps{};
+    accelProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+    VkPhysicalDeviceProperties2 props2{};
+    props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    props2.pNext = &accelProps;
+    vkGetPhysicalDeviceProperties2(phys.getPhysicalDevice(), &props2);
+    scratchAlignment = accelProps.minAccelerationStructureScratchOffsetAlignment;
+    if (scratchAlignment == 0) {
+        scratchAlignment = 1;
+    }
+}
+
+void AccelerationStructure::destroy(VkDevice dev)
+{
+    if (device == VK_NULL_HANDLE) {
+        return;
+    }
+    for (Mesh& mesh : meshes) {
+        if (mesh.blas.handle != VK_NULL_HANDLE) {
+            pfnDestroyAccelerationStructure(dev, mesh.blas.handle, nullptr);
+        }
+        destroyBuffer(mesh.blas.storage);
+        destroyBuffer(mesh.positions);
+        destroyBuffer(mesh.indices);
+    }
+    meshes.clear();
+
+    if (topLevel.handle != VK_NULL_HANDLE) {
+        pfnDestroyAccelerationStructure(dev, topLevel.handle, nullptr);
+        topLevel.handle = VK_NULL_HANDLE;
+    }
+    destroyBuffer(topLevel.storage);
+    if (instanceMapped) {
+        vkUnmapMemory(dev, instanceBuffer.memory);
+        instanceMapped = nullptr;
+    }
+    destroyBuffer(instanceBuffer);
+    destroyBuffer(tlasScratch);
+    maxInstances = 0;
+    device = VK_NULL_HANDLE;
+}
+
+// ---------------------------------------------------------------------------
+// Buffers
+// ---------------------------------------------------------------------------
+AccelerationStructure::DeviceBuffer AccelerationStructure::createBuffer(
+    VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+{
+    DeviceBuffer b;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &b.buffer) != VK_SUCCESS) {
+        throw std::runtime_error("AccelerationStructure: failed to create buffer!");
+    }
+
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(device, b.buffer, &memReqs);
+
+    VkMemoryAllocateFlagsInfo flagsInfo{};
+    flagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+    flagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext = &flagsInfo;
+    allocInfo.allocationSize = memReqs.size;
+    allocInfo.memoryTypeIndex = physDevice->findMemoryType(memReqs.memoryTypeBits, properties);
+
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &b.memory) != VK_SUCCESS) {
+        throw std::runtime_error("AccelerationStructure: failed to allocate buffer memory!");
+    }
+    vkBindBufferMemory(device, b.buffer, b.memory, 0);
+
+    VkBufferDeviceAddressInfo addressInfo{};
+    addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+    addressInfo.buffer = b.buffer;
+    b.address = pfnGetBufferDeviceAddress(device, &addressInfo);
+    return b;
+}
+
+void AccelerationStructure::destroyBuffer(DeviceBuffer& b)
+{
+    if (b.buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, b.buffer, nullptr);
+        b.buffer = VK_NULL_HANDLE;
+    }
+    if (b.memory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, b.memory, nullptr);
+        b.memory = VK_NULL_HANDLE;
+    }
+    b.address = 0;
+}
+
+void AccelerationStructure::createStructure(Structure& s, VkAccelerationStructureTypeKHR type, VkDeviceSize size)
+{
+    s.storage = createBuffer(size,
+        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    VkAccelerationStructureCreateInfoKHR createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+    createInfo.buffer = s.storage.buffer;
+    createInfo.size = size;
+    createInfo.type = type;
+
+    if (pfnCreateAccelerationStructure(device, &createInfo, nullptr, &s.handle) != VK_SUCCESS) {
+        throw std::runtime_error("AccelerationStructure: failed to create acceleration structure!");
+    }
+
+    VkAccelerationStructureDeviceAddressInfoKHR addressInfo{};
+    addressInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
+    addressInfo.accelerationStructure = s.handle;
+    s.address = pfnGetAccelerationStructureAddress(device, &addressInfo);
+}
+
+VkDeviceSize AccelerationStructure::alignScratch(VkDeviceSize size) const
+{
+    return (size + scratchAlignment - 1) / scratchAlignment * scratchAlignment;
+}
+
+// ---------------------------------------------------------------------------
+// Bottom level
+// ---------------------------------------------------------------------------
+uint32_t AccelerationStructure::addMesh(const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices)
+{
+    Mesh mesh;
+    mesh.vertexCount = (uint32_t)vertices.size();
+    mesh.triangleCount = (uint32_t)(indices.size() / 3);
+
+    const VkBufferUsageFlags inputUsage =
+        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR;
+    const VkMemoryPropertyFlags hostVisible =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+    // Tightly packed positions: the build only needs vertexStride, but a
+    // separate copy keeps this independent of the raster vertex layout
+    std::vector<glm::vec3> positions(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        positions[i] = vertices[i].position;
+    }
+
+    VkDeviceSize positionBytes = sizeof(glm::vec3) * positions.size();
+    mesh.positions = createBuffer(positionBytes, inputUsage, hostVisible);
+    void* data = nullptr;
+    vkMapMemory(device, mesh.positions.memory, 0, positionBytes, 0, &data);
+    memcpy(data, positions.data(), (size_t)positionBytes);
+    vkUnmapMemory(device, mesh.positions.memory);
+
+    VkDeviceSize indexBytes = sizeof(uint16_t) * indices.size();
+    mesh.indices = createBuffer(indexBytes, inputUsage, hostVisible);
+    vkMapMemory(device, mesh.indices.memory, 0, indexBytes, 0, &data);
+    memcpy(data, indices.data(), (size_t)indexBytes);
+    vkUnmapMemory(device, mesh.indices.memory);
+
+    meshes.push_back(mesh);
+    return (uint32_t)(meshes.size() - 1);
+}
+
+void AccelerationStructure::buildMeshes(VkDevice dev, VkCommandPool commandPool, VkQueue queue)
+{
+    if (meshes.empty()) {
+        return;
+    }
+
+    // 1) Geometry + sizes for every mesh that isn't built yet
+    std::vector<VkAccelerationStructureGeometryKHR> geometries(meshes.size());
+    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> buildInfos;
+    std::vector<VkAccelerationStructureBuildRangeInfoKHR> ranges(meshes.size());
+    std::vector<size_t> meshOfBuild;
+    VkDeviceSize scratchTotal = 0;
+    std::vector<VkDeviceSize> scratchOffsets;
+
+    for (size_t i = 0; i < meshes.size(); i++) {
+        Mesh& mesh = meshes[i];
+        if (mesh.blas.handle != VK_NULL_HANDLE) {
+            continue;
+        }
+
+        VkAccelerationStructureGeometryKHR& geometry = geometries[i];
+        geometry = {};
+        geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+        geometry.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+        geometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+        geometry.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+        geometry.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+        geometry.geometry.triangles.vertexData.deviceAddress = mesh.positions.address;
+        geometry.geometry.triangles.vertexStride = sizeof(glm::vec3);
+        geometry.geometry.triangles.maxVertex = mesh.vertexCount - 1;
+        geometry.geometry.triangles.indexType = VK_INDEX_TYPE_UINT16;
+        geometry.geometry.triangles.indexData.deviceAddress = mesh.indices.address;
+
+        VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
+        buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+        buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+        buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+        buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+        buildInfo.geometryCount = 1;
+        buildInfo.pGeometries = &geometry;
+
+        VkAccelerationStructureBuildSizesInfoKHR sizes{};
+        sizes.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+        pfnGetBuildSizes(dev, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+            &buildInfo, &mesh.triangleCount, &sizes);
+
+        createStructure(mesh.blas, VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR,
+            sizes.accelerationStructureSize);
+        buildInfo.dstAccelerationStructure = mesh.blas.handle;
+
+        // One scratch buffer, each build gets its own aligned slice
+        scratchOffsets.push_back(scratchTotal);
+        scratchTotal += alignScratch(sizes.buildScratchSize);
+
+        ranges[i] = {};
+        ranges[i].primitiveCount = mesh.triangleCount;
+
+        buildInfos.push_back(buildInfo);
+        meshOfBuild.push_back(i);
+    }
+    if (buildInfos.empty()) {
+        return;
+    }
+
+    // Extra alignment so the first slice can start on an aligned address
+    DeviceBuffer scratch = createBuffer(scratchTotal + scratchAlignment,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    VkDeviceAddress scratchBase = (scratch.address + scratchAlignment - 1) / scratchAlignment * scratchAlignment;
+
+    std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> rangePtrs;
+    for (size_t b = 0; b < buildInfos.size(); b++) {
+        buildInfos[b].scratchData.deviceAddress = scratchBase + scratchOffsets[b];
+        rangePtrs.push_back(&ranges[meshOfBuild[b]]);
+    }
+
+    // 2) Record all builds in one command buffer, submit and wait
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer cb;
+    if (vkAllocateCommandBuffers(dev, &allocInfo, &cb) != VK_SUCCESS) {
+        throw std::runtime_error("AccelerationStructure: failed to allocate build command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cb, &beginInfo);
+    pfnCmdBuildAccelerationStructures(cb, (uint32_t)buildInfos.size(), buildInfos.data(), rangePtrs.data());
+    vkEndCommandBuffer(cb);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cb;
+    vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(queue);
+
+    vkFreeCommandBuffers(dev, commandPool, 1, &cb);
+    destroyBuffer(scratch);
+}
+
+// ---------------------------------------------------------------------------
+// Top level
+// ---------------------------------------------------------------------------
+void AccelerationStructure::createTopLevel(VkDevice dev, uint32_t instanceCapacity)
+{
+    maxInstances = instanceCapacity;
+
+    // 1) Instance buffer, written straight from the host every frame
+    VkDeviceSize instanceBytes = sizeof(VkAccelerationStructureInstanceKHR) * maxInstances;
+    instanceBuffer = createBuffer(instanceBytes,
+        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    vkMapMemory(dev, instanceBuffer.memory, 0, instanceBytes, 0, &instanceMapped);
+
+    // 2) Size for the worst case (maxInstances)
+    VkAccelerationStructureGeometryKHR geometry{};
+    geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+    geometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+    geometry.geometry.instances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+    geometry.geometry.instances.data.deviceAddress = instanceBuffer.address;
+
+    VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
+    buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+    buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+    buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
+    buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+    buildInfo.geometryCount = 1;
+    buildInfo.pGeometries = &geometry;
+
+    VkAccelerationStructureBuildSizesInfoKHR sizes{};
+    sizes.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+    pfnGetBuildSizes(dev, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+        &buildInfo, &maxInstances, &sizes);
+
+    createStructure(topLevel, VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR, sizes.accelerationStructureSize);
+    tlasScratch = createBuffer(sizes.buildScratchSize + scratchAlignment,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void AccelerationStructure::recordTopLevelBuild(VkCommandBuffer cb, const std::vector<Instance>& instances)
+{
+    if (topLevel.handle == VK_NULL_HANDLE) {
+        throw std::runtime_error("AccelerationStructure: createTopLevel() not called!");
+    }
+    uint32_t count = (uint32_t)instances.size();
+    if (count > maxInstances) {
+        count = maxInstances;
+    }
+
+    // 1) glm is column-major, VkTransformMatrixKHR is the top 3 rows, row-major
+    VkAccelerationStructureInstanceKHR* dst = static_cast<VkAccelerationStructureInstanceKHR*>(instanceMapped);
+    for (uint32_t i = 0; i < count; i++) {
+        const Instance& src = instances[i];
+        VkAccelerationStructureInstanceKHR inst{};
+        for (int row = 0; row < 3; row++) {
+            for (int col = 0; col < 4; col++) {
+                inst.transform.matrix[row][col] = src.transform[col][row];
+            }
+        }
+        inst.instanceCustomIndex = src.meshIndex;
+        inst.mask = 0xFF;
+        inst.instanceShaderBindingTableRecordOffset = 0;
+        inst.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
+        inst.accelerationStructureReference = meshes.at(src.meshIndex).blas.address;
+        dst[i] = inst;
+    }
+
+    // 2) Rebuild (the instance count can change from frame to frame)
+    VkAccelerationStructureGeometryKHR geometry{};
+    geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+    geometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+    geometry.flags = VK_GEOMETRY_OPAQUE_BIT_KHR;
+    geometry.geometry.instances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+    geometry.geometry.instances.data.deviceAddress = instanceBuffer.address;
+
+    VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
+    buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+    buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+    buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
+    buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+    buildInfo.dstAccelerationStructure = topLevel.handle;
+    buildInfo.geometryCount = 1;
+    buildInfo.pGeometries = &geometry;
+    buildInfo.scratchData.deviceAddress =
+        (tlasScratch.address + scratchAlignment - 1) / scratchAlignment * scratchAlignment;
+
+    VkAccelerationStructureBuildRangeInfoKHR range{};
+    range.primitiveCount = count;
+    const VkAccelerationStructureBuildRangeInfoKHR* rangePtr = &range;
+
+    // Host writes to the instance buffer -> build input
+    VkMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+    vkCmdPipelineBarrier(cb,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+        0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+
+    pfnCmdBuildAccelerationStructures(cb, 1, &buildInfo, &rangePtr);
+
+    // 3) Build -> ray queries in compute / fragment shaders
+    VkMemoryBarrier buildBarrier{};
+    buildBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    buildBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    buildBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+    vkCmdPipelineBarrier(cb,
+        VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 1, &buildBarrier, 0, nullptr, 0, nullptr);
+}
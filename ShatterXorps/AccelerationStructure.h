@@ -0,0 +1,109 @@
+// AccelerationStructure.h
+#ifndef ACCELERATION_STRUCTURE_H
+#define ACCELERATION_STRUCTURE_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "Vertex.h"
+
+class PhysicalDevice;
+
+/*
+  AccelerationStructure holds the BLAS/TLAS used by the ray query shaders
+  (raytrace.comp / shader.frag built with -DUSE_RAY_QUERY).
+
+  Only valid when PhysicalDevice::supportsRayQuery() is true.
+
+  Usage:
+    accel.create(device, physDevice);
+    accel.addMesh(cubeVertices, cubeIndices);      // -> mesh index 0
+    accel.buildMeshes(device, commandPool, queue); // one-time BLAS builds
+    accel.createTopLevel(device, maxInstances);
+    ...per frame, before the passes that trace against it:
+    accel.recordTopLevelBuild(cb, instances);
+
+  BLASes are static (PREFER_FAST_TRACE). The TLAS is rebuilt every frame
+  from a host-visible instance buffer, so moving objects just means passing
+  new transforms.
+*/
+class AccelerationStructure {
+public:
+    struct Instance {
+        glm::mat4 transform;
+        uint32_t  meshIndex;
+    };
+
+    AccelerationStructure() = default;
+    ~AccelerationStructure() = default;
+
+    void create(VkDevice device, PhysicalDevice& physDevice);
+    void destroy(VkDevice device);
+
+    // Positions are read from Vertex::position, indices are uint16 like the
+    // raster index buffers. Returns the mesh index used by Instance.
+    uint32_t addMesh(const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices);
+
+    // Build every added BLAS (submits to queue and waits)
+    void buildMeshes(VkDevice device, VkCommandPool commandPool, VkQueue queue);
+
+    // Allocate the TLAS + its instance / scratch buffers
+    void createTopLevel(VkDevice device, uint32_t maxInstances);
+
+    // Write the instances and record a TLAS build followed by a barrier
+    // making it visible to compute and fragment shaders
+    void recordTopLevelBuild(VkCommandBuffer cb, const std::vector<Instance>& instances);
+
+    VkAccelerationStructureKHR getTopLevel() const { return topLevel.handle; }
+
+private:
+    struct DeviceBuffer {
+        VkBuffer        buffer = VK_NULL_HANDLE;
+        VkDeviceMemory  memory = VK_NULL_HANDLE;
+        VkDeviceAddress address = 0;
+    };
+
+    struct Structure {
+        VkAccelerationStructureKHR handle = VK_NULL_HANDLE;
+        DeviceBuffer               storage;
+        VkDeviceAddress            address = 0;
+    };
+
+    struct Mesh {
+        DeviceBuffer positions;
+        DeviceBuffer indices;
+        uint32_t     vertexCount = 0;
+        uint32_t     triangleCount = 0;
+        Structure    blas;
+    };
+
+    // Buffers with SHADER_DEVICE_ADDRESS usage (memory allocated with the DEVICE_ADDRESS flag)
+    DeviceBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+    void destroyBuffer(DeviceBuffer& b);
+    void createStructure(Structure& s, VkAccelerationStructureTypeKHR type, VkDeviceSize size);
+    VkDeviceSize alignScratch(VkDeviceSize size) const;
+
+    VkDevice        device = VK_NULL_HANDLE;
+    PhysicalDevice* physDevice = nullptr;
+    VkDeviceSize    scratchAlignment = 1;
+
+    std::vector<Mesh> meshes;
+
+    // Top level
+    Structure    topLevel;
+    DeviceBuffer instanceBuffer;   // host-visible, persistently mapped
+    void*        instanceMapped = nullptr;
+    DeviceBuffer tlasScratch;
+    uint32_t     maxInstances = 0;
+
+    // Extension entry points (not exported by the loader)
+    PFN_vkGetBufferDeviceAddressKHR                 pfnGetBufferDeviceAddress = nullptr;
+    PFN_vkCreateAccelerationStructureKHR            pfnCreateAccelerationStructure = nullptr;
+    PFN_vkDestroyAccelerationStructureKHR           pfnDestroyAccelerationStructure = nullptr;
+    PFN_vkGetAccelerationStructureBuildSizesKHR     pfnGetBuildSizes = nullptr;
+    PFN_vkGetAccelerationStructureDeviceAddressKHR  pfnGetAccelerationStructureAddress = nullptr;
+    PFN_vkCmdBuildAccelerationStructuresKHR         pfnCmdBuildAccelerationStructures = nullptr;
+};
+
+#endif // ACCELERATION_STRUCTURE_H
@@ -0,0 +1,201 @@
+// BindlessDescriptors.cpp
+#include "BindlessDescriptors.h"
+#include "PhysicalDevice.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+// Per-stage update-after-bind limits also count the other sets of the
+// pipeline layout (shadow maps, light SSBOs, ...), leave them some room
+static const uint32_t OTHER_SETS_HEADROOM = 16;
+
+void BindlessDescriptors::create(VkDevice device, PhysicalDevice& physDevice,
+    uint32_t maxTextures, uint32_t maxBuffers)
+{
+    if (!physDevice.supportsDescriptorIndexing()) {
+        throw std::runtime_error("Bindless descriptors need descriptor indexing!");
+    }
+
+    VkPhysicalDeviceVulkan12Properties props12{};
+    props12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 props2{};
+    props2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    props2.pNext = &props12;
+    vkGetPhysicalDeviceProperties2(physDevice.getPhysicalDevice(), &props2);
+
+    uint32_t textureLimit = std::min({
+        props12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+        props12.maxPerStageDescriptorUpdateAfterBindSamplers,
+        props12.maxDescriptorSetUpdateAfterBindSampledImages,
+        props12.maxDescriptorSetUpdateAfterBindSamplers });
+    uint32_t bufferLimit = std::min(
+        props12.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+        props12.maxDescriptorSetUpdateAfterBindStorageBuffers);
+    textureCapacity = std::max(1u, std::min(maxTextures, textureLimit - std::min(textureLimit, OTHER_SETS_HEADROOM)));
+    bufferCapacity = std::max(1u, std::min(maxBuffers, bufferLimit - std::min(bufferLimit, OTHER_SETS_HEADROOM)));
+
+    // Layout: two runtime-sized arrays, both partially bound and writable
+    // while bound
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+    bindings[0].binding = TEXTURE_BINDING;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = textureCapacity;
+    bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    bindings[1].binding = BUFFER_BINDING;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[1].descriptorCount = bufferCapacity;
+    bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    std::array<VkDescriptorBindingFlags, 2> bindingFlags = {
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT,
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+    };
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+    flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flagsInfo.bindingCount = (uint32_t)bindingFlags.size();
+    flagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &flagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = (uint32_t)bindings.size();
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create bindless set layout!");
+    }
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[0].descriptorCount = textureCapacity;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = bufferCapacity;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = (uint32_t)poolSizes.size();
+    poolInfo.pPoolSizes = poolSizes.data();
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create bindless descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+    if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate bindless descriptor set!");
+    }
+
+    textureCount = 0;
+    bufferCount = 1;
+    freeTextures.clear();
+    freeBuffers.clear();
+}
+
+void BindlessDescriptors::destroy(VkDevice device)
+{
+    // The set goes with its pool
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+        descriptorSet = VK_NULL_HANDLE;
+    }
+    if (setLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        setLayout = VK_NULL_HANDLE;
+    }
+}
+
+uint32_t BindlessDescriptors::allocateSlot(uint32_t& count, uint32_t capacity, std::vector<uint32_t>& freeList)
+{
+    if (!freeList.empty()) {
+        uint32_t slot = freeList.back();
+        freeList.pop_back();
+        return slot;
+    }
+    if (count >= capacity) {
+        return INVALID_SLOT;
+    }
+    return count++;
+}
+
+uint32_t BindlessDescriptors::addTexture(VkDevice device, VkImageView view, VkSampler sampler)
+{
+    uint32_t slot = allocateSlot(textureCount, textureCapacity, freeTextures);
+    if (slot != INVALID_SLOT) {
+        updateTexture(device, slot, view, sampler);
+    }
+    return slot;
+}
+
+void BindlessDescriptors::updateTexture(VkDevice device, uint32_t slot, VkImageView view, VkSampler sampler)
+{
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = sampler;
+    imageInfo.imageView = view;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = TEXTURE_BINDING;
+    write.dstArrayElement = slot;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+
+void BindlessDescriptors::removeTexture(uint32_t slot)
+{
+    // Partially bound: the stale descriptor may stay as long as no shader
+    // indexes it
+    if (slot < textureCount) {
+        freeTextures.push_back(slot);
+    }
+}
+
+uint32_t BindlessDescriptors::addBuffer(VkDevice device, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    uint32_t slot = allocateSlot(bufferCount, bufferCapacity, freeBuffers);
+    if (slot != INVALID_SLOT) {
+        writeBuffer(device, slot, buffer, offset, range);
+    }
+    return slot;
+}
+
+void BindlessDescriptors::removeBuffer(uint32_t slot)
+{
+    if (slot != MATERIAL_BUFFER_SLOT && slot < bufferCount) {
+        freeBuffers.push_back(slot);
+    }
+}
+
+void BindlessDescriptors::setMaterialBuffer(VkDevice device, VkBuffer buffer, VkDeviceSize range)
+{
+    writeBuffer(device, MATERIAL_BUFFER_SLOT, buffer, 0, range);
+}
+
+void BindlessDescriptors::writeBuffer(VkDevice device, uint32_t slot, VkBuffer buffer,
+    VkDeviceSize offset, VkDeviceSize range)
+{
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = offset;
+    bufferInfo.range = range;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = BUFFER_BINDING;
+    write.dstArrayElement = slot;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
@@ -0,0 +1,91 @@
+// BindlessDescriptors.h
+#ifndef BINDLESS_DESCRIPTORS_H
+#define BINDLESS_DESCRIPTORS_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+
+class PhysicalDevice;
+
+/*
+  One descriptor set holding every texture and storage buffer the shaders
+  may index (needs PhysicalDevice::supportsDescriptorIndexing()):
+
+    binding=0 -> sampler2D textures[]   (combined image samplers)
+    binding=1 -> buffers[]              (storage buffers)
+
+  Both arrays are partially bound and update-after-bind, so the set is bound
+  once per command buffer and slots are written while it is bound (even by
+  a pre-recorded command buffer). Shaders index them with ids from the push
+  constants / object data under nonuniformEXT(); a draw never binds a
+  per-material set.
+
+  Buffer slot 0 is reserved for the MaterialTable (setMaterialBuffer), so
+  shaders can find the materials without being told where they are.
+
+  A removed slot goes back to the free list right away: the caller makes
+  sure no frame in flight still reads it (same as the per-image UBOs).
+
+    BindlessDescriptors bindless;
+    bindless.create(device, physDevice);
+    uint32_t tex = bindless.addTexture(device, view, sampler);
+    ...
+    vkCmdBindDescriptorSets(cb, ..., layout, BindlessDescriptors::SET_INDEX, 1, &set, 0, nullptr);
+*/
+class BindlessDescriptors {
+public:
+    // set=3 of GraphicsPipeline's layout when bindless is on
+    static const uint32_t SET_INDEX = 3;
+    static const uint32_t TEXTURE_BINDING = 0;
+    static const uint32_t BUFFER_BINDING = 1;
+    static const uint32_t MATERIAL_BUFFER_SLOT = 0;
+    static const uint32_t INVALID_SLOT = 0xFFFFFFFFu;
+
+    BindlessDescriptors() = default;
+    ~BindlessDescriptors() = default;
+
+    // Capacities are clamped to the device's update-after-bind limits
+    void create(VkDevice device, PhysicalDevice& physDevice,
+        uint32_t maxTextures = 1024, uint32_t maxBuffers = 256);
+    void destroy(VkDevice device);
+
+    // Image must be in SHADER_READ_ONLY_OPTIMAL when sampled. INVALID_SLOT
+    // when the array is full.
+    uint32_t addTexture(VkDevice device, VkImageView view, VkSampler sampler);
+    void     updateTexture(VkDevice device, uint32_t slot, VkImageView view, VkSampler sampler);
+    void     removeTexture(uint32_t slot);
+
+    uint32_t addBuffer(VkDevice device, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+    void     removeBuffer(uint32_t slot);
+
+    // Writes the reserved slot 0
+    void setMaterialBuffer(VkDevice device, VkBuffer buffer, VkDeviceSize range = VK_WHOLE_SIZE);
+
+    VkDescriptorSetLayout getSetLayout() const { return setLayout; }
+    VkDescriptorSet       getDescriptorSet() const { return descriptorSet; }
+
+    uint32_t getTextureCapacity() const { return textureCapacity; }
+    uint32_t getBufferCapacity() const { return bufferCapacity; }
+    uint32_t getTextureCount() const { return textureCount - (uint32_t)freeTextures.size(); }
+    uint32_t getBufferCount() const { return bufferCount - (uint32_t)freeBuffers.size(); }
+
+private:
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool      descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet       descriptorSet = VK_NULL_HANDLE;
+
+    uint32_t textureCapacity = 0;
+    uint32_t bufferCapacity = 0;
+
+    // Slots [0, count) have been handed out at least once, freed ones are
+    // reused before count grows
+    uint32_t              textureCount = 0;
+    uint32_t              bufferCount = 1;   // slot 0 = materials
+    std::vector<uint32_t> freeTextures;
+    std::vector<uint32_t> freeBuffers;
+
+    uint32_t allocateSlot(uint32_t& count, uint32_t capacity, std::vector<uint32_t>& freeList);
+    void writeBuffer(VkDevice device, uint32_t slot, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+};
+
+#endif // BINDLESS_DESCRIPTORS_H
@@ -0,0 +1,713 @@
+// CascadedShadowMap.cpp
+#include "CascadedShadowMap.h"
+#include "PhysicalDevice.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <array>
+
+// Extra depth in front of each cascade so casters outside the camera
+// frustum (between the light and the slice) still land in the map
+static const float CASTER_MARGIN = 20.0f;
+
+// With the static cache a cascade moves in steps of resolution / this many
+// texels instead of single texels
+static const uint32_t CACHE_SNAP_DIVISOR = 16;
+
+void CascadedShadowMap::create(VkDevice device, PhysicalDevice& physDevice, VkRenderPass pass,
+    uint32_t res, uint32_t count)
+{
+    if (count < 1 || count > MAX_CASCADES) {
+        throw std::runtime_error("CascadedShadowMap: cascade count must be 1..4!");
+    }
+    shadowPass = pass;
+    resolution = res;
+    cascadeCount = count;
+
+    // ------------------------------------------------------------------
+    // 1) Layered depth image, one layer per cascade
+    // ------------------------------------------------------------------
+    VkImageCreateInfo imgInfo{};
+    imgInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imgInfo.imageType = VK_IMAGE_TYPE_2D;
+    imgInfo.extent = { resolution, resolution, 1 };
+    imgInfo.mipLevels = 1;
+    imgInfo.arrayLayers = cascadeCount;
+    imgInfo.format = VK_FORMAT_D32_SFLOAT;
+    imgInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imgInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    // TRANSFER_DST: the static cache is copied in before the dynamic casters
+    imgInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    imgInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imgInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateImage(device, &imgInfo, nullptr, &depthImage) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create cascaded shadow image!");
+    }
+
+    VkMemoryRequirements memReq;
+    vkGetImageMemoryRequirements(device, depthImage, &memReq);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReq.size;
+    allocInfo.memoryTypeIndex = physDevice.findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &depthMemory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate cascaded shadow memory!");
+    }
+    vkBindImageMemory(device, depthImage, depthMemory, 0);
+
+    // ------------------------------------------------------------------
+    // 2) Array view for sampling + a single-layer view/framebuffer per cascade
+    // ------------------------------------------------------------------
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = depthImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    viewInfo.format = VK_FORMAT_D32_SFLOAT;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = cascadeCount;
+    if (vkCreateImageView(device, &viewInfo, nullptr, &arrayView) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create cascaded shadow array view!");
+    }
+
+    layerViews.resize(cascadeCount, VK_NULL_HANDLE);
+    framebuffers.resize(cascadeCount, VK_NULL_HANDLE);
+    for (uint32_t i = 0; i < cascadeCount; i++) {
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.subresourceRange.baseArrayLayer = i;
+        viewInfo.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &layerViews[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create cascade layer view!");
+        }
+
+        VkFramebufferCreateInfo fbInfo{};
+        fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        fbInfo.renderPass = shadowPass;
+        fbInfo.attachmentCount = 1;
+        fbInfo.pAttachments = &layerViews[i];
+        fbInfo.width = resolution;
+        fbInfo.height = resolution;
+        fbInfo.layers = 1;
+        if (vkCreateFramebuffer(device, &fbInfo, nullptr, &framebuffers[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create cascade framebuffer!");
+        }
+    }
+}
+
+void CascadedShadowMap::destroy(VkDevice device)
+{
+    for (VkFramebuffer fb : cacheFramebuffers) {
+        vkDestroyFramebuffer(device, fb, nullptr);
+    }
+    cacheFramebuffers.clear();
+    for (VkImageView view : cacheLayerViews) {
+        vkDestroyImageView(device, view, nullptr);
+    }
+    cacheLayerViews.clear();
+    if (cacheImage) {
+        vkDestroyImage(device, cacheImage, nullptr);
+        cacheImage = VK_NULL_HANDLE;
+    }
+    if (cacheMemory) {
+        vkFreeMemory(device, cacheMemory, nullptr);
+        cacheMemory = VK_NULL_HANDLE;
+    }
+    if (cacheStaticPass) {
+        vkDestroyRenderPass(device, cacheStaticPass, nullptr);
+        cacheStaticPass = VK_NULL_HANDLE;
+    }
+    if (cacheDynamicPass) {
+        vkDestroyRenderPass(device, cacheDynamicPass, nullptr);
+        cacheDynamicPass = VK_NULL_HANDLE;
+    }
+    pendingRegions.clear();
+
+    for (VkFramebuffer fb : framebuffers) {
+        vkDestroyFramebuffer(device, fb, nullptr);
+    }
+    framebuffers.clear();
+    for (VkImageView view : layerViews) {
+        vkDestroyImageView(device, view, nullptr);
+    }
+    layerViews.clear();
+    if (arrayView) {
+        vkDestroyImageView(device, arrayView, nullptr);
+        arrayView = VK_NULL_HANDLE;
+    }
+    if (depthImage) {
+        vkDestroyImage(device, depthImage, nullptr);
+        depthImage = VK_NULL_HANDLE;
+    }
+    if (depthMemory) {
+        vkFreeMemory(device, depthMemory, nullptr);
+        depthMemory = VK_NULL_HANDLE;
+    }
+}
+
+void CascadedShadowMap::update(const glm::mat4& cameraView, float fovY, float aspect,
+    float zNear, float zFar, const glm::vec3& lightDir)
+{
+    const float farPlane = std::min(zFar, shadowDistance);
+    const glm::vec3 L = glm::normalize(lightDir);
+
+    gpuData.cameraView = cameraView;
+    gpuData.lightDir = glm::vec4(L, (float)cascadeCount);
+    gpuData.cascadeSplits = glm::vec4(0.0f);
+    gpuData.shadowParams = glm::vec4(1.0f / (float)resolution, (float)(int32_t)pcfKernel, depthBias, 0.0f);
+
+    // Camera -> world, and the frustum slope for the slice corners
+    const glm::mat4 invView = glm::inverse(cameraView);
+    const float tanY = std::tan(fovY * 0.5f);
+    const float tanX = tanY * aspect;
+
+    // Light "up" must not be parallel to the light direction
+    const glm::vec3 up = (std::fabs(L.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+    // Light space anchored at the world origin, only the rotation depends on
+    // the light: a camera move is a plain shift of the cascade in this frame.
+    // Looks away from the light, so +z points towards it.
+    const glm::mat4 lightRot = glm::lookAt(glm::vec3(0.0f), -L, up);
+    const float snapTexels = hasStaticCache() ? (float)std::max(1u, resolution / CACHE_SNAP_DIVISOR) : 1.0f;
+
+    float sliceNear = zNear;
+    for (uint32_t i = 0; i < cascadeCount; i++) {
+        // 1) Practical split: blend of logarithmic and uniform
+        float p = (float)(i + 1) / (float)cascadeCount;
+        float logSplit = zNear * std::pow(farPlane / zNear, p);
+        float uniSplit = zNear + (farPlane - zNear) * p;
+        float sliceFar = splitLambda * logSplit + (1.0f - splitLambda) * uniSplit;
+        gpuData.cascadeSplits[i] = sliceFar;
+
+        // 2) The 8 world-space corners of the slice
+        glm::vec3 corners[8];
+        int c = 0;
+        for (float d : { sliceNear, sliceFar }) {
+            for (float sy : { -1.0f, 1.0f }) {
+                for (float sx : { -1.0f, 1.0f }) {
+                    glm::vec4 viewPos(sx * tanX * d, sy * tanY * d, -d, 1.0f);
+                    corners[c++] = glm::vec3(invView * viewPos);
+                }
+            }
+        }
+
+        // 3) Bounding sphere: its size only depends on the split distances,
+        //    so the cascade doesn't grow/shrink when the camera rotates
+        glm::vec3 center(0.0f);
+        for (const glm::vec3& corner : corners) {
+            center += corner;
+        }
+        center /= 8.0f;
+        float radius = 0.0f;
+        for (const glm::vec3& corner : corners) {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        // 4) Snap the center to a grid of the light frame: whole texels (no
+        //    shimmering), or snapTexels with the static cache so the cascade
+        //    and its cached depth stay put for a while. The half size grows
+        //    by half a step, the sphere fits wherever it sits in its cell.
+        const float halfSize = (snapTexels > 1.0f) ? radius / (1.0f - snapTexels / (float)resolution) : radius;
+        const float step = snapTexels * 2.0f * halfSize / (float)resolution;
+        const glm::vec3 lightCenter = glm::vec3(lightRot * glm::vec4(center, 1.0f));
+        const float cx = std::round(lightCenter.x / step) * step;
+        const float cy = std::round(lightCenter.y / step) * step;
+
+        // 5) Depth range, towards the light first. With the cache its top is
+        //    snapped too (halfSize steps, the range grows by one step), so
+        //    the cached depth values don't shift with every camera move.
+        const float zStep = hasStaticCache() ? halfSize : 0.0f;
+        float zTop = lightCenter.z + halfSize;
+        if (zStep > 0.0f) {
+            zTop = std::ceil(zTop / zStep) * zStep;
+        }
+        zTop += CASTER_MARGIN;
+        const float depthRange = 2.0f * halfSize + CASTER_MARGIN + zStep;
+
+        // Ortho light projection (Vulkan 0..1 depth)
+        glm::mat4 lightProj = glm::orthoRH_ZO(cx - halfSize, cx + halfSize, cy - halfSize, cy + halfSize,
+            -zTop, depthRange - zTop);
+        gpuData.cascadeViewProj[i] = lightProj * lightRot;
+
+        // 6) Culling volumes: the cascade box for casters, the camera slice
+        //    for where their shadows have to land
+        lightFrusta[i] = Frustum(gpuData.cascadeViewProj[i]);
+        sliceFrusta[i] = Frustum(glm::perspectiveRH_ZO(fovY, aspect, sliceNear, sliceFar) * cameraView);
+        casterSweep[i] = depthRange;
+
+        sliceNear = sliceFar;
+    }
+}
+
+bool CascadedShadowMap::casterVisible(uint32_t cascade, const Aabb& worldBox) const
+{
+    if (!lightFrusta[cascade].intersects(worldBox)) {
+        return false;
+    }
+    // Shadows go away from the light, at most through the whole cascade depth
+    const glm::vec3 awayFromLight = -glm::vec3(gpuData.lightDir);
+    return sliceFrusta[cascade].intersectsSwept(worldBox, awayFromLight, casterSweep[cascade]);
+}
+
+void CascadedShadowMap::setCascadeState(VkCommandBuffer cb, const VkRect2D& scissor) const
+{
+    // Plain viewport: shader.frag maps light NDC to uv with ndc * 0.5 + 0.5
+    VkViewport vp{};
+    vp.x = 0.f;
+    vp.y = 0.f;
+    vp.width = (float)resolution;
+    vp.height = (float)resolution;
+    vp.minDepth = 0.f;
+    vp.maxDepth = 1.f;
+    vkCmdSetViewport(cb, 0, 1, &vp);
+    vkCmdSetScissor(cb, 0, 1, &scissor);
+
+    vkCmdSetDepthBias(cb, 1.25f, 0.f, 1.75f);
+}
+
+void CascadedShadowMap::record(VkCommandBuffer cb, VkPipeline pipeline,
+    const std::function<void(VkCommandBuffer, uint32_t)>& drawScene) const
+{
+    VkClearValue clearDepth{};
+    clearDepth.depthStencil = { 1.f, 0 };
+
+    VkRect2D full{};
+    full.offset = { 0, 0 };
+    full.extent = { resolution, resolution };
+
+    for (uint32_t i = 0; i < cascadeCount; i++) {
+        VkRenderPassBeginInfo rpBegin{};
+        rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        rpBegin.renderPass = shadowPass;
+        rpBegin.framebuffer = framebuffers[i];
+        rpBegin.renderArea = full;
+        rpBegin.clearValueCount = 1;
+        rpBegin.pClearValues = &clearDepth;
+
+        vkCmdBeginRenderPass(cb, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        setCascadeState(cb, full);
+
+        drawScene(cb, i);
+
+        vkCmdEndRenderPass(cb);
+    }
+}
+
+// ----------------------------------------------------------------------
+// Static caster cache
+// ----------------------------------------------------------------------
+
+// Depth-only pass that keeps what's already in the attachment
+static VkRenderPass createLoadPass(VkDevice device, VkImageLayout initialLayout, VkImageLayout finalLayout,
+    const std::vector<VkSubpassDependency>& deps)
+{
+    VkAttachmentDescription depthAttachment{};
+    depthAttachment.format = VK_FORMAT_D32_SFLOAT;
+    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout = initialLayout;
+    depthAttachment.finalLayout = finalLayout;
+
+    VkAttachmentReference depthRef{};
+    depthRef.attachment = 0;
+    depthRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.pDepthStencilAttachment = &depthRef;
+
+    VkRenderPassCreateInfo rpInfo{};
+    rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    rpInfo.attachmentCount = 1;
+    rpInfo.pAttachments = &depthAttachment;
+    rpInfo.subpassCount = 1;
+    rpInfo.pSubpasses = &subpass;
+    rpInfo.dependencyCount = static_cast<uint32_t>(deps.size());
+    rpInfo.pDependencies = deps.empty() ? nullptr : deps.data();
+
+    VkRenderPass pass = VK_NULL_HANDLE;
+    if (vkCreateRenderPass(device, &rpInfo, nullptr, &pass) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shadow cache render pass!");
+    }
+    return pass;
+}
+
+void CascadedShadowMap::enableStaticCache(VkDevice device, PhysicalDevice& physDevice,
+    VkCommandPool commandPool, VkQueue queue)
+{
+    if (depthImage == VK_NULL_HANDLE) {
+        throw std::runtime_error("CascadedShadowMap: create() before enableStaticCache()!");
+    }
+
+    // ------------------------------------------------------------------
+    // 1) Render passes
+    //    static:  TRANSFER_SRC -> TRANSFER_SRC (copied out every frame).
+    //             The cache never leaves this class, its own dependencies
+    //             order it against the copies.
+    //    dynamic: stays DEPTH_STENCIL_ATTACHMENT, the render graph moves
+    //             the cascades in and out of it
+    //    Both are compatible with shadowPass, so the framebuffers match.
+    // ------------------------------------------------------------------
+    const VkPipelineStageFlags depthStages =
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    const VkAccessFlags depthAccess =
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    VkSubpassDependency in{};
+    in.srcSubpass = VK_SUBPASS_EXTERNAL;
+    in.dstSubpass = 0;
+    in.dstStageMask = depthStages;
+    in.dstAccessMask = depthAccess;
+
+    VkSubpassDependency out{};
+    out.srcSubpass = 0;
+    out.dstSubpass = VK_SUBPASS_EXTERNAL;
+    out.srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    out.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    // Static: after last frame's copy read it, before this frame's copy
+    in.srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    in.srcAccessMask = 0;
+    out.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    out.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    cacheStaticPass = createLoadPass(device,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, { in, out });
+
+    cacheDynamicPass = createLoadPass(device,
+        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, {});
+
+    // ------------------------------------------------------------------
+    // 2) Cache image, same layout as the sampled one
+    // ------------------------------------------------------------------
+    VkImageCreateInfo imgInfo{};
+    imgInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imgInfo.imageType = VK_IMAGE_TYPE_2D;
+    imgInfo.extent = { resolution, resolution, 1 };
+    imgInfo.mipLevels = 1;
+    imgInfo.arrayLayers = cascadeCount;
+    imgInfo.format = VK_FORMAT_D32_SFLOAT;
+    imgInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imgInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imgInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imgInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imgInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateImage(device, &imgInfo, nullptr, &cacheImage) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shadow cache image!");
+    }
+
+    VkMemoryRequirements memReq;
+    vkGetImageMemoryRequirements(device, cacheImage, &memReq);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReq.size;
+    allocInfo.memoryTypeIndex = physDevice.findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &cacheMemory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate shadow cache memory!");
+    }
+    vkBindImageMemory(device, cacheImage, cacheMemory, 0);
+
+    // ------------------------------------------------------------------
+    // 3) Per-layer views / framebuffers
+    // ------------------------------------------------------------------
+    cacheLayerViews.resize(cascadeCount, VK_NULL_HANDLE);
+    cacheFramebuffers.resize(cascadeCount, VK_NULL_HANDLE);
+    for (uint32_t i = 0; i < cascadeCount; i++) {
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = cacheImage;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = VK_FORMAT_D32_SFLOAT;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = i;
+        viewInfo.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &cacheLayerViews[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create shadow cache layer view!");
+        }
+
+        VkFramebufferCreateInfo fbInfo{};
+        fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        fbInfo.renderPass = cacheStaticPass;
+        fbInfo.attachmentCount = 1;
+        fbInfo.pAttachments = &cacheLayerViews[i];
+        fbInfo.width = resolution;
+        fbInfo.height = resolution;
+        fbInfo.layers = 1;
+        if (vkCreateFramebuffer(device, &fbInfo, nullptr, &cacheFramebuffers[i]) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create shadow cache framebuffer!");
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // 4) Starting layouts (one-time submit): the cache in TRANSFER_SRC, the
+    //    cascades in SHADER_READ_ONLY like at the end of every frame, so
+    //    the render graph can import them in that state. The first
+    //    recordCacheCopy redraws and copies every texel.
+    // ------------------------------------------------------------------
+    {
+        VkCommandBufferAllocateInfo cbInfo{};
+        cbInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cbInfo.commandPool = commandPool;
+        cbInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cbInfo.commandBufferCount = 1;
+
+        VkCommandBuffer cb;
+        if (vkAllocateCommandBuffers(device, &cbInfo, &cb) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate shadow cache init command buffer!");
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(cb, &beginInfo);
+
+        std::array<VkImageMemoryBarrier, 2> init{};
+        for (VkImageMemoryBarrier& b : init) {
+            b.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            b.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            b.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+            b.subresourceRange.baseMipLevel = 0;
+            b.subresourceRange.levelCount = 1;
+            b.subresourceRange.baseArrayLayer = 0;
+            b.subresourceRange.layerCount = cascadeCount;
+            b.srcAccessMask = 0;
+            b.dstAccessMask = 0;
+        }
+        init[0].image = cacheImage;
+        init[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        init[1].image = depthImage;
+        init[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        vkCmdPipelineBarrier(cb,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0, 0, nullptr, 0, nullptr, (uint32_t)init.size(), init.data());
+
+        vkEndCommandBuffer(cb);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &cb;
+        vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+        vkQueueWaitIdle(queue);
+
+        vkFreeCommandBuffers(device, commandPool, 1, &cb);
+    }
+
+    invalidateStatic();
+}
+
+// Union of two texel rects, extent 0 counts as empty
+static VkRect2D unionRect(const VkRect2D& a, const VkRect2D& b)
+{
+    if (a.extent.width == 0 || a.extent.height == 0) return b;
+    if (b.extent.width == 0 || b.extent.height == 0) return a;
+    int32_t x0 = std::min(a.offset.x, b.offset.x);
+    int32_t y0 = std::min(a.offset.y, b.offset.y);
+    int32_t x1 = std::max(a.offset.x + (int32_t)a.extent.width, b.offset.x + (int32_t)b.extent.width);
+    int32_t y1 = std::max(a.offset.y + (int32_t)a.extent.height, b.offset.y + (int32_t)b.extent.height);
+    VkRect2D u{};
+    u.offset = { x0, y0 };
+    u.extent = { (uint32_t)(x1 - x0), (uint32_t)(y1 - y0) };
+    return u;
+}
+
+void CascadedShadowMap::invalidateStatic()
+{
+    for (uint32_t i = 0; i < MAX_CASCADES; i++) {
+        dirtyRects[i].offset = { 0, 0 };
+        dirtyRects[i].extent = { resolution, resolution };
+    }
+    pendingRegions.clear();
+}
+
+void CascadedShadowMap::invalidateStaticRegion(const glm::vec3& worldMin, const glm::vec3& worldMax)
+{
+    // Projected in recordCacheCopy, with the matrices of the frame that redraws it
+    pendingRegions.emplace_back(worldMin, worldMax);
+}
+
+VkRect2D CascadedShadowMap::texelRect(uint32_t cascade, const glm::vec3& mn, const glm::vec3& mx) const
+{
+    const glm::mat4& viewProj = gpuData.cascadeViewProj[cascade];
+
+    float x0 = FLT_MAX, y0 = FLT_MAX, x1 = -FLT_MAX, y1 = -FLT_MAX;
+    for (int c = 0; c < 8; c++) {
+        glm::vec4 corner((c & 1) ? mx.x : mn.x, (c & 2) ? mx.y : mn.y, (c & 4) ? mx.z : mn.z, 1.0f);
+        glm::vec4 clip = viewProj * corner;
+        // Orthographic, w stays 1
+        float u = (clip.x * 0.5f + 0.5f) * (float)resolution;
+        float v = (clip.y * 0.5f + 0.5f) * (float)resolution;
+        x0 = std::min(x0, u);
+        y0 = std::min(y0, v);
+        x1 = std::max(x1, u);
+        y1 = std::max(y1, v);
+    }
+
+    // One texel of padding for rasterization rounding, then clamp to the layer
+    const float res = (float)resolution;
+    int32_t ix0 = (int32_t)std::max(0.0f, std::floor(x0) - 1.0f);
+    int32_t iy0 = (int32_t)std::max(0.0f, std::floor(y0) - 1.0f);
+    int32_t ix1 = (int32_t)std::min(res, std::ceil(x1) + 1.0f);
+    int32_t iy1 = (int32_t)std::min(res, std::ceil(y1) + 1.0f);
+
+    VkRect2D rect{};
+    if (ix1 > ix0 && iy1 > iy0) {
+        rect.offset = { ix0, iy0 };
+        rect.extent = { (uint32_t)(ix1 - ix0), (uint32_t)(iy1 - iy0) };
+    }
+    return rect;
+}
+
+void CascadedShadowMap::recordCacheCopy(VkCommandBuffer cb, VkPipeline pipeline,
+    const std::vector<Aabb>& dynamicBoxes,
+    const std::function<void(VkCommandBuffer, uint32_t)>& drawStatic)
+{
+    if (!hasStaticCache()) {
+        throw std::runtime_error("CascadedShadowMap: recordCacheCopy without enableStaticCache!");
+    }
+
+    VkRect2D full{};
+    full.offset = { 0, 0 };
+    full.extent = { resolution, resolution };
+
+    // ------------------------------------------------------------------
+    // 1) Work out what's dirty. The cascade matrices only change when a
+    //    cascade crossed a snap cell or the light changed (see update()),
+    //    then that cascade is redrawn whole; otherwise only the texels
+    //    covered by the invalidated boxes.
+    // ------------------------------------------------------------------
+    for (uint32_t i = 0; i < cascadeCount; i++) {
+        if (cachedViewProj[i] != gpuData.cascadeViewProj[i]) {
+            dirtyRects[i] = full;
+            cachedViewProj[i] = gpuData.cascadeViewProj[i];
+            continue;
+        }
+        for (const auto& region : pendingRegions) {
+            dirtyRects[i] = unionRect(dirtyRects[i], texelRect(i, region.first, region.second));
+        }
+    }
+    pendingRegions.clear();
+
+    // The sampled image still holds last frame's static + dynamic depth:
+    // restore the texels that changed statically or had a dynamic caster
+    VkRect2D copyRects[MAX_CASCADES]{};
+    for (uint32_t i = 0; i < cascadeCount; i++) {
+        copyRects[i] = unionRect(dirtyRects[i], dynamicRects[i]);
+        dynamicRects[i] = VkRect2D{};
+        for (const Aabb& box : dynamicBoxes) {
+            dynamicRects[i] = unionRect(dynamicRects[i], texelRect(i, box.min, box.max));
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // 2) Redraw the static casters into the dirty rects only
+    // ------------------------------------------------------------------
+    staticTexelsRedrawn = 0;
+    for (uint32_t i = 0; i < cascadeCount; i++) {
+        const VkRect2D rect = dirtyRects[i];
+        if (rect.extent.width == 0 || rect.extent.height == 0) {
+            continue;
+        }
+
+        VkRenderPassBeginInfo rpBegin{};
+        rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        rpBegin.renderPass = cacheStaticPass;
+        rpBegin.framebuffer = cacheFramebuffers[i];
+        rpBegin.renderArea = rect;
+
+        vkCmdBeginRenderPass(cb, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        setCascadeState(cb, rect);
+
+        // LOAD keeps the clean texels, reset the dirty ones to the far plane
+        VkClearAttachment clear{};
+        clear.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        clear.clearValue.depthStencil = { 1.f, 0 };
+        VkClearRect clearRect{};
+        clearRect.rect = rect;
+        clearRect.baseArrayLayer = 0;
+        clearRect.layerCount = 1;
+        vkCmdClearAttachments(cb, 1, &clear, 1, &clearRect);
+
+        drawStatic(cb, i);
+
+        vkCmdEndRenderPass(cb);
+
+        staticTexelsRedrawn += (uint64_t)rect.extent.width * rect.extent.height;
+        dirtyRects[i] = VkRect2D{};
+    }
+
+    // ------------------------------------------------------------------
+    // 3) Copy the restored rects into the sampled image (none when the
+    //    cache is clean and nothing dynamic was drawn last frame). The
+    //    static pass' dependency covers the cache, the graph the cascades.
+    // ------------------------------------------------------------------
+    std::array<VkImageCopy, MAX_CASCADES> copies{};
+    uint32_t copyCount = 0;
+    texelsCopied = 0;
+    for (uint32_t i = 0; i < cascadeCount; i++) {
+        const VkRect2D rect = copyRects[i];
+        if (rect.extent.width == 0 || rect.extent.height == 0) {
+            continue;
+        }
+        VkImageCopy& copy = copies[copyCount++];
+        copy.srcSubresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        copy.srcSubresource.mipLevel = 0;
+        copy.srcSubresource.baseArrayLayer = i;
+        copy.srcSubresource.layerCount = 1;
+        copy.dstSubresource = copy.srcSubresource;
+        copy.srcOffset = { rect.offset.x, rect.offset.y, 0 };
+        copy.dstOffset = copy.srcOffset;
+        copy.extent = { rect.extent.width, rect.extent.height, 1 };
+        texelsCopied += (uint64_t)rect.extent.width * rect.extent.height;
+    }
+    if (copyCount > 0) {
+        vkCmdCopyImage(cb,
+            cacheImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            depthImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            copyCount, copies.data());
+    }
+}
+
+void CascadedShadowMap::recordDynamic(VkCommandBuffer cb, VkPipeline pipeline,
+    const std::function<void(VkCommandBuffer, uint32_t)>& drawDynamic) const
+{
+    if (!hasStaticCache()) {
+        throw std::runtime_error("CascadedShadowMap: recordDynamic without enableStaticCache!");
+    }
+
+    VkRect2D full{};
+    full.offset = { 0, 0 };
+    full.extent = { resolution, resolution };
+
+    // Dynamic casters on top of the restored static depth, every cascade
+    for (uint32_t i = 0; i < cascadeCount; i++) {
+        VkRenderPassBeginInfo rpBegin{};
+        rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        rpBegin.renderPass = cacheDynamicPass;
+        rpBegin.framebuffer = framebuffers[i];
+        rpBegin.renderArea = full;
+
+        vkCmdBeginRenderPass(cb, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        setCascadeState(cb, full);
+
+        drawDynamic(cb, i);
+
+        vkCmdEndRenderPass(cb);
+    }
+}
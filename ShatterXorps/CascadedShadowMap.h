@@ -0,0 +1,188 @@
+// CascadedShadowMap.h
+#ifndef CASCADED_SHADOW_MAP_H
+#define CASCADED_SHADOW_MAP_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <functional>
+#include <utility>
+#include "Frustum.h"
+
+class PhysicalDevice;
+
+/*
+  Cascaded shadow map for a directional light.
+
+  The camera frustum (up to shadowDistance) is split into 2..4 slices with the
+  "practical" scheme (log/uniform blend, splitLambda). Each slice gets its own
+  orthographic light projection rendered into one layer of a D32 array image.
+
+  Cascades are stable: each one is fit to the bounding sphere of its slice
+  (size doesn't change when the camera turns) and the projection is snapped
+  to whole shadow texels (no shimmering when the camera moves).
+
+  Per frame:
+    csm.update(view, fovY, aspect, near, far, lightDir);
+    copy csm.getGpuData() into the light UBO;
+    csm.record(cb, shadowPipeline, [&](VkCommandBuffer cb, uint32_t cascade) { ...draws... });
+
+  The record functions are RenderGraph passes and record no barriers: the
+  graph moves the cascades (getDepthImage, depth aspect, one layer per
+  cascade) into the layout each one documents and on to SHADER_READ_ONLY.
+
+  Static cache (enableStaticCache): static casters are rendered into a second
+  layered image that is kept between frames, and only the dynamic casters
+  are drawn every frame. With the cache on, the cascades snap to a coarse
+  grid of a world-anchored light frame (resolution / 16 texels, the depth
+  range in steps too), so a cascade's matrix only changes when the camera
+  carries it into another cell or the light moves. Then that layer is
+  redrawn whole; otherwise only the texels of invalidateStaticRegion boxes.
+  Only the texels that changed (redrawn static, last frame's dynamic
+  casters) are copied into the sampled image. With the cache the frame is
+  two graph passes: recordCacheCopy (cascades TransferWrite) then
+  recordDynamic (cascades DepthAttachmentWrite); the cascades are imported
+  in SHADER_READ_ONLY, where enableStaticCache leaves them.
+*/
+class CascadedShadowMap {
+public:
+    static const uint32_t MAX_CASCADES = 4;
+
+    // PCF kernel used by shader.frag. Every tap goes through the comparison
+    // sampler, so with linear filtering each one is already a 2x2 PCF.
+    enum class PcfKernel : int32_t {
+        FourTap = 0,   //  4 filtered taps, ~3x3 footprint
+        Poisson = 1,   // 12 filtered taps on a Poisson disk
+        Gather5x5 = 2, //  9 textureGather, 5x5 box with sub-texel weights
+        Evsm = 3       //  not PCF: 1 trilinear fetch of the EvsmShadowMap moments
+    };
+
+    // Must match LightUBO in shadow_lighting.glsl / shadow.vert (std140)
+    struct GpuData {
+        glm::mat4 cascadeViewProj[MAX_CASCADES];
+        glm::mat4 cameraView;     // for the view depth used to pick a cascade
+        glm::vec4 cascadeSplits;  // view-space far distance of each cascade
+        glm::vec4 lightDir;       // xyz: direction towards the light, w: cascade count
+        glm::vec4 shadowParams;   // x: texel size (1/resolution), y: PcfKernel, z: depth bias
+        glm::vec4 evsmParams;     // x/y: positive/negative exponent, z: light bleeding reduction, w: min variance
+    };
+
+    CascadedShadowMap() = default;
+    ~CascadedShadowMap() = default;
+
+    // shadowPass: depth-only pass (RenderPass::getShadowRenderPass), used for one framebuffer per layer
+    void create(VkDevice device, PhysicalDevice& physDevice, VkRenderPass shadowPass,
+        uint32_t resolution, uint32_t cascadeCount);
+    void destroy(VkDevice device);
+
+    // Fit the cascades to the camera frustum. lightDir points towards the light.
+    void update(const glm::mat4& cameraView, float fovY, float aspect,
+        float zNear, float zFar, const glm::vec3& lightDir);
+
+    // Caster culling for the draw callbacks: false when the world box is
+    // outside the cascade's light volume, or when its shadow (the box swept
+    // away from the light) can't reach the cascade's slice of the camera frustum
+    bool casterVisible(uint32_t cascade, const Aabb& worldBox) const;
+    // Light volume test only, for casters kept in the static cache: the
+    // cached layer has to stay valid while the camera slice changes
+    bool casterInCascade(uint32_t cascade, const Aabb& worldBox) const { return lightFrusta[cascade].intersects(worldBox); }
+
+    // One render pass per cascade, drawScene is called inside each with the
+    // pipeline bound. Every layer in DEPTH_STENCIL_ATTACHMENT_OPTIMAL before
+    // and after (graph: DepthAttachmentWrite), cleared first.
+    void record(VkCommandBuffer cb, VkPipeline pipeline,
+        const std::function<void(VkCommandBuffer, uint32_t)>& drawScene) const;
+
+    // 0 = uniform splits, 1 = logarithmic
+    void setSplitLambda(float lambda) { splitLambda = lambda; }
+    // Shadows end here even if the camera far plane is further away
+    void setShadowDistance(float d) { shadowDistance = d; }
+
+    void      setPcfKernel(PcfKernel k) { pcfKernel = k; }
+    PcfKernel getPcfKernel() const { return pcfKernel; }
+    // Subtracted from the receiver depth before the compare
+    void      setDepthBias(float b) { depthBias = b; }
+    // Exponents from EvsmShadowMap::getExponents, used when the kernel is Evsm
+    void      setEvsmParams(const glm::vec2& exponents, float lightBleedingReduction = 0.2f) {
+        gpuData.evsmParams = glm::vec4(exponents.x, exponents.y, lightBleedingReduction, 0.0001f);
+    }
+
+    // ---- Static caster cache (optional) ----
+    // commandPool / queue: one-time submit putting the cache and the
+    // cascades in their starting layouts
+    void enableStaticCache(VkDevice device, PhysicalDevice& physDevice,
+        VkCommandPool commandPool, VkQueue queue);
+    // Redraw every static texel next frame
+    void invalidateStatic();
+    // A static caster inside this world box changed. When something moves,
+    // call it for both the old and the new bounds.
+    void invalidateStaticRegion(const glm::vec3& worldMin, const glm::vec3& worldMax);
+    // Cached replacement for record(), in two passes. recordCacheCopy runs
+    // drawStatic only for the dirty part of each cascade (scissored to it)
+    // and copies what changed into the cascades, which must be in
+    // TRANSFER_DST_OPTIMAL (graph: TransferWrite). dynamicBoxes: world
+    // bounds of everything drawDynamic may draw, where next frame restores
+    // the static depth. After a record() (which overwrites every layer),
+    // call invalidateStatic() first.
+    void recordCacheCopy(VkCommandBuffer cb, VkPipeline pipeline,
+        const std::vector<Aabb>& dynamicBoxes,
+        const std::function<void(VkCommandBuffer, uint32_t)>& drawStatic);
+    // drawDynamic on top of the copied static depth, every cascade. Layers
+    // in DEPTH_STENCIL_ATTACHMENT_OPTIMAL before and after (graph:
+    // DepthAttachmentWrite).
+    void recordDynamic(VkCommandBuffer cb, VkPipeline pipeline,
+        const std::function<void(VkCommandBuffer, uint32_t)>& drawDynamic) const;
+    bool     hasStaticCache() const { return cacheImage != VK_NULL_HANDLE; }
+    // Static texels redrawn / copied by the last recordCacheCopy, 0 when fully cached
+    uint64_t getStaticTexelsRedrawn() const { return staticTexelsRedrawn; }
+    uint64_t getTexelsCopied() const { return texelsCopied; }
+
+    const GpuData& getGpuData() const { return gpuData; }
+    VkImage     getDepthImage() const { return depthImage; }
+    VkImageView getArrayView() const { return arrayView; }
+    uint32_t    getCascadeCount() const { return cascadeCount; }
+    uint32_t    getResolution() const { return resolution; }
+
+private:
+    VkRenderPass   shadowPass = VK_NULL_HANDLE;
+    VkImage        depthImage = VK_NULL_HANDLE;
+    VkDeviceMemory depthMemory = VK_NULL_HANDLE;
+    VkImageView    arrayView = VK_NULL_HANDLE;       // sampled as sampler2DArray
+    std::vector<VkImageView>   layerViews;           // one per cascade, render targets
+    std::vector<VkFramebuffer> framebuffers;
+
+    uint32_t resolution = 0;
+    uint32_t cascadeCount = 0;
+    float    splitLambda = 0.75f;
+    float    shadowDistance = 50.0f;
+    PcfKernel pcfKernel = PcfKernel::FourTap;
+    float    depthBias = 0.001f;
+
+    GpuData gpuData{};
+
+    // Filled by update() for casterVisible
+    Frustum   lightFrusta[MAX_CASCADES];
+    Frustum   sliceFrusta[MAX_CASCADES];
+    float     casterSweep[MAX_CASCADES]{};
+
+    // Viewport / scissor / depth bias shared by every shadow render pass
+    void setCascadeState(VkCommandBuffer cb, const VkRect2D& scissor) const;
+    // Texels of a cascade covered by a world box (extent 0 if it misses)
+    VkRect2D texelRect(uint32_t cascade, const glm::vec3& worldMin, const glm::vec3& worldMax) const;
+
+    // Static cache
+    VkRenderPass   cacheStaticPass = VK_NULL_HANDLE;   // LOAD, stays TRANSFER_SRC between frames
+    VkRenderPass   cacheDynamicPass = VK_NULL_HANDLE;  // LOAD on top of the copied static depth, no layout change
+    VkImage        cacheImage = VK_NULL_HANDLE;
+    VkDeviceMemory cacheMemory = VK_NULL_HANDLE;
+    std::vector<VkImageView>   cacheLayerViews;
+    std::vector<VkFramebuffer> cacheFramebuffers;
+    glm::mat4 cachedViewProj[MAX_CASCADES];
+    VkRect2D  dirtyRects[MAX_CASCADES]{};            // extent 0 = clean
+    VkRect2D  dynamicRects[MAX_CASCADES]{};          // dynamic casters of the last frame
+    std::vector<std::pair<glm::vec3, glm::vec3>> pendingRegions;
+    uint64_t  staticTexelsRedrawn = 0;
+    uint64_t  texelsCopied = 0;
+};
+
+#endif // CASCADED_SHADOW_MAP_H
@@ -0,0 +1,294 @@
+// ClusteredLights.cpp
+#include "ClusteredLights.h"
+#include "PhysicalDevice.h"
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// cluster_lights.comp: local_size_x
+static const uint32_t CLUSTER_WORKGROUP_SIZE = 64;
+
+VkDeviceSize ClusteredLights::getClusterBufferSize() const
+{
+    // uvec4 header (x: used indices) + uvec2 cells[] + uint indices[]
+    return sizeof(glm::uvec4) + sizeof(glm::uvec2) * CLUSTER_COUNT + sizeof(uint32_t) * MAX_INDICES;
+}
+
+void ClusteredLights::createBuffer(VkDevice device, PhysicalDevice& physDevice, Buffer& buf, VkDeviceSize size,
+    VkBufferUsageFlags usage, VkMemoryPropertyFlags props)
+{
+    VkBufferCreateInfo bufInfo{};
+    bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufInfo.size = size;
+    bufInfo.usage = usage;
+    bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufInfo, nullptr, &buf.buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create cluster buffer!");
+    }
+
+    VkMemoryRequirements memReq;
+    vkGetBufferMemoryRequirements(device, buf.buffer, &memReq);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReq.size;
+    allocInfo.memoryTypeIndex = physDevice.findMemoryType(memReq.memoryTypeBits, props);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &buf.memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate cluster buffer memory!");
+    }
+    vkBindBufferMemory(device, buf.buffer, buf.memory, 0);
+
+    if (props & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        vkMapMemory(device, buf.memory, 0, size, 0, &buf.mapped);
+        memset(buf.mapped, 0, (size_t)size);
+    }
+}
+
+void ClusteredLights::destroyBuffer(VkDevice device, Buffer& buf)
+{
+    if (buf.mapped) {
+        vkUnmapMemory(device, buf.memory);
+        buf.mapped = nullptr;
+    }
+    if (buf.buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, buf.buffer, nullptr);
+        buf.buffer = VK_NULL_HANDLE;
+    }
+    if (buf.memory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, buf.memory, nullptr);
+        buf.memory = VK_NULL_HANDLE;
+    }
+}
+
+void ClusteredLights::create(VkDevice device, PhysicalDevice& physDevice, float nearPlane, float farPlane)
+{
+    zNear = nearPlane;
+    zFar = farPlane;
+
+    // ------------------------------------------------------------------
+    // 1) Buffers: params UBO + light SSBO (CPU-written), cluster SSBO (GPU)
+    // ------------------------------------------------------------------
+    const VkMemoryPropertyFlags hostProps =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    createBuffer(device, physDevice, paramsBuffer, getParamsBufferSize(),
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, hostProps);
+    createBuffer(device, physDevice, lightBuffer, getLightBufferSize(),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostProps);
+    createBuffer(device, physDevice, clusterBuffer, getClusterBufferSize(),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // ------------------------------------------------------------------
+    // 2) Descriptor set for the compute pass: (0) params, (1) lights, (2) clusters
+    // ------------------------------------------------------------------
+    {
+        VkDescriptorSetLayoutBinding bindings[3]{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        bindings[1].binding = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        bindings[2].binding = 2;
+        bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[2].descriptorCount = 1;
+        bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 3;
+        layoutInfo.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create cluster descriptor set layout!");
+        }
+
+        VkDescriptorPoolSize poolSizes[2] = {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 }
+        };
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 2;
+        poolInfo.pPoolSizes = poolSizes;
+        poolInfo.maxSets = 1;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create cluster descriptor pool!");
+        }
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &descriptorSetLayout;
+        if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate cluster descriptor set!");
+        }
+
+        VkDescriptorBufferInfo infos[3]{};
+        infos[0] = { paramsBuffer.buffer, 0, getParamsBufferSize() };
+        infos[1] = { lightBuffer.buffer, 0, getLightBufferSize() };
+        infos[2] = { clusterBuffer.buffer, 0, getClusterBufferSize() };
+
+        VkWriteDescriptorSet writes[3]{};
+        for (uint32_t i = 0; i < 3; i++) {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = descriptorSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorType = bindings[i].descriptorType;
+            writes[i].descriptorCount = 1;
+            writes[i].pBufferInfo = &infos[i];
+        }
+        vkUpdateDescriptorSets(device, 3, writes, 0, nullptr);
+    }
+
+    // ------------------------------------------------------------------
+    // 3) Compute pipeline
+    // ------------------------------------------------------------------
+    {
+        VkPipelineLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layoutInfo.setLayoutCount = 1;
+        layoutInfo.pSetLayouts = &descriptorSetLayout;
+        if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create cluster pipeline layout!");
+        }
+
+        auto compCode = readFile("shaders/cluster_lights.comp.spv");
+        VkShaderModule compModule = createShaderModule(device, compCode);
+
+        VkPipelineShaderStageCreateInfo stageInfo{};
+        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stageInfo.module = compModule;
+        stageInfo.pName = "main";
+
+        VkComputePipelineCreateInfo pipeInfo{};
+        pipeInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipeInfo.stage = stageInfo;
+        pipeInfo.layout = pipelineLayout;
+        if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create cluster compute pipeline!");
+        }
+
+        vkDestroyShaderModule(device, compModule, nullptr);
+    }
+}
+
+void ClusteredLights::destroy(VkDevice device)
+{
+    if (pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        pipeline = VK_NULL_HANDLE;
+    }
+    if (pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+        descriptorSet = VK_NULL_HANDLE;
+    }
+    if (descriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        descriptorSetLayout = VK_NULL_HANDLE;
+    }
+    destroyBuffer(device, clusterBuffer);
+    destroyBuffer(device, lightBuffer);
+    destroyBuffer(device, paramsBuffer);
+}
+
+void ClusteredLights::setLights(const std::vector<Light>& lights)
+{
+    lightCount = (uint32_t)std::min<size_t>(lights.size(), MAX_LIGHTS);
+
+    GpuLight* dst = static_cast<GpuLight*>(lightBuffer.mapped);
+    for (uint32_t i = 0; i < lightCount; i++) {
+        const Light& l = lights[i];
+        const bool spot = l.outerAngle > 0.0f;
+        dst[i].positionRange = glm::vec4(l.position, l.range);
+        // Point lights: cos bounds outside [-1, 1] make the cone factor 1 everywhere
+        dst[i].directionCos = glm::vec4(glm::normalize(l.direction), spot ? cosf(l.outerAngle) : -2.0f);
+        dst[i].colorCos = glm::vec4(l.color, spot ? cosf(l.innerAngle) : -1.0f);
+    }
+}
+
+void ClusteredLights::update(const glm::mat4& view, const glm::mat4& proj, VkExtent2D extent)
+{
+    // Exponential slices: slice = log(depth / near) * GRID_Z / log(far / near)
+    const float logRatio = logf(zFar / zNear);
+
+    GpuParams params{};
+    params.view = view;
+    params.projParams = glm::vec4(1.0f / proj[0][0], 1.0f / proj[1][1], zNear, zFar);
+    params.grid = glm::uvec4(GRID_X, GRID_Y, GRID_Z, lightCount);
+    params.screen = glm::vec4((float)extent.width, (float)extent.height,
+        (float)GRID_Z / logRatio, -(float)GRID_Z * logf(zNear) / logRatio);
+    memcpy(paramsBuffer.mapped, &params, sizeof(params));
+}
+
+void ClusteredLights::record(VkCommandBuffer cb)
+{
+    // 1) Reset the shared index counter (header.x)
+    vkCmdFillBuffer(cb, clusterBuffer.buffer, 0, sizeof(glm::uvec4), 0);
+
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = clusterBuffer.buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cb,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    // 2) One invocation per cluster
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+        0, 1, &descriptorSet, 0, nullptr);
+    vkCmdDispatch(cb, (CLUSTER_COUNT + CLUSTER_WORKGROUP_SIZE - 1) / CLUSTER_WORKGROUP_SIZE, 1, 1);
+
+    // 3) Cells + indices -> fragment shader of the main pass
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cb,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+VkShaderModule ClusteredLights::createShaderModule(VkDevice device, const std::vector<char>& code)
+{
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create cluster shader module!");
+    }
+    return shaderModule;
+}
+
+std::vector<char> ClusteredLights::readFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open cluster shader file: " + filename);
+    }
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+    return buffer;
+}
@@ -0,0 +1,121 @@
+// ClusteredLights.h
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+
+class PhysicalDevice;
+
+/*
+  Clustered forward shading for many unshadowed point / spot lights.
+
+  The view frustum is cut into a GRID_X x GRID_Y x GRID_Z froxel grid
+  (screen tiles x exponential depth slices). Every frame a compute pass
+  (shaders/cluster_lights.comp, one invocation per cluster) tests every
+  light's sphere against every cluster's view-space AABB and writes
+  per-cluster (offset, count) ranges into one shared light index list.
+  shader.frag finds its cluster from gl_FragCoord + view depth and only
+  loops over that range, so the per-pixel cost follows the local light
+  count instead of the total.
+
+  Buffers, all read by shader.frag at set=1:
+    binding=6 => params UBO (camera view, projection terms, grid, screen)
+    binding=7 => light SSBO (GpuLight[MAX_LIGHTS])
+    binding=8 => cluster SSBO (counter, uvec2 cells[CLUSTER_COUNT], uint indices[MAX_INDICES])
+
+  Per frame (queue idle from the last frame, single buffers are enough):
+    clusters.update(view, proj, extent);
+    clusters.record(cb);   // before the main pass
+*/
+class ClusteredLights {
+public:
+    static const uint32_t MAX_LIGHTS = 4096;
+    static const uint32_t GRID_X = 16;
+    static const uint32_t GRID_Y = 9;
+    static const uint32_t GRID_Z = 24;
+    static const uint32_t CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+    // Lights kept per cluster (the rest are dropped) and in the whole list
+    static const uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+    static const uint32_t MAX_INDICES = CLUSTER_COUNT * 64;
+
+    struct Light {
+        glm::vec3 position;
+        float     range;
+        glm::vec3 color;
+        glm::vec3 direction  = glm::vec3(0.0f, -1.0f, 0.0f);
+        float     innerAngle = 0.0f;   // half angles, radians
+        float     outerAngle = 0.0f;   // 0 => point light
+    };
+
+    // Must match ClusterLight in shader.frag / cluster_lights.comp (std430)
+    struct GpuLight {
+        glm::vec4 positionRange;   // xyz: position, w: range
+        glm::vec4 directionCos;    // xyz: direction, w: cos(outer angle), -2 for point lights
+        glm::vec4 colorCos;        // xyz: color,     w: cos(inner angle), -1 for point lights
+    };
+
+    // Must match ClusterParams in shader.frag / cluster_lights.comp (std140)
+    struct GpuParams {
+        glm::mat4  view;
+        glm::vec4  projParams;     // x: 1/proj[0][0], y: 1/proj[1][1], z: near, w: far
+        glm::uvec4 grid;           // xyz: grid size, w: light count
+        glm::vec4  screen;         // xy: framebuffer size, z/w: slice = log(depth) * z + w
+    };
+
+    ClusteredLights() = default;
+    ~ClusteredLights() = default;
+
+    // zNear / zFar: the camera projection's, the slices cover that range
+    void create(VkDevice device, PhysicalDevice& physDevice, float zNear, float zFar);
+    void destroy(VkDevice device);
+
+    // Writes the light SSBO. Lights past MAX_LIGHTS are dropped.
+    void setLights(const std::vector<Light>& lights);
+
+    // Camera of this frame (proj with the Vulkan y flip is fine)
+    void update(const glm::mat4& view, const glm::mat4& proj, VkExtent2D extent);
+
+    // Clears the index counter, bins the lights, barrier to the fragment shader
+    void record(VkCommandBuffer cb);
+
+    VkBuffer     getParamsBuffer() const { return paramsBuffer.buffer; }
+    VkBuffer     getLightBuffer() const { return lightBuffer.buffer; }
+    VkBuffer     getClusterBuffer() const { return clusterBuffer.buffer; }
+    VkDeviceSize getParamsBufferSize() const { return sizeof(GpuParams); }
+    VkDeviceSize getLightBufferSize() const { return sizeof(GpuLight) * MAX_LIGHTS; }
+    VkDeviceSize getClusterBufferSize() const;
+
+    uint32_t getLightCount() const { return lightCount; }
+
+private:
+    struct Buffer {
+        VkBuffer       buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void*          mapped = nullptr;
+    };
+    void createBuffer(VkDevice device, PhysicalDevice& physDevice, Buffer& buf, VkDeviceSize size,
+        VkBufferUsageFlags usage, VkMemoryPropertyFlags props);
+    void destroyBuffer(VkDevice device, Buffer& buf);
+
+    Buffer paramsBuffer;    // host-visible, persistently mapped
+    Buffer lightBuffer;     // host-visible, persistently mapped
+    Buffer clusterBuffer;   // device-local, written by the compute pass
+
+    VkPipeline            pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout      pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool      descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet       descriptorSet = VK_NULL_HANDLE;
+
+    float    zNear = 0.1f;
+    float    zFar = 100.0f;
+    uint32_t lightCount = 0;
+
+    VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
+    std::vector<char> readFile(const std::string& filename);
+};
+
+#endif // CLUSTERED_LIGHTS_H
@@ -0,0 +1,296 @@
+// CpuRayTracer.cpp
+#include "CpuRayTracer.h"
+#include "CpuRayTracerKernels.h"
+#include "ThreadPool.h"
+#include "SimdSupport.h"
+#include <emmintrin.h>  // SSE2, always there on x64
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+// ---------------------------------------------------------------------------
+// 4-wide SSE2 float for the packet kernel
+// ---------------------------------------------------------------------------
+namespace {
+
+    struct F4 {
+        static const int width = 4;
+        __m128 v;
+
+        F4() = default;
+        F4(__m128 x) : v(x) {}
+        explicit F4(float s) : v(_mm_set1_ps(s)) {}
+
+        static F4 ramp(float b) { return _mm_add_ps(_mm_set1_ps(b), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f)); }
+        void store(float* p) const { _mm_storeu_ps(p, v); }
+    };
+
+    inline F4 operator+(F4 a, F4 b) { return _mm_add_ps(a.v, b.v); }
+    inline F4 operator-(F4 a, F4 b) { return _mm_sub_ps(a.v, b.v); }
+    inline F4 operator*(F4 a, F4 b) { return _mm_mul_ps(a.v, b.v); }
+    inline F4 operator/(F4 a, F4 b) { return _mm_div_ps(a.v, b.v); }
+    inline F4 operator<(F4 a, F4 b) { return _mm_cmplt_ps(a.v, b.v); }
+    inline F4 operator>(F4 a, F4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+    inline F4 operator==(F4 a, F4 b) { return _mm_cmpeq_ps(a.v, b.v); }
+    inline F4 operator&(F4 a, F4 b) { return _mm_and_ps(a.v, b.v); }
+    inline F4 operator|(F4 a, F4 b) { return _mm_or_ps(a.v, b.v); }
+    inline F4 andnot(F4 m, F4 a) { return _mm_andnot_ps(m.v, a.v); }
+    inline F4 select(F4 m, F4 a, F4 b) { return _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)); }
+    inline F4 vmin(F4 a, F4 b) { return _mm_min_ps(a.v, b.v); }
+    inline F4 vmax(F4 a, F4 b) { return _mm_max_ps(a.v, b.v); }
+    inline F4 vabs(F4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+    inline F4 vsqrt(F4 a) { return _mm_sqrt_ps(a.v); }
+    inline bool any(F4 m) { return _mm_movemask_ps(m.v) != 0; }
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Scalar reference, written to follow raytrace.comp step by step
+// ---------------------------------------------------------------------------
+static bool intersectBoxScalar(const TraceParams& p, const float o[3], const float d[3], float& tHit)
+{
+    float tMin = 0.0f;
+    float tMax = 1e6f;
+
+    for (int i = 0; i < 3; i++) {
+        if (std::fabs(d[i]) < 1e-6f) {
+            if (o[i] < p.boxMin[i] || o[i] > p.boxMax[i]) {
+                return false;
+            }
+        }
+        else {
+            float ood = 1.0f / d[i];
+            float t1 = (p.boxMin[i] - o[i]) * ood;
+            float t2 = (p.boxMax[i] - o[i]) * ood;
+            if (t1 > t2) {
+                std::swap(t1, t2);
+            }
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            if (tMin > tMax) {
+                return false;
+            }
+        }
+    }
+
+    tHit = (tMin > 0.0f) ? tMin : tMax;
+    return true;
+}
+
+static float signf(float x)
+{
+    return (x > 0.0f) ? 1.0f : ((x < 0.0f) ? -1.0f : 0.0f);
+}
+
+void traceRowScalar(const TraceParams& p, uint32_t y, uint32_t x0, uint32_t x1, float* out)
+{
+    const float* L = p.lightDir;
+    const float base[3] = { 0.8f, 0.2f, 0.2f };
+
+    for (uint32_t x = x0; x < x1; x++) {
+        float* px = out + (size_t)x * 4;
+
+        // Ray generation
+        float u = ((float)x / p.width) * 2.0f - 1.0f;
+        float v = ((float)y / p.height) * 2.0f - 1.0f;
+        float invLen = 1.0f / std::sqrt(u * u + v * v + 1.0f);
+        float o[3] = { p.cameraPos[0], p.cameraPos[1], p.cameraPos[2] };
+        float d[3] = { u * invLen, v * invLen, invLen };
+
+        float color[3] = { 0.0f, 0.0f, 0.0f };
+        float alpha = 0.0f;
+        float throughput = 1.0f;
+
+        for (int bounce = 0; bounce <= p.maxBounces; bounce++) {
+            float t;
+            if (!intersectBoxScalar(p, o, d, t)) {
+                if (bounce > 0) {
+                    for (int c = 0; c < 3; c++) {
+                        color[c] += throughput * p.lightColor[c] * TRACE_ENV_AMBIENT;
+                    }
+                }
+                break;
+            }
+            if (bounce == 0) {
+                alpha = 1.0f;
+            }
+
+            // Hit position + axis normal
+            float pos[3];
+            float local[3];
+            for (int i = 0; i < 3; i++) {
+                pos[i] = o[i] + t * d[i];
+                local[i] = pos[i] - (p.boxMin[i] + p.boxMax[i]) * 0.5f;
+            }
+            float maxAxis = std::max(std::max(std::fabs(local[0]), std::fabs(local[1])), std::fabs(local[2]));
+            float n[3] = { 0.0f, 0.0f, 0.0f };
+            if (maxAxis == std::fabs(local[0])) n[0] = signf(local[0]);
+            else if (maxAxis == std::fabs(local[1])) n[1] = signf(local[1]);
+            else n[2] = signf(local[2]);
+
+            // Lambert + shadow
+            float ndotl = std::max(n[0] * L[0] + n[1] * L[1] + n[2] * L[2], 0.0f);
+            float shadowFactor = 1.0f;
+            if (p.enableShadows) {
+                float so[3] = { pos[0] + 0.001f * L[0], pos[1] + 0.001f * L[1], pos[2] + 0.001f * L[2] };
+                float st;
+                bool shadowed = intersectBoxScalar(p, so, L, st) && st > 0.0f && st < 1e6f;
+                shadowFactor = shadowed ? 0.0f : 1.0f;
+            }
+
+            float lit = ndotl * shadowFactor;
+            for (int c = 0; c < 3; c++) {
+                color[c] += throughput * ((base[c] * p.lightColor[c]) * lit + base[c] * 0.1f);
+            }
+
+            // Mirror bounce
+            throughput *= TRACE_REFLECTIVITY;
+            float dn = n[0] * d[0] + n[1] * d[1] + n[2] * d[2];
+            for (int i = 0; i < 3; i++) {
+                o[i] = pos[i] + 0.001f * n[i];
+                d[i] = d[i] - 2.0f * dn * n[i];
+            }
+        }
+
+        px[0] = color[0];
+        px[1] = color[1];
+        px[2] = color[2];
+        px[3] = alpha;
+    }
+}
+
+void traceRowSSE(const TraceParams& p, uint32_t y, uint32_t x0, uint32_t x1, float* out)
+{
+    traceRowPackets<F4>(p, y, x0, x1, out);
+}
+
+// ---------------------------------------------------------------------------
+// CpuRayTracer
+// ---------------------------------------------------------------------------
+CpuRayTracer::CpuRayTracer(uint32_t w, uint32_t h)
+    : width(w), height(h), simdPath(bestSimdPath()), pixels((size_t)w * h * 4, 0.0f)
+{
+    if (w == 0 || h == 0) {
+        throw std::runtime_error("CpuRayTracer: image size must not be zero!");
+    }
+}
+
+CpuRayTracer::SimdPath CpuRayTracer::bestSimdPath()
+{
+    if (simd::hasAVX2()) return SimdPath::AVX2;
+    if (simd::hasSSE2()) return SimdPath::SSE;
+    return SimdPath::Scalar;
+}
+
+const char* CpuRayTracer::simdPathName(SimdPath path)
+{
+    switch (path) {
+    case SimdPath::AVX2: return "AVX2 (8-wide)";
+    case SimdPath::SSE:  return "SSE (4-wide)";
+    default:             return "scalar";
+    }
+}
+
+void CpuRayTracer::setSimdPath(SimdPath path)
+{
+    SimdPath best = bestSimdPath();
+    simdPath = ((int)path > (int)best) ? best : path;
+}
+
+void CpuRayTracer::render(ThreadPool& pool)
+{
+    // 1) Per-render constants (the shader normalizes lightDir per pixel)
+    TraceParams params{};
+    const Scene& s = scene;
+    float len = std::sqrt(s.lightDir[0] * s.lightDir[0] + s.lightDir[1] * s.lightDir[1] + s.lightDir[2] * s.lightDir[2]);
+    for (int i = 0; i < 3; i++) {
+        params.cameraPos[i] = s.cameraPos[i];
+        params.lightDir[i] = (len > 0.0f) ? s.lightDir[i] / len : 0.0f;
+        params.lightColor[i] = s.lightColor[i];
+        params.boxMin[i] = s.boxMin[i];
+        params.boxMax[i] = s.boxMax[i];
+    }
+    params.width = (float)width;
+    params.height = (float)height;
+    params.enableShadows = s.enableShadows;
+    params.maxBounces = (int)s.maxBounces;
+
+    void (*traceRow)(const TraceParams&, uint32_t, uint32_t, uint32_t, float*) = traceRowScalar;
+    if (simdPath == SimdPath::AVX2) traceRow = traceRowAVX2;
+    else if (simdPath == SimdPath::SSE) traceRow = traceRowSSE;
+
+    // 2) One parallelFor index per tile, rows inside a tile are independent
+    uint32_t tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    uint32_t tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    float* image = pixels.data();
+
+    pool.parallelFor(tilesX * tilesY, [&](uint32_t tile) {
+        uint32_t x0 = (tile % tilesX) * TILE_SIZE;
+        uint32_t y0 = (tile / tilesX) * TILE_SIZE;
+        uint32_t x1 = std::min(x0 + TILE_SIZE, width);
+        uint32_t y1 = std::min(y0 + TILE_SIZE, height);
+        for (uint32_t y = y0; y < y1; y++) {
+            traceRow(params, y, x0, x1, image + (size_t)y * width * 4);
+        }
+    });
+}
+
+CpuRayTracer::CompareResult CpuRayTracer::compare(const float* a, const float* b, size_t pixelCount, float tolerance)
+{
+    CompareResult result;
+    for (size_t i = 0; i < pixelCount; i++) {
+        bool bad = false;
+        for (int c = 0; c < 4; c++) {
+            float diff = std::fabs(a[i * 4 + c] - b[i * 4 + c]);
+            result.maxError = std::max(result.maxError, diff);
+            bad = bad || diff > tolerance;
+        }
+        if (bad) {
+            result.mismatches++;
+        }
+    }
+    return result;
+}
+
+void CpuRayTracer::writePPM(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + path);
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    std::vector<unsigned char> row((size_t)width * 3);
+    for (uint32_t y = 0; y < height; y++) {
+        const float* src = pixels.data() + (size_t)y * width * 4;
+        for (uint32_t x = 0; x < width; x++) {
+            for (int c = 0; c < 3; c++) {
+                float value = std::min(std::max(src[x * 4 + c], 0.0f), 1.0f);
+                row[x * 3 + c] = (unsigned char)(value * 255.0f + 0.5f);
+            }
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+}
+
+void CpuRayTracer::writePFM(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing: " + path);
+    }
+    // Negative scale = little endian. PFM rows go bottom to top.
+    file << "PF\n" << width << " " << height << "\n-1.0\n";
+
+    std::vector<float> row((size_t)width * 3);
+    for (uint32_t y = height; y-- > 0;) {
+        const float* src = pixels.data() + (size_t)y * width * 4;
+        for (uint32_t x = 0; x < width; x++) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
+    }
+}
@@ -0,0 +1,82 @@
+// CpuRayTracer.h
+#ifndef CPU_RAY_TRACER_H
+#define CPU_RAY_TRACER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+class ThreadPool;
+
+/*
+  CPU version of shaders/raytrace.comp (PixelTracer): same ray generation,
+  slab AABB test, axis normal, Lambert + hard shadow. Used to check the GPU
+  output, as a render path when there's no Vulkan device, and as a baseline
+  for timing the compute shader.
+
+  Rays are traced in packets of 4 (SSE) or 8 (AVX2) pixels along a row, the
+  widest path the CPU supports is picked at runtime. Tiles of TILE_SIZE x
+  TILE_SIZE are spread over a ThreadPool. The scalar path follows the GLSL
+  line by line and is the reference for the packet paths.
+
+  Output is RGBA32F, row-major, the same layout as the rgba32f GPU image.
+*/
+class CpuRayTracer {
+public:
+    enum class SimdPath { Scalar, SSE, AVX2 };
+
+    // Defaults match what PixelTracer uploads (camera at origin, light straight down)
+    struct Scene {
+        float cameraPos[3] = { 0.0f, 0.0f, 0.0f };
+        float lightDir[3] = { 0.0f, -1.0f, 0.0f };
+        float lightColor[3] = { 1.0f, 1.0f, 1.0f };
+        float boxMin[3] = { -1.0f, -1.0f, 4.0f };
+        float boxMax[3] = { 1.0f, 1.0f, 6.0f };
+
+        // Same meaning as PixelTracer::PipelineConfig
+        bool     enableShadows = true;
+        uint32_t maxBounces = 0;
+    };
+
+    struct CompareResult {
+        float    maxError = 0.0f;  // largest per-channel difference
+        uint32_t mismatches = 0;   // pixels with any channel above the tolerance
+    };
+
+    static const uint32_t TILE_SIZE = 32;
+
+    CpuRayTracer(uint32_t width, uint32_t height);
+
+    void setScene(const Scene& s) { scene = s; }
+    const Scene& getScene() const { return scene; }
+
+    // Requests a path, falls back to the best one the CPU actually has
+    void setSimdPath(SimdPath path);
+    SimdPath getSimdPath() const { return simdPath; }
+    static SimdPath bestSimdPath();
+    static const char* simdPathName(SimdPath path);
+
+    // Trace the whole image
+    void render(ThreadPool& pool);
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    const std::vector<float>& getPixels() const { return pixels; }
+
+    // Compare two RGBA32F images of pixelCount pixels (e.g. CPU vs GPU readback)
+    static CompareResult compare(const float* a, const float* b, size_t pixelCount, float tolerance);
+
+    // 8-bit PPM (clamped, for a quick look) and float PFM (exact values)
+    void writePPM(const std::string& path) const;
+    void writePFM(const std::string& path) const;
+
+private:
+    uint32_t width;
+    uint32_t height;
+    Scene    scene;
+    SimdPath simdPath;
+    std::vector<float> pixels;
+};
+
+#endif // CPU_RAY_TRACER_H
@@ -0,0 +1,55 @@
+// CpuRayTracerAvx2.cpp
+// 8-wide AVX2 path of CpuRayTracer. Only called after simd::hasAVX2(), so this
+// file is the only place that may contain AVX instructions. Keep std:: headers
+// with inline functions out of here: copies compiled for AVX2 could otherwise
+// be picked by the linker for the non-AVX callers too.
+#if defined(__GNUC__) && !defined(_MSC_VER)
+#pragma GCC target("avx2")
+#endif
+
+#include "CpuRayTracerKernels.h"
+#include <immintrin.h>
+
+namespace {
+
+    struct F8 {
+        static const int width = 8;
+        __m256 v;
+
+        F8() = default;
+        F8(__m256 x) : v(x) {}
+        explicit F8(float s) : v(_mm256_set1_ps(s)) {}
+
+        static F8 ramp(float b)
+        {
+            return _mm256_add_ps(_mm256_set1_ps(b),
+                _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+        }
+        void store(float* p) const { _mm256_storeu_ps(p, v); }
+    };
+
+    inline F8 operator+(F8 a, F8 b) { return _mm256_add_ps(a.v, b.v); }
+    inline F8 operator-(F8 a, F8 b) { return _mm256_sub_ps(a.v, b.v); }
+    inline F8 operator*(F8 a, F8 b) { return _mm256_mul_ps(a.v, b.v); }
+    inline F8 operator/(F8 a, F8 b) { return _mm256_div_ps(a.v, b.v); }
+    inline F8 operator<(F8 a, F8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+    inline F8 operator>(F8 a, F8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+    inline F8 operator==(F8 a, F8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ); }
+    inline F8 operator&(F8 a, F8 b) { return _mm256_and_ps(a.v, b.v); }
+    inline F8 operator|(F8 a, F8 b) { return _mm256_or_ps(a.v, b.v); }
+    inline F8 andnot(F8 m, F8 a) { return _mm256_andnot_ps(m.v, a.v); }
+    inline F8 select(F8 m, F8 a, F8 b) { return _mm256_blendv_ps(b.v, a.v, m.v); }
+    inline F8 vmin(F8 a, F8 b) { return _mm256_min_ps(a.v, b.v); }
+    inline F8 vmax(F8 a, F8 b) { return _mm256_max_ps(a.v, b.v); }
+    inline F8 vabs(F8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+    inline F8 vsqrt(F8 a) { return _mm256_sqrt_ps(a.v); }
+    inline bool any(F8 m) { return _mm256_movemask_ps(m.v) != 0; }
+
+} // namespace
+
+void traceRowAVX2(const TraceParams& p, uint32_t y, uint32_t x0, uint32_t x1, float* out)
+{
+    traceRowPackets<F8>(p, y, x0, x1, out);
+    // Avoid AVX->SSE transition stalls in the caller
+    _mm256_zeroupper();
+}
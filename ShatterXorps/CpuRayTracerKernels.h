@@ -0,0 +1,195 @@
+// CpuRayTracerKernels.h
+// Internal to CpuRayTracer*.cpp: the packet version of raytrace.comp,
+// written once against a small "wide float" interface (see F4 / F8).
+#ifndef CPU_RAY_TRACER_KERNELS_H
+#define CPU_RAY_TRACER_KERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Everything the kernels need, prepared once per render()
+struct TraceParams {
+    float cameraPos[3];
+    float lightDir[3];   // already normalized
+    float lightColor[3];
+    float boxMin[3];
+    float boxMax[3];
+    float width;         // camera.screenSize
+    float height;
+    bool  enableShadows; // ENABLE_SHADOWS / MAX_BOUNCES specialization constants
+    int   maxBounces;
+};
+
+// Same constants as raytrace.comp
+const float TRACE_REFLECTIVITY = 0.25f;
+const float TRACE_ENV_AMBIENT = 0.1f;
+
+// Trace pixels [x0, x1) of row y into out (RGBA32F, 4 floats per pixel, out = row start)
+void traceRowScalar(const TraceParams& p, uint32_t y, uint32_t x0, uint32_t x1, float* out);
+void traceRowSSE(const TraceParams& p, uint32_t y, uint32_t x0, uint32_t x1, float* out);
+void traceRowAVX2(const TraceParams& p, uint32_t y, uint32_t x0, uint32_t x1, float* out);
+
+// ---------------------------------------------------------------------------
+// Packet kernel. W provides: W(float) splat, W::ramp(b) = {b, b+1, ...},
+// W::width, store(float*), + - * /, < > == (lane masks), & | , andnot(m, a),
+// select(m, a, b), vmin, vmax, vabs, vsqrt, any(m).
+// Anonymous namespace: each .cpp gets its own copy compiled for its ISA.
+// ---------------------------------------------------------------------------
+namespace {
+
+    template <class W>
+    inline W allLanes()
+    {
+        return W(0.0f) < W(1.0f);
+    }
+
+    template <class W>
+    inline W vsign(W x)
+    {
+        return select(x > W(0.0f), W(1.0f), select(x < W(0.0f), W(-1.0f), W(0.0f)));
+    }
+
+    // Slab test against the box, same steps as intersectCube() in raytrace.comp.
+    // Returns the lane mask of hits, tHit is only meaningful in those lanes.
+    template <class W>
+    inline W intersectBoxPacket(const TraceParams& p, const W o[3], const W d[3], W& tHit)
+    {
+        W tMin(0.0f);
+        W tMax(1e6f);
+        W miss = andnot(allLanes<W>(), allLanes<W>());
+
+        for (int i = 0; i < 3; i++) {
+            W bmin(p.boxMin[i]);
+            W bmax(p.boxMax[i]);
+
+            // Ray parallel to the slab: miss if the origin is outside it
+            W parallel = vabs(d[i]) < W(1e-6f);
+            W outside = (o[i] < bmin) | (o[i] > bmax);
+            miss = miss | (parallel & outside);
+
+            // inf/NaN in parallel lanes, those are masked out below
+            W ood = W(1.0f) / d[i];
+            W t1 = (bmin - o[i]) * ood;
+            W t2 = (bmax - o[i]) * ood;
+            tMin = select(parallel, tMin, vmax(tMin, vmin(t1, t2)));
+            tMax = select(parallel, tMax, vmin(tMax, vmax(t1, t2)));
+        }
+        // tMin only grows and tMax only shrinks, so checking once at the end
+        // is the same as the shader's early-out per axis
+        miss = miss | (tMin > tMax);
+
+        tHit = select(tMin > W(0.0f), tMin, tMax);
+        return andnot(miss, allLanes<W>());
+    }
+
+    // W::width pixels starting at x (all inside the row)
+    template <class W>
+    inline void tracePacket(const TraceParams& p, uint32_t y, uint32_t x, float* out)
+    {
+        // 1) Ray generation: u,v in [-1,1) from the pixel corner, dir = normalize(u, v, 1)
+        W u = W::ramp((float)x) / W(p.width) * W(2.0f) - W(1.0f);
+        W v = W((float)y / p.height * 2.0f - 1.0f);
+        W invLen = W(1.0f) / vsqrt(u * u + v * v + W(1.0f));
+
+        W o[3] = { W(p.cameraPos[0]), W(p.cameraPos[1]), W(p.cameraPos[2]) };
+        W d[3] = { u * invLen, v * invLen, invLen };
+
+        W L[3] = { W(p.lightDir[0]), W(p.lightDir[1]), W(p.lightDir[2]) };
+        const float base[3] = { 0.8f, 0.2f, 0.2f };
+
+        W color[3] = { W(0.0f), W(0.0f), W(0.0f) };
+        W alpha(0.0f);
+        W throughput(1.0f);
+        W active = allLanes<W>();
+
+        for (int bounce = 0; bounce <= p.maxBounces; bounce++) {
+            W t;
+            W hit = intersectBoxPacket(p, o, d, t) & active;
+
+            // Escaped bounce rays pick up the environment term
+            if (bounce > 0) {
+                W escaped = andnot(hit, active);
+                for (int c = 0; c < 3; c++) {
+                    color[c] = color[c] + select(escaped, throughput * W(p.lightColor[c]) * W(TRACE_ENV_AMBIENT), W(0.0f));
+                }
+            }
+            if (!any(hit)) {
+                break;
+            }
+            if (bounce == 0) {
+                alpha = select(hit, W(1.0f), W(0.0f));
+            }
+
+            // 2) Hit position + axis normal (x wins ties, then y, like the shader)
+            W pos[3] = { o[0] + t * d[0], o[1] + t * d[1], o[2] + t * d[2] };
+            W lx = pos[0] - W((p.boxMin[0] + p.boxMax[0]) * 0.5f);
+            W ly = pos[1] - W((p.boxMin[1] + p.boxMax[1]) * 0.5f);
+            W lz = pos[2] - W((p.boxMin[2] + p.boxMax[2]) * 0.5f);
+            W ax = vabs(lx), ay = vabs(ly), az = vabs(lz);
+            W maxAxis = vmax(vmax(ax, ay), az);
+
+            W isX = maxAxis == ax;
+            W isY = andnot(isX, maxAxis == ay);
+            W isZ = andnot(isX | isY, allLanes<W>());
+            W n[3] = {
+                select(isX, vsign(lx), W(0.0f)),
+                select(isY, vsign(ly), W(0.0f)),
+                select(isZ, vsign(lz), W(0.0f))
+            };
+
+            // 3) Lambert + hard shadow along the (directional) light
+            W ndotl = vmax(n[0] * L[0] + n[1] * L[1] + n[2] * L[2], W(0.0f));
+            W shadowFactor(1.0f);
+            if (p.enableShadows) {
+                W so[3] = {
+                    pos[0] + W(0.001f) * L[0],
+                    pos[1] + W(0.001f) * L[1],
+                    pos[2] + W(0.001f) * L[2]
+                };
+                W st;
+                W shadowHit = intersectBoxPacket(p, so, L, st);
+                W shadowed = shadowHit & (st > W(0.0f)) & (st < W(1e6f));
+                shadowFactor = select(shadowed, W(0.0f), W(1.0f));
+            }
+
+            W lit = ndotl * shadowFactor;
+            for (int c = 0; c < 3; c++) {
+                W shaded = W(base[c] * p.lightColor[c]) * lit + W(base[c] * 0.1f);
+                color[c] = color[c] + select(hit, throughput * shaded, W(0.0f));
+            }
+
+            // 4) Mirror bounce off the hit, lanes that missed stop here
+            throughput = throughput * W(TRACE_REFLECTIVITY);
+            W dn = n[0] * d[0] + n[1] * d[1] + n[2] * d[2];
+            for (int i = 0; i < 3; i++) {
+                o[i] = pos[i] + W(0.001f) * n[i];
+                d[i] = d[i] - W(2.0f) * dn * n[i];
+            }
+            active = hit;
+        }
+
+        // 5) SoA -> RGBA
+        float rs[W::width], gs[W::width], bs[W::width], as[W::width];
+        color[0].store(rs); color[1].store(gs); color[2].store(bs); alpha.store(as);
+        for (int i = 0; i < W::width; i++) {
+            float* px = out + (size_t)(x + i) * 4;
+            px[0] = rs[i]; px[1] = gs[i]; px[2] = bs[i]; px[3] = as[i];
+        }
+    }
+
+    template <class W>
+    inline void traceRowPackets(const TraceParams& p, uint32_t y, uint32_t x0, uint32_t x1, float* out)
+    {
+        uint32_t x = x0;
+        for (; x + W::width <= x1; x += W::width) {
+            tracePacket<W>(p, y, x, out);
+        }
+        // Leftover pixels at the end of the row
+        if (x < x1) {
+            traceRowScalar(p, y, x, x1, out);
+        }
+    }
+
+} // namespace
+
+#endif // CPU_RAY_TRACER_KERNELS_H
@@ -0,0 +1,728 @@
+// DeferredRenderer.cpp
+#include "DeferredRenderer.h"
+#include "ClusteredLights.h"
+#include "ShadowAtlas.h"
+#include "EvsmShadowMap.h"
+#include "BindlessDescriptors.h"
+#include "PhysicalDevice.h"
+#include "Vertex.h"
+#include "GraphicsPipeline.h"
+#include <fstream>
+#include <stdexcept>
+#include <array>
+
+static const VkFormat ALBEDO_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+static const VkFormat NORMAL_FORMAT = VK_FORMAT_R16G16_SFLOAT;
+static const VkFormat DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+static const VkFormat LIT_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+void DeferredRenderer::createImage(VkDevice device, PhysicalDevice& physDevice, Image& img,
+    VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect)
+{
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = { extent.width, extent.height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(device, &imageInfo, nullptr, &img.image) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create G-buffer image!");
+    }
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device, img.image, &memReqs);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReqs.size;
+    allocInfo.memoryTypeIndex =
+        physDevice.findMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &img.memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate G-buffer image memory!");
+    }
+    vkBindImageMemory(device, img.image, img.memory, 0);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = img.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = aspect;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+    if (vkCreateImageView(device, &viewInfo, nullptr, &img.view) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create G-buffer image view!");
+    }
+}
+
+void DeferredRenderer::destroyImage(VkDevice device, Image& img)
+{
+    if (img.view != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, img.view, nullptr);
+        img.view = VK_NULL_HANDLE;
+    }
+    if (img.image != VK_NULL_HANDLE) {
+        vkDestroyImage(device, img.image, nullptr);
+        img.image = VK_NULL_HANDLE;
+    }
+    if (img.memory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, img.memory, nullptr);
+        img.memory = VK_NULL_HANDLE;
+    }
+}
+
+void DeferredRenderer::create(VkDevice device, PhysicalDevice& physDevice, VkExtent2D size,
+    VkDescriptorSetLayout uboLayout, VkRenderPass mainPass, uint32_t frameCount,
+    const VkPipelineRenderingCreateInfoKHR* mainRendering, VkDescriptorSetLayout bindlessLayout)
+{
+    extent = size;
+
+    // ------------------------------------------------------------------
+    // 1) G-buffer + lit image, point sampler for every fetch
+    // ------------------------------------------------------------------
+    createImage(device, physDevice, albedo, ALBEDO_FORMAT,
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+    createImage(device, physDevice, normal, NORMAL_FORMAT,
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+    createImage(device, physDevice, depth, DEPTH_FORMAT,
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+    createImage(device, physDevice, lit, LIT_FORMAT,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+    {
+        VkSamplerCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        info.magFilter = VK_FILTER_NEAREST;
+        info.minFilter = VK_FILTER_NEAREST;
+        info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        info.unnormalizedCoordinates = VK_FALSE;
+        if (vkCreateSampler(device, &info, nullptr, &pointSampler) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create G-buffer sampler!");
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // 2) G-buffer render pass + framebuffer
+    // ------------------------------------------------------------------
+    createRenderPass(device);
+
+    std::array<VkImageView, 3> attachments = { albedo.view, normal.view, depth.view };
+    VkFramebufferCreateInfo fbInfo{};
+    fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fbInfo.renderPass = gbufferPass;
+    fbInfo.attachmentCount = (uint32_t)attachments.size();
+    fbInfo.pAttachments = attachments.data();
+    fbInfo.width = extent.width;
+    fbInfo.height = extent.height;
+    fbInfo.layers = 1;
+    if (vkCreateFramebuffer(device, &fbInfo, nullptr, &gbufferFramebuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create G-buffer framebuffer!");
+    }
+
+    // ------------------------------------------------------------------
+    // 3) Descriptor pool: a lighting set per frame + the composite set
+    // ------------------------------------------------------------------
+    {
+        std::array<VkDescriptorPoolSize, 4> poolSizes = { {
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 6 * frameCount + 2 },
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3 * frameCount },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * frameCount },
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, frameCount }
+        } };
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = (uint32_t)poolSizes.size();
+        poolInfo.pPoolSizes = poolSizes.data();
+        poolInfo.maxSets = frameCount + 1;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create deferred descriptor pool!");
+        }
+    }
+
+    createGeometryPipeline(device, uboLayout, bindlessLayout);
+    createLightingPipeline(device, frameCount);
+    createCompositePipeline(device, mainPass, mainRendering);
+}
+
+void DeferredRenderer::createRenderPass(VkDevice device)
+{
+    // No layout changes and no external dependencies: the main RenderGraph
+    // moves the targets into the attachment layouts before the pass and on
+    // to SHADER_READ_ONLY for the lighting pass / composite
+    std::array<VkAttachmentDescription, 3> attachments{};
+    const VkFormat formats[3] = { ALBEDO_FORMAT, NORMAL_FORMAT, DEPTH_FORMAT };
+    for (uint32_t i = 0; i < 3; i++) {
+        attachments[i].format = formats[i];
+        attachments[i].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[i].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachments[i].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        attachments[i].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[i].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachments[i].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+    attachments[2].initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    attachments[2].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    VkAttachmentReference colorRefs[2] = {
+        { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+        { 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL }
+    };
+    VkAttachmentReference depthRef{ 2, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 2;
+    subpass.pColorAttachments = colorRefs;
+    subpass.pDepthStencilAttachment = &depthRef;
+
+    VkRenderPassCreateInfo rpInfo{};
+    rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    rpInfo.attachmentCount = (uint32_t)attachments.size();
+    rpInfo.pAttachments = attachments.data();
+    rpInfo.subpassCount = 1;
+    rpInfo.pSubpasses = &subpass;
+    rpInfo.dependencyCount = 0;
+    rpInfo.pDependencies = nullptr;
+    if (vkCreateRenderPass(device, &rpInfo, nullptr, &gbufferPass) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create G-buffer render pass!");
+    }
+}
+
+void DeferredRenderer::createGeometryPipeline(VkDevice device, VkDescriptorSetLayout uboLayout,
+    VkDescriptorSetLayout bindlessLayout)
+{
+    const bool bindless = bindlessLayout != VK_NULL_HANDLE;
+    auto vertCode = readFile("shaders/shader.vert.spv");
+    auto fragCode = readFile(bindless ? "shaders/gbuffer_bindless.frag.spv" : "shaders/gbuffer.frag.spv");
+    VkShaderModule vertModule = createShaderModule(device, vertCode);
+    VkShaderModule fragModule = createShaderModule(device, fragCode);
+
+    VkPipelineShaderStageCreateInfo stages[2]{};
+    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stages[0].module = vertModule;
+    stages[0].pName = "main";
+    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    stages[1].module = fragModule;
+    stages[1].pName = "main";
+
+    // Same full Vertex stream as the forward pipeline
+    auto bindingDesc = Vertex::getBindingDescription();
+    auto attrDescs = Vertex::getAttributeDescriptions();
+
+    VkPipelineVertexInputStateCreateInfo vertexInput{};
+    vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInput.vertexBindingDescriptionCount = 1;
+    vertexInput.pVertexBindingDescriptions = &bindingDesc;
+    vertexInput.vertexAttributeDescriptionCount = (uint32_t)attrDescs.size();
+    vertexInput.pVertexAttributeDescriptions = attrDescs.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+    VkPipelineColorBlendAttachmentState blendAttachments[2]{};
+    for (auto& b : blendAttachments) {
+        b.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+            VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        b.blendEnable = VK_FALSE;
+    }
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.attachmentCount = 2;
+    colorBlending.pAttachments = blendAttachments;
+
+    std::array<VkDynamicState, 2> dynStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynState{};
+    dynState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynState.dynamicStateCount = (uint32_t)dynStates.size();
+    dynState.pDynamicStates = dynStates.data();
+
+    // set=0 camera, bindless: set=3 materials, sets 1 / 2 left empty
+    std::vector<VkDescriptorSetLayout> setLayouts = { uboLayout };
+    if (bindless) {
+        VkDescriptorSetLayoutCreateInfo emptyInfo{};
+        emptyInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        if (vkCreateDescriptorSetLayout(device, &emptyInfo, nullptr, &emptySetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create G-buffer empty set layout!");
+        }
+        setLayouts.resize(BindlessDescriptors::SET_INDEX, emptySetLayout);
+        setLayouts.push_back(bindlessLayout);
+    }
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = (uint32_t)setLayouts.size();
+    layoutInfo.pSetLayouts = setLayouts.data();
+    // shader.vert: per-draw model + material
+    VkPushConstantRange pushRange{ GraphicsPipeline::PUSH_CONSTANT_STAGES, 0, sizeof(GraphicsPipeline::PushConstants) };
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges = &pushRange;
+    if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &geometryLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create G-buffer pipeline layout!");
+    }
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = stages;
+    pipelineInfo.pVertexInputState = &vertexInput;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynState;
+    pipelineInfo.layout = geometryLayout;
+    pipelineInfo.renderPass = gbufferPass;
+    pipelineInfo.subpass = 0;
+    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &geometryPipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create G-buffer pipeline!");
+    }
+
+    vkDestroyShaderModule(device, fragModule, nullptr);
+    vkDestroyShaderModule(device, vertModule, nullptr);
+}
+
+void DeferredRenderer::createLightingPipeline(VkDevice device, uint32_t frameCount)
+{
+    // Must match deferred_lighting.comp:
+    //   0..2 G-buffer depth / albedo / normal, 3 camera UBO, 4 light UBO,
+    //   5 cascades (comparison), 6 cluster params, 7 light SSBO, 8 lit image,
+    //   9 atlas light SSBO, 10 shadow atlas (comparison), 11 EVSM moments
+    const VkDescriptorType types[12] = {
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER
+    };
+    VkDescriptorSetLayoutBinding bindings[12]{};
+    for (uint32_t i = 0; i < 12; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = types[i];
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.bindingCount = 12;
+    setLayoutInfo.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &lightingSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create deferred lighting set layout!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(frameCount, lightingSetLayout);
+    lightingSets.resize(frameCount);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = frameCount;
+    allocInfo.pSetLayouts = layouts.data();
+    if (vkAllocateDescriptorSets(device, &allocInfo, lightingSets.data()) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate deferred lighting sets!");
+    }
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = 1;
+    layoutInfo.pSetLayouts = &lightingSetLayout;
+    if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &lightingLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create deferred lighting pipeline layout!");
+    }
+
+    auto compCode = readFile("shaders/deferred_lighting.comp.spv");
+    VkShaderModule compModule = createShaderModule(device, compCode);
+
+    VkPipelineShaderStageCreateInfo stageInfo{};
+    stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    stageInfo.module = compModule;
+    stageInfo.pName = "main";
+
+    VkComputePipelineCreateInfo pipeInfo{};
+    pipeInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeInfo.stage = stageInfo;
+    pipeInfo.layout = lightingLayout;
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &lightingPipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create deferred lighting pipeline!");
+    }
+
+    vkDestroyShaderModule(device, compModule, nullptr);
+}
+
+void DeferredRenderer::createCompositePipeline(VkDevice device, VkRenderPass mainPass,
+    const VkPipelineRenderingCreateInfoKHR* rendering)
+{
+    // (0) lit image, (1) G-buffer depth
+    VkDescriptorSetLayoutBinding bindings[2]{};
+    for (uint32_t i = 0; i < 2; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.bindingCount = 2;
+    setLayoutInfo.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &compositeSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create composite set layout!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &compositeSetLayout;
+    if (vkAllocateDescriptorSets(device, &allocInfo, &compositeSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate composite set!");
+    }
+
+    VkDescriptorImageInfo imageInfos[2]{};
+    imageInfos[0] = { pointSampler, lit.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    imageInfos[1] = { pointSampler, depth.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkWriteDescriptorSet writes[2]{};
+    for (uint32_t i = 0; i < 2; i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = compositeSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[i].descriptorCount = 1;
+        writes[i].pImageInfo = &imageInfos[i];
+    }
+    vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = 1;
+    layoutInfo.pSetLayouts = &compositeSetLayout;
+    if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &compositeLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create composite pipeline layout!");
+    }
+
+    auto vertCode = readFile("shaders/fullscreen.vert.spv");
+    auto fragCode = readFile("shaders/deferred_composite.frag.spv");
+    VkShaderModule vertModule = createShaderModule(device, vertCode);
+    VkShaderModule fragModule = createShaderModule(device, fragCode);
+
+    VkPipelineShaderStageCreateInfo stages[2]{};
+    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stages[0].module = vertModule;
+    stages[0].pName = "main";
+    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    stages[1].module = fragModule;
+    stages[1].pName = "main";
+
+    // Full-screen triangle from gl_VertexIndex, no vertex buffer
+    VkPipelineVertexInputStateCreateInfo vertexInput{};
+    vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    // Writes the G-buffer depth (gl_FragDepth) into the main depth buffer
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+
+    VkPipelineColorBlendAttachmentState blendAttachment{};
+    blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+        VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    blendAttachment.blendEnable = VK_FALSE;
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &blendAttachment;
+
+    std::array<VkDynamicState, 2> dynStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynState{};
+    dynState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynState.dynamicStateCount = (uint32_t)dynStates.size();
+    dynState.pDynamicStates = dynStates.data();
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = stages;
+    pipelineInfo.pVertexInputState = &vertexInput;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynState;
+    pipelineInfo.layout = compositeLayout;
+    // Dynamic rendering: no render pass, the attachment formats come in pNext
+    pipelineInfo.pNext = rendering;
+    pipelineInfo.renderPass = mainPass;
+    pipelineInfo.subpass = 0;
+    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &compositePipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create composite pipeline!");
+    }
+
+    vkDestroyShaderModule(device, fragModule, nullptr);
+    vkDestroyShaderModule(device, vertModule, nullptr);
+}
+
+void DeferredRenderer::destroy(VkDevice device)
+{
+    VkPipeline pipelines[3] = { geometryPipeline, lightingPipeline, compositePipeline };
+    for (VkPipeline p : pipelines) {
+        if (p != VK_NULL_HANDLE) {
+            vkDestroyPipeline(device, p, nullptr);
+        }
+    }
+    geometryPipeline = lightingPipeline = compositePipeline = VK_NULL_HANDLE;
+
+    VkPipelineLayout layouts[3] = { geometryLayout, lightingLayout, compositeLayout };
+    for (VkPipelineLayout l : layouts) {
+        if (l != VK_NULL_HANDLE) {
+            vkDestroyPipelineLayout(device, l, nullptr);
+        }
+    }
+    geometryLayout = lightingLayout = compositeLayout = VK_NULL_HANDLE;
+
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+        lightingSets.clear();
+        compositeSet = VK_NULL_HANDLE;
+    }
+    if (lightingSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, lightingSetLayout, nullptr);
+        lightingSetLayout = VK_NULL_HANDLE;
+    }
+    if (emptySetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, emptySetLayout, nullptr);
+        emptySetLayout = VK_NULL_HANDLE;
+    }
+    if (compositeSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, compositeSetLayout, nullptr);
+        compositeSetLayout = VK_NULL_HANDLE;
+    }
+    if (gbufferFramebuffer != VK_NULL_HANDLE) {
+        vkDestroyFramebuffer(device, gbufferFramebuffer, nullptr);
+        gbufferFramebuffer = VK_NULL_HANDLE;
+    }
+    if (gbufferPass != VK_NULL_HANDLE) {
+        vkDestroyRenderPass(device, gbufferPass, nullptr);
+        gbufferPass = VK_NULL_HANDLE;
+    }
+    if (pointSampler != VK_NULL_HANDLE) {
+        vkDestroySampler(device, pointSampler, nullptr);
+        pointSampler = VK_NULL_HANDLE;
+    }
+    destroyImage(device, lit);
+    destroyImage(device, depth);
+    destroyImage(device, normal);
+    destroyImage(device, albedo);
+}
+
+void DeferredRenderer::setFrameInputs(VkDevice device, uint32_t frame,
+    VkBuffer cameraUBO, VkDeviceSize cameraSize,
+    VkBuffer lightUBO, VkDeviceSize lightSize,
+    VkImageView shadowView, VkSampler shadowSampler,
+    const ClusteredLights& lights, const ShadowAtlas& atlas, const EvsmShadowMap& evsm)
+{
+    VkDescriptorImageInfo images[6]{};
+    images[0] = { pointSampler, depth.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    images[1] = { pointSampler, albedo.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    images[2] = { pointSampler, normal.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    images[3] = { shadowSampler, shadowView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    images[4] = { shadowSampler, atlas.getView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    images[5] = { evsm.getSampler(), evsm.getView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+    VkDescriptorImageInfo litInfo{ VK_NULL_HANDLE, lit.view, VK_IMAGE_LAYOUT_GENERAL };
+
+    VkDescriptorBufferInfo buffers[5]{};
+    buffers[0] = { cameraUBO, 0, cameraSize };
+    buffers[1] = { lightUBO, 0, lightSize };
+    buffers[2] = { lights.getParamsBuffer(), 0, lights.getParamsBufferSize() };
+    buffers[3] = { lights.getLightBuffer(), 0, lights.getLightBufferSize() };
+    buffers[4] = { atlas.getLightBuffer(), 0, atlas.getLightBufferSize() };
+
+    std::array<VkWriteDescriptorSet, 12> writes{};
+    for (uint32_t i = 0; i < 12; i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = lightingSets[frame];
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+    }
+    // 0..2: G-buffer
+    for (uint32_t i = 0; i < 3; i++) {
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[i].pImageInfo = &images[i];
+    }
+    // 3, 4: camera / light UBO
+    writes[3].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[3].pBufferInfo = &buffers[0];
+    writes[4].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[4].pBufferInfo = &buffers[1];
+    // 5: cascades
+    writes[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[5].pImageInfo = &images[3];
+    // 6, 7: clustered light params / lights
+    writes[6].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    writes[6].pBufferInfo = &buffers[2];
+    writes[7].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[7].pBufferInfo = &buffers[3];
+    // 8: lit output
+    writes[8].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[8].pImageInfo = &litInfo;
+    // 9..11: atlas lights / shadow atlas, EVSM moments
+    writes[9].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[9].pBufferInfo = &buffers[4];
+    writes[10].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[10].pImageInfo = &images[4];
+    writes[11].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[11].pImageInfo = &images[5];
+
+    vkUpdateDescriptorSets(device, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+}
+
+void DeferredRenderer::recordGeometry(VkCommandBuffer cb, VkDescriptorSet uboSet,
+    const std::function<void(VkCommandBuffer)>& drawOpaque)
+{
+    std::array<VkClearValue, 3> clears{};
+    clears[0].color = { {0.f, 0.f, 0.f, 1.f} };
+    clears[1].color = { {0.f, 0.f, 0.f, 0.f} };
+    clears[2].depthStencil = { 1.f, 0 };
+
+    VkRenderPassBeginInfo rpBegin{};
+    rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rpBegin.renderPass = gbufferPass;
+    rpBegin.framebuffer = gbufferFramebuffer;
+    rpBegin.renderArea.offset = { 0, 0 };
+    rpBegin.renderArea.extent = extent;
+    rpBegin.clearValueCount = (uint32_t)clears.size();
+    rpBegin.pClearValues = clears.data();
+    vkCmdBeginRenderPass(cb, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, geometryPipeline);
+
+    VkViewport viewport{ 0.f, 0.f, (float)extent.width, (float)extent.height, 0.f, 1.f };
+    VkRect2D scissor{ { 0, 0 }, extent };
+    vkCmdSetViewport(cb, 0, 1, &viewport);
+    vkCmdSetScissor(cb, 0, 1, &scissor);
+
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, geometryLayout,
+        0, 1, &uboSet, 0, nullptr);
+
+    drawOpaque(cb);
+
+    vkCmdEndRenderPass(cb);
+}
+
+void DeferredRenderer::recordLighting(VkCommandBuffer cb, uint32_t frame)
+{
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, lightingPipeline);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, lightingLayout,
+        0, 1, &lightingSets[frame], 0, nullptr);
+    vkCmdDispatch(cb,
+        (extent.width + TILE_SIZE - 1) / TILE_SIZE,
+        (extent.height + TILE_SIZE - 1) / TILE_SIZE,
+        1);
+}
+
+void DeferredRenderer::recordComposite(VkCommandBuffer cb)
+{
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, compositePipeline);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, compositeLayout,
+        0, 1, &compositeSet, 0, nullptr);
+    vkCmdDraw(cb, 3, 1, 0, 0);
+}
+
+VkShaderModule DeferredRenderer::createShaderModule(VkDevice device, const std::vector<char>& code)
+{
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create deferred shader module!");
+    }
+    return shaderModule;
+}
+
+std::vector<char> DeferredRenderer::readFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open deferred shader file: " + filename);
+    }
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+    return buffer;
+}
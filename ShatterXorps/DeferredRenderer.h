@@ -0,0 +1,146 @@
+// DeferredRenderer.h
+#ifndef DEFERRED_RENDERER_H
+#define DEFERRED_RENDERER_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+#include <functional>
+
+class PhysicalDevice;
+class ClusteredLights;
+class ShadowAtlas;
+class EvsmShadowMap;
+
+/*
+  Deferred shading path, alternative to the forward GraphicsPipeline.
+
+  1) Geometry: shader.vert + gbuffer.frag write a compact G-buffer
+       albedo  RGBA8          (rgb: albedo, a: MaterialTable index / 255)
+       normal  RG16F          (octahedral-packed world normal)
+       depth   D32
+  2) Lighting: deferred_lighting.comp, one 16x16 workgroup per screen tile.
+     The tile reduces its min/max view depth, culls the ClusteredLights
+     lights against the tile's view-space box (shared-memory list), then
+     every pixel shades the directional light (cascaded shadow map, same
+     PCF kernel / EVSM selection as the forward path), the ShadowAtlas
+     lights and the tile's lights once. The shadow code is shared with
+     shader.frag (shaders/shadow_lighting.glsl). Lit result in an RGBA16F
+     storage image.
+  3) Composite: inside the main render pass a full-screen triangle copies
+     the lit image to the swapchain and writes the G-buffer depth, so
+     forward geometry drawn after it (the light ray) still depth-tests.
+
+  Lighting cost is paid once per pixel, whatever the overdraw.
+
+  With a bindless set layout the geometry pass uses gbuffer_bindless.frag
+  and the albedo is the material's (triplanar texture included); drawOpaque
+  binds BindlessDescriptors at set=3 with getGeometryLayout().
+
+  None of the steps records a barrier; they are passes of the main
+  RenderGraph, which imports the images (getAlbedoImage() etc.):
+    geometry   albedo / normal ColorAttachmentWrite, depth DepthAttachmentWrite
+    lighting   albedo / normal / depth SampledCompute, lit StorageWriteCompute
+    composite  lit / depth SampledFragment (inside the main pass)
+
+  Per swapchain image (command buffers are pre-recorded):
+    graph.addPass("gbuffer", ..., deferred.recordGeometry(cb, uboSet, drawOpaque));
+    graph.addPass("deferred lighting", ..., deferred.recordLighting(cb, image));
+    graph.addPass("main", ..., ...begin main pass... deferred.recordComposite(cb));
+*/
+class DeferredRenderer {
+public:
+    static const uint32_t TILE_SIZE = 16;   // deferred_lighting.comp local size
+
+    DeferredRenderer() = default;
+    ~DeferredRenderer() = default;
+
+    // uboLayout: GraphicsPipeline set=0 (camera + light UBO), mainPass: the
+    // swapchain pass the composite is drawn in (VK_NULL_HANDLE + mainRendering
+    // with dynamic rendering), frameCount: swapchain images, bindlessLayout:
+    // BindlessDescriptors set layout (VK_NULL_HANDLE = vertex colors only)
+    void create(VkDevice device, PhysicalDevice& physDevice, VkExtent2D extent,
+        VkDescriptorSetLayout uboLayout, VkRenderPass mainPass, uint32_t frameCount,
+        const VkPipelineRenderingCreateInfoKHR* mainRendering = nullptr,
+        VkDescriptorSetLayout bindlessLayout = VK_NULL_HANDLE);
+    void destroy(VkDevice device);
+
+    // Lighting inputs of one swapchain image: its camera / light UBOs, the
+    // cascades (comparison sampler, also used for the atlas), the clustered
+    // light list, the shadow atlas + its lights and the EVSM moments
+    void setFrameInputs(VkDevice device, uint32_t frame,
+        VkBuffer cameraUBO, VkDeviceSize cameraSize,
+        VkBuffer lightUBO, VkDeviceSize lightSize,
+        VkImageView shadowView, VkSampler shadowSampler,
+        const ClusteredLights& lights, const ShadowAtlas& atlas, const EvsmShadowMap& evsm);
+
+    // G-buffer render pass (targets in the attachment layouts), drawOpaque binds vertex/index buffers, pushes
+    // each draw's GraphicsPipeline::PushConstants (getGeometryLayout()) and
+    // draws. The G-buffer pipeline and uboSet (set=0) are bound before it is called.
+    void recordGeometry(VkCommandBuffer cb, VkDescriptorSet uboSet,
+        const std::function<void(VkCommandBuffer)>& drawOpaque);
+    VkPipelineLayout getGeometryLayout() const { return geometryLayout; }
+    // Tiled lighting: G-buffer in SHADER_READ_ONLY_OPTIMAL, lit image in GENERAL
+    void recordLighting(VkCommandBuffer cb, uint32_t frame);
+    // Inside the main render pass (viewport / scissor already set), lit
+    // image and depth in SHADER_READ_ONLY_OPTIMAL
+    void recordComposite(VkCommandBuffer cb);
+
+    VkImage getAlbedoImage() const { return albedo.image; }
+    VkImage getNormalImage() const { return normal.image; }
+    VkImage getDepthImage() const { return depth.image; }
+    VkImage getLitImage() const { return lit.image; }
+
+private:
+    struct Image {
+        VkImage        image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView    view = VK_NULL_HANDLE;
+    };
+    void createImage(VkDevice device, PhysicalDevice& physDevice, Image& img,
+        VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect);
+    void destroyImage(VkDevice device, Image& img);
+
+    void createRenderPass(VkDevice device);
+    void createGeometryPipeline(VkDevice device, VkDescriptorSetLayout uboLayout,
+        VkDescriptorSetLayout bindlessLayout);
+    void createLightingPipeline(VkDevice device, uint32_t frameCount);
+    void createCompositePipeline(VkDevice device, VkRenderPass mainPass,
+        const VkPipelineRenderingCreateInfoKHR* rendering);
+
+    VkExtent2D extent{ 0, 0 };
+
+    Image albedo;
+    Image normal;
+    Image depth;
+    Image lit;
+
+    VkSampler     pointSampler = VK_NULL_HANDLE;
+    VkRenderPass  gbufferPass = VK_NULL_HANDLE;
+    VkFramebuffer gbufferFramebuffer = VK_NULL_HANDLE;
+
+    // (1) G-buffer
+    VkPipeline            geometryPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout      geometryLayout = VK_NULL_HANDLE;
+    // Fills sets 1 and 2 of the bindless geometry layout (set=3)
+    VkDescriptorSetLayout emptySetLayout = VK_NULL_HANDLE;
+
+    // (2) Tiled lighting, one set per swapchain image
+    VkPipeline                   lightingPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout             lightingLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout        lightingSetLayout = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> lightingSets;
+
+    // (3) Composite
+    VkPipeline            compositePipeline = VK_NULL_HANDLE;
+    VkPipelineLayout      compositeLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout compositeSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSet       compositeSet = VK_NULL_HANDLE;
+
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+
+    VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
+    std::vector<char> readFile(const std::string& filename);
+};
+
+#endif // DEFERRED_RENDERER_H
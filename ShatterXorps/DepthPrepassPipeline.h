@@ -0,0 +1,43 @@
+// DepthPrepassPipeline.h
+#ifndef DEPTH_PREPASS_PIPELINE_H
+#define DEPTH_PREPASS_PIPELINE_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+
+/*
+  Depth-only prepass for the main render pass.
+
+  Draws the opaque meshes from their position-only streams (Vertex::
+  getPositionBindingDescription) with depth_prepass.vert and no fragment
+  shader, colour writes off. The main GraphicsPipeline then runs its
+  getEqualDepthPipeline() variant (compare EQUAL, no depth writes) so the
+  shading in shader.frag runs once per covered pixel, whatever the overdraw.
+
+  depth_prepass.vert and shader.vert compute gl_Position with the same
+  expression and both declare it invariant, so EQUAL matches bit for bit.
+*/
+class DepthPrepassPipeline {
+public:
+    DepthPrepassPipeline() = default;
+    ~DepthPrepassPipeline() = default;
+
+    // renderPass: the main pass (subpass 0), uboLayout: GraphicsPipeline's set=0,
+    // rendering: attachment formats when renderPass is VK_NULL_HANDLE
+    void create(VkDevice device, VkRenderPass renderPass, VkDescriptorSetLayout uboLayout,
+        const VkPipelineRenderingCreateInfoKHR* rendering = nullptr);
+    void destroy(VkDevice device);
+
+    VkPipeline       getPipeline()       const { return pipeline; }
+    VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
+
+private:
+    VkPipeline       pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+    VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
+    std::vector<char> readFile(const std::string& filename);
+};
+
+#endif // DEPTH_PREPASS_PIPELINE_H
@@ -0,0 +1,62 @@
+// DepthPyramid.h
+#ifndef DEPTH_PYRAMID_H
+#define DEPTH_PYRAMID_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+
+class PhysicalDevice;
+
+/*
+  Hierarchical depth (Hi-Z) for occlusion culling.
+
+  An R32F mip chain built from a depth attachment by shaders/hiz_downsample.comp:
+  level 0 is half the depth size (rounded up), every texel holds the max
+  (farthest) depth of the 2x2 texels below it, down to 1x1. A screen rect
+  is occluded when its nearest depth is behind the max over the few texels
+  of the level where the rect spans at most 2x2 of them.
+
+  The depth must be in DEPTH_STENCIL_READ_ONLY_OPTIMAL and visible to the
+  compute stage when record() runs. record() leaves every level in GENERAL,
+  readable by compute shaders (texelFetch through getView()).
+*/
+class DepthPyramid {
+public:
+    DepthPyramid() = default;
+    ~DepthPyramid() = default;
+
+    // depthExtent / depthView: the attachment the pyramid is built from
+    void create(VkDevice device, PhysicalDevice& physDevice, VkExtent2D depthExtent, VkImageView depthView);
+    void destroy(VkDevice device);
+
+    void record(VkCommandBuffer cb);
+
+    // All levels, for a sampler2D + texelFetch(.., level)
+    VkImageView getView() const { return view; }
+    VkSampler   getSampler() const { return sampler; }
+    uint32_t    getLevelCount() const { return levelCount; }
+    VkExtent2D  getDepthExtent() const { return depthExtent; }
+
+private:
+    VkImage                  image = VK_NULL_HANDLE;
+    VkDeviceMemory           memory = VK_NULL_HANDLE;
+    VkImageView              view = VK_NULL_HANDLE;
+    std::vector<VkImageView> levelViews;
+    std::vector<VkExtent2D>  levelSizes;
+    VkSampler                sampler = VK_NULL_HANDLE;
+
+    VkPipeline                   pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout             pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout        descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool             descriptorPool = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> levelSets;   // [i]: level i-1 (or depth) -> level i
+
+    VkExtent2D depthExtent{ 0, 0 };
+    uint32_t   levelCount = 0;
+
+    VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
+    std::vector<char> readFile(const std::string& filename);
+};
+
+#endif // DEPTH_PYRAMID_H
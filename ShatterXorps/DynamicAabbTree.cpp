@@ -0,0 +1,310 @@
+// DynamicAabbTree.cpp
+#include "DynamicAabbTree.h"
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+Aabb combine(const Aabb& a, const Aabb& b)
+{
+    return Aabb{ glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+float surfaceArea(const Aabb& box)
+{
+    glm::vec3 d = box.max - box.min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+bool contains(const Aabb& outer, const Aabb& inner)
+{
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+        outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+} // namespace
+
+DynamicAabbTree::DynamicAabbTree(float fatMargin)
+    : margin(fatMargin)
+{
+}
+
+// ---------------------------------------------------------------------------
+// Node pool
+// ---------------------------------------------------------------------------
+int32_t DynamicAabbTree::allocateNode()
+{
+    if (freeList == NULL_NODE) {
+        nodes.emplace_back();
+        return (int32_t)nodes.size() - 1;
+    }
+    int32_t node = freeList;
+    freeList = nodes[node].parent;
+    nodes[node] = Node{};
+    return node;
+}
+
+void DynamicAabbTree::freeNode(int32_t node)
+{
+    nodes[node].parent = freeList;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+void DynamicAabbTree::clear()
+{
+    nodes.clear();
+    root = NULL_NODE;
+    freeList = NULL_NODE;
+    proxyCount = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Proxies
+// ---------------------------------------------------------------------------
+int32_t DynamicAabbTree::createProxy(const Aabb& box, uint32_t userData)
+{
+    int32_t proxy = allocateNode();
+    nodes[proxy].box = Aabb{ box.min - glm::vec3(margin), box.max + glm::vec3(margin) };
+    nodes[proxy].userData = userData;
+    nodes[proxy].height = 0;
+    insertLeaf(proxy);
+    ++proxyCount;
+    return proxy;
+}
+
+void DynamicAabbTree::destroyProxy(int32_t proxy)
+{
+    assert(nodes[proxy].isLeaf());
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --proxyCount;
+}
+
+bool DynamicAabbTree::moveProxy(int32_t proxy, const Aabb& box, const glm::vec3& displacement)
+{
+    assert(nodes[proxy].isLeaf());
+    if (contains(nodes[proxy].box, box)) {
+        return false;
+    }
+
+    // Predict the motion so a steadily moving object isn't reinserted every frame
+    Aabb fat{ box.min - glm::vec3(margin), box.max + glm::vec3(margin) };
+    glm::vec3 d = 2.0f * displacement;
+    fat.min += glm::min(d, glm::vec3(0.0f));
+    fat.max += glm::max(d, glm::vec3(0.0f));
+
+    removeLeaf(proxy);
+    nodes[proxy].box = fat;
+    insertLeaf(proxy);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Insert / remove
+// ---------------------------------------------------------------------------
+void DynamicAabbTree::insertLeaf(int32_t leaf)
+{
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // Find the best sibling: at every step compare the cost of pairing the
+    // leaf with this node against the cheapest it could get going down
+    // either child (the inherited cost is what the ancestors grow by)
+    const Aabb leafBox = nodes[leaf].box;
+    int32_t index = root;
+    while (!nodes[index].isLeaf()) {
+        const Node& node = nodes[index];
+        float area = surfaceArea(node.box);
+        float combinedArea = surfaceArea(combine(node.box, leafBox));
+
+        float cost = 2.0f * combinedArea;
+        float inheritance = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int32_t child) {
+            Aabb box = combine(leafBox, nodes[child].box);
+            if (nodes[child].isLeaf()) {
+                return surfaceArea(box) + inheritance;
+            }
+            return surfaceArea(box) - surfaceArea(nodes[child].box) + inheritance;
+        };
+        float cost1 = descendCost(node.child1);
+        float cost2 = descendCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+    const int32_t sibling = index;
+
+    // New parent in place of the sibling
+    const int32_t oldParent = nodes[sibling].parent;
+    const int32_t newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = combine(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_NODE) {
+        root = newParent;
+    }
+    else if (nodes[oldParent].child1 == sibling) {
+        nodes[oldParent].child1 = newParent;
+    }
+    else {
+        nodes[oldParent].child2 = newParent;
+    }
+
+    // Refit + rebalance the ancestors
+    index = nodes[leaf].parent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+        const Node& node = nodes[index];
+        nodes[index].height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+        nodes[index].box = combine(nodes[node.child1].box, nodes[node.child2].box);
+        index = nodes[index].parent;
+    }
+}
+
+void DynamicAabbTree::removeLeaf(int32_t leaf)
+{
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    // The sibling takes the parent's place
+    const int32_t parent = nodes[leaf].parent;
+    const int32_t grandParent = nodes[parent].parent;
+    const int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent == NULL_NODE) {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+        return;
+    }
+
+    if (nodes[grandParent].child1 == parent) {
+        nodes[grandParent].child1 = sibling;
+    }
+    else {
+        nodes[grandParent].child2 = sibling;
+    }
+    nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    int32_t index = grandParent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+        const Node& node = nodes[index];
+        nodes[index].height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+        nodes[index].box = combine(nodes[node.child1].box, nodes[node.child2].box);
+        index = nodes[index].parent;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Rotation: if one child of a is 2+ levels taller, its taller child moves up
+// to a's level and a takes the shorter one. Returns the subtree's new root.
+// ---------------------------------------------------------------------------
+int32_t DynamicAabbTree::balance(int32_t a)
+{
+    Node& A = nodes[a];
+    if (A.isLeaf() || A.height < 2) {
+        return a;
+    }
+
+    const int32_t b = A.child1;
+    const int32_t c = A.child2;
+    const int32_t diff = nodes[c].height - nodes[b].height;
+
+    // Rotate the taller side up: (up = the tall child, stay = the other one)
+    auto rotate = [&](int32_t up, int32_t stay) {
+        Node& U = nodes[up];
+        const int32_t f = U.child1;
+        const int32_t g = U.child2;
+
+        // up replaces a under a's parent, a becomes a child of up
+        U.child1 = a;
+        U.parent = nodes[a].parent;
+        nodes[a].parent = up;
+
+        if (U.parent == NULL_NODE) {
+            root = up;
+        }
+        else if (nodes[U.parent].child1 == a) {
+            nodes[U.parent].child1 = up;
+        }
+        else {
+            nodes[U.parent].child2 = up;
+        }
+
+        // The taller grandchild stays under up, the other one goes to a
+        int32_t keep = f, give = g;
+        if (nodes[f].height < nodes[g].height) {
+            keep = g;
+            give = f;
+        }
+        U.child2 = keep;
+        if (nodes[a].child1 == up) {
+            nodes[a].child1 = give;
+        }
+        else {
+            nodes[a].child2 = give;
+        }
+        nodes[give].parent = a;
+
+        nodes[a].box = combine(nodes[stay].box, nodes[give].box);
+        nodes[a].height = 1 + std::max(nodes[stay].height, nodes[give].height);
+        U.box = combine(nodes[a].box, nodes[keep].box);
+        U.height = 1 + std::max(nodes[a].height, nodes[keep].height);
+        return up;
+    };
+
+    if (diff > 1) {
+        return rotate(c, b);
+    }
+    if (diff < -1) {
+        return rotate(b, c);
+    }
+    return a;
+}
+
+// ---------------------------------------------------------------------------
+// Queries / stats
+// ---------------------------------------------------------------------------
+bool DynamicAabbTree::rayIntersects(const Aabb& box, const glm::vec3& origin, const glm::vec3& invDir,
+    float maxT, float& tEntry)
+{
+    glm::vec3 t0 = (box.min - origin) * invDir;
+    glm::vec3 t1 = (box.max - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+    tEntry = enter;
+    return enter <= exit;
+}
+
+float DynamicAabbTree::getAreaRatio() const
+{
+    if (root == NULL_NODE) {
+        return 0.0f;
+    }
+    float total = 0.0f;
+    for (const Node& node : nodes) {
+        if (node.height > 0) {
+            total += surfaceArea(node.box);
+        }
+    }
+    float rootArea = surfaceArea(nodes[root].box);
+    return rootArea > 0.0f ? total / rootArea : 0.0f;
+}
@@ -0,0 +1,228 @@
+// DynamicAabbTree.h
+#ifndef DYNAMIC_AABB_TREE_H
+#define DYNAMIC_AABB_TREE_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "Frustum.h"
+
+/*
+  Dynamic bounding volume hierarchy over world-space AABBs: the scene index
+  for culling, picking and ray / proximity queries.
+
+  Every renderable is a leaf (proxy) holding a "fat" box: its real bounds
+  grown by a margin (+ the displacement when moving). moveProxy() is free
+  while the object stays inside its fat box, otherwise the leaf is removed
+  and inserted again.
+
+  Insertion walks down by surface-area cost (the sibling that grows the
+  tree's total area least, including the enlargement of every ancestor).
+  On the way back up every ancestor is refit and rebalanced with a local
+  rotation (a child of height difference > 1 is rotated up), so the tree
+  stays O(log n) deep whatever the insertion order, without rebuilds.
+
+  Queries take a callback, templated so the traversal inlines it:
+    query(box, [&](int32_t proxy) { ...; return true; })             overlap, false stops
+    querySphere(center, radius, ...)                                 proximity
+    queryFrustum(frustum, [&](int32_t proxy) { ... })                culling, fully
+        inside subtrees are reported without testing their boxes
+    raycast(origin, dir, maxT, [&](int32_t proxy, float maxT) { return t; })
+        the callback returns the new maxT (its hit distance to clip the ray,
+        maxT to go on unchanged, 0 to stop)
+*/
+class DynamicAabbTree {
+public:
+    static const int32_t NULL_NODE = -1;
+
+    explicit DynamicAabbTree(float fatMargin = 0.1f);
+
+    int32_t createProxy(const Aabb& box, uint32_t userData);
+    void    destroyProxy(int32_t proxy);
+    // Returns true when the leaf had to be reinserted. displacement: how far
+    // the object moves per update, the fat box is stretched that way.
+    bool    moveProxy(int32_t proxy, const Aabb& box, const glm::vec3& displacement = glm::vec3(0.0f));
+    void    clear();
+
+    uint32_t    getUserData(int32_t proxy) const { return nodes[proxy].userData; }
+    const Aabb& getFatAabb(int32_t proxy) const { return nodes[proxy].box; }
+
+    uint32_t getProxyCount() const { return proxyCount; }
+    int32_t  getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+    // Sum of internal node areas / root area (lower is a tighter tree)
+    float    getAreaRatio() const;
+
+    template <class F> void query(const Aabb& box, F&& callback) const;
+    template <class F> void querySphere(const glm::vec3& center, float radius, F&& callback) const;
+    template <class F> void queryFrustum(const Frustum& frustum, F&& callback) const;
+    template <class F> void raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT, F&& callback) const;
+
+    // Ray against a box: entry distance in [0, maxT], false on a miss
+    static bool rayIntersects(const Aabb& box, const glm::vec3& origin, const glm::vec3& invDir,
+        float maxT, float& tEntry);
+
+private:
+    struct Node {
+        Aabb     box;
+        int32_t  parent = NULL_NODE;   // next free node when on the free list
+        int32_t  child1 = NULL_NODE;
+        int32_t  child2 = NULL_NODE;
+        int32_t  height = 0;           // leaf = 0, free = -1
+        uint32_t userData = 0;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    std::vector<Node> nodes;
+    int32_t  root = NULL_NODE;
+    int32_t  freeList = NULL_NODE;
+    uint32_t proxyCount = 0;
+    float    margin;
+
+    int32_t allocateNode();
+    void    freeNode(int32_t node);
+    void    insertLeaf(int32_t leaf);
+    void    removeLeaf(int32_t leaf);
+    int32_t balance(int32_t node);
+
+    template <class F> void reportSubtree(int32_t node, F& callback, std::vector<int32_t>& stack) const;
+
+    static bool overlaps(const Aabb& a, const Aabb& b)
+    {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+            a.min.y <= b.max.y && a.max.y >= b.min.y &&
+            a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Traversals (explicit stack, no recursion)
+// ---------------------------------------------------------------------------
+template <class F>
+void DynamicAabbTree::query(const Aabb& box, F&& callback) const
+{
+    if (root == NULL_NODE) {
+        return;
+    }
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        int32_t index = stack.back();
+        stack.pop_back();
+        if (!overlaps(node.box, box)) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            if (!callback(index)) {
+                return;
+            }
+        }
+        else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+template <class F>
+void DynamicAabbTree::querySphere(const glm::vec3& center, float radius, F&& callback) const
+{
+    // Box around the sphere for the walk, exact distance for the leaves' boxes
+    const Aabb bounds{ center - glm::vec3(radius), center + glm::vec3(radius) };
+    const float radiusSq = radius * radius;
+    query(bounds, [&](int32_t proxy) {
+        const Aabb& b = nodes[proxy].box;
+        glm::vec3 closest = glm::clamp(center, b.min, b.max);
+        glm::vec3 d = closest - center;
+        if (glm::dot(d, d) > radiusSq) {
+            return true;
+        }
+        return (bool)callback(proxy);
+    });
+}
+
+template <class F>
+void DynamicAabbTree::reportSubtree(int32_t node, F& callback, std::vector<int32_t>& stack) const
+{
+    const size_t base = stack.size();
+    stack.push_back(node);
+    while (stack.size() > base) {
+        int32_t index = stack.back();
+        stack.pop_back();
+        const Node& n = nodes[index];
+        if (n.isLeaf()) {
+            callback(index);
+        }
+        else {
+            stack.push_back(n.child1);
+            stack.push_back(n.child2);
+        }
+    }
+}
+
+template <class F>
+void DynamicAabbTree::queryFrustum(const Frustum& frustum, F&& callback) const
+{
+    if (root == NULL_NODE) {
+        return;
+    }
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        int32_t index = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[index];
+
+        Frustum::Containment c = frustum.classify(node.box);
+        if (c == Frustum::Containment::Outside) {
+            continue;
+        }
+        if (c == Frustum::Containment::Inside || node.isLeaf()) {
+            reportSubtree(index, callback, stack);
+        }
+        else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+template <class F>
+void DynamicAabbTree::raycast(const glm::vec3& origin, const glm::vec3& dir, float maxT, F&& callback) const
+{
+    if (root == NULL_NODE) {
+        return;
+    }
+    const glm::vec3 invDir = 1.0f / dir;   // +-inf on zero components is fine for the slabs
+
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(root);
+    while (!stack.empty()) {
+        int32_t index = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[index];
+
+        float tEntry;
+        if (!rayIntersects(node.box, origin, invDir, maxT, tEntry)) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            float t = callback(index, maxT);
+            if (t <= 0.0f) {
+                return;
+            }
+            maxT = std::min(maxT, t);
+        }
+        else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+#endif // DYNAMIC_AABB_TREE_H
@@ -0,0 +1,134 @@
+// DynamicResolution.cpp
+#include "DynamicResolution.h"
+#include "PhysicalDevice.h"
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+void DynamicResolution::create(VkDevice device, const PhysicalDevice& physDevice,
+    uint32_t maxW, uint32_t maxH, float budget)
+{
+    maxWidth = maxW;
+    maxHeight = maxH;
+    budgetMs = budget;
+    scale = 1.0f;
+    smoothedMs = 0.0f;
+    pending = false;
+
+    // 1) Timestamps need a non-zero validBits on the queue we submit to
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physDevice.getPhysicalDevice(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physDevice.getPhysicalDevice(), &familyCount, families.data());
+
+    uint32_t family = physDevice.getGraphicsQueueFamilyIndex();
+    VkPhysicalDeviceProperties props = physDevice.getProperties();
+    supported = family < familyCount &&
+        families[family].timestampValidBits != 0 &&
+        props.limits.timestampPeriod > 0.0f;
+    timestampPeriod = props.limits.timestampPeriod;
+    // Only the low validBits of a timestamp are meaningful (the rest is
+    // garbage, and the counter wraps at that width)
+    if (supported) {
+        uint32_t validBits = families[family].timestampValidBits;
+        timestampMask = (validBits >= 64) ? ~0ull : ((1ull << validBits) - 1);
+    }
+
+    // 2) One begin/end pair, the frame loop waits for the queue anyway
+    if (supported) {
+        VkQueryPoolCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        info.queryCount = 2;
+        if (vkCreateQueryPool(device, &info, nullptr, &queryPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create timestamp query pool!");
+        }
+    }
+
+    updateExtent();
+}
+
+void DynamicResolution::destroy(VkDevice device)
+{
+    if (queryPool) {
+        vkDestroyQueryPool(device, queryPool, nullptr);
+        queryPool = VK_NULL_HANDLE;
+    }
+    pending = false;
+}
+
+void DynamicResolution::writeBegin(VkCommandBuffer cb)
+{
+    if (!supported) {
+        return;
+    }
+    vkCmdResetQueryPool(cb, queryPool, 0, 2);
+    vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+}
+
+void DynamicResolution::writeEnd(VkCommandBuffer cb)
+{
+    if (!supported) {
+        return;
+    }
+    vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+    pending = true;
+}
+
+void DynamicResolution::update(VkDevice device)
+{
+    if (!supported || !pending) {
+        return;
+    }
+
+    // Don't stall: if the GPU isn't done yet keep the current extent
+    uint64_t ticks[2] = { 0, 0 };
+    VkResult res = vkGetQueryPoolResults(device, queryPool, 0, 2, sizeof(ticks), ticks,
+        sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (res != VK_SUCCESS) {
+        return;
+    }
+    pending = false;
+
+    // Masked difference stays right across a counter wrap
+    uint64_t elapsed = ((ticks[1] & timestampMask) - (ticks[0] & timestampMask)) & timestampMask;
+    if (elapsed == 0) {
+        return;
+    }
+    float gpuMs = float(double(elapsed) * double(timestampPeriod) * 1e-6);
+
+    // Smooth out single-frame spikes
+    smoothedMs = (smoothedMs == 0.0f) ? gpuMs : smoothedMs + (gpuMs - smoothedMs) * 0.2f;
+
+    // Dead band: within +-10% of the budget the extent stays put
+    float ratio = budgetMs / std::max(smoothedMs, 0.001f);
+    if (ratio > 0.9f && ratio < 1.1f) {
+        return;
+    }
+
+    // Cost ~ pixel count ~ scale^2, move a quarter of the way per frame
+    float target = scale * std::sqrt(ratio);
+    scale += (target - scale) * 0.25f;
+    scale = std::clamp(scale, minScale, 1.0f);
+
+    updateExtent();
+}
+
+void DynamicResolution::setGranularity(uint32_t x, uint32_t y)
+{
+    granularityX = std::max(1u, x);
+    granularityY = std::max(1u, y);
+    updateExtent();
+}
+
+void DynamicResolution::updateExtent()
+{
+    // Whole workgroups only (rounded to nearest), never above the maximum
+    auto snap = [](float v, uint32_t step, uint32_t maxV) {
+        uint32_t s = (uint32_t(v) + step / 2) / step * step;
+        return std::min(std::max(step, s), maxV);
+    };
+    traceExtent.width = snap(maxWidth * scale, granularityX, maxWidth);
+    traceExtent.height = snap(maxHeight * scale, granularityY, maxHeight);
+}
@@ -0,0 +1,72 @@
+// DynamicResolution.h
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <vulkan/vulkan.h>
+
+class PhysicalDevice;
+
+/*
+  DynamicResolution picks the PixelTracer trace extent every frame so the
+  traced pass stays inside a GPU time budget.
+
+  Usage per frame (compute command buffer):
+    dynRes.update(device);                      // read last frame's timing
+    pixelTracer.setTraceExtent(device, dynRes.getTraceExtent().width, ...);
+    dynRes.writeBegin(cb);  ...dispatch...  dynRes.writeEnd(cb);
+
+  The measured time is smoothed, then the scale moves towards
+  scale * sqrt(budget / measured) (cost grows with pixel count = scale^2).
+  A dead band around the budget keeps it from oscillating, and the extent
+  is rounded to multiples of the workgroup size (setGranularity, default 8x8).
+*/
+class DynamicResolution {
+public:
+    DynamicResolution() = default;
+    ~DynamicResolution() = default;
+
+    void create(VkDevice device, const PhysicalDevice& physDevice,
+        uint32_t maxWidth, uint32_t maxHeight, float budgetMs);
+    void destroy(VkDevice device);
+
+    // Reset the query pair and write the start timestamp (outside a render pass)
+    void writeBegin(VkCommandBuffer cb);
+    // Write the end timestamp after the traced work
+    void writeEnd(VkCommandBuffer cb);
+
+    // Read back the last measurement and move the scale towards the budget.
+    // Does nothing until a measurement is available.
+    void update(VkDevice device);
+
+    VkExtent2D getTraceExtent() const { return traceExtent; }
+    float      getScale() const { return scale; }
+    float      getGpuTimeMs() const { return smoothedMs; }
+    bool       isSupported() const { return supported; }
+
+    void setBudgetMs(float ms) { budgetMs = ms; }
+    void setMinScale(float s) { minScale = s; }
+    // Round the extent to multiples of the tracer's workgroup size
+    void setGranularity(uint32_t x, uint32_t y);
+
+private:
+    void updateExtent();
+
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    bool  supported = false;     // timestamps usable on the graphics queue
+    bool  pending = false;       // a begin/end pair was recorded and not read yet
+    float timestampPeriod = 1.0f; // ns per tick
+    uint64_t timestampMask = ~0ull; // timestampValidBits of the queue family
+
+    uint32_t   maxWidth = 0;
+    uint32_t   maxHeight = 0;
+    VkExtent2D traceExtent{ 0, 0 };
+    uint32_t   granularityX = 8;
+    uint32_t   granularityY = 8;
+
+    float budgetMs = 4.0f;
+    float scale = 1.0f;
+    float minScale = 0.25f;
+    float smoothedMs = 0.0f;
+};
+
+#endif // DYNAMIC_RESOLUTION_H
@@ -0,0 +1,515 @@
+// EvsmShadowMap.cpp
+#include "EvsmShadowMap.h"
+#include "CascadedShadowMap.h"
+#include "PhysicalDevice.h"
+#include <fstream>
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+
+// Must match the push_constant block in evsm_blur.comp
+struct EvsmBlurParams {
+    int32_t direction[2];
+    int32_t fromDepth;
+    int32_t pad;
+    float   exponents[2];
+};
+
+void EvsmShadowMap::createImage(VkDevice device, PhysicalDevice& physDevice, Image& img,
+    uint32_t mips, VkImageUsageFlags usage)
+{
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = format;
+    imageInfo.extent = { resolution, resolution, 1 };
+    imageInfo.mipLevels = mips;
+    imageInfo.arrayLayers = layers;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(device, &imageInfo, nullptr, &img.image) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create EVSM image!");
+    }
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device, img.image, &memReqs);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReqs.size;
+    allocInfo.memoryTypeIndex =
+        physDevice.findMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &img.memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate EVSM image memory!");
+    }
+    vkBindImageMemory(device, img.image, img.memory, 0);
+}
+
+VkImageView EvsmShadowMap::createView(VkDevice device, VkImage image, uint32_t mips)
+{
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = mips;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = layers;
+
+    VkImageView view = VK_NULL_HANDLE;
+    if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create EVSM image view!");
+    }
+    return view;
+}
+
+void EvsmShadowMap::create(VkDevice device, PhysicalDevice& physDevice, const CascadedShadowMap& csm,
+    VkCommandPool commandPool, VkQueue queue)
+{
+    resolution = csm.getResolution();
+    layers = csm.getCascadeCount();
+    mipLevels = 1;
+    for (uint32_t s = resolution; s > 1; s >>= 1) {
+        mipLevels++;
+    }
+
+    // ------------------------------------------------------------------
+    // 1) Format: RGBA32F needs optional linear filtering (trilinear fetch
+    //    + blit mips), RGBA16F always has it but limits the exponents
+    // ------------------------------------------------------------------
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(physDevice.getPhysicalDevice(), VK_FORMAT_R32G32B32A32_SFLOAT, &props);
+    const VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT |
+        VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+    if ((props.optimalTilingFeatures & needed) == needed) {
+        format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        exponents = glm::vec2(40.0f, 5.0f);
+    }
+    else {
+        format = VK_FORMAT_R16G16B16A16_SFLOAT;
+        exponents = glm::vec2(5.0f, 5.0f);
+        std::cout << "RGBA32F not filterable, EVSM falls back to RGBA16F" << std::endl;
+    }
+
+    // ------------------------------------------------------------------
+    // 2) Moments with the full mip chain (the horizontal pass' temp is a
+    //    render graph transient, see getTempDesc)
+    // ------------------------------------------------------------------
+    createImage(device, physDevice, momentsImage, mipLevels,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+    momentsMip0View = createView(device, momentsImage.image, 1);
+    sampledView = createView(device, momentsImage.image, mipLevels);
+
+    // ------------------------------------------------------------------
+    // 3) Samplers: point for the blur taps, trilinear for shader.frag
+    // ------------------------------------------------------------------
+    {
+        VkSamplerCreateInfo info{};
+        info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        info.magFilter = VK_FILTER_NEAREST;
+        info.minFilter = VK_FILTER_NEAREST;
+        info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        info.unnormalizedCoordinates = VK_FALSE;
+        if (vkCreateSampler(device, &info, nullptr, &pointSampler) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create EVSM point sampler!");
+        }
+
+        info.magFilter = VK_FILTER_LINEAR;
+        info.minFilter = VK_FILTER_LINEAR;
+        info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        info.maxLod = (float)mipLevels;
+        if (vkCreateSampler(device, &info, nullptr, &trilinearSampler) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create EVSM trilinear sampler!");
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // 4) Descriptor layout: (0) source sampler, (1) destination storage image
+    // ------------------------------------------------------------------
+    {
+        VkDescriptorSetLayoutBinding bindings[2]{};
+        bindings[0].binding = 0;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        bindings[1].binding = 1;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 2;
+        layoutInfo.pBindings = bindings;
+
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create EVSM descriptor set layout!");
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // 5) Pipeline layout (+ push constants) and compute pipeline
+    // ------------------------------------------------------------------
+    {
+        VkPushConstantRange range{};
+        range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        range.offset = 0;
+        range.size = sizeof(EvsmBlurParams);
+
+        VkPipelineLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layoutInfo.setLayoutCount = 1;
+        layoutInfo.pSetLayouts = &descriptorSetLayout;
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges = &range;
+
+        if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create EVSM pipeline layout!");
+        }
+
+        auto compCode = readFile(format == VK_FORMAT_R16G16B16A16_SFLOAT
+            ? "shaders/evsm_blur_rgba16f.comp.spv" : "shaders/evsm_blur.comp.spv");
+        VkShaderModule compModule = createShaderModule(device, compCode);
+
+        VkPipelineShaderStageCreateInfo stageInfo{};
+        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stageInfo.module = compModule;
+        stageInfo.pName = "main";
+
+        VkComputePipelineCreateInfo pipeInfo{};
+        pipeInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipeInfo.stage = stageInfo;
+        pipeInfo.layout = pipelineLayout;
+
+        if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create EVSM compute pipeline!");
+        }
+        vkDestroyShaderModule(device, compModule, nullptr);
+    }
+
+    // ------------------------------------------------------------------
+    // 6) Descriptor pool + one set per pass
+    // ------------------------------------------------------------------
+    {
+        VkDescriptorPoolSize poolSizes[2] = {
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2 }
+        };
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 2;
+        poolInfo.pPoolSizes = poolSizes;
+        poolInfo.maxSets = 2;
+
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create EVSM descriptor pool!");
+        }
+
+        VkDescriptorSetLayout layouts[2] = { descriptorSetLayout, descriptorSetLayout };
+        VkDescriptorSet sets[2];
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 2;
+        allocInfo.pSetLayouts = layouts;
+
+        if (vkAllocateDescriptorSets(device, &allocInfo, sets) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate EVSM descriptor sets!");
+        }
+        horizontalSet = sets[0];
+        verticalSet = sets[1];
+
+        // Horizontal: cascade depth -> temp (setTempView)
+        VkDescriptorImageInfo depthInfo{};
+        depthInfo.sampler = pointSampler;
+        depthInfo.imageView = csm.getArrayView();
+        depthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        // Vertical: temp (setTempView) -> moments mip 0
+        VkDescriptorImageInfo momentsStoreInfo{};
+        momentsStoreInfo.imageView = momentsMip0View;
+        momentsStoreInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet writes[2]{};
+        writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet = horizontalSet;
+        writes[0].dstBinding = 0;
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[0].descriptorCount = 1;
+        writes[0].pImageInfo = &depthInfo;
+
+        writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[1].dstSet = verticalSet;
+        writes[1].dstBinding = 1;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[1].descriptorCount = 1;
+        writes[1].pImageInfo = &momentsStoreInfo;
+
+        vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+    }
+
+    // ------------------------------------------------------------------
+    // 7) Moments start out in SHADER_READ_ONLY (one-time submit)
+    // ------------------------------------------------------------------
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer cb;
+        if (vkAllocateCommandBuffers(device, &allocInfo, &cb) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate EVSM init command buffer!");
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(cb, &beginInfo);
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = momentsImage.image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = mipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = layers;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(cb,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        vkEndCommandBuffer(cb);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &cb;
+        vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+        vkQueueWaitIdle(queue);
+
+        vkFreeCommandBuffers(device, commandPool, 1, &cb);
+    }
+}
+
+RenderGraph::ImageDesc EvsmShadowMap::getTempDesc() const
+{
+    RenderGraph::ImageDesc desc;
+    desc.format = format;
+    desc.extent = { resolution, resolution };
+    desc.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    desc.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+    desc.layers = layers;
+    return desc;
+}
+
+void EvsmShadowMap::setTempView(VkDevice device, VkImageView tempView)
+{
+    // Horizontal stores into it, vertical samples it
+    VkDescriptorImageInfo tempStoreInfo{};
+    tempStoreInfo.imageView = tempView;
+    tempStoreInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VkDescriptorImageInfo tempReadInfo{};
+    tempReadInfo.sampler = pointSampler;
+    tempReadInfo.imageView = tempView;
+    tempReadInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet writes[2]{};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = horizontalSet;
+    writes[0].dstBinding = 1;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    writes[0].descriptorCount = 1;
+    writes[0].pImageInfo = &tempStoreInfo;
+
+    writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[1].dstSet = verticalSet;
+    writes[1].dstBinding = 0;
+    writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[1].descriptorCount = 1;
+    writes[1].pImageInfo = &tempReadInfo;
+
+    vkUpdateDescriptorSets(device, 2, writes, 0, nullptr);
+}
+
+void EvsmShadowMap::recordHorizontal(VkCommandBuffer cb)
+{
+    // Depth -> moments, blurred along x into the temp
+    EvsmBlurParams params{};
+    params.direction[0] = 1;
+    params.direction[1] = 0;
+    params.fromDepth = 1;
+    params.exponents[0] = exponents.x;
+    params.exponents[1] = exponents.y;
+
+    const uint32_t groups = (resolution + 7) / 8;
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+        0, 1, &horizontalSet, 0, nullptr);
+    vkCmdPushConstants(cb, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdDispatch(cb, groups, groups, layers);
+}
+
+void EvsmShadowMap::recordVertical(VkCommandBuffer cb)
+{
+    // Temp -> moments mip 0, blurred along y
+    EvsmBlurParams params{};
+    params.direction[0] = 0;
+    params.direction[1] = 1;
+    params.fromDepth = 0;
+    params.exponents[0] = exponents.x;
+    params.exponents[1] = exponents.y;
+
+    const uint32_t groups = (resolution + 7) / 8;
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+        0, 1, &verticalSet, 0, nullptr);
+    vkCmdPushConstants(cb, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdDispatch(cb, groups, groups, layers);
+}
+
+void EvsmShadowMap::recordMips(VkCommandBuffer cb)
+{
+    // The graph hands over every level in TRANSFER_SRC (mip 0 written by
+    // recordVertical). Each level is blitted from the one above: it goes
+    // to TRANSFER_DST (old content discarded) and back to TRANSFER_SRC, so
+    // every level ends where the graph expects it.
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = momentsImage.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = layers;
+
+    int32_t size = (int32_t)resolution;
+    for (uint32_t level = 1; level < mipLevels; level++) {
+        barrier.subresourceRange.baseMipLevel = level;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(cb,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        int32_t half = std::max(size / 2, 1);
+        VkImageBlit blit{};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = layers;
+        blit.srcOffsets[1] = { size, size, 1 };
+        blit.dstSubresource = blit.srcSubresource;
+        blit.dstSubresource.mipLevel = level;
+        blit.dstOffsets[1] = { half, half, 1 };
+        vkCmdBlitImage(cb,
+            momentsImage.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            momentsImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            1, &blit, VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(cb,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        size = half;
+    }
+}
+
+void EvsmShadowMap::destroy(VkDevice device)
+{
+    if (pipeline) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        pipeline = VK_NULL_HANDLE;
+    }
+    if (pipelineLayout) {
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+    if (descriptorPool) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+    }
+    if (descriptorSetLayout) {
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        descriptorSetLayout = VK_NULL_HANDLE;
+    }
+    if (pointSampler) {
+        vkDestroySampler(device, pointSampler, nullptr);
+        pointSampler = VK_NULL_HANDLE;
+    }
+    if (trilinearSampler) {
+        vkDestroySampler(device, trilinearSampler, nullptr);
+        trilinearSampler = VK_NULL_HANDLE;
+    }
+    for (VkImageView* view : { &momentsMip0View, &sampledView }) {
+        if (*view) {
+            vkDestroyImageView(device, *view, nullptr);
+            *view = VK_NULL_HANDLE;
+        }
+    }
+    if (momentsImage.image) {
+        vkDestroyImage(device, momentsImage.image, nullptr);
+        momentsImage.image = VK_NULL_HANDLE;
+    }
+    if (momentsImage.memory) {
+        vkFreeMemory(device, momentsImage.memory, nullptr);
+        momentsImage.memory = VK_NULL_HANDLE;
+    }
+}
+
+std::vector<char> EvsmShadowMap::readFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + filename);
+    }
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+    return buffer;
+}
+
+VkShaderModule EvsmShadowMap::createShaderModule(VkDevice device, const std::vector<char>& code)
+{
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shader module!");
+    }
+    return shaderModule;
+}
@@ -0,0 +1,98 @@
+// EvsmShadowMap.h
+#ifndef EVSM_SHADOW_MAP_H
+#define EVSM_SHADOW_MAP_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include "RenderGraph.h"
+
+class PhysicalDevice;
+class CascadedShadowMap;
+
+/*
+  Exponential variance shadow maps built from the cascade depth layers.
+
+  A compute pass (shaders/evsm_blur.comp) runs twice per frame:
+    1) depth -> EVSM moments (e^(c+ d), e^(2c+ d), -e^(-c- d), e^(-2c- d))
+       + horizontal Gaussian into a temporary array image
+    2) vertical Gaussian into mip 0 of the moments image
+  then the mip chain is built with blits. Each step is a RenderGraph pass
+  (recordHorizontal / recordVertical / recordMips record no barriers): the
+  temporary image is a graph transient, described by getTempDesc and
+  handed back with setTempView after the graph is compiled. shader.frag (PcfKernel::Evsm)
+  does a single trilinear fetch and a Chebyshev bound per warp instead of
+  a PCF kernel, so the penumbra width costs nothing per pixel.
+
+  RGBA32F when it can be linearly filtered (exponents 40 / 5), otherwise
+  RGBA16F (exponents 5 / 5, a 16-bit float overflows above that).
+
+  Graph uses, in order:
+    recordHorizontal  cascade depth SampledCompute, temp StorageWriteCompute
+    recordVertical    temp SampledCompute, moments StorageWriteCompute
+    recordMips        moments TransferReadWrite
+  with the moments read after the graph in SHADER_READ_ONLY_OPTIMAL.
+*/
+class EvsmShadowMap {
+public:
+    EvsmShadowMap() = default;
+    ~EvsmShadowMap() = default;
+
+    // commandPool / queue: one-time submit moving the moments image to
+    // SHADER_READ_ONLY, so it can stay bound while another kernel is used
+    void create(VkDevice device, PhysicalDevice& physDevice, const CascadedShadowMap& csm,
+        VkCommandPool commandPool, VkQueue queue);
+    void destroy(VkDevice device);
+
+    // The blur temp for RenderGraph::createImage, and its view once the
+    // graph is compiled (writes both blur descriptor sets)
+    RenderGraph::ImageDesc getTempDesc() const;
+    void setTempView(VkDevice device, VkImageView tempView);
+
+    // Every cascade layer; only the dispatches / blits, the graph owns the
+    // barriers around them
+    void recordHorizontal(VkCommandBuffer cb);
+    void recordVertical(VkCommandBuffer cb);
+    void recordMips(VkCommandBuffer cb);
+
+    // x: positive exponent, y: negative exponent (for CascadedShadowMap::setEvsmParams)
+    glm::vec2 getExponents() const { return exponents; }
+    VkFormat    getFormat() const { return format; }
+    VkImage     getMomentsImage() const { return momentsImage.image; }
+    VkImageView getView() const { return sampledView; }      // all mips, sampler2DArray
+    VkSampler   getSampler() const { return trilinearSampler; }
+
+private:
+    struct Image {
+        VkImage        image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+    };
+    void createImage(VkDevice device, PhysicalDevice& physDevice, Image& img,
+        uint32_t mips, VkImageUsageFlags usage);
+    VkImageView createView(VkDevice device, VkImage image, uint32_t mips);
+
+    VkPipeline            pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout      pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool      descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet       horizontalSet = VK_NULL_HANDLE;   // depth -> temp
+    VkDescriptorSet       verticalSet = VK_NULL_HANDLE;     // temp -> moments mip 0 (temp set by setTempView)
+    VkSampler             pointSampler = VK_NULL_HANDLE;
+    VkSampler             trilinearSampler = VK_NULL_HANDLE;
+
+    Image       momentsImage;
+    VkImageView momentsMip0View = VK_NULL_HANDLE;   // storage target of the vertical pass
+    VkImageView sampledView = VK_NULL_HANDLE;
+
+    VkFormat  format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    glm::vec2 exponents = glm::vec2(40.0f, 5.0f);
+    uint32_t  resolution = 0;
+    uint32_t  layers = 0;
+    uint32_t  mipLevels = 1;
+
+    VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
+    std::vector<char> readFile(const std::string& filename);
+};
+
+#endif // EVSM_SHADOW_MAP_H
@@ -0,0 +1,109 @@
+// Frustum.cpp
+#include "Frustum.h"
+#include <algorithm>
+#include <cfloat>
+
+Aabb Aabb::fromVertices(const std::vector<Vertex>& vertices)
+{
+    Aabb box;
+    box.min = glm::vec3(FLT_MAX);
+    box.max = glm::vec3(-FLT_MAX);
+    for (const Vertex& v : vertices) {
+        box.min = glm::min(box.min, v.position);
+        box.max = glm::max(box.max, v.position);
+    }
+    return box;
+}
+
+Aabb Aabb::transformed(const glm::mat4& m) const
+{
+    Aabb out;
+    out.min = glm::vec3(FLT_MAX);
+    out.max = glm::vec3(-FLT_MAX);
+    for (int c = 0; c < 8; c++) {
+        glm::vec3 corner((c & 1) ? max.x : min.x, (c & 2) ? max.y : min.y, (c & 4) ? max.z : min.z);
+        glm::vec3 p = glm::vec3(m * glm::vec4(corner, 1.0f));
+        out.min = glm::min(out.min, p);
+        out.max = glm::max(out.max, p);
+    }
+    return out;
+}
+
+Frustum::Frustum(const glm::mat4& m)
+{
+    // Rows of the matrix (glm is column-major)
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    // -w <= x, y <= w and 0 <= z <= w
+    planes[0] = row3 + row0;   // left
+    planes[1] = row3 - row0;   // right
+    planes[2] = row3 + row1;   // bottom
+    planes[3] = row3 - row1;   // top
+    planes[4] = row2;          // near
+    planes[5] = row3 - row2;   // far
+
+    for (glm::vec4& p : planes) {
+        p /= glm::length(glm::vec3(p));
+    }
+}
+
+// Signed distance of the box corner furthest along the plane normal
+static float maxDistance(const glm::vec4& plane, const Aabb& box)
+{
+    glm::vec3 p(
+        plane.x >= 0.0f ? box.max.x : box.min.x,
+        plane.y >= 0.0f ? box.max.y : box.min.y,
+        plane.z >= 0.0f ? box.max.z : box.min.z);
+    return glm::dot(glm::vec3(plane), p) + plane.w;
+}
+
+bool Frustum::intersects(const Aabb& box) const
+{
+    for (const glm::vec4& plane : planes) {
+        if (maxDistance(plane, box) < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Signed distance of the box corner least far along the plane normal
+static float minDistance(const glm::vec4& plane, const Aabb& box)
+{
+    glm::vec3 p(
+        plane.x >= 0.0f ? box.min.x : box.max.x,
+        plane.y >= 0.0f ? box.min.y : box.max.y,
+        plane.z >= 0.0f ? box.min.z : box.max.z);
+    return glm::dot(glm::vec3(plane), p) + plane.w;
+}
+
+Frustum::Containment Frustum::classify(const Aabb& box) const
+{
+    Containment result = Containment::Inside;
+    for (const glm::vec4& plane : planes) {
+        if (maxDistance(plane, box) < 0.0f) {
+            return Containment::Outside;
+        }
+        if (minDistance(plane, box) < 0.0f) {
+            result = Containment::Intersecting;
+        }
+    }
+    return result;
+}
+
+bool Frustum::intersectsSwept(const Aabb& box, const glm::vec3& dir, float distance) const
+{
+    // The swept volume is the hull of the box at both ends, so its furthest
+    // point along a normal is at one of the two ends
+    for (const glm::vec4& plane : planes) {
+        float d = maxDistance(plane, box);
+        float moved = d + glm::dot(glm::vec3(plane), dir) * distance;
+        if (std::max(d, moved) < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
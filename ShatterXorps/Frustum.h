@@ -0,0 +1,53 @@
+// Frustum.h
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "Vertex.h"
+
+// World- or object-space axis-aligned box
+struct Aabb {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    // Bounds of a vertex list (e.g. cubeVertices)
+    static Aabb fromVertices(const std::vector<Vertex>& vertices);
+    // Box around the 8 transformed corners
+    Aabb transformed(const glm::mat4& m) const;
+};
+
+/*
+  The 6 planes of a view-projection (Vulkan clip space, 0..1 depth), pointing
+  inwards. Works for perspective and orthographic matrices alike.
+
+  Used for culling shadow casters: a caster is only drawn into a cascade /
+  atlas tile when its box touches the light frustum, and for cascades only
+  when the box swept along the light direction touches the camera frustum
+  (otherwise its shadow can't land on anything visible).
+*/
+class Frustum {
+public:
+    enum class Containment { Outside, Intersecting, Inside };
+
+    Frustum() = default;
+    explicit Frustum(const glm::mat4& viewProj);
+
+    // Inside: the whole box is within all 6 planes (a tree query can stop
+    // testing below such a node)
+    Containment classify(const Aabb& box) const;
+
+    // False only when the box is fully outside one plane (conservative)
+    bool intersects(const Aabb& box) const;
+
+    // Same test for the volume the box covers when moved by dir * distance
+    bool intersectsSwept(const Aabb& box, const glm::vec3& dir, float distance) const;
+
+    // For uploading to a GPU cull shader (same plane convention)
+    const glm::vec4& getPlane(int i) const { return planes[i]; }
+
+private:
+    glm::vec4 planes[6]{};   // xyz: normal, w: distance, inside when dot(n, p) + w >= 0
+};
+
+#endif // FRUSTUM_H
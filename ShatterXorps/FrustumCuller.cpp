@@ -0,0 +1,215 @@
+// FrustumCuller.cpp
+#include "FrustumCuller.h"
+#include "FrustumCullerKernels.h"
+#include "SimdSupport.h"
+#include <emmintrin.h>  // SSE2, always there on x64
+#include <cmath>
+
+// Padding entries: a hugely negative radius puts them outside every plane
+static const float PADDING_RADIUS = -1e30f;
+
+// ---------------------------------------------------------------------------
+// Kernels (AVX2 lives in FrustumCullerAvx2.cpp)
+// ---------------------------------------------------------------------------
+uint32_t cullScalar(const CullPlanes& planes, const CullBounds& bounds, uint32_t* out)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < bounds.count; i++) {
+        bool inside = true;
+        for (int p = 0; p < 6; p++) {
+            float d = planes.w[p] + bounds.r[i];
+            d = d + planes.nx[p] * bounds.cx[i];
+            d = d + planes.ny[p] * bounds.cy[i];
+            d = d + planes.nz[p] * bounds.cz[i];
+            d = d + planes.ax[p] * bounds.ex[i];
+            d = d + planes.ay[p] * bounds.ey[i];
+            d = d + planes.az[p] * bounds.ez[i];
+            inside = inside && !(d < 0.0f);
+        }
+        out[n] = i;
+        n += inside ? 1u : 0u;
+    }
+    return n;
+}
+
+uint32_t cullSSE(const CullPlanes& planes, const CullBounds& bounds, uint32_t* out)
+{
+    const __m128 zero = _mm_setzero_ps();
+
+    // 8 objects per iteration as two 4-wide halves
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < bounds.count; i += 8) {
+        uint32_t mask = 0;
+        for (uint32_t half = 0; half < 8; half += 4) {
+            const uint32_t j = i + half;
+            const __m128 cx = _mm_loadu_ps(bounds.cx + j);
+            const __m128 cy = _mm_loadu_ps(bounds.cy + j);
+            const __m128 cz = _mm_loadu_ps(bounds.cz + j);
+            const __m128 ex = _mm_loadu_ps(bounds.ex + j);
+            const __m128 ey = _mm_loadu_ps(bounds.ey + j);
+            const __m128 ez = _mm_loadu_ps(bounds.ez + j);
+            const __m128 r = _mm_loadu_ps(bounds.r + j);
+
+            __m128 outside = zero;
+            for (int p = 0; p < 6; p++) {
+                __m128 d = _mm_add_ps(_mm_set1_ps(planes.w[p]), r);
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.nx[p]), cx));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.ny[p]), cy));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.nz[p]), cz));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.ax[p]), ex));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.ay[p]), ey));
+                d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.az[p]), ez));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(d, zero));
+            }
+            mask |= ((uint32_t)(~_mm_movemask_ps(outside)) & 0xFu) << half;
+        }
+        n = appendVisible(out, n, i, mask);
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+FrustumCuller::FrustumCuller()
+    : simdPath(bestSimdPath())
+{
+}
+
+FrustumCuller::SimdPath FrustumCuller::bestSimdPath()
+{
+    if (simd::hasAVX2()) return SimdPath::AVX2;
+    if (simd::hasSSE2()) return SimdPath::SSE;
+    return SimdPath::Scalar;
+}
+
+const char* FrustumCuller::simdPathName(SimdPath path)
+{
+    switch (path) {
+    case SimdPath::AVX2: return "AVX2 (8-wide)";
+    case SimdPath::SSE:  return "SSE (2x 4-wide)";
+    default:             return "scalar";
+    }
+}
+
+void FrustumCuller::setSimdPath(SimdPath path)
+{
+    SimdPath best = bestSimdPath();
+    simdPath = ((int)path > (int)best) ? best : path;
+}
+
+uint32_t FrustumCuller::push()
+{
+    // A new batch of padding when the last one is full
+    if (objectCount % BATCH == 0) {
+        size_t size = (size_t)objectCount + BATCH;
+        centerX.resize(size, 0.0f);
+        centerY.resize(size, 0.0f);
+        centerZ.resize(size, 0.0f);
+        extentX.resize(size, 0.0f);
+        extentY.resize(size, 0.0f);
+        extentZ.resize(size, 0.0f);
+        radius.resize(size, PADDING_RADIUS);
+    }
+    return objectCount++;
+}
+
+uint32_t FrustumCuller::addAabb(const Aabb& box)
+{
+    uint32_t index = push();
+    setAabb(index, box);
+    return index;
+}
+
+uint32_t FrustumCuller::addSphere(const glm::vec3& center, float r)
+{
+    uint32_t index = push();
+    setSphere(index, center, r);
+    return index;
+}
+
+Aabb FrustumCuller::getBounds(uint32_t index) const
+{
+    glm::vec3 c(centerX[index], centerY[index], centerZ[index]);
+    glm::vec3 e = glm::vec3(extentX[index], extentY[index], extentZ[index]) + glm::vec3(radius[index]);
+    return Aabb{ c - e, c + e };
+}
+
+void FrustumCuller::setAabb(uint32_t index, const Aabb& box)
+{
+    glm::vec3 c = 0.5f * (box.min + box.max);
+    glm::vec3 e = 0.5f * (box.max - box.min);
+    centerX[index] = c.x;
+    centerY[index] = c.y;
+    centerZ[index] = c.z;
+    extentX[index] = e.x;
+    extentY[index] = e.y;
+    extentZ[index] = e.z;
+    radius[index] = 0.0f;
+}
+
+void FrustumCuller::setSphere(uint32_t index, const glm::vec3& center, float r)
+{
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    extentX[index] = 0.0f;
+    extentY[index] = 0.0f;
+    extentZ[index] = 0.0f;
+    radius[index] = r;
+}
+
+void FrustumCuller::clear()
+{
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+    radius.clear();
+    visible.clear();
+    objectCount = 0;
+}
+
+const std::vector<uint32_t>& FrustumCuller::cull(const glm::mat4& viewProj)
+{
+    return cull(Frustum(viewProj));
+}
+
+const std::vector<uint32_t>& FrustumCuller::cull(const Frustum& frustum)
+{
+    CullPlanes planes{};
+    for (int p = 0; p < 6; p++) {
+        const glm::vec4& plane = frustum.getPlane(p);
+        planes.nx[p] = plane.x;
+        planes.ny[p] = plane.y;
+        planes.nz[p] = plane.z;
+        planes.ax[p] = std::fabs(plane.x);
+        planes.ay[p] = std::fabs(plane.y);
+        planes.az[p] = std::fabs(plane.z);
+        planes.w[p] = plane.w;
+    }
+
+    CullBounds bounds{};
+    bounds.cx = centerX.data();
+    bounds.cy = centerY.data();
+    bounds.cz = centerZ.data();
+    bounds.ex = extentX.data();
+    bounds.ey = extentY.data();
+    bounds.ez = extentZ.data();
+    bounds.r = radius.data();
+    bounds.count = (uint32_t)centerX.size();
+
+    // Room for every lane, shrunk to the visible count afterwards
+    visible.resize(bounds.count);
+    if (bounds.count == 0) {
+        return visible;
+    }
+
+    uint32_t count = 0;
+    if (simdPath == SimdPath::AVX2) count = cullAVX2(planes, bounds, visible.data());
+    else if (simdPath == SimdPath::SSE) count = cullSSE(planes, bounds, visible.data());
+    else count = cullScalar(planes, bounds, visible.data());
+
+    visible.resize(count);
+    return visible;
+}
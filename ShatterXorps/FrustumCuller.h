@@ -0,0 +1,72 @@
+// FrustumCuller.h
+#ifndef FRUSTUM_CULLER_H
+#define FRUSTUM_CULLER_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "Frustum.h"
+
+/*
+  CPU frustum culling for the draw-recording path, many objects per call.
+
+  World-space bounds are kept structure-of-arrays: center xyz, half extents
+  xyz and a radius per object. An AABB has radius 0, a sphere has zero
+  extents, so both go through the same test against each of the 6 planes:
+
+    dot(n, center) + w + dot(abs(n), extents) + radius < 0  =>  outside
+
+  8 objects per iteration (one AVX2 register, or two SSE registers), the
+  widest path the CPU supports is picked at runtime. The arrays are padded
+  to a multiple of 8 with entries that are always outside, so there is no
+  scalar tail. The result is a compact list of visible indices, ascending.
+
+    FrustumCuller culler;
+    uint32_t id = culler.addAabb(worldBox);
+    ...
+    for (uint32_t i : culler.cull(proj * view)) { record draw i }
+*/
+class FrustumCuller {
+public:
+    enum class SimdPath { Scalar, SSE, AVX2 };
+
+    static const uint32_t BATCH = 8;
+
+    FrustumCuller();
+
+    // World-space bounds, returns the object index
+    uint32_t addAabb(const Aabb& box);
+    uint32_t addSphere(const glm::vec3& center, float radius);
+    void setAabb(uint32_t index, const Aabb& box);
+    void setSphere(uint32_t index, const glm::vec3& center, float radius);
+    void clear();
+
+    uint32_t getObjectCount() const { return objectCount; }
+    // Box around an entry (a sphere's bounding cube), e.g. to build a DynamicAabbTree
+    Aabb getBounds(uint32_t index) const;
+
+    // Requests a path, falls back to the best one the CPU actually has
+    void setSimdPath(SimdPath path);
+    SimdPath getSimdPath() const { return simdPath; }
+    static SimdPath bestSimdPath();
+    static const char* simdPathName(SimdPath path);
+
+    // Indices of the objects touching the frustum (valid until the next call)
+    const std::vector<uint32_t>& cull(const glm::mat4& viewProj);
+    const std::vector<uint32_t>& cull(const Frustum& frustum);
+    const std::vector<uint32_t>& getVisible() const { return visible; }
+
+private:
+    // SoA bounds, size is objectCount rounded up to BATCH
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+    std::vector<float> radius;
+    uint32_t           objectCount = 0;
+
+    std::vector<uint32_t> visible;
+    SimdPath              simdPath;
+
+    uint32_t push();
+};
+
+#endif // FRUSTUM_CULLER_H
@@ -0,0 +1,56 @@
+// FrustumCullerAvx2.cpp
+// 8-wide AVX2 path of FrustumCuller. Only called after simd::hasAVX2(), so
+// this file is the only place that may contain AVX instructions (same rules
+// as CpuRayTracerAvx2.cpp: no std:: headers with inline functions).
+#if defined(__GNUC__) && !defined(_MSC_VER)
+#pragma GCC target("avx2")
+#endif
+
+#include "FrustumCullerKernels.h"
+#include <immintrin.h>
+
+uint32_t cullAVX2(const CullPlanes& planes, const CullBounds& bounds, uint32_t* out)
+{
+    // Plane terms splatted once, reused for every batch
+    __m256 nx[6], ny[6], nz[6], ax[6], ay[6], az[6], w[6];
+    for (int p = 0; p < 6; p++) {
+        nx[p] = _mm256_set1_ps(planes.nx[p]);
+        ny[p] = _mm256_set1_ps(planes.ny[p]);
+        nz[p] = _mm256_set1_ps(planes.nz[p]);
+        ax[p] = _mm256_set1_ps(planes.ax[p]);
+        ay[p] = _mm256_set1_ps(planes.ay[p]);
+        az[p] = _mm256_set1_ps(planes.az[p]);
+        w[p] = _mm256_set1_ps(planes.w[p]);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < bounds.count; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(bounds.cx + i);
+        const __m256 cy = _mm256_loadu_ps(bounds.cy + i);
+        const __m256 cz = _mm256_loadu_ps(bounds.cz + i);
+        const __m256 ex = _mm256_loadu_ps(bounds.ex + i);
+        const __m256 ey = _mm256_loadu_ps(bounds.ey + i);
+        const __m256 ez = _mm256_loadu_ps(bounds.ez + i);
+        const __m256 r = _mm256_loadu_ps(bounds.r + i);
+
+        // Lanes go to all ones once they are outside any plane
+        __m256 outside = zero;
+        for (int p = 0; p < 6; p++) {
+            // Same operation order as cullScalar (no FMA), so every path
+            // returns the same list
+            __m256 d = _mm256_add_ps(w[p], r);
+            d = _mm256_add_ps(d, _mm256_mul_ps(nx[p], cx));
+            d = _mm256_add_ps(d, _mm256_mul_ps(ny[p], cy));
+            d = _mm256_add_ps(d, _mm256_mul_ps(nz[p], cz));
+            d = _mm256_add_ps(d, _mm256_mul_ps(ax[p], ex));
+            d = _mm256_add_ps(d, _mm256_mul_ps(ay[p], ey));
+            d = _mm256_add_ps(d, _mm256_mul_ps(az[p], ez));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, zero, _CMP_LT_OQ));
+        }
+
+        uint32_t mask = (uint32_t)(~_mm256_movemask_ps(outside)) & 0xFFu;
+        n = appendVisible(out, n, i, mask);
+    }
+    return n;
+}
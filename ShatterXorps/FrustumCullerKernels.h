@@ -0,0 +1,48 @@
+// FrustumCullerKernels.h
+// Internal to FrustumCuller*.cpp: the per-ISA culling loops.
+#ifndef FRUSTUM_CULLER_KERNELS_H
+#define FRUSTUM_CULLER_KERNELS_H
+
+#include <cstdint>
+
+// The 6 planes split per component, abs(normal) precomputed
+struct CullPlanes {
+    float nx[6], ny[6], nz[6];
+    float ax[6], ay[6], az[6];
+    float w[6];
+};
+
+// SoA bounds, count is a multiple of 8 (padding is always outside)
+struct CullBounds {
+    const float* cx;
+    const float* cy;
+    const float* cz;
+    const float* ex;
+    const float* ey;
+    const float* ez;
+    const float* r;
+    uint32_t     count;
+};
+
+// Write the visible indices to out (room for bounds.count), return how many
+uint32_t cullScalar(const CullPlanes& planes, const CullBounds& bounds, uint32_t* out);
+uint32_t cullSSE(const CullPlanes& planes, const CullBounds& bounds, uint32_t* out);
+uint32_t cullAVX2(const CullPlanes& planes, const CullBounds& bounds, uint32_t* out);
+
+// Anonymous namespace: each .cpp gets its own copy compiled for its ISA
+namespace {
+
+    // Branchless compaction of one batch of 8: every lane is stored, the
+    // cursor only moves past the visible ones
+    inline uint32_t appendVisible(uint32_t* out, uint32_t n, uint32_t base, uint32_t mask)
+    {
+        for (uint32_t b = 0; b < 8; b++) {
+            out[n] = base + b;
+            n += (mask >> b) & 1u;
+        }
+        return n;
+    }
+
+} // namespace
+
+#endif // FRUSTUM_CULLER_KERNELS_H
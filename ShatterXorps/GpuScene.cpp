@@ -0,0 +1,703 @@
+// GpuScene.cpp
+#include "GpuScene.h"
+#include "PhysicalDevice.h"
+#include "Frustum.h"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+
+// gpu_cull.comp: local_size_x
+static const uint32_t CULL_WORKGROUP_SIZE = 64;
+
+static const VkFormat OCCLUSION_DEPTH_FORMAT = VK_FORMAT_D32_SFLOAT;
+
+// gpu_cull.comp pc.phase
+static const uint32_t PHASE_FRUSTUM = 0;
+static const uint32_t PHASE_LAST_VISIBLE = 1;
+static const uint32_t PHASE_HIZ = 2;
+
+void GpuScene::createBuffer(VkDevice device, PhysicalDevice& physDevice, Buffer& buf, VkDeviceSize size,
+    VkBufferUsageFlags usage, VkMemoryPropertyFlags props)
+{
+    VkBufferCreateInfo bufInfo{};
+    bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufInfo.size = size;
+    bufInfo.usage = usage;
+    bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufInfo, nullptr, &buf.buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create GPU scene buffer!");
+    }
+
+    VkMemoryRequirements memReq;
+    vkGetBufferMemoryRequirements(device, buf.buffer, &memReq);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReq.size;
+    allocInfo.memoryTypeIndex = physDevice.findMemoryType(memReq.memoryTypeBits, props);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &buf.memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate GPU scene buffer memory!");
+    }
+    vkBindBufferMemory(device, buf.buffer, buf.memory, 0);
+
+    if (props & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        vkMapMemory(device, buf.memory, 0, size, 0, &buf.mapped);
+        memset(buf.mapped, 0, (size_t)size);
+    }
+}
+
+void GpuScene::destroyBuffer(VkDevice device, Buffer& buf)
+{
+    if (buf.mapped) {
+        vkUnmapMemory(device, buf.memory);
+        buf.mapped = nullptr;
+    }
+    if (buf.buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, buf.buffer, nullptr);
+        buf.buffer = VK_NULL_HANDLE;
+    }
+    if (buf.memory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, buf.memory, nullptr);
+        buf.memory = VK_NULL_HANDLE;
+    }
+}
+
+void GpuScene::create(VkDevice device, PhysicalDevice& physDevice,
+    VkDescriptorSetLayout objectSetLayout, VkPipelineLayout layout,
+    VkExtent2D size, uint32_t objectCapacity)
+{
+    maxObjects = objectCapacity;
+    graphicsLayout = layout;
+    extent = size;
+
+    if (physDevice.supportsDrawIndirectCount()) {
+        cmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCount>(
+            vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCount"));
+    }
+
+    // ------------------------------------------------------------------
+    // 1) Per-object buffers: objects + params (CPU-written), draws + counts +
+    //    visibility (GPU). Two draw lists / counts: phase 1 and phase 2.
+    // ------------------------------------------------------------------
+    const VkMemoryPropertyFlags hostProps =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    createBuffer(device, physDevice, objectBuffer, sizeof(GpuObject) * maxObjects,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostProps);
+    createBuffer(device, physDevice, paramsBuffer, sizeof(GpuCullParams),
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, hostProps);
+    createBuffer(device, physDevice, drawBuffer, sizeof(VkDrawIndexedIndirectCommand) * maxObjects * 2,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    createBuffer(device, physDevice, countBuffer, sizeof(uint32_t) * 2,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    // Starts all zero: the first frame draws nothing in phase 1, everything
+    // visible comes through phase 2
+    createBuffer(device, physDevice, visibilityBuffer, sizeof(uint32_t) * maxObjects,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // Occlusion depth + render pass + Hi-Z
+    createOcclusionTargets(device, physDevice);
+
+    // ------------------------------------------------------------------
+    // 2) Descriptors: compute set (0..5) + the graphics object set (set=2)
+    // ------------------------------------------------------------------
+    {
+        VkDescriptorSetLayoutBinding bindings[6]{};
+        for (uint32_t i = 0; i < 6; i++) {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+        bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        bindings[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = 6;
+        layoutInfo.pBindings = bindings;
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create GPU cull descriptor set layout!");
+        }
+
+        VkDescriptorPoolSize poolSizes[3] = {
+            { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 },
+            { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5 },
+            { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 }
+        };
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.poolSizeCount = 3;
+        poolInfo.pPoolSizes = poolSizes;
+        poolInfo.maxSets = 2;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create GPU scene descriptor pool!");
+        }
+
+        VkDescriptorSetLayout setLayouts[2] = { descriptorSetLayout, objectSetLayout };
+        VkDescriptorSet sets[2];
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = descriptorPool;
+        allocInfo.descriptorSetCount = 2;
+        allocInfo.pSetLayouts = setLayouts;
+        if (vkAllocateDescriptorSets(device, &allocInfo, sets) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate GPU scene descriptor sets!");
+        }
+        computeSet = sets[0];
+        objectSet = sets[1];
+
+        VkDescriptorBufferInfo infos[5]{};
+        infos[0] = { objectBuffer.buffer, 0, VK_WHOLE_SIZE };
+        infos[1] = { drawBuffer.buffer, 0, VK_WHOLE_SIZE };
+        infos[2] = { countBuffer.buffer, 0, VK_WHOLE_SIZE };
+        infos[3] = { paramsBuffer.buffer, 0, sizeof(GpuCullParams) };
+        infos[4] = { visibilityBuffer.buffer, 0, VK_WHOLE_SIZE };
+
+        VkDescriptorImageInfo pyramidInfo{};
+        pyramidInfo.sampler = pyramid.getSampler();
+        pyramidInfo.imageView = pyramid.getView();
+        pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet writes[7]{};
+        for (uint32_t i = 0; i < 6; i++) {
+            writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[i].dstSet = computeSet;
+            writes[i].dstBinding = i;
+            writes[i].descriptorType = bindings[i].descriptorType;
+            writes[i].descriptorCount = 1;
+            if (i < 5) {
+                writes[i].pBufferInfo = &infos[i];
+            }
+        }
+        writes[5].pImageInfo = &pyramidInfo;
+        writes[6].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[6].dstSet = objectSet;
+        writes[6].dstBinding = 0;
+        writes[6].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[6].descriptorCount = 1;
+        writes[6].pBufferInfo = &infos[0];
+        vkUpdateDescriptorSets(device, 7, writes, 0, nullptr);
+    }
+
+    // ------------------------------------------------------------------
+    // 3) Cull pipeline (push constant: phase)
+    // ------------------------------------------------------------------
+    {
+        VkPushConstantRange range{};
+        range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        range.offset = 0;
+        range.size = sizeof(uint32_t);
+
+        VkPipelineLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layoutInfo.setLayoutCount = 1;
+        layoutInfo.pSetLayouts = &descriptorSetLayout;
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges = &range;
+        if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create GPU cull pipeline layout!");
+        }
+
+        auto compCode = readFile("shaders/gpu_cull.comp.spv");
+        VkShaderModule compModule = createShaderModule(device, compCode);
+
+        VkPipelineShaderStageCreateInfo stageInfo{};
+        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stageInfo.module = compModule;
+        stageInfo.pName = "main";
+
+        VkComputePipelineCreateInfo pipeInfo{};
+        pipeInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipeInfo.stage = stageInfo;
+        pipeInfo.layout = pipelineLayout;
+        if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &pipeline) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create GPU cull compute pipeline!");
+        }
+
+        vkDestroyShaderModule(device, compModule, nullptr);
+    }
+
+    createDepthPipeline(device);
+}
+
+void GpuScene::createOcclusionTargets(VkDevice device, PhysicalDevice& physDevice)
+{
+    // Depth-only target for the phase 1 list, sampled by the pyramid build
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = OCCLUSION_DEPTH_FORMAT;
+    imageInfo.extent = { extent.width, extent.height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(device, &imageInfo, nullptr, &occlusionDepth) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create occlusion depth image!");
+    }
+
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(device, occlusionDepth, &memReqs);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReqs.size;
+    allocInfo.memoryTypeIndex =
+        physDevice.findMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &occlusionDepthMemory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate occlusion depth memory!");
+    }
+    vkBindImageMemory(device, occlusionDepth, occlusionDepthMemory, 0);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = occlusionDepth;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = OCCLUSION_DEPTH_FORMAT;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
+    if (vkCreateImageView(device, &viewInfo, nullptr, &occlusionDepthView) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create occlusion depth view!");
+    }
+
+    // Cleared every frame, left read-only for the pyramid build
+    VkAttachmentDescription depthAttachment{};
+    depthAttachment.format = OCCLUSION_DEPTH_FORMAT;
+    depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+    VkAttachmentReference depthRef{ 0, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 0;
+    subpass.pDepthStencilAttachment = &depthRef;
+
+    // Last frame's pyramid build read the depth before the clear,
+    // this frame's depth before the pyramid build
+    VkSubpassDependency deps[2]{};
+    deps[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    deps[0].dstSubpass = 0;
+    deps[0].srcStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    deps[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    deps[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    deps[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    deps[1].srcSubpass = 0;
+    deps[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    deps[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    deps[1].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    deps[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    deps[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    VkRenderPassCreateInfo rpInfo{};
+    rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    rpInfo.attachmentCount = 1;
+    rpInfo.pAttachments = &depthAttachment;
+    rpInfo.subpassCount = 1;
+    rpInfo.pSubpasses = &subpass;
+    rpInfo.dependencyCount = 2;
+    rpInfo.pDependencies = deps;
+    if (vkCreateRenderPass(device, &rpInfo, nullptr, &depthPass) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create occlusion depth render pass!");
+    }
+
+    VkFramebufferCreateInfo fbInfo{};
+    fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fbInfo.renderPass = depthPass;
+    fbInfo.attachmentCount = 1;
+    fbInfo.pAttachments = &occlusionDepthView;
+    fbInfo.width = extent.width;
+    fbInfo.height = extent.height;
+    fbInfo.layers = 1;
+    if (vkCreateFramebuffer(device, &fbInfo, nullptr, &depthFramebuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create occlusion depth framebuffer!");
+    }
+
+    pyramid.create(device, physDevice, extent, occlusionDepthView);
+}
+
+void GpuScene::createDepthPipeline(VkDevice device)
+{
+    // gpu_scene.vert alone: same positions as the main pass, no fragment stage
+    auto vertCode = readFile("shaders/gpu_scene.vert.spv");
+    VkShaderModule vertModule = createShaderModule(device, vertCode);
+
+    VkPipelineShaderStageCreateInfo stage{};
+    stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stage.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stage.module = vertModule;
+    stage.pName = "main";
+
+    auto bindingDesc = Vertex::getBindingDescription();
+    auto attrDescs = Vertex::getAttributeDescriptions();
+
+    VkPipelineVertexInputStateCreateInfo vertexInput{};
+    vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInput.vertexBindingDescriptionCount = 1;
+    vertexInput.pVertexBindingDescriptions = &bindingDesc;
+    vertexInput.vertexAttributeDescriptionCount = (uint32_t)attrDescs.size();
+    vertexInput.pVertexAttributeDescriptions = attrDescs.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.lineWidth = 1.0f;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.attachmentCount = 0;
+
+    VkDynamicState dynStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynState{};
+    dynState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynState.dynamicStateCount = 2;
+    dynState.pDynamicStates = dynStates;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = 1;
+    pipelineInfo.pStages = &stage;
+    pipelineInfo.pVertexInputState = &vertexInput;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynState;
+    pipelineInfo.layout = graphicsLayout;
+    pipelineInfo.renderPass = depthPass;
+    pipelineInfo.subpass = 0;
+    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &depthPipeline) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create occlusion depth pipeline!");
+    }
+
+    vkDestroyShaderModule(device, vertModule, nullptr);
+}
+
+void GpuScene::destroy(VkDevice device)
+{
+    if (depthPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, depthPipeline, nullptr);
+        depthPipeline = VK_NULL_HANDLE;
+    }
+    pyramid.destroy(device);
+    if (depthFramebuffer != VK_NULL_HANDLE) {
+        vkDestroyFramebuffer(device, depthFramebuffer, nullptr);
+        depthFramebuffer = VK_NULL_HANDLE;
+    }
+    if (depthPass != VK_NULL_HANDLE) {
+        vkDestroyRenderPass(device, depthPass, nullptr);
+        depthPass = VK_NULL_HANDLE;
+    }
+    if (occlusionDepthView != VK_NULL_HANDLE) {
+        vkDestroyImageView(device, occlusionDepthView, nullptr);
+        occlusionDepthView = VK_NULL_HANDLE;
+    }
+    if (occlusionDepth != VK_NULL_HANDLE) {
+        vkDestroyImage(device, occlusionDepth, nullptr);
+        occlusionDepth = VK_NULL_HANDLE;
+    }
+    if (occlusionDepthMemory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, occlusionDepthMemory, nullptr);
+        occlusionDepthMemory = VK_NULL_HANDLE;
+    }
+    if (pipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        pipeline = VK_NULL_HANDLE;
+    }
+    if (pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        pipelineLayout = VK_NULL_HANDLE;
+    }
+    if (descriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+        computeSet = VK_NULL_HANDLE;
+        objectSet = VK_NULL_HANDLE;
+    }
+    if (descriptorSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        descriptorSetLayout = VK_NULL_HANDLE;
+    }
+    destroyBuffer(device, visibilityBuffer);
+    destroyBuffer(device, countBuffer);
+    destroyBuffer(device, drawBuffer);
+    destroyBuffer(device, paramsBuffer);
+    destroyBuffer(device, objectBuffer);
+    destroyBuffer(device, indexBuffer);
+    destroyBuffer(device, vertexBuffer);
+}
+
+uint32_t GpuScene::addMesh(const std::vector<Vertex>& meshVertices, const std::vector<uint16_t>& meshIndices)
+{
+    const Aabb bounds = Aabb::fromVertices(meshVertices);
+
+    Mesh mesh{};
+    mesh.indexCount = (uint32_t)meshIndices.size();
+    mesh.firstIndex = (uint32_t)indices.size();
+    mesh.vertexOffset = (uint32_t)vertices.size();
+    mesh.boundsMin = bounds.min;
+    mesh.boundsMax = bounds.max;
+
+    // Indices stay mesh-relative, vertexOffset rebases them in the draw
+    vertices.insert(vertices.end(), meshVertices.begin(), meshVertices.end());
+    indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
+
+    meshes.push_back(mesh);
+    return (uint32_t)meshes.size() - 1;
+}
+
+uint32_t GpuScene::addObject(uint32_t mesh, const glm::mat4& model, uint32_t material)
+{
+    if (objects.size() >= maxObjects) {
+        throw std::runtime_error("GPU scene object capacity exceeded!");
+    }
+    const Mesh& m = meshes.at(mesh);
+
+    GpuObject obj{};
+    obj.model = model;
+    obj.boundsMin = glm::vec4(m.boundsMin, 1.0f);
+    obj.boundsMax = glm::vec4(m.boundsMax, 1.0f);
+    obj.mesh = glm::uvec4(m.indexCount, m.firstIndex, m.vertexOffset, material);
+
+    objects.push_back(obj);
+    return (uint32_t)objects.size() - 1;
+}
+
+void GpuScene::upload(VkDevice device, PhysicalDevice& physDevice)
+{
+    if (vertices.empty() || indices.empty()) {
+        throw std::runtime_error("GPU scene has no meshes to upload!");
+    }
+
+    destroyBuffer(device, indexBuffer);
+    destroyBuffer(device, vertexBuffer);
+
+    const VkMemoryPropertyFlags hostProps =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    const VkDeviceSize vbSize = sizeof(Vertex) * vertices.size();
+    const VkDeviceSize ibSize = sizeof(uint32_t) * indices.size();
+    createBuffer(device, physDevice, vertexBuffer, vbSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, hostProps);
+    createBuffer(device, physDevice, indexBuffer, ibSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, hostProps);
+    memcpy(vertexBuffer.mapped, vertices.data(), (size_t)vbSize);
+    memcpy(indexBuffer.mapped, indices.data(), (size_t)ibSize);
+
+    memcpy(objectBuffer.mapped, objects.data(), sizeof(GpuObject) * objects.size());
+}
+
+void GpuScene::setTransform(uint32_t object, const glm::mat4& model)
+{
+    objects[object].model = model;
+    GpuObject* dst = static_cast<GpuObject*>(objectBuffer.mapped);
+    dst[object].model = model;
+}
+
+void GpuScene::updateCulling(const glm::mat4& viewProj)
+{
+    const Frustum frustum(viewProj);
+
+    GpuCullParams params{};
+    for (int i = 0; i < 6; i++) {
+        params.planes[i] = frustum.getPlane(i);
+    }
+    params.counts = glm::uvec4((uint32_t)objects.size(), usesDrawCount() ? 1u : 0u, maxObjects, 0u);
+    params.viewProj = viewProj;
+    params.pyramid = glm::vec4((float)extent.width, (float)extent.height, (float)pyramid.getLevelCount(), 0.0f);
+    memcpy(paramsBuffer.mapped, &params, sizeof(params));
+}
+
+void GpuScene::dispatchCull(VkCommandBuffer cb, uint32_t phase)
+{
+    const uint32_t objectCount = (uint32_t)objects.size();
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+        0, 1, &computeSet, 0, nullptr);
+    vkCmdPushConstants(cb, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(phase), &phase);
+    vkCmdDispatch(cb, (objectCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+}
+
+void GpuScene::drawList(VkCommandBuffer cb, uint32_t list)
+{
+    const uint32_t objectCount = (uint32_t)objects.size();
+    const VkDeviceSize drawOffset = sizeof(VkDrawIndexedIndirectCommand) * maxObjects * list;
+    if (cmdDrawIndexedIndirectCount) {
+        cmdDrawIndexedIndirectCount(cb, drawBuffer.buffer, drawOffset,
+            countBuffer.buffer, sizeof(uint32_t) * list,
+            objectCount, sizeof(VkDrawIndexedIndirectCommand));
+    }
+    else {
+        // Fixed slots, culled objects have instanceCount 0
+        vkCmdDrawIndexedIndirect(cb, drawBuffer.buffer, drawOffset,
+            objectCount, sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
+
+void GpuScene::recordCull(VkCommandBuffer cb, VkDescriptorSet cameraSet)
+{
+    VkBufferMemoryBarrier barriers[3]{};
+    for (int i = 0; i < 3; i++) {
+        barriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].offset = 0;
+        barriers[i].size = VK_WHOLE_SIZE;
+    }
+    barriers[0].buffer = countBuffer.buffer;
+    barriers[1].buffer = drawBuffer.buffer;
+    barriers[2].buffer = visibilityBuffer.buffer;
+
+    // 1) Last frame's indirect read of the counts is done -> clear them
+    barriers[0].srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(cb,
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 1, barriers, 0, nullptr);
+    vkCmdFillBuffer(cb, countBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+
+    // 2) Cleared counts + last frame's draw lists / visibility -> cull shader
+    barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[1].srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[2].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[2].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cb,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr, 3, barriers, 0, nullptr);
+
+    // 3) Phase 1 (or frustum only)
+    dispatchCull(cb, occlusionEnabled ? PHASE_LAST_VISIBLE : PHASE_FRUSTUM);
+
+    // Draw list + counts -> indirect draw
+    barriers[0].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[0].dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    barriers[1].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barriers[1].dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(cb,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0, 0, nullptr, 2, barriers, 0, nullptr);
+
+    if (!occlusionEnabled) {
+        return;
+    }
+
+    // 4) Depth of what was visible last frame
+    VkClearValue clear{};
+    clear.depthStencil = { 1.f, 0 };
+
+    VkRenderPassBeginInfo rpBegin{};
+    rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rpBegin.renderPass = depthPass;
+    rpBegin.framebuffer = depthFramebuffer;
+    rpBegin.renderArea.offset = { 0, 0 };
+    rpBegin.renderArea.extent = extent;
+    rpBegin.clearValueCount = 1;
+    rpBegin.pClearValues = &clear;
+    vkCmdBeginRenderPass(cb, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPipeline);
+    VkViewport viewport{ 0.f, 0.f, (float)extent.width, (float)extent.height, 0.f, 1.f };
+    VkRect2D scissor{ { 0, 0 }, extent };
+    vkCmdSetViewport(cb, 0, 1, &viewport);
+    vkCmdSetScissor(cb, 0, 1, &scissor);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsLayout,
+        0, 1, &cameraSet, 0, nullptr);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsLayout,
+        2, 1, &objectSet, 0, nullptr);
+
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(cb, 0, 1, &vertexBuffer.buffer, &offset);
+    vkCmdBindIndexBuffer(cb, indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    drawList(cb, 0);
+
+    vkCmdEndRenderPass(cb);
+
+    // 5) Hi-Z of that depth (the render pass dependency covers the read)
+    pyramid.record(cb);
+
+    // 6) Phase 2: everything else against the pyramid
+    dispatchCull(cb, PHASE_HIZ);
+
+    vkCmdPipelineBarrier(cb,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+        0, 0, nullptr, 2, barriers, 0, nullptr);
+}
+
+void GpuScene::recordDraw(VkCommandBuffer cb, VkPipelineLayout layout)
+{
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
+        2, 1, &objectSet, 0, nullptr);
+
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(cb, 0, 1, &vertexBuffer.buffer, &offset);
+    vkCmdBindIndexBuffer(cb, indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+    drawList(cb, 0);
+    if (occlusionEnabled) {
+        drawList(cb, 1);
+    }
+}
+
+VkShaderModule GpuScene::createShaderModule(VkDevice device, const std::vector<char>& code)
+{
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule shaderModule;
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create GPU cull shader module!");
+    }
+    return shaderModule;
+}
+
+std::vector<char> GpuScene::readFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open GPU cull shader file: " + filename);
+    }
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+    file.close();
+    return buffer;
+}
@@ -0,0 +1,169 @@
+// GpuScene.h
+#ifndef GPU_SCENE_H
+#define GPU_SCENE_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include "Vertex.h"
+#include "DepthPyramid.h"
+
+class PhysicalDevice;
+
+/*
+  GPU-driven drawing: all meshes live in one shared vertex / index buffer,
+  every object (model matrix, object-space box, mesh range) in one SSBO.
+
+  Per frame a compute pass (shaders/gpu_cull.comp, one invocation per
+  object) frustum-culls the objects and writes a VkDrawIndexedIndirectCommand
+  per visible one, with firstInstance = object index so gpu_scene.vert can
+  fetch the model matrix. The main pass then draws the whole scene with a
+  single vkCmdDrawIndexedIndirectCount, the CPU no longer issues a draw per
+  object. Devices without drawIndirectCount get fixed slots instead (culled
+  objects are written with instanceCount 0) and vkCmdDrawIndexedIndirect.
+
+  Occlusion culling (setOcclusionEnabled), two phases per frame:
+    1) cull: frustum + drawn last frame -> list 0, drawn depth-only into
+       an occlusion depth buffer, DepthPyramid builds the Hi-Z from it
+    2) cull: frustum + Hi-Z test -> list 1 = visible now but not in list 0,
+       the per-object visibility flags are rewritten for the next frame
+  The main pass draws both lists. Objects hidden last frame cost nothing
+  until they come out, and nothing pops in: a disoccluded object is caught
+  by phase 2 in the same frame.
+
+  Descriptors:
+    compute set   => (0) objects, (1) draw commands, (2) draw counts, (3) cull params UBO,
+                     (4) visibility flags, (5) depth pyramid
+    graphics set  => set=2 binding=0 objects (GraphicsPipeline::getDescriptorSetLayoutObjects)
+
+    gpuScene.create(device, physDevice, pipeline.getDescriptorSetLayoutObjects(),
+        pipeline.getPipelineLayout(), extent, 64);
+    uint32_t mesh = gpuScene.addMesh(cubeVertices, cubeIndices);
+    uint32_t obj = gpuScene.addObject(mesh, model);
+    gpuScene.upload(device, physDevice);
+    ...
+    gpuScene.setTransform(obj, model);
+    gpuScene.updateCulling(proj * view);
+    gpuScene.recordCull(cb, uboSet);           // outside the render pass
+    gpuScene.recordDraw(cb, pipelineLayout);   // inside, gpu-driven pipeline bound
+*/
+class GpuScene {
+public:
+    // Must match GpuObject in gpu_scene.vert / gpu_cull.comp (std430)
+    struct GpuObject {
+        glm::mat4  model;
+        glm::vec4  boundsMin;
+        glm::vec4  boundsMax;
+        glm::uvec4 mesh;        // x: index count, y: first index, z: vertex offset, w: material
+    };
+
+    // Must match CullParams in gpu_cull.comp (std140)
+    struct GpuCullParams {
+        glm::vec4  planes[6];
+        glm::uvec4 counts;      // x: object count, y: 1 = compact draw list, z: list capacity
+        glm::mat4  viewProj;
+        glm::vec4  pyramid;     // xy: occlusion depth size, z: pyramid levels
+    };
+
+    GpuScene() = default;
+    ~GpuScene() = default;
+
+    // graphicsLayout: GraphicsPipeline layout (set=0 camera UBO, set=2 objects),
+    // used by the occlusion depth pass; extent: occlusion depth size
+    void create(VkDevice device, PhysicalDevice& physDevice,
+        VkDescriptorSetLayout objectSetLayout, VkPipelineLayout graphicsLayout,
+        VkExtent2D extent, uint32_t maxObjects);
+    void destroy(VkDevice device);
+
+    // CPU side only until upload(); returns the mesh index
+    uint32_t addMesh(const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices);
+    // Returns the object index (= firstInstance of its draw). material:
+    // MaterialTable index, only read by the bindless fragment shader
+    uint32_t addObject(uint32_t mesh, const glm::mat4& model, uint32_t material = 0);
+
+    // Builds the shared vertex / index buffers and writes every object
+    void upload(VkDevice device, PhysicalDevice& physDevice);
+
+    void setTransform(uint32_t object, const glm::mat4& model);
+    // Camera of this frame, planes + matrix for the cull shader
+    void updateCulling(const glm::mat4& viewProj);
+
+    // Takes effect the next time the command buffers are recorded
+    void setOcclusionEnabled(bool enabled) { occlusionEnabled = enabled; }
+    bool isOcclusionEnabled() const { return occlusionEnabled; }
+
+    // Clears the counts, culls (both phases + depth pass + Hi-Z with
+    // occlusion on), barrier to DRAW_INDIRECT. Outside a render pass.
+    // cameraSet: set=0 of the graphics layout, for the occlusion depth pass.
+    void recordCull(VkCommandBuffer cb, VkDescriptorSet cameraSet);
+    // Binds set=2 + the shared buffers and issues the indirect draw(s)
+    void recordDraw(VkCommandBuffer cb, VkPipelineLayout layout);
+
+    uint32_t getObjectCount() const { return (uint32_t)objects.size(); }
+    bool     usesDrawCount() const { return cmdDrawIndexedIndirectCount != nullptr; }
+
+private:
+    struct Mesh {
+        uint32_t indexCount;
+        uint32_t firstIndex;
+        uint32_t vertexOffset;
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+    };
+
+    struct Buffer {
+        VkBuffer       buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void*          mapped = nullptr;
+    };
+    void createBuffer(VkDevice device, PhysicalDevice& physDevice, Buffer& buf, VkDeviceSize size,
+        VkBufferUsageFlags usage, VkMemoryPropertyFlags props);
+    void destroyBuffer(VkDevice device, Buffer& buf);
+
+    std::vector<Mesh>      meshes;
+    std::vector<GpuObject> objects;
+    std::vector<Vertex>    vertices;
+    std::vector<uint32_t>  indices;
+    uint32_t               maxObjects = 0;
+
+    Buffer vertexBuffer;    // host-visible, written once by upload()
+    Buffer indexBuffer;     // host-visible, written once by upload()
+    Buffer objectBuffer;    // host-visible, persistently mapped
+    Buffer paramsBuffer;    // host-visible, persistently mapped
+    Buffer drawBuffer;      // device-local, written by the cull pass (2 lists)
+    Buffer countBuffer;     // device-local, written by the cull pass (2 counts)
+    Buffer visibilityBuffer;   // device-local, written by cull phase 2
+
+    VkPipeline            pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout      pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool      descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet       computeSet = VK_NULL_HANDLE;
+    VkDescriptorSet       objectSet = VK_NULL_HANDLE;
+
+    // Occlusion: depth-only pass of list 0 + its Hi-Z
+    VkImage          occlusionDepth = VK_NULL_HANDLE;
+    VkDeviceMemory   occlusionDepthMemory = VK_NULL_HANDLE;
+    VkImageView      occlusionDepthView = VK_NULL_HANDLE;
+    VkRenderPass     depthPass = VK_NULL_HANDLE;
+    VkFramebuffer    depthFramebuffer = VK_NULL_HANDLE;
+    VkPipeline       depthPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout graphicsLayout = VK_NULL_HANDLE;   // not owned
+    DepthPyramid     pyramid;
+    VkExtent2D       extent{ 0, 0 };
+    bool             occlusionEnabled = false;
+
+    // vkCmdDrawIndexedIndirectCount (core 1.2), null => fixed slots
+    PFN_vkCmdDrawIndexedIndirectCount cmdDrawIndexedIndirectCount = nullptr;
+
+    void createOcclusionTargets(VkDevice device, PhysicalDevice& physDevice);
+    void createDepthPipeline(VkDevice device);
+    void dispatchCull(VkCommandBuffer cb, uint32_t phase);
+    void drawList(VkCommandBuffer cb, uint32_t list);
+
+    VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
+    std::vector<char> readFile(const std::string& filename);
+};
+
+#endif // GPU_SCENE_H
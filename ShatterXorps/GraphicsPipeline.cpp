@@ -10,14 +10,23 @@
 GraphicsPipeline::GraphicsPipeline(
     VkDevice device,
     VkExtent2D swapChainExtent,
-    VkRenderPass renderPass)
+    VkRenderPass renderPass,
+    bool useRayQuery,
+    const VkPipelineRenderingCreateInfoKHR* rendering,
+    VkDescriptorSetLayout bindlessLayout)
     : device(device),
     pipelineLayout(VK_NULL_HANDLE),
     graphicsPipeline(VK_NULL_HANDLE),
+    equalDepthPipeline(VK_NULL_HANDLE),
+    gpuDrivenPipeline(VK_NULL_HANDLE),
+    instancedPipeline(VK_NULL_HANDLE),
+    useRayQuery(useRayQuery),
+    descriptorSetLayoutBindless(bindlessLayout),
     descriptorSetLayoutUBO(VK_NULL_HANDLE),
-    descriptorSetLayoutSampler(VK_NULL_HANDLE)
+    descriptorSetLayoutSampler(VK_NULL_HANDLE),
+    descriptorSetLayoutObjects(VK_NULL_HANDLE)
 {
-    createGraphicsPipeline(swapChainExtent, renderPass);
+    createGraphicsPipeline(swapChainExtent, renderPass, rendering);
 }
 
 GraphicsPipeline::~GraphicsPipeline() {
@@ -29,6 +38,18 @@ void GraphicsPipeline::destroy(VkDevice device) {
         vkDestroyPipeline(device, graphicsPipeline, nullptr);
         graphicsPipeline = VK_NULL_HANDLE;
     }
+    if (equalDepthPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, equalDepthPipeline, nullptr);
+        equalDepthPipeline = VK_NULL_HANDLE;
+    }
+    if (gpuDrivenPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, gpuDrivenPipeline, nullptr);
+        gpuDrivenPipeline = VK_NULL_HANDLE;
+    }
+    if (instancedPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, instancedPipeline, nullptr);
+        instancedPipeline = VK_NULL_HANDLE;
+    }
     if (pipelineLayout != VK_NULL_HANDLE) {
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
         pipelineLayout = VK_NULL_HANDLE;
@@ -41,14 +62,24 @@ void GraphicsPipeline::destroy(VkDevice device) {
         vkDestroyDescriptorSetLayout(device, descriptorSetLayoutUBO, nullptr);
         descriptorSetLayoutUBO = VK_NULL_HANDLE;
     }
+    if (descriptorSetLayoutObjects != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, descriptorSetLayoutObjects, nullptr);
+        descriptorSetLayoutObjects = VK_NULL_HANDLE;
+    }
 }
 
-void GraphicsPipeline::createGraphicsPipeline(VkExtent2D swapChainExtent, VkRenderPass renderPass) {
+void GraphicsPipeline::createGraphicsPipeline(VkExtent2D swapChainExtent, VkRenderPass renderPass,
+    const VkPipelineRenderingCreateInfoKHR* rendering) {
     //-----------------------------------------------------------------
     // 1) Load SPIR-V vertex & fragment shaders
     //-----------------------------------------------------------------
     auto vertShaderCode = readFile("shaders/shader.vert.spv");
-    auto fragShaderCode = readFile("shaders/shader.frag.spv");
+    // Bindless variants read the material table + texture array at set=3
+    const bool useBindless = descriptorSetLayoutBindless != VK_NULL_HANDLE;
+    const char* fragFile = useRayQuery
+        ? (useBindless ? "shaders/shader_rq_bindless.frag.spv" : "shaders/shader_rq.frag.spv")
+        : (useBindless ? "shaders/shader_bindless.frag.spv" : "shaders/shader.frag.spv");
+    auto fragShaderCode = readFile(fragFile);
 
     VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
     VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
@@ -163,6 +194,10 @@ void GraphicsPipeline::createGraphicsPipeline(VkExtent2D swapChainExtent, VkRend
     //     set=1 -> Sampler layout:
     //        binding=0 => PixelTracer (or any additional sampler)
     //        binding=1 => Shadow map sampler
+    //        binding=2 => scene TLAS (ray query variant only)
+    //        binding=3 => local light SSBO (ShadowAtlas)
+    //        binding=4 => shadow atlas sampler
+    //        binding=5 => EVSM moments sampler
     //-----------------------------------------------------------------
 
     // (A) set=0 (UBO with camera + light)
@@ -214,11 +249,70 @@ void GraphicsPipeline::createGraphicsPipeline(VkExtent2D swapChainExtent, VkRend
     samplerBinding1.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
     samplerBinding1.pImmutableSamplers = nullptr;
 
-    std::array<VkDescriptorSetLayoutBinding, 2> samplerBindings = {
+    VkDescriptorSetLayoutBinding localLightBinding{};
+    localLightBinding.binding = 3;
+    localLightBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    localLightBinding.descriptorCount = 1;
+    localLightBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    localLightBinding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutBinding atlasBinding{};
+    atlasBinding.binding = 4;
+    atlasBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    atlasBinding.descriptorCount = 1;
+    atlasBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    atlasBinding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutBinding momentsBinding{};
+    momentsBinding.binding = 5;
+    momentsBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    momentsBinding.descriptorCount = 1;
+    momentsBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    momentsBinding.pImmutableSamplers = nullptr;
+
+    // ClusteredLights: params UBO, light SSBO, froxel cells + index list
+    VkDescriptorSetLayoutBinding clusterParamsBinding{};
+    clusterParamsBinding.binding = 6;
+    clusterParamsBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    clusterParamsBinding.descriptorCount = 1;
+    clusterParamsBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    clusterParamsBinding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutBinding clusterLightBinding{};
+    clusterLightBinding.binding = 7;
+    clusterLightBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    clusterLightBinding.descriptorCount = 1;
+    clusterLightBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    clusterLightBinding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutBinding clusterBinding{};
+    clusterBinding.binding = 8;
+    clusterBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    clusterBinding.descriptorCount = 1;
+    clusterBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    clusterBinding.pImmutableSamplers = nullptr;
+
+    std::vector<VkDescriptorSetLayoutBinding> samplerBindings = {
         samplerBinding0,
-        samplerBinding1
+        samplerBinding1,
+        localLightBinding,
+        atlasBinding,
+        momentsBinding,
+        clusterParamsBinding,
+        clusterLightBinding,
+        clusterBinding
     };
 
+    if (useRayQuery) {
+        VkDescriptorSetLayoutBinding tlasBinding{};
+        tlasBinding.binding = 2;
+        tlasBinding.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+        tlasBinding.descriptorCount = 1;
+        tlasBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        tlasBinding.pImmutableSamplers = nullptr;
+        samplerBindings.push_back(tlasBinding);
+    }
+
     VkDescriptorSetLayoutCreateInfo layoutInfoSampler{};
     layoutInfoSampler.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfoSampler.bindingCount = static_cast<uint32_t>(samplerBindings.size());
@@ -230,11 +324,36 @@ void GraphicsPipeline::createGraphicsPipeline(VkExtent2D swapChainExtent, VkRend
         throw std::runtime_error("Failed to create descriptor set layout (samplers)!");
     }
 
-    // Combine both sets (set=0 for UBO, set=1 for samplers)
-    std::array<VkDescriptorSetLayout, 2> setLayouts = {
+    // set=2: GpuScene per-object SSBO (gpu_scene.vert only)
+    VkDescriptorSetLayoutBinding objectBinding{};
+    objectBinding.binding = 0;
+    objectBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    objectBinding.descriptorCount = 1;
+    objectBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    objectBinding.pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfoObjects{};
+    layoutInfoObjects.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfoObjects.bindingCount = 1;
+    layoutInfoObjects.pBindings = &objectBinding;
+
+    if (vkCreateDescriptorSetLayout(
+        device, &layoutInfoObjects, nullptr, &descriptorSetLayoutObjects) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create descriptor set layout (objects)!");
+    }
+
+    // Combine the sets (set=0 for UBO, set=1 for samplers, set=2 for objects;
+    // the per-draw path never binds set=2). set=3 is the bindless set, owned
+    // by BindlessDescriptors, only when it was passed in.
+    std::vector<VkDescriptorSetLayout> setLayouts = {
         descriptorSetLayoutUBO,
-        descriptorSetLayoutSampler
+        descriptorSetLayoutSampler,
+        descriptorSetLayoutObjects
     };
+    if (useBindless) {
+        setLayouts.push_back(descriptorSetLayoutBindless);
+    }
 
     //-----------------------------------------------------------------
     // 11) Pipeline Layout
@@ -243,7 +362,13 @@ void GraphicsPipeline::createGraphicsPipeline(VkExtent2D swapChainExtent, VkRend
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
     pipelineLayoutInfo.pSetLayouts = setLayouts.data();
-    pipelineLayoutInfo.pushConstantRangeCount = 0;  // if needed, add push constants
+    // Per-draw model + material (PushConstants), shared by every variant
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = PUSH_CONSTANT_STAGES;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(PushConstants);
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushRange;
 
     if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create pipeline layout!");
@@ -265,6 +390,8 @@ void GraphicsPipeline::createGraphicsPipeline(VkExtent2D swapChainExtent, VkRend
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = pipelineLayout;
+    // Dynamic rendering: no render pass, the attachment formats come in pNext
+    pipelineInfo.pNext = rendering;
     pipelineInfo.renderPass = renderPass;
     pipelineInfo.subpass = 0;
 
@@ -279,6 +406,67 @@ void GraphicsPipeline::createGraphicsPipeline(VkExtent2D swapChainExtent, VkRend
         throw std::runtime_error("Failed to create graphics pipeline!");
     }
 
+    // Depth prepass variant: the depth buffer is already final, only shade
+    // the fragments that match it and leave it untouched
+    depthStencil.depthWriteEnable = VK_FALSE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_EQUAL;
+
+    if (vkCreateGraphicsPipelines(
+        device,
+        VK_NULL_HANDLE,
+        1,
+        &pipelineInfo,
+        nullptr,
+        &equalDepthPipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create equal-depth graphics pipeline!");
+    }
+
+    // GPU-driven variant: regular depth test, vertex shader reads the model
+    // matrix of objects[gl_InstanceIndex] (GpuScene puts it in firstInstance)
+    auto gpuVertShaderCode = readFile("shaders/gpu_scene.vert.spv");
+    VkShaderModule gpuVertShaderModule = createShaderModule(gpuVertShaderCode);
+    shaderStages[0].module = gpuVertShaderModule;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+    if (vkCreateGraphicsPipelines(
+        device,
+        VK_NULL_HANDLE,
+        1,
+        &pipelineInfo,
+        nullptr,
+        &gpuDrivenPipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create GPU-driven graphics pipeline!");
+    }
+    vkDestroyShaderModule(device, gpuVertShaderModule, nullptr);
+
+    // Instanced variant: same depth state, model matrix per instance from
+    // vertex binding 1
+    auto instancedBindings = Vertex::getInstancedBindingDescriptions();
+    auto instancedAttributes = Vertex::getInstancedAttributeDescriptions();
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(instancedBindings.size());
+    vertexInputInfo.pVertexBindingDescriptions = instancedBindings.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(instancedAttributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = instancedAttributes.data();
+
+    auto instancedVertShaderCode = readFile("shaders/instanced.vert.spv");
+    VkShaderModule instancedVertShaderModule = createShaderModule(instancedVertShaderCode);
+    shaderStages[0].module = instancedVertShaderModule;
+
+    if (vkCreateGraphicsPipelines(
+        device,
+        VK_NULL_HANDLE,
+        1,
+        &pipelineInfo,
+        nullptr,
+        &instancedPipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create instanced graphics pipeline!");
+    }
+    vkDestroyShaderModule(device, instancedVertShaderModule, nullptr);
+
     // Clean up shader modules after pipeline creation
     vkDestroyShaderModule(device, fragShaderModule, nullptr);
     vkDestroyShaderModule(device, vertShaderModule, nullptr);
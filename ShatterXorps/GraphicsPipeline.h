@@ -2,29 +2,75 @@
 #define GRAPHICS_PIPELINE_H
 
 #include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
 #include <vector>
 #include <string>
 
 class GraphicsPipeline {
 public:
-    GraphicsPipeline(VkDevice device, VkExtent2D swapChainExtent, VkRenderPass renderPass);
+    // Per-draw data, pushed with vkCmdPushConstants before each draw (no
+    // buffer writes, no descriptor updates). Must match the push_constant
+    // block in shader.vert / depth_prepass.vert. Camera data stays in the
+    // per-frame UBO set.
+    struct PushConstants {
+        glm::mat4 model;
+        uint32_t  materialIndex;
+    };
+    static const VkShaderStageFlags PUSH_CONSTANT_STAGES =
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    // useRayQuery: shader_rq.frag.spv + a TLAS at set=1, binding=2 instead of
+    // shadow-map lookups (only when PhysicalDevice::supportsRayQuery())
+    // rendering: attachment formats when renderPass is VK_NULL_HANDLE
+    // (dynamic rendering, RenderPass::getPipelineRenderingInfo())
+    // bindlessLayout: BindlessDescriptors::getSetLayout() to add it as set=3
+    // and shade with shader_bindless.frag.spv (materials looked up by
+    // PushConstants::materialIndex), VK_NULL_HANDLE keeps the vertex colors
+    GraphicsPipeline(VkDevice device, VkExtent2D swapChainExtent, VkRenderPass renderPass,
+        bool useRayQuery = false, const VkPipelineRenderingCreateInfoKHR* rendering = nullptr,
+        VkDescriptorSetLayout bindlessLayout = VK_NULL_HANDLE);
     ~GraphicsPipeline();
 
     void destroy(VkDevice device);
 
     VkPipeline getPipeline() const { return graphicsPipeline; }
+    // Same shaders/layout, depth compare EQUAL and no depth writes: for use
+    // after a DepthPrepassPipeline pass, so shader.frag runs once per pixel
+    VkPipeline getEqualDepthPipeline() const { return equalDepthPipeline; }
+    // gpu_scene.vert + the same fragment shader/state: GpuScene indirect
+    // draws, the model matrix comes from the object SSBO at set=2
+    VkPipeline getGpuDrivenPipeline() const { return gpuDrivenPipeline; }
+    // instanced.vert: a second, per-instance vertex binding carries the
+    // model matrix (Vertex::getInstancedBindingDescriptions), one draw per
+    // mesh with instanceCount = copies (InstanceBatch)
+    VkPipeline getInstancedPipeline() const { return instancedPipeline; }
     VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
 
     // set=0 -> UBO layout (camera + light)
     VkDescriptorSetLayout getDescriptorSetLayoutUBO() const { return descriptorSetLayoutUBO; }
 
-    // set=1 -> Sampler layout (PixelTracer at binding=0, ShadowMap at binding=1)
+    // set=1 -> Sampler layout (PixelTracer at binding=0, ShadowMap at binding=1,
+    //          scene TLAS at binding=2 when usesRayQuery(), local light SSBO at
+    //          binding=3, shadow atlas at binding=4, EVSM moments at binding=5,
+    //          clustered light params / lights / cells at binding=6/7/8)
     VkDescriptorSetLayout getDescriptorSetLayoutSampler() const { return descriptorSetLayoutSampler; }
 
+    // set=2 -> GpuScene object SSBO (binding=0), only read by gpu_scene.vert
+    VkDescriptorSetLayout getDescriptorSetLayoutObjects() const { return descriptorSetLayoutObjects; }
+
+    bool usesRayQuery() const { return useRayQuery; }
+    // set=3 -> BindlessDescriptors (not owned, destroy() leaves it alone)
+    bool usesBindless() const { return descriptorSetLayoutBindless != VK_NULL_HANDLE; }
+
 private:
     VkDevice device;
     VkPipelineLayout pipelineLayout;
     VkPipeline graphicsPipeline;
+    VkPipeline equalDepthPipeline;
+    VkPipeline gpuDrivenPipeline;
+    VkPipeline instancedPipeline;
+    bool useRayQuery;
+    VkDescriptorSetLayout descriptorSetLayoutBindless;
 
     // set=0 layout
     VkDescriptorSetLayout descriptorSetLayoutUBO;
@@ -32,7 +78,11 @@ private:
     // set=1 layout
     VkDescriptorSetLayout descriptorSetLayoutSampler;
 
-    void createGraphicsPipeline(VkExtent2D swapChainExtent, VkRenderPass renderPass);
+    // set=2 layout
+    VkDescriptorSetLayout descriptorSetLayoutObjects;
+
+    void createGraphicsPipeline(VkExtent2D swapChainExtent, VkRenderPass renderPass,
+        const VkPipelineRenderingCreateInfoKHR* rendering);
     VkShaderModule createShaderModule(const std::vector<char>& code);
     std::vector<char> readFile(const std::string& filename);
 };
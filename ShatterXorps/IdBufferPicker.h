@@ -0,0 +1,85 @@
+// IdBufferPicker.h
+#ifndef ID_BUFFER_PICKER_H
+#define ID_BUFFER_PICKER_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+
+class PhysicalDevice;
+
+/*
+  Pixel-exact picking: on request the given draws are rasterized into an
+  R32_UINT object-id target (pick_id.vert / pick_id.frag, depth tested) and
+  the one texel under the cursor is copied back. The render area and scissor
+  are that single pixel, so only its fragments are shaded.
+
+  pick() submits and waits on the queue: meant for a click, not every frame.
+
+    IdBufferPicker idPicker;
+    idPicker.create(device, physDevice, swapChainExtent);
+    std::vector<IdBufferPicker::Draw> draws = { { cubePositions, cubeIB, cubeIndexCount, proj * view * model, SceneCube } };
+    uint32_t id = idPicker.pick(device, commandPool, queue, x, y, draws);
+*/
+class IdBufferPicker {
+public:
+    static const uint32_t NO_OBJECT = 0xFFFFFFFFu;
+
+    // Must match the push_constant block in pick_id.vert
+    struct PushConstants {
+        glm::mat4 mvp;
+        uint32_t  objectId;
+    };
+
+    // Position-only vertex stream + 16-bit indices
+    struct Draw {
+        VkBuffer  positions = VK_NULL_HANDLE;
+        VkBuffer  indices = VK_NULL_HANDLE;
+        uint32_t  indexCount = 0;
+        glm::mat4 mvp = glm::mat4(1.0f);
+        uint32_t  objectId = NO_OBJECT;
+    };
+
+    IdBufferPicker() = default;
+    ~IdBufferPicker() = default;
+
+    void create(VkDevice device, PhysicalDevice& physDevice, VkExtent2D extent);
+    void destroy(VkDevice device);
+
+    // Object id at pixel (x, y) of the target, NO_OBJECT for background
+    uint32_t pick(VkDevice device, VkCommandPool commandPool, VkQueue queue,
+        uint32_t x, uint32_t y, const std::vector<Draw>& draws);
+
+    VkExtent2D getExtent() const { return extent; }
+
+private:
+    VkExtent2D extent{ 0, 0 };
+
+    VkImage        idImage = VK_NULL_HANDLE;
+    VkDeviceMemory idMemory = VK_NULL_HANDLE;
+    VkImageView    idView = VK_NULL_HANDLE;
+    VkImage        depthImage = VK_NULL_HANDLE;
+    VkDeviceMemory depthMemory = VK_NULL_HANDLE;
+    VkImageView    depthView = VK_NULL_HANDLE;
+
+    VkRenderPass     renderPass = VK_NULL_HANDLE;
+    VkFramebuffer    framebuffer = VK_NULL_HANDLE;
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline       pipeline = VK_NULL_HANDLE;
+
+    // 1 texel, host visible
+    VkBuffer       readbackBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory readbackMemory = VK_NULL_HANDLE;
+
+    void createTargets(VkDevice device, PhysicalDevice& physDevice);
+    void createImage(VkDevice device, PhysicalDevice& physDevice, VkFormat format, VkImageUsageFlags usage,
+        VkImageAspectFlags aspect, VkImage& image, VkDeviceMemory& memory, VkImageView& view);
+    void createRenderPass(VkDevice device);
+    void createPipeline(VkDevice device);
+
+    VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
+    std::vector<char> readFile(const std::string& filename);
+};
+
+#endif // ID_BUFFER_PICKER_H
@@ -0,0 +1,92 @@
+// InstanceBatch.cpp
+#include "InstanceBatch.h"
+#include "PhysicalDevice.h"
+#include "MaterialTable.h"
+#include <stdexcept>
+#include <algorithm>
+
+void InstanceBatch::create(VkDevice device, PhysicalDevice& physDevice, uint32_t maxInstances)
+{
+    capacity = maxInstances;
+
+    VkBufferCreateInfo bufInfo{};
+    bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufInfo.size = sizeof(InstanceData) * (VkDeviceSize)std::max(capacity, 1u);
+    bufInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufInfo, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create instance buffer!");
+    }
+
+    VkMemoryRequirements memReq;
+    vkGetBufferMemoryRequirements(device, buffer, &memReq);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReq.size;
+    allocInfo.memoryTypeIndex = physDevice.findMemoryType(memReq.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate instance buffer memory!");
+    }
+    vkBindBufferMemory(device, buffer, memory, 0);
+
+    void* data = nullptr;
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+    mapped = static_cast<InstanceData*>(data);
+}
+
+void InstanceBatch::destroy(VkDevice device)
+{
+    if (mapped) {
+        vkUnmapMemory(device, memory);
+        mapped = nullptr;
+    }
+    if (buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+    }
+    if (memory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, memory, nullptr);
+        memory = VK_NULL_HANDLE;
+    }
+    capacity = 0;
+    instanceCount = 0;
+}
+
+void InstanceBatch::setInstances(const std::vector<glm::mat4>& models,
+    const std::vector<uint32_t>& materials)
+{
+    instanceCount = std::min((uint32_t)models.size(), capacity);
+    for (uint32_t i = 0; i < instanceCount; i++) {
+        mapped[i].model = models[i];
+        mapped[i].materialIndex = (i < materials.size()) ? materials[i] : MaterialTable::DEFAULT_MATERIAL;
+    }
+}
+
+void InstanceBatch::setInstance(uint32_t index, const glm::mat4& model)
+{
+    if (index < instanceCount) {
+        mapped[index].model = model;
+    }
+}
+
+void InstanceBatch::setInstanceMaterial(uint32_t index, uint32_t material)
+{
+    if (index < instanceCount) {
+        mapped[index].materialIndex = material;
+    }
+}
+
+void InstanceBatch::draw(VkCommandBuffer cb, VkBuffer vertexBuffer, VkBuffer indexBuffer,
+    VkIndexType indexType, uint32_t indexCount) const
+{
+    if (instanceCount == 0) {
+        return;
+    }
+    VkBuffer buffers[2] = { vertexBuffer, buffer };
+    VkDeviceSize offsets[2] = { 0, 0 };
+    vkCmdBindVertexBuffers(cb, 0, 2, buffers, offsets);
+    vkCmdBindIndexBuffer(cb, indexBuffer, 0, indexType);
+    vkCmdDrawIndexed(cb, indexCount, instanceCount, 0, 0, 0);
+}
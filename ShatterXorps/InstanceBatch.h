@@ -0,0 +1,61 @@
+// InstanceBatch.h
+#ifndef INSTANCE_BATCH_H
+#define INSTANCE_BATCH_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Vertex.h"
+
+class PhysicalDevice;
+
+/*
+  Copies of one mesh drawn with a single instanced vkCmdDrawIndexed: the
+  per-instance model matrices + material indices (InstanceData) live in a
+  host-visible vertex buffer bound at binding=1 next to the mesh's vertex
+  stream at binding=0.
+  Use with GraphicsPipeline::getInstancedPipeline().
+
+  setInstances() writes through a persistent mapping, so moving props is a
+  memcpy and no re-record; only a changed instance count has to be recorded
+  again (it is baked into the draw). Writing while a frame that reads the
+  buffer is in flight is the caller's business (same as the per-image UBOs).
+
+    InstanceBatch props;
+    props.create(device, physDevice, 256);
+    props.setInstances(modelMatrices, materialIndices);
+    ...
+    vkCmdBindPipeline(cb, ..., graphicsPipeline.getInstancedPipeline());
+    props.draw(cb, cubeVB, cubeIB, VK_INDEX_TYPE_UINT16, cubeIndexCount);
+*/
+class InstanceBatch {
+public:
+    InstanceBatch() = default;
+    ~InstanceBatch() = default;
+
+    void create(VkDevice device, PhysicalDevice& physDevice, uint32_t maxInstances);
+    void destroy(VkDevice device);
+
+    // Up to maxInstances, the rest is dropped. Instances without an entry
+    // in materials get MaterialTable::DEFAULT_MATERIAL.
+    void setInstances(const std::vector<glm::mat4>& models,
+        const std::vector<uint32_t>& materials = {});
+    void setInstance(uint32_t index, const glm::mat4& model);
+    void setInstanceMaterial(uint32_t index, uint32_t material);
+
+    // Binds both vertex streams + the index buffer, one draw for every instance
+    void draw(VkCommandBuffer cb, VkBuffer vertexBuffer, VkBuffer indexBuffer,
+        VkIndexType indexType, uint32_t indexCount) const;
+
+    uint32_t getInstanceCount() const { return instanceCount; }
+    VkBuffer getBuffer() const { return buffer; }
+
+private:
+    VkBuffer       buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    InstanceData*  mapped = nullptr;
+    uint32_t       capacity = 0;
+    uint32_t       instanceCount = 0;
+};
+
+#endif // INSTANCE_BATCH_H
@@ -33,7 +33,8 @@ VkShaderModule LightRayPipeline::createShaderModule(VkDevice device, const std::
     return shaderModule;
 }
 
-void LightRayPipeline::create(VkDevice device, VkRenderPass renderPass, VkDescriptorSetLayout lightRayDescriptorSetLayout) {
+void LightRayPipeline::create(VkDevice device, VkRenderPass renderPass, VkDescriptorSetLayout lightRayDescriptorSetLayout,
+    const VkPipelineRenderingCreateInfoKHR* rendering) {
     // Load shader code (make sure to compile your GLSL files to SPIR-V as "light_ray.vert.spv" and "light_ray.frag.spv")
     auto vertCode = readFile("shaders/light_ray.vert.spv");
     auto fragCode = readFile("shaders/light_ray.frag.spv");
@@ -145,12 +146,18 @@ void LightRayPipeline::create(VkDevice device, VkRenderPass renderPass, VkDescri
     dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
     dynamicState.pDynamicStates = dynamicStates.data();
 
-    // Pipeline layout: use the descriptor set layout passed in (which should bind a UBO with MVP)
+    // Pipeline layout: the camera UBO set passed in + the model as a push constant
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(PushConstants);
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = 1;
     pipelineLayoutInfo.pSetLayouts = &lightRayDescriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushRange;
     if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create light ray pipeline layout!");
     }
@@ -169,6 +176,8 @@ void LightRayPipeline::create(VkDevice device, VkRenderPass renderPass, VkDescri
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = &dynamicState;
     pipelineInfo.layout = pipelineLayout;
+    // Dynamic rendering: no render pass, the attachment formats come in pNext
+    pipelineInfo.pNext = rendering;
     pipelineInfo.renderPass = renderPass;
     pipelineInfo.subpass = 0;
 
@@ -2,19 +2,28 @@
 #define LIGHT_RAY_PIPELINE_H
 
 #include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
 #include <vector>
 #include <string>
 
 // This pipeline will render the lightray (cylinder) geometry.
-// It expects a descriptor set layout (for a UBO with an MVP matrix)
+// It expects a descriptor set layout with the camera UBO at binding 0
+// (GraphicsPipeline's set=0), the model matrix is a push constant.
 class LightRayPipeline {
 public:
+    // Must match the push_constant block in light_ray.vert
+    struct PushConstants {
+        glm::mat4 model;
+    };
+
     LightRayPipeline() = default;
     ~LightRayPipeline() = default;
 
     // Create the pipeline given the device, the render pass (main pass),
-    // and a descriptor set layout (for binding a uniform buffer).
-    void create(VkDevice device, VkRenderPass renderPass, VkDescriptorSetLayout lightRayDescriptorSetLayout);
+    // and the camera UBO descriptor set layout.
+    // rendering: attachment formats when renderPass is VK_NULL_HANDLE (dynamic rendering)
+    void create(VkDevice device, VkRenderPass renderPass, VkDescriptorSetLayout lightRayDescriptorSetLayout,
+        const VkPipelineRenderingCreateInfoKHR* rendering = nullptr);
     void destroy(VkDevice device);
 
     VkPipeline getPipeline() const { return pipeline; }
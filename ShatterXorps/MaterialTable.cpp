@@ -0,0 +1,271 @@
+// MaterialTable.cpp
+#include "MaterialTable.h"
+#include "BindlessDescriptors.h"
+#include "PhysicalDevice.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+// Same channel order as the uint32 texels (0xAABBGGRR little endian);
+// UNORM so a texel scales the vertex color the way baseColor does
+static const VkFormat TEXTURE_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
+void MaterialTable::create(VkDevice device, PhysicalDevice& physDevice, BindlessDescriptors& bindless,
+    uint32_t maxMaterials)
+{
+    capacity = std::max(maxMaterials, 1u);
+
+    VkBufferCreateInfo bufInfo{};
+    bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufInfo.size = sizeof(Material) * (VkDeviceSize)capacity;
+    bufInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufInfo, nullptr, &buffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create material buffer!");
+    }
+
+    VkMemoryRequirements memReq;
+    vkGetBufferMemoryRequirements(device, buffer, &memReq);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReq.size;
+    allocInfo.memoryTypeIndex = physDevice.findMemoryType(memReq.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate material buffer memory!");
+    }
+    vkBindBufferMemory(device, buffer, memory, 0);
+
+    void* data = nullptr;
+    vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+    mapped = static_cast<Material*>(data);
+
+    // Every slot starts as the default, so a stray index still shades sanely
+    for (uint32_t i = 0; i < capacity; i++) {
+        mapped[i] = Material{};
+    }
+    materialCount = 1;
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.maxLod = 0.0f;
+    if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create material sampler!");
+    }
+
+    bindless.setMaterialBuffer(device, buffer);
+}
+
+void MaterialTable::destroy(VkDevice device, BindlessDescriptors& bindless)
+{
+    for (Texture& tex : textures) {
+        bindless.removeTexture(tex.slot);
+        vkDestroyImageView(device, tex.view, nullptr);
+        vkDestroyImage(device, tex.image, nullptr);
+        vkFreeMemory(device, tex.memory, nullptr);
+    }
+    textures.clear();
+
+    if (sampler != VK_NULL_HANDLE) {
+        vkDestroySampler(device, sampler, nullptr);
+        sampler = VK_NULL_HANDLE;
+    }
+    if (mapped) {
+        vkUnmapMemory(device, memory);
+        mapped = nullptr;
+    }
+    if (buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+    }
+    if (memory != VK_NULL_HANDLE) {
+        vkFreeMemory(device, memory, nullptr);
+        memory = VK_NULL_HANDLE;
+    }
+    capacity = 0;
+    materialCount = 0;
+}
+
+uint32_t MaterialTable::addMaterial(const Material& material)
+{
+    if (materialCount >= capacity) {
+        return DEFAULT_MATERIAL;
+    }
+    mapped[materialCount] = material;
+    return materialCount++;
+}
+
+void MaterialTable::setMaterial(uint32_t index, const Material& material)
+{
+    if (index < materialCount) {
+        mapped[index] = material;
+    }
+}
+
+uint32_t MaterialTable::addTexture(VkDevice device, PhysicalDevice& physDevice, BindlessDescriptors& bindless,
+    VkCommandPool commandPool, VkQueue queue,
+    uint32_t width, uint32_t height, const std::vector<uint32_t>& pixels)
+{
+    if (pixels.size() < (size_t)width * height) {
+        throw std::runtime_error("MaterialTable: not enough texels for the texture size!");
+    }
+    const VkDeviceSize byteSize = (VkDeviceSize)width * height * sizeof(uint32_t);
+
+    // 1) Staging buffer
+    VkBufferCreateInfo bufInfo{};
+    bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufInfo.size = byteSize;
+    bufInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VkBuffer staging;
+    if (vkCreateBuffer(device, &bufInfo, nullptr, &staging) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create texture staging buffer!");
+    }
+
+    VkMemoryRequirements bufReq;
+    vkGetBufferMemoryRequirements(device, staging, &bufReq);
+
+    VkMemoryAllocateInfo bufAlloc{};
+    bufAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    bufAlloc.allocationSize = bufReq.size;
+    bufAlloc.memoryTypeIndex = physDevice.findMemoryType(bufReq.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    VkDeviceMemory stagingMemory;
+    if (vkAllocateMemory(device, &bufAlloc, nullptr, &stagingMemory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate texture staging memory!");
+    }
+    vkBindBufferMemory(device, staging, stagingMemory, 0);
+
+    void* data = nullptr;
+    vkMapMemory(device, stagingMemory, 0, byteSize, 0, &data);
+    memcpy(data, pixels.data(), (size_t)byteSize);
+    vkUnmapMemory(device, stagingMemory);
+
+    // 2) Device-local image + view
+    Texture tex;
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = TEXTURE_FORMAT;
+    imageInfo.extent = { width, height, 1 };
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(device, &imageInfo, nullptr, &tex.image) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create material texture!");
+    }
+
+    VkMemoryRequirements imgReq;
+    vkGetImageMemoryRequirements(device, tex.image, &imgReq);
+
+    VkMemoryAllocateInfo imgAlloc{};
+    imgAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    imgAlloc.allocationSize = imgReq.size;
+    imgAlloc.memoryTypeIndex = physDevice.findMemoryType(imgReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device, &imgAlloc, nullptr, &tex.memory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate material texture memory!");
+    }
+    vkBindImageMemory(device, tex.image, tex.memory, 0);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = tex.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = TEXTURE_FORMAT;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    if (vkCreateImageView(device, &viewInfo, nullptr, &tex.view) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create material texture view!");
+    }
+
+    // 3) Copy, left in SHADER_READ_ONLY for the fragment shader
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = commandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer cb;
+    if (vkAllocateCommandBuffers(device, &allocInfo, &cb) != VK_SUCCESS) {
+        throw std::runtime_error("MaterialTable: failed to allocate command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cb, &beginInfo);
+
+    VkImageMemoryBarrier toTransfer{};
+    toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toTransfer.srcAccessMask = 0;
+    toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.image = tex.image;
+    toTransfer.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+    region.imageExtent = { width, height, 1 };
+    vkCmdCopyBufferToImage(cb, staging, tex.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    VkImageMemoryBarrier toShader = toTransfer;
+    toShader.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toShader.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    toShader.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toShader.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &toShader);
+
+    vkEndCommandBuffer(cb);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cb;
+    vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(queue);
+    vkFreeCommandBuffers(device, commandPool, 1, &cb);
+
+    vkDestroyBuffer(device, staging, nullptr);
+    vkFreeMemory(device, stagingMemory, nullptr);
+
+    // 4) Into the bindless array
+    tex.slot = bindless.addTexture(device, tex.view, sampler);
+    if (tex.slot == BindlessDescriptors::INVALID_SLOT) {
+        vkDestroyImageView(device, tex.view, nullptr);
+        vkDestroyImage(device, tex.image, nullptr);
+        vkFreeMemory(device, tex.memory, nullptr);
+        return NO_TEXTURE;
+    }
+    textures.push_back(tex);
+    return tex.slot;
+}
+
+std::vector<uint32_t> MaterialTable::makeChecker(uint32_t size, uint32_t cells, uint32_t colorA, uint32_t colorB)
+{
+    std::vector<uint32_t> pixels((size_t)size * size);
+    uint32_t cellSize = std::max(size / std::max(cells, 1u), 1u);
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            bool odd = ((x / cellSize) + (y / cellSize)) & 1u;
+            pixels[(size_t)y * size + x] = odd ? colorB : colorA;
+        }
+    }
+    return pixels;
+}
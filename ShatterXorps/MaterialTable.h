@@ -0,0 +1,86 @@
+// MaterialTable.h
+#ifndef MATERIAL_TABLE_H
+#define MATERIAL_TABLE_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+class PhysicalDevice;
+class BindlessDescriptors;
+
+/*
+  Every material in one host-visible SSBO, registered as buffer slot 0 of
+  BindlessDescriptors. A draw only pushes its material index
+  (GraphicsPipeline::PushConstants::materialIndex); shader.frag built with
+  USE_BINDLESS looks the material up and samples its albedo out of the
+  bindless texture array.
+
+  The table owns the textures it uploads (addTexture, one shared repeat
+  sampler). Material 0 is the default: white, untextured, i.e. the vertex
+  colors as they are.
+
+  setMaterial() writes through a persistent mapping, no re-record; writing
+  while a frame that reads it is in flight is the caller's business.
+
+    MaterialTable materials;
+    materials.create(device, physDevice, bindless);
+    uint32_t checker = materials.addTexture(device, physDevice, bindless, pool, queue,
+        64, 64, MaterialTable::makeChecker(64, 8, 0xFFFFFFFFu, 0xFF808080u));
+    uint32_t floor = materials.addMaterial({ glm::vec4(1.f), glm::uvec4(checker, 0, 0, 0), glm::vec4(0.5f) });
+*/
+class MaterialTable {
+public:
+    static const uint32_t DEFAULT_MATERIAL = 0;
+    static const uint32_t NO_TEXTURE = 0xFFFFFFFFu;
+
+    // Must match struct Material in shaders/material.glsl (std430)
+    struct Material {
+        glm::vec4  baseColor = glm::vec4(1.0f);          // multiplies the vertex color
+        glm::uvec4 textures = glm::uvec4(NO_TEXTURE);    // x: albedo (bindless texture slot)
+        glm::vec4  params = glm::vec4(1.0f);             // x: texture tiles per world unit
+    };
+
+    MaterialTable() = default;
+    ~MaterialTable() = default;
+
+    void create(VkDevice device, PhysicalDevice& physDevice, BindlessDescriptors& bindless,
+        uint32_t maxMaterials = 256);
+    // Frees the texture slots too
+    void destroy(VkDevice device, BindlessDescriptors& bindless);
+
+    // Index for PushConstants::materialIndex, DEFAULT_MATERIAL when full
+    uint32_t addMaterial(const Material& material);
+    void     setMaterial(uint32_t index, const Material& material);
+
+    // RGBA8 (0xAABBGGRR per texel) uploaded through a staging buffer, submits
+    // and waits on the queue: load time only. Returns the bindless slot.
+    uint32_t addTexture(VkDevice device, PhysicalDevice& physDevice, BindlessDescriptors& bindless,
+        VkCommandPool commandPool, VkQueue queue,
+        uint32_t width, uint32_t height, const std::vector<uint32_t>& pixels);
+
+    // size x size texels, cells x cells squares of colorA / colorB
+    static std::vector<uint32_t> makeChecker(uint32_t size, uint32_t cells, uint32_t colorA, uint32_t colorB);
+
+    uint32_t getMaterialCount() const { return materialCount; }
+    VkBuffer getBuffer() const { return buffer; }
+
+private:
+    struct Texture {
+        VkImage        image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView    view = VK_NULL_HANDLE;
+        uint32_t       slot = 0;
+    };
+
+    VkBuffer       buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    Material*      mapped = nullptr;
+    uint32_t       capacity = 0;
+    uint32_t       materialCount = 0;
+
+    VkSampler            sampler = VK_NULL_HANDLE;
+    std::vector<Texture> textures;
+};
+
+#endif // MATERIAL_TABLE_H
@@ -3,9 +3,15 @@
 #include <stdexcept>
 #include <set>
 #include <cstring>
+#include <algorithm>
 
-PhysicalDevice::PhysicalDevice(VkInstance instance, VkSurfaceKHR surface)
-    : surface(surface) {
+// major.minor only, so 1.2.x compares equal to VK_API_VERSION_1_2
+static uint32_t stripPatch(uint32_t version) {
+    return VK_MAKE_API_VERSION(0, VK_API_VERSION_MAJOR(version), VK_API_VERSION_MINOR(version), 0);
+}
+
+PhysicalDevice::PhysicalDevice(VkInstance instance, VkSurfaceKHR surface, uint32_t instanceApiVersion)
+    : instanceApiVersion(stripPatch(instanceApiVersion)), surface(surface) {
     pickPhysicalDevice(instance);
     createLogicalDevice();
 }
@@ -30,6 +36,7 @@ void PhysicalDevice::pickPhysicalDevice(VkInstance instance) {
         if (isDeviceSuitable(device)) {
             physicalDevice = device;
             vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+            apiVersion = std::min(instanceApiVersion, stripPatch(deviceProperties.apiVersion));
             break;
         }
     }
@@ -83,20 +90,124 @@ void PhysicalDevice::findQueueFamilies(VkPhysicalDevice device) {
     }
 }
 
-bool PhysicalDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) {
+std::set<std::string> PhysicalDevice::queryAvailableExtensions(VkPhysicalDevice device) const {
     uint32_t extensionCount;
     vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
 
     std::vector<VkExtensionProperties> availableExtensions(extensionCount);
     vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
-
+    std::set<std::string> names;
     for (const auto& extension : availableExtensions) {
-        requiredExtensions.erase(extension.extensionName);
+        names.insert(extension.extensionName);
+    }
+    return names;
+}
+
+bool PhysicalDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) {
+    std::set<std::string> available = queryAvailableExtensions(device);
+    for (const char* name : requiredExtensions) {
+        if (available.count(name) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PhysicalDevice::isExtensionEnabled(const char* name) const {
+    for (const char* enabled : enabledExtensions) {
+        if (strcmp(enabled, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PhysicalDevice::selectOptionalCapabilities(const std::set<std::string>& available) {
+    // Feature structs / vkGetPhysicalDeviceFeatures2 need a 1.2 device here
+    if (apiVersion < VK_API_VERSION_1_2) {
+        return;
+    }
+
+    bool hasRayQueryExtensions = true;
+    for (const char* name : rayQueryExtensions) {
+        hasRayQueryExtensions = hasRayQueryExtensions && available.count(name) != 0;
+    }
+    const bool hasDynamicRenderingExtension = available.count(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) != 0;
+
+    // 1) Query what the device supports through one pNext chain. An
+    //    extension's feature struct is only chained when the device has the
+    //    extension (the 1.2 struct is core, the version check is above).
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceAccelerationStructureFeaturesKHR accelFeatures{};
+    accelFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
+
+    VkPhysicalDeviceRayQueryFeaturesKHR rayQueryFeatures{};
+    rayQueryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_QUERY_FEATURES_KHR;
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &vulkan12Features;
+    void** next = &vulkan12Features.pNext;
+    if (hasRayQueryExtensions) {
+        *next = &accelFeatures;
+        accelFeatures.pNext = &rayQueryFeatures;
+        next = &rayQueryFeatures.pNext;
+    }
+    if (hasDynamicRenderingExtension) {
+        *next = &dynamicRenderingFeatures;
+    }
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+    // 2) Ray queries: every extension + feature, or nothing
+    if (hasRayQueryExtensions &&
+        vulkan12Features.bufferDeviceAddress &&
+        accelFeatures.accelerationStructure &&
+        rayQueryFeatures.rayQuery) {
+        enabledExtensions.insert(enabledExtensions.end(), rayQueryExtensions.begin(), rayQueryExtensions.end());
+        enabledVulkan12Features.bufferDeviceAddress = VK_TRUE;
+        enabledAccelerationStructureFeatures.accelerationStructure = VK_TRUE;
+        enabledRayQueryFeatures.rayQuery = VK_TRUE;
+        rayQuerySupported = true;
+    }
+
+    // 3) GPU-driven draws with a GPU-written draw count
+    if (vulkan12Features.drawIndirectCount) {
+        enabledVulkan12Features.drawIndirectCount = VK_TRUE;
+        drawIndirectCountSupported = true;
     }
 
-    return requiredExtensions.empty();
+    // 4) Bindless: everything BindlessDescriptors relies on, or nothing
+    if (vulkan12Features.descriptorIndexing &&
+        vulkan12Features.runtimeDescriptorArray &&
+        vulkan12Features.descriptorBindingPartiallyBound &&
+        vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+        vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+        vulkan12Features.shaderSampledImageArrayNonUniformIndexing &&
+        vulkan12Features.shaderStorageBufferArrayNonUniformIndexing) {
+        enabledVulkan12Features.descriptorIndexing = VK_TRUE;
+        enabledVulkan12Features.runtimeDescriptorArray = VK_TRUE;
+        enabledVulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+        enabledVulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        enabledVulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        enabledVulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        enabledVulkan12Features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+        descriptorIndexingSupported = true;
+    }
+
+    // 5) Dynamic rendering (its depth_stencil_resolve / renderpass2
+    //    dependencies are core in 1.2)
+    if (hasDynamicRenderingExtension &&
+        dynamicRenderingFeatures.dynamicRendering) {
+        enabledExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        enabledDynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+        dynamicRenderingSupported = true;
+    }
 }
 
 void PhysicalDevice::createLogicalDevice() {
@@ -113,15 +224,58 @@ void PhysicalDevice::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures{};
+    // Only turn on optional features the device actually reports
+    VkPhysicalDeviceFeatures supportedFeatures{};
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+    // Needed for r11f_g11f_b10f storage images (PixelTracer packed output)
+    enabledFeatures.shaderStorageImageExtendedFormats = supportedFeatures.shaderStorageImageExtendedFormats;
+
+    // GpuScene: many indirect draws per call, object index in firstInstance
+    enabledFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+    enabledFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+
+    // Required extensions first, then whatever optional capability is usable
+    enabledExtensions = requiredExtensions;
+    enabledVulkan12Features = {};
+    enabledVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    enabledAccelerationStructureFeatures = {};
+    enabledAccelerationStructureFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
+    enabledRayQueryFeatures = {};
+    enabledRayQueryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_QUERY_FEATURES_KHR;
+    enabledDynamicRenderingFeatures = {};
+    enabledDynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    selectOptionalCapabilities(queryAvailableExtensions(physicalDevice));
 
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
-    createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
+
+    // 1.2 devices: features go through VkPhysicalDeviceFeatures2 so the
+    // extension feature structs can ride along in pNext
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    if (apiVersion >= VK_API_VERSION_1_2) {
+        features2.features = enabledFeatures;
+        features2.pNext = &enabledVulkan12Features;
+        void** next = &enabledVulkan12Features.pNext;
+        if (rayQuerySupported) {
+            *next = &enabledAccelerationStructureFeatures;
+            enabledAccelerationStructureFeatures.pNext = &enabledRayQueryFeatures;
+            next = &enabledRayQueryFeatures.pNext;
+        }
+        if (dynamicRenderingSupported) {
+            *next = &enabledDynamicRenderingFeatures;
+        }
+        createInfo.pNext = &features2;
+        createInfo.pEnabledFeatures = nullptr;
+    }
+    else {
+        createInfo.pEnabledFeatures = &enabledFeatures;
+    }
 
     if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &logicalDevice) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create logical device!");
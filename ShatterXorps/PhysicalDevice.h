@@ -5,16 +5,52 @@
 #include <vulkan/vulkan.h>
 #include "SwapChainSupportDetails.h"
 #include <vector>
+#include <set>
+#include <string>
 
+/*
+  Picks the GPU and creates the logical device.
+
+  Extensions are chosen from what the device reports: requiredExtensions must
+  all be there for a device to be picked, optional capabilities (e.g. ray
+  queries) are only turned on when every extension AND feature they need is
+  supported. Callers check supportsRayQuery() / isExtensionEnabled() and take
+  their fallback path otherwise.
+*/
 class PhysicalDevice {
 public:
-    PhysicalDevice(VkInstance instance, VkSurfaceKHR surface);
+    // instanceApiVersion: what the VkInstance was created with (VulkanInstance::getApiVersion)
+    PhysicalDevice(VkInstance instance, VkSurfaceKHR surface, uint32_t instanceApiVersion = VK_API_VERSION_1_0);
     ~PhysicalDevice();
 
     VkDevice getDevice() const { return logicalDevice; }
     VkPhysicalDevice getPhysicalDevice() const { return physicalDevice; }
     VkPhysicalDeviceProperties getProperties() const { return deviceProperties; }
 
+    // Core features that were actually turned on in createLogicalDevice()
+    const VkPhysicalDeviceFeatures& getEnabledFeatures() const { return enabledFeatures; }
+
+    // Usable API version: min(instance, device), major.minor only
+    uint32_t getApiVersion() const { return apiVersion; }
+
+    const std::vector<const char*>& getEnabledExtensions() const { return enabledExtensions; }
+    bool isExtensionEnabled(const char* name) const;
+
+    // VK_KHR_ray_query + VK_KHR_acceleration_structure + bufferDeviceAddress are on
+    bool supportsRayQuery() const { return rayQuerySupported; }
+
+    // VK_KHR_dynamic_rendering is on: vkCmdBeginRenderingKHR instead of
+    // VkRenderPass / VkFramebuffer objects (RenderPass dynamic mode)
+    bool supportsDynamicRendering() const { return dynamicRenderingSupported; }
+
+    // Core 1.2 drawIndirectCount is on (vkCmdDrawIndexedIndirectCount)
+    bool supportsDrawIndirectCount() const { return drawIndirectCountSupported; }
+
+    // Core 1.2 descriptor indexing (VK_EXT_descriptor_indexing) is on:
+    // runtime-sized, partially bound, update-after-bind arrays of sampled
+    // images / storage buffers, non-uniformly indexed (BindlessDescriptors)
+    bool supportsDescriptorIndexing() const { return descriptorIndexingSupported; }
+
     uint32_t getGraphicsQueueFamilyIndex() const { return graphicsQueueFamilyIndex; }
     uint32_t getPresentQueueFamilyIndex() const { return presentQueueFamilyIndex; }
 
@@ -29,6 +65,20 @@ private:
     VkDevice logicalDevice;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
     VkPhysicalDeviceProperties deviceProperties{};
+    VkPhysicalDeviceFeatures enabledFeatures{};
+
+    // Feature structs chained into VkDeviceCreateInfo (1.2+ devices only)
+    VkPhysicalDeviceVulkan12Features                 enabledVulkan12Features{};
+    VkPhysicalDeviceAccelerationStructureFeaturesKHR enabledAccelerationStructureFeatures{};
+    VkPhysicalDeviceRayQueryFeaturesKHR              enabledRayQueryFeatures{};
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR      enabledDynamicRenderingFeatures{};
+
+    uint32_t instanceApiVersion = VK_API_VERSION_1_0;
+    uint32_t apiVersion = VK_API_VERSION_1_0;
+    bool     rayQuerySupported = false;
+    bool     dynamicRenderingSupported = false;
+    bool     drawIndirectCountSupported = false;
+    bool     descriptorIndexingSupported = false;
 
     uint32_t graphicsQueueFamilyIndex = UINT32_MAX;
     uint32_t presentQueueFamilyIndex = UINT32_MAX;
@@ -40,8 +90,20 @@ private:
     bool isDeviceSuitable(VkPhysicalDevice device);
     void findQueueFamilies(VkPhysicalDevice device);
     bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+    std::set<std::string> queryAvailableExtensions(VkPhysicalDevice device) const;
+    // Adds optional extensions + feature structs the picked device can do
+    void selectOptionalCapabilities(const std::set<std::string>& available);
 
-    const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    // A device without these is skipped
+    const std::vector<const char*> requiredExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    // Optional: all or nothing, see selectOptionalCapabilities()
+    const std::vector<const char*> rayQueryExtensions = {
+        VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME,
+        VK_KHR_RAY_QUERY_EXTENSION_NAME,
+        VK_KHR_DEFERRED_HOST_OPERATIONS_EXTENSION_NAME
+    };
+    // required + whatever optional ones were turned on
+    std::vector<const char*> enabledExtensions;
 };
 
 #endif // PHYSICAL_DEVICE_H
@@ -4,6 +4,8 @@
 #include <vector>
 #include <fstream>
 #include <cstring>   // for memcpy
+#include <cstddef>   // for offsetof
+#include <algorithm>
 
 static std::vector<char> readFile(const char* filename)
 {
@@ -30,6 +32,14 @@ struct CameraDataGPU {
     float _pad1[2];
 };
 
+// Specialization data, constant_id 0..3 in raytrace.comp
+struct SpecializationData {
+    uint32_t groupSizeX;
+    uint32_t groupSizeY;
+    VkBool32 enableShadows;
+    int32_t  maxBounces;
+};
+
 // A small struct for scene data in compute
 struct SceneDataGPU {
     // Must match layout in raytrace.comp
@@ -49,12 +59,15 @@ PixelTracer::PixelTracer()
     outputImage(VK_NULL_HANDLE),
     outputMemory(VK_NULL_HANDLE),
     outputImageView(VK_NULL_HANDLE),
+    outputFormat(VK_FORMAT_UNDEFINED),
+    sceneTLAS(VK_NULL_HANDLE),
     cameraBuffer(VK_NULL_HANDLE),
     cameraBufferMemory(VK_NULL_HANDLE),
     sceneBuffer(VK_NULL_HANDLE),
     sceneBufferMemory(VK_NULL_HANDLE),
     width(0),
-    height(0)
+    height(0),
+    traceExtent{ 0, 0 }
 {
 }
 
@@ -63,10 +76,71 @@ PixelTracer::~PixelTracer()
     // Normally call destroy() explicitly before destructor if needed
 }
 
-void PixelTracer::create(VkDevice device, PhysicalDevice& physDevice, uint32_t w, uint32_t h)
+const char* PixelTracer::shaderPathForFormat(VkFormat format, bool rayQuery)
+{
+    switch (format) {
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+        return rayQuery ? "shaders/raytrace_rq.comp.spv" : "shaders/raytrace.comp.spv";
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+        return rayQuery ? "shaders/raytrace_rgba16f_rq.comp.spv" : "shaders/raytrace_rgba16f.comp.spv";
+    case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        return rayQuery ? "shaders/raytrace_r11g11b10f_rq.comp.spv" : "shaders/raytrace_r11g11b10f.comp.spv";
+    case VK_FORMAT_R8G8B8A8_UNORM:
+        return rayQuery ? "shaders/raytrace_rgba8_rq.comp.spv" : "shaders/raytrace_rgba8.comp.spv";
+    default:
+        throw std::runtime_error("PixelTracer: unsupported output format!");
+    }
+}
+
+const char* PixelTracer::formatName(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_R32G32B32A32_SFLOAT:    return "RGBA32F";
+    case VK_FORMAT_R16G16B16A16_SFLOAT:    return "RGBA16F";
+    case VK_FORMAT_B10G11R11_UFLOAT_PACK32: return "R11G11B10F";
+    case VK_FORMAT_R8G8B8A8_UNORM:         return "RGBA8";
+    default:                               return "unknown";
+    }
+}
+
+VkFormat PixelTracer::chooseOutputFormat(const PhysicalDevice& physDevice, VkFormat requested)
 {
+    const VkFormatFeatureFlags needed =
+        VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+
+    auto usable = [&](VkFormat format) {
+        // r11f_g11f_b10f is an "extended" storage format, the feature must be on
+        if (format == VK_FORMAT_B10G11R11_UFLOAT_PACK32 &&
+            !physDevice.getEnabledFeatures().shaderStorageImageExtendedFormats) {
+            return false;
+        }
+        VkFormatProperties props;
+        vkGetPhysicalDeviceFormatProperties(physDevice.getPhysicalDevice(), format, &props);
+        return (props.optimalTilingFeatures & needed) == needed;
+    };
+
+    const VkFormat candidates[] = {
+        requested,
+        VK_FORMAT_R16G16B16A16_SFLOAT,
+        VK_FORMAT_R32G32B32A32_SFLOAT
+    };
+    for (VkFormat format : candidates) {
+        if (usable(format)) {
+            return format;
+        }
+    }
+    throw std::runtime_error("PixelTracer: no usable storage image format!");
+}
+
+void PixelTracer::create(VkDevice device, PhysicalDevice& physDevice, uint32_t w, uint32_t h,
+    VkFormat requestedFormat, const PipelineConfig& pipelineConfig, VkAccelerationStructureKHR tlas)
+{
+    config = pipelineConfig;
+    sceneTLAS = tlas;
     width = w;
     height = h;
+    traceExtent = { w, h };
+    outputFormat = chooseOutputFormat(physDevice, requestedFormat);
 
     //------------------------------------------------------
     // 0) Create minimal UBOs for camera & scene
@@ -164,7 +238,7 @@ void PixelTracer::create(VkDevice device, PhysicalDevice& physDevice, uint32_t w
         VkImageCreateInfo imageInfo{};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         imageInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageInfo.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        imageInfo.format = outputFormat;
         imageInfo.extent = { width, height, 1 };
         imageInfo.mipLevels = 1;
         imageInfo.arrayLayers = 1;
@@ -197,7 +271,7 @@ void PixelTracer::create(VkDevice device, PhysicalDevice& physDevice, uint32_t w
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewInfo.image = outputImage;
         viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewInfo.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        viewInfo.format = outputFormat;
         viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         viewInfo.subresourceRange.baseMipLevel = 0;
         viewInfo.subresourceRange.levelCount = 1;
@@ -210,7 +284,8 @@ void PixelTracer::create(VkDevice device, PhysicalDevice& physDevice, uint32_t w
     }
 
     //------------------------------------------------------
-    // 2) Descriptor set layout: (0) camera UBO, (1) scene UBO, (2) storage image
+    // 2) Descriptor set layout: (0) camera UBO, (1) scene UBO, (2) storage image,
+    //    (3) scene TLAS when ray queries are used
     //------------------------------------------------------
     {
         VkDescriptorSetLayoutBinding bindingCamera{};
@@ -235,6 +310,15 @@ void PixelTracer::create(VkDevice device, PhysicalDevice& physDevice, uint32_t w
             bindingCamera, bindingScene, bindingImage
         };
 
+        if (sceneTLAS != VK_NULL_HANDLE) {
+            VkDescriptorSetLayoutBinding bindingTLAS{};
+            bindingTLAS.binding = 3;
+            bindingTLAS.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+            bindingTLAS.descriptorCount = 1;
+            bindingTLAS.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            bindings.push_back(bindingTLAS);
+        }
+
         VkDescriptorSetLayoutCreateInfo layoutInfo{};
         layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         layoutInfo.bindingCount = (uint32_t)bindings.size();
@@ -260,10 +344,10 @@ void PixelTracer::create(VkDevice device, PhysicalDevice& physDevice, uint32_t w
     }
 
     //------------------------------------------------------
-    // 4) Load the compute shader ("raytrace.comp.spv")
+    // 4) Load the compute shader variant matching outputFormat
     //------------------------------------------------------
     {
-        auto spirv = readFile("shaders/raytrace.comp.spv");
+        auto spirv = readFile(shaderPathForFormat(outputFormat, sceneTLAS != VK_NULL_HANDLE));
         VkShaderModuleCreateInfo moduleCreateInfo{};
         moduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
         moduleCreateInfo.codeSize = spirv.size();
@@ -275,34 +359,22 @@ void PixelTracer::create(VkDevice device, PhysicalDevice& physDevice, uint32_t w
     }
 
     //------------------------------------------------------
-    // 5) Create the compute pipeline
+    // 5) Create the compute pipeline (constants from config)
     //------------------------------------------------------
-    {
-        VkPipelineShaderStageCreateInfo stageInfo{};
-        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-        stageInfo.module = shaderModule;
-        stageInfo.pName = "main";
-
-        VkComputePipelineCreateInfo pipeInfo{};
-        pipeInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-        pipeInfo.stage = stageInfo;
-        pipeInfo.layout = pipelineLayout;
-
-        if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &pipeline) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create PixelTracer compute pipeline!");
-        }
-    }
+    pipeline = buildPipeline(device, config);
 
     //------------------------------------------------------
     // 6) Descriptor pool + single set
     //------------------------------------------------------
     {
-        // We need 2 UBO descriptors + 1 storage image
+        // We need 2 UBO descriptors + 1 storage image (+ 1 TLAS)
         std::vector<VkDescriptorPoolSize> poolSizes = {
             { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 },
             { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,  1 }
         };
+        if (sceneTLAS != VK_NULL_HANDLE) {
+            poolSizes.push_back({ VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1 });
+        }
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -367,10 +439,273 @@ void PixelTracer::create(VkDevice device, PhysicalDevice& physDevice, uint32_t w
         writeImg.pImageInfo = &imageInfo;
 
         std::vector<VkWriteDescriptorSet> writes = { writeCam, writeScene, writeImg };
+
+        // (D) Scene TLAS => binding=3 (its handle goes through a pNext struct)
+        VkWriteDescriptorSetAccelerationStructureKHR tlasInfo{};
+        tlasInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+        tlasInfo.accelerationStructureCount = 1;
+        tlasInfo.pAccelerationStructures = &sceneTLAS;
+        if (sceneTLAS != VK_NULL_HANDLE) {
+            VkWriteDescriptorSet writeTLAS{};
+            writeTLAS.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeTLAS.pNext = &tlasInfo;
+            writeTLAS.dstSet = descriptorSet;
+            writeTLAS.dstBinding = 3;
+            writeTLAS.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+            writeTLAS.descriptorCount = 1;
+            writes.push_back(writeTLAS);
+        }
         vkUpdateDescriptorSets(device, (uint32_t)writes.size(), writes.data(), 0, nullptr);
     }
 }
 
+VkPipeline PixelTracer::buildPipeline(VkDevice device, const PipelineConfig& cfg) const
+{
+    SpecializationData data{};
+    data.groupSizeX = cfg.groupSizeX;
+    data.groupSizeY = cfg.groupSizeY;
+    data.enableShadows = cfg.enableShadows ? VK_TRUE : VK_FALSE;
+    data.maxBounces = (int32_t)cfg.maxBounces;
+
+    const VkSpecializationMapEntry entries[] = {
+        { 0, offsetof(SpecializationData, groupSizeX),    sizeof(uint32_t) },
+        { 1, offsetof(SpecializationData, groupSizeY),    sizeof(uint32_t) },
+        { 2, offsetof(SpecializationData, enableShadows), sizeof(VkBool32) },
+        { 3, offsetof(SpecializationData, maxBounces),    sizeof(int32_t) }
+    };
+
+    VkSpecializationInfo specInfo{};
+    specInfo.mapEntryCount = 4;
+    specInfo.pMapEntries = entries;
+    specInfo.dataSize = sizeof(data);
+    specInfo.pData = &data;
+
+    VkPipelineShaderStageCreateInfo stageInfo{};
+    stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    stageInfo.module = shaderModule;
+    stageInfo.pName = "main";
+    stageInfo.pSpecializationInfo = &specInfo;
+
+    VkComputePipelineCreateInfo pipeInfo{};
+    pipeInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeInfo.stage = stageInfo;
+    pipeInfo.layout = pipelineLayout;
+
+    VkPipeline result = VK_NULL_HANDLE;
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &result) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create PixelTracer compute pipeline!");
+    }
+    return result;
+}
+
+void PixelTracer::setPipelineConfig(VkDevice device, const PipelineConfig& newConfig)
+{
+    VkPipeline newPipeline = buildPipeline(device, newConfig);
+    if (pipeline) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+    }
+    pipeline = newPipeline;
+    config = newConfig;
+}
+
+void PixelTracer::recordDispatch(VkCommandBuffer cb) const
+{
+    recordDispatch(cb, pipeline, config);
+}
+
+void PixelTracer::recordDispatch(VkCommandBuffer cb, VkPipeline pipe, const PipelineConfig& cfg) const
+{
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipe);
+    vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+        0, 1, &descriptorSet, 0, nullptr);
+    vkCmdDispatch(cb,
+        (traceExtent.width + cfg.groupSizeX - 1) / cfg.groupSizeX,
+        (traceExtent.height + cfg.groupSizeY - 1) / cfg.groupSizeY,
+        1);
+}
+
+bool PixelTracer::autoTuneWorkgroupSize(VkDevice device, const PhysicalDevice& physDevice,
+    VkQueue queue, VkCommandPool commandPool)
+{
+    //------------------------------------------------------
+    // 0) Timestamps must work on this queue family
+    //------------------------------------------------------
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physDevice.getPhysicalDevice(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physDevice.getPhysicalDevice(), &familyCount, families.data());
+
+    uint32_t family = physDevice.getGraphicsQueueFamilyIndex();
+    VkPhysicalDeviceProperties props = physDevice.getProperties();
+    if (family >= familyCount || families[family].timestampValidBits == 0 ||
+        props.limits.timestampPeriod <= 0.0f) {
+        return false;
+    }
+
+    //------------------------------------------------------
+    // 1) Candidate shapes within the device limits.
+    //    Wide rows suit GPUs with large SIMD widths,
+    //    squarer tiles keep neighbouring rays coherent.
+    //------------------------------------------------------
+    const uint32_t shapes[][2] = {
+        { 8, 8 }, { 16, 8 }, { 8, 16 }, { 16, 16 }, { 32, 8 }, { 32, 4 }, { 64, 1 }, { 32, 32 }, { 4, 4 }
+    };
+    std::vector<PipelineConfig> candidates;
+    for (const auto& shape : shapes) {
+        if (shape[0] > props.limits.maxComputeWorkGroupSize[0] ||
+            shape[1] > props.limits.maxComputeWorkGroupSize[1] ||
+            shape[0] * shape[1] > props.limits.maxComputeWorkGroupInvocations) {
+            continue;
+        }
+        PipelineConfig cfg = config;
+        cfg.groupSizeX = shape[0];
+        cfg.groupSizeY = shape[1];
+        candidates.push_back(cfg);
+    }
+    if (candidates.empty()) {
+        return false;
+    }
+
+    std::vector<VkPipeline> pipelines;
+    for (const auto& cfg : candidates) {
+        pipelines.push_back(buildPipeline(device, cfg));
+    }
+
+    //------------------------------------------------------
+    // 2) One command buffer: per candidate a warm-up dispatch,
+    //    then REPEAT timed dispatches between two timestamps
+    //------------------------------------------------------
+    const uint32_t REPEAT = 3;
+    uint32_t queryCount = (uint32_t)candidates.size() * 2;
+
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    VkQueryPoolCreateInfo qpInfo{};
+    qpInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    qpInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    qpInfo.queryCount = queryCount;
+    if (vkCreateQueryPool(device, &qpInfo, nullptr, &queryPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create PixelTracer tuning query pool!");
+    }
+
+    VkCommandBufferAllocateInfo cbAlloc{};
+    cbAlloc.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cbAlloc.commandPool = commandPool;
+    cbAlloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cbAlloc.commandBufferCount = 1;
+    VkCommandBuffer cb = VK_NULL_HANDLE;
+    if (vkAllocateCommandBuffers(device, &cbAlloc, &cb) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate PixelTracer tuning command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cb, &beginInfo);
+    vkCmdResetQueryPool(cb, queryPool, 0, queryCount);
+
+    VkImageMemoryBarrier imageBarrier{};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = outputImage;
+    imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    imageBarrier.srcAccessMask = 0;
+    imageBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    // Dispatches write the same image, serialize them so each one is timed alone
+    VkMemoryBarrier serialize{};
+    serialize.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    serialize.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    serialize.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        recordDispatch(cb, pipelines[i], candidates[i]);
+        vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            0, 1, &serialize, 0, nullptr, 0, nullptr);
+
+        vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, queryPool, (uint32_t)i * 2);
+        for (uint32_t r = 0; r < REPEAT; r++) {
+            recordDispatch(cb, pipelines[i], candidates[i]);
+            vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0, 1, &serialize, 0, nullptr, 0, nullptr);
+        }
+        vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, queryPool, (uint32_t)i * 2 + 1);
+    }
+    vkEndCommandBuffer(cb);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &cb;
+    if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to submit PixelTracer tuning pass!");
+    }
+    vkQueueWaitIdle(queue);
+
+    //------------------------------------------------------
+    // 3) Keep the fastest, drop the rest
+    //------------------------------------------------------
+    // Only the low timestampValidBits are meaningful, the counter wraps there
+    const uint32_t validBits = families[family].timestampValidBits;
+    const uint64_t tickMask = (validBits >= 64) ? ~0ull : ((1ull << validBits) - 1);
+
+    std::vector<uint64_t> ticks(queryCount);
+    VkResult res = vkGetQueryPoolResults(device, queryPool, 0, queryCount,
+        ticks.size() * sizeof(uint64_t), ticks.data(), sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+    vkFreeCommandBuffers(device, commandPool, 1, &cb);
+    vkDestroyQueryPool(device, queryPool, nullptr);
+
+    size_t best = candidates.size();
+    uint64_t bestTicks = UINT64_MAX;
+    if (res == VK_SUCCESS) {
+        for (size_t i = 0; i < candidates.size(); i++) {
+            uint64_t elapsed = ((ticks[i * 2 + 1] & tickMask) - (ticks[i * 2] & tickMask)) & tickMask;
+            if (elapsed > 0 && elapsed < bestTicks) {
+                bestTicks = elapsed;
+                best = i;
+            }
+        }
+    }
+    for (size_t i = 0; i < pipelines.size(); i++) {
+        if (i != best) {
+            vkDestroyPipeline(device, pipelines[i], nullptr);
+        }
+    }
+    if (best == candidates.size()) {
+        return false;
+    }
+
+    vkDestroyPipeline(device, pipeline, nullptr);
+    pipeline = pipelines[best];
+    config = candidates[best];
+    return true;
+}
+
+void PixelTracer::setTraceExtent(VkDevice device, uint32_t w, uint32_t h)
+{
+    // Never trace outside the allocated image
+    w = std::max(1u, std::min(w, width));
+    h = std::max(1u, std::min(h, height));
+    if (w == traceExtent.width && h == traceExtent.height) {
+        return;
+    }
+    traceExtent = { w, h };
+
+    // Only screenSize changes, so just patch those 8 bytes
+    float screenSize[2] = { (float)w, (float)h };
+    void* dataPtr = nullptr;
+    vkMapMemory(device, cameraBufferMemory, offsetof(CameraDataGPU, screenSize), sizeof(screenSize), 0, &dataPtr);
+    std::memcpy(dataPtr, screenSize, sizeof(screenSize));
+    vkUnmapMemory(device, cameraBufferMemory);
+}
+
 void PixelTracer::destroy(VkDevice device)
 {
     // Destroy pipeline
@@ -430,4 +765,6 @@ void PixelTracer::destroy(VkDevice device)
         vkFreeMemory(device, outputMemory, nullptr);
         outputMemory = VK_NULL_HANDLE;
     }
+    // The TLAS belongs to the caller
+    sceneTLAS = VK_NULL_HANDLE;
 }
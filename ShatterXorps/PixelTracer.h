@@ -9,19 +9,72 @@ class PhysicalDevice;
   PixelTracer encapsulates a compute pipeline that writes ray-traced output
   into a storage image (outputImage). Now also includes minimal uniform buffers
   for the "camera" and "scene" so we can match the shader's set=0, binding=0..2.
+
+  The output format is selectable. Each supported format has its own compiled
+  variant of raytrace.comp (the storage image format qualifier must match):
+    VK_FORMAT_R32G32B32A32_SFLOAT    -> raytrace.comp.spv          (16 bytes/pixel)
+    VK_FORMAT_R16G16B16A16_SFLOAT    -> raytrace_rgba16f.comp.spv  ( 8 bytes/pixel)
+    VK_FORMAT_B10G11R11_UFLOAT_PACK32 -> raytrace_r11g11b10f.comp.spv (4 bytes/pixel, no alpha)
+    VK_FORMAT_R8G8B8A8_UNORM         -> raytrace_rgba8.comp.spv    ( 4 bytes/pixel, LDR)
+  If the device can't use the requested format as a storage image we fall back
+  to RGBA16F, then RGBA32F.
+
+  Passing a TLAS to create() picks the *_rq variants (-DUSE_RAY_QUERY): shadow
+  rays then also hit the scene geometry through VK_KHR_ray_query (binding=3).
+  Without one only the analytic box test is used.
+
+  Workgroup size, shadow rays and bounce count are specialization constants
+  (PipelineConfig), so changing them only rebuilds the pipeline from the same
+  module. autoTuneWorkgroupSize() times the workgroup shapes the device allows
+  and keeps the fastest.
 */
 class PixelTracer
 {
 public:
+    // Specialization constants of raytrace.comp (constant_id 0..3)
+    struct PipelineConfig {
+        uint32_t groupSizeX;
+        uint32_t groupSizeY;
+        bool     enableShadows;
+        uint32_t maxBounces;
+
+        PipelineConfig() : groupSizeX(8), groupSizeY(8), enableShadows(true), maxBounces(0) {}
+    };
+
     PixelTracer();
     ~PixelTracer();
 
     // Create all resources for the compute pass
-    void create(VkDevice device, PhysicalDevice& physDevice, uint32_t width, uint32_t height);
+    void create(VkDevice device, PhysicalDevice& physDevice, uint32_t width, uint32_t height,
+        VkFormat requestedFormat = VK_FORMAT_R16G16B16A16_SFLOAT,
+        const PipelineConfig& config = PipelineConfig(),
+        VkAccelerationStructureKHR sceneTLAS = VK_NULL_HANDLE);
 
     // Destroy the compute resources
     void destroy(VkDevice device);
 
+    // Dynamic resolution: the output image is allocated at the maximum size
+    // given to create(), each frame only the top-left (w x h) region is traced.
+    // Updates camera.screenSize in the camera UBO (host-coherent, call between frames).
+    void setTraceExtent(VkDevice device, uint32_t w, uint32_t h);
+    VkExtent2D getTraceExtent() const { return traceExtent; }
+    VkExtent2D getMaxExtent() const { return { width, height }; }
+
+    // Rebuild the pipeline with other constants. The old pipeline must not be in use.
+    void setPipelineConfig(VkDevice device, const PipelineConfig& newConfig);
+    const PipelineConfig& getPipelineConfig() const { return config; }
+
+    // Bind the pipeline + set and dispatch enough workgroups to cover the
+    // trace extent. The output image must already be in GENERAL layout.
+    void recordDispatch(VkCommandBuffer cb) const;
+
+    // Startup tuner: times every candidate workgroup shape that fits the device
+    // limits (a few dispatches each, GPU timestamps) and keeps the fastest.
+    // Submits to queue and waits for it. Returns false and keeps the current
+    // config if the queue can't do timestamps.
+    bool autoTuneWorkgroupSize(VkDevice device, const PhysicalDevice& physDevice,
+        VkQueue queue, VkCommandPool commandPool);
+
     // Accessors
     VkPipeline       getPipeline() const { return pipeline; }
     VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
@@ -29,12 +82,28 @@ public:
 
     VkImage     getOutputImage() const { return outputImage; }
     VkImageView getOutputImageView() const { return outputImageView; }
+    VkFormat    getOutputFormat() const { return outputFormat; }
+    bool        usesRayQuery() const { return sceneTLAS != VK_NULL_HANDLE; }
+
+    // Picks the requested format if the device supports it for storage + sampling,
+    // otherwise the closest fallback
+    static VkFormat chooseOutputFormat(const PhysicalDevice& physDevice, VkFormat requested);
+    // Readable name of one of the output formats, for logs
+    static const char* formatName(VkFormat format);
 
 private:
+    // Compiled SPIR-V variant of raytrace.comp for a given output format
+    static const char* shaderPathForFormat(VkFormat format, bool rayQuery);
+
+    // Compute pipeline from shaderModule + pipelineLayout with cfg as specialization
+    VkPipeline buildPipeline(VkDevice device, const PipelineConfig& cfg) const;
+    void recordDispatch(VkCommandBuffer cb, VkPipeline pipe, const PipelineConfig& cfg) const;
+
     // The compute pipeline
     VkPipeline       pipeline;
     VkPipelineLayout pipelineLayout;
     VkShaderModule   shaderModule;
+    PipelineConfig   config;
 
     // Descriptor layout/pool/set
     VkDescriptorSetLayout descriptorSetLayout;
@@ -45,6 +114,10 @@ private:
     VkImage        outputImage;
     VkDeviceMemory outputMemory;
     VkImageView    outputImageView;
+    VkFormat       outputFormat;
+
+    // Scene TLAS for ray-query shadows (not owned), VK_NULL_HANDLE = off
+    VkAccelerationStructureKHR sceneTLAS;
 
     // Minimal uniform buffers for "camera" and "scene"
     VkBuffer       cameraBuffer;
@@ -54,4 +127,5 @@ private:
 
     uint32_t width;
     uint32_t height;
+    VkExtent2D traceExtent;
 };
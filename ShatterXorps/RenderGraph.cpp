@@ -0,0 +1,637 @@
+// RenderGraph.cpp
+#include "RenderGraph.h"
+#include "PhysicalDevice.h"
+#include <stdexcept>
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+    struct AccessInfo {
+        VkPipelineStageFlags stage;
+        VkAccessFlags        access;
+        VkImageLayout        layout;
+        bool                 write;
+    };
+
+    AccessInfo accessInfo(RenderGraph::Access a)
+    {
+        switch (a) {
+        case RenderGraph::Access::ColorAttachmentWrite:
+            return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true };
+        case RenderGraph::Access::DepthAttachmentWrite:
+            return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, true };
+        case RenderGraph::Access::DepthAttachmentRead:
+            return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, false };
+        case RenderGraph::Access::SampledFragment:
+            return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+        case RenderGraph::Access::SampledCompute:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+        case RenderGraph::Access::StorageReadCompute:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                VK_IMAGE_LAYOUT_GENERAL, false };
+        case RenderGraph::Access::StorageWriteCompute:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_GENERAL, true };
+        case RenderGraph::Access::StorageReadWriteCompute:
+            return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_GENERAL, true };
+        case RenderGraph::Access::UniformRead:
+            return { VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_UNIFORM_READ_BIT,
+                VK_IMAGE_LAYOUT_UNDEFINED, false };
+        case RenderGraph::Access::IndirectRead:
+            return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+                VK_IMAGE_LAYOUT_UNDEFINED, false };
+        case RenderGraph::Access::VertexRead:
+            return { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT,
+                VK_IMAGE_LAYOUT_UNDEFINED, false };
+        case RenderGraph::Access::TransferRead:
+            return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false };
+        case RenderGraph::Access::TransferWrite:
+            return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true };
+        case RenderGraph::Access::TransferReadWrite:
+            return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, true };
+        }
+        throw std::runtime_error("Unknown render graph access!");
+    }
+
+    // Only writes have to be made available, reads need an execution dependency
+    const VkAccessFlags WRITE_ACCESS_MASK =
+        VK_ACCESS_SHADER_WRITE_BIT |
+        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_TRANSFER_WRITE_BIT |
+        VK_ACCESS_HOST_WRITE_BIT |
+        VK_ACCESS_MEMORY_WRITE_BIT;
+
+    // Hazard tracking state of one resource while walking the passes
+    struct TrackState {
+        VkImageLayout        layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags writeStages = 0;     // last write (or layout transition)
+        VkAccessFlags        writeAccess = 0;
+        VkPipelineStageFlags readStages = 0;      // readers since that write
+        VkPipelineStageFlags visibleStages = 0;   // already synchronized with the write
+        VkAccessFlags        visibleAccess = 0;
+    };
+
+    // Inclusive pass ranges
+    bool overlaps(int a0, int a1, int b0, int b1)
+    {
+        return a0 <= b1 && b0 <= a1;
+    }
+}
+
+RenderGraph::ResourceId RenderGraph::importImage(const std::string& name, VkImage image,
+    VkImageAspectFlags aspect, const ExternalState& initial, const ExternalState& final, uint32_t layers)
+{
+    Resource r;
+    r.name = name;
+    r.isImage = true;
+    r.imported = true;
+    r.image = image;
+    r.aspect = aspect;
+    r.layers = layers;
+    r.initial = initial;
+    r.final = final;
+    resources.push_back(r);
+    return (ResourceId)(resources.size() - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::importBuffer(const std::string& name, VkBuffer buffer,
+    const ExternalState& initial, const ExternalState& final)
+{
+    Resource r;
+    r.name = name;
+    r.isImage = false;
+    r.imported = true;
+    r.buffer = buffer;
+    r.initial = initial;
+    r.final = final;
+    resources.push_back(r);
+    return (ResourceId)(resources.size() - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::createImage(const std::string& name, const ImageDesc& desc)
+{
+    Resource r;
+    r.name = name;
+    r.isImage = true;
+    r.desc = desc;
+    r.aspect = desc.aspect;
+    r.layers = desc.layers;
+    resources.push_back(r);
+    return (ResourceId)(resources.size() - 1);
+}
+
+RenderGraph::ResourceId RenderGraph::createBuffer(const std::string& name, VkDeviceSize size,
+    VkBufferUsageFlags usage)
+{
+    Resource r;
+    r.name = name;
+    r.isImage = false;
+    r.bufferSize = size;
+    r.bufferUsage = usage;
+    resources.push_back(r);
+    return (ResourceId)(resources.size() - 1);
+}
+
+void RenderGraph::addPass(const std::string& name, const std::vector<Use>& uses,
+    std::function<void(VkCommandBuffer)> execute, bool sideEffect)
+{
+    if (compiled) {
+        throw std::runtime_error("Render graph pass added after compile()!");
+    }
+    for (const Use& u : uses) {
+        if (u.resource >= resources.size()) {
+            throw std::runtime_error("Render graph pass '" + name + "' uses an unknown resource!");
+        }
+    }
+
+    Pass p;
+    p.name = name;
+    p.uses = uses;
+    p.callback = std::move(execute);
+    p.sideEffect = sideEffect;
+    passes.push_back(std::move(p));
+}
+
+void RenderGraph::compile(VkDevice device, PhysicalDevice& physDevice)
+{
+    if (compiled) {
+        throw std::runtime_error("Render graph compiled twice!");
+    }
+
+    cullPasses();
+    computeLifetimes();
+    allocateTransients(device, physDevice);
+    computeBarriers();
+
+    compiled = true;
+}
+
+// ----------------------------------------------------------------------
+// 1) Culling
+// ----------------------------------------------------------------------
+void RenderGraph::cullPasses()
+{
+    // Read after the graph: anything with a final state to reach
+    std::vector<bool> needed(resources.size(), false);
+    for (ResourceId id = 0; id < (ResourceId)resources.size(); id++) {
+        const ExternalState& final = resources[id].final;
+        needed[id] = final.layout != VK_IMAGE_LAYOUT_UNDEFINED || final.stage != 0;
+    }
+
+    for (int p = (int)passes.size() - 1; p >= 0; p--) {
+        Pass& pass = passes[p];
+
+        bool alive = pass.sideEffect;
+        for (const Use& u : pass.uses) {
+            if (accessInfo(u.access).write && needed[u.resource]) {
+                alive = true;
+            }
+        }
+        pass.active = alive;
+        if (!alive) {
+            continue;
+        }
+
+        // Read-modify-write counts as a read: whoever wrote before is needed
+        for (const Use& u : pass.uses) {
+            if (!accessInfo(u.access).write || u.access == Access::StorageReadWriteCompute ||
+                u.access == Access::TransferReadWrite) {
+                needed[u.resource] = true;
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// 2) Lifetimes of the transients over the kept passes
+// ----------------------------------------------------------------------
+void RenderGraph::computeLifetimes()
+{
+    for (int p = 0; p < (int)passes.size(); p++) {
+        if (!passes[p].active) {
+            continue;
+        }
+        for (const Use& u : passes[p].uses) {
+            Resource& r = resources[u.resource];
+            if (r.imported) {
+                continue;
+            }
+            if (r.firstPass < 0) {
+                r.firstPass = p;
+            }
+            r.lastPass = p;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// 3) Create the transients, pack the ones with disjoint lifetimes into
+//    shared memory blocks (every occupant is bound at offset 0)
+// ----------------------------------------------------------------------
+void RenderGraph::allocateTransients(VkDevice device, PhysicalDevice& physDevice)
+{
+    std::vector<VkMemoryRequirements> reqs(resources.size());
+    std::vector<int> order;
+
+    for (int id = 0; id < (int)resources.size(); id++) {
+        Resource& r = resources[id];
+        if (r.imported || r.firstPass < 0) {
+            continue;   // imported, or only used by culled passes
+        }
+
+        if (r.isImage) {
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = r.desc.format;
+            imageInfo.extent = { r.desc.extent.width, r.desc.extent.height, 1 };
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = r.desc.layers;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = r.desc.usage;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            if (vkCreateImage(device, &imageInfo, nullptr, &r.image) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create render graph image '" + r.name + "'!");
+            }
+            vkGetImageMemoryRequirements(device, r.image, &reqs[id]);
+        }
+        else {
+            VkBufferCreateInfo bufInfo{};
+            bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            bufInfo.size = r.bufferSize;
+            bufInfo.usage = r.bufferUsage;
+            bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            if (vkCreateBuffer(device, &bufInfo, nullptr, &r.buffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create render graph buffer '" + r.name + "'!");
+            }
+            vkGetBufferMemoryRequirements(device, r.buffer, &reqs[id]);
+        }
+        unaliasedBytes += reqs[id].size;
+        order.push_back(id);
+    }
+
+    // Largest first, each into the first block whose occupants never
+    // overlap it in time
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return reqs[a].size > reqs[b].size; });
+    for (int id : order) {
+        Resource& r = resources[id];
+        int chosen = -1;
+        for (int s = 0; s < (int)slots.size() && chosen < 0; s++) {
+            if ((slots[s].typeBits & reqs[id].memoryTypeBits) == 0) {
+                continue;
+            }
+            bool free = true;
+            for (int other : slots[s].occupants) {
+                if (overlaps(r.firstPass, r.lastPass, resources[other].firstPass, resources[other].lastPass)) {
+                    free = false;
+                    break;
+                }
+            }
+            if (free) {
+                chosen = s;
+            }
+        }
+        if (chosen < 0) {
+            slots.push_back(MemorySlot{});
+            chosen = (int)slots.size() - 1;
+        }
+
+        MemorySlot& slot = slots[chosen];
+        slot.size = std::max(slot.size, reqs[id].size);
+        slot.typeBits &= reqs[id].memoryTypeBits;
+        slot.occupants.push_back(id);
+        r.memorySlot = chosen;
+    }
+
+    for (MemorySlot& slot : slots) {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = slot.size;
+        allocInfo.memoryTypeIndex = physDevice.findMemoryType(slot.typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (vkAllocateMemory(device, &allocInfo, nullptr, &slot.memory) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to allocate render graph memory!");
+        }
+        aliasedBytes += slot.size;
+
+        std::sort(slot.occupants.begin(), slot.occupants.end(),
+            [&](int a, int b) { return resources[a].firstPass < resources[b].firstPass; });
+
+        for (int id : slot.occupants) {
+            Resource& r = resources[id];
+            if (!r.isImage) {
+                vkBindBufferMemory(device, r.buffer, slot.memory, 0);
+                continue;
+            }
+            vkBindImageMemory(device, r.image, slot.memory, 0);
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = r.image;
+            viewInfo.viewType = r.layers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = r.desc.format;
+            viewInfo.subresourceRange.aspectMask = r.aspect;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = r.layers;
+            if (vkCreateImageView(device, &viewInfo, nullptr, &r.view) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create render graph image view '" + r.name + "'!");
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// 4) Barriers, simulated once over the kept passes
+// ----------------------------------------------------------------------
+void RenderGraph::computeBarriers()
+{
+    // Every stage a transient is touched in, so the next occupant of its
+    // memory block (or itself, next execution) can wait on them
+    std::vector<VkPipelineStageFlags> usedStages(resources.size(), 0);
+    for (const Pass& pass : passes) {
+        if (!pass.active) {
+            continue;
+        }
+        for (const Use& u : pass.uses) {
+            usedStages[u.resource] |= accessInfo(u.access).stage;
+        }
+    }
+
+    std::vector<TrackState> states(resources.size());
+    for (ResourceId id = 0; id < (ResourceId)resources.size(); id++) {
+        const Resource& r = resources[id];
+        TrackState& st = states[id];
+        if (r.imported) {
+            st.layout = r.initial.layout;
+            st.writeAccess = r.initial.access & WRITE_ACCESS_MASK;
+            st.writeStages = st.writeAccess ? r.initial.stage : 0;
+            st.readStages = st.writeAccess ? 0 : r.initial.stage;
+        }
+        else if (r.memorySlot >= 0) {
+            // Memory handed over from the previous occupant (wrapping around
+            // to the last one of the previous execution)
+            const std::vector<int>& occ = slots[r.memorySlot].occupants;
+            auto it = std::find(occ.begin(), occ.end(), (int)id);
+            int prev = (it == occ.begin()) ? occ.back() : *(it - 1);
+            st.readStages = usedStages[prev];
+        }
+    }
+
+    // One hazard check, appends to the batch when a barrier is needed
+    auto transition = [&](ResourceId id, VkPipelineStageFlags stage, VkAccessFlags access,
+        VkImageLayout layout, bool write,
+        VkPipelineStageFlags& srcStages, VkPipelineStageFlags& dstStages,
+        std::vector<VkImageMemoryBarrier>& imageBarriers,
+        std::vector<VkBufferMemoryBarrier>& bufferBarriers) {
+
+        const Resource& r = resources[id];
+        TrackState& st = states[id];
+
+        const bool layoutChange = r.isImage && st.layout != layout;
+        VkPipelineStageFlags src = 0;
+        VkAccessFlags srcAccess = 0;
+        bool needed = false;
+
+        if (write || layoutChange) {
+            // RAW on the transition, WAR on the readers, WAW on the writer
+            src = st.writeStages | st.readStages;
+            srcAccess = st.writeAccess;
+            needed = layoutChange || src != 0;
+        }
+        else if (st.writeStages != 0 &&
+            ((stage & ~st.visibleStages) != 0 || (access & ~st.visibleAccess) != 0)) {
+            // RAW not yet covered by an earlier barrier
+            src = st.writeStages;
+            srcAccess = st.writeAccess;
+            needed = true;
+        }
+
+        if (needed) {
+            srcStages |= (src != 0) ? src : stage;
+            dstStages |= stage;
+
+            if (r.isImage) {
+                VkImageMemoryBarrier b{};
+                b.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                b.oldLayout = st.layout;
+                b.newLayout = layout;
+                b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                b.image = r.image;
+                b.subresourceRange.aspectMask = r.aspect;
+                b.subresourceRange.baseMipLevel = 0;
+                b.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+                b.subresourceRange.baseArrayLayer = 0;
+                b.subresourceRange.layerCount = r.layers;
+                b.srcAccessMask = srcAccess;
+                b.dstAccessMask = access;
+                imageBarriers.push_back(b);
+            }
+            else {
+                VkBufferMemoryBarrier b{};
+                b.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                b.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                b.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                b.buffer = r.buffer;
+                b.offset = 0;
+                b.size = VK_WHOLE_SIZE;
+                b.srcAccessMask = srcAccess;
+                b.dstAccessMask = access;
+                bufferBarriers.push_back(b);
+            }
+        }
+
+        if (write) {
+            st.writeStages = stage;
+            st.writeAccess = access & WRITE_ACCESS_MASK;
+            st.readStages = 0;
+            st.visibleStages = 0;
+            st.visibleAccess = 0;
+        }
+        else if (layoutChange) {
+            // The transition is the new "write", already visible to this reader
+            st.writeStages = stage;
+            st.writeAccess = 0;
+            st.readStages = stage;
+            st.visibleStages = stage;
+            st.visibleAccess = access;
+        }
+        else {
+            st.readStages |= stage;
+            if (needed) {
+                st.visibleStages |= stage;
+                st.visibleAccess |= access;
+            }
+        }
+        if (r.isImage) {
+            st.layout = layout;
+        }
+    };
+
+    for (Pass& pass : passes) {
+        if (!pass.active) {
+            continue;
+        }
+
+        // Merge the uses of one resource inside a pass
+        std::vector<ResourceId> ids;
+        std::vector<AccessInfo> merged;
+        for (const Use& u : pass.uses) {
+            const AccessInfo info = accessInfo(u.access);
+            auto it = std::find(ids.begin(), ids.end(), u.resource);
+            if (it == ids.end()) {
+                ids.push_back(u.resource);
+                merged.push_back(info);
+                continue;
+            }
+            AccessInfo& m = merged[it - ids.begin()];
+            if (resources[u.resource].isImage && m.layout != info.layout) {
+                throw std::runtime_error("Render graph pass '" + pass.name + "' uses '" +
+                    resources[u.resource].name + "' in two layouts!");
+            }
+            m.stage |= info.stage;
+            m.access |= info.access;
+            m.write = m.write || info.write;
+        }
+
+        for (size_t i = 0; i < ids.size(); i++) {
+            transition(ids[i], merged[i].stage, merged[i].access, merged[i].layout, merged[i].write,
+                pass.srcStages, pass.dstStages, pass.imageBarriers, pass.bufferBarriers);
+        }
+    }
+
+    // Resources that have to end up somewhere specific
+    for (ResourceId id = 0; id < (ResourceId)resources.size(); id++) {
+        const Resource& r = resources[id];
+        if (r.final.layout == VK_IMAGE_LAYOUT_UNDEFINED && r.final.stage == 0) {
+            continue;
+        }
+        const VkImageLayout layout =
+            (r.final.layout != VK_IMAGE_LAYOUT_UNDEFINED) ? r.final.layout : states[id].layout;
+        const VkPipelineStageFlags stage =
+            (r.final.stage != 0) ? r.final.stage : (VkPipelineStageFlags)VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        transition(id, stage, r.final.access, layout, false,
+            finalSrcStages, finalDstStages, finalImageBarriers, finalBufferBarriers);
+    }
+}
+
+void RenderGraph::execute(VkCommandBuffer cb) const
+{
+    if (!compiled) {
+        throw std::runtime_error("Render graph executed before compile()!");
+    }
+
+    for (const Pass& pass : passes) {
+        if (!pass.active) {
+            continue;
+        }
+        if (!pass.imageBarriers.empty() || !pass.bufferBarriers.empty()) {
+            vkCmdPipelineBarrier(cb, pass.srcStages, pass.dstStages, 0,
+                0, nullptr,
+                (uint32_t)pass.bufferBarriers.size(), pass.bufferBarriers.data(),
+                (uint32_t)pass.imageBarriers.size(), pass.imageBarriers.data());
+        }
+        pass.callback(cb);
+    }
+
+    if (!finalImageBarriers.empty() || !finalBufferBarriers.empty()) {
+        vkCmdPipelineBarrier(cb, finalSrcStages, finalDstStages, 0,
+            0, nullptr,
+            (uint32_t)finalBufferBarriers.size(), finalBufferBarriers.data(),
+            (uint32_t)finalImageBarriers.size(), finalImageBarriers.data());
+    }
+}
+
+bool RenderGraph::isPassActive(const std::string& name) const
+{
+    for (const Pass& pass : passes) {
+        if (pass.name == name) {
+            return pass.active;
+        }
+    }
+    return false;
+}
+
+uint32_t RenderGraph::getCulledPassCount() const
+{
+    uint32_t count = 0;
+    for (const Pass& pass : passes) {
+        if (!pass.active) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void RenderGraph::destroy(VkDevice device)
+{
+    for (Resource& r : resources) {
+        if (r.imported) {
+            continue;
+        }
+        if (r.view) {
+            vkDestroyImageView(device, r.view, nullptr);
+            r.view = VK_NULL_HANDLE;
+        }
+        if (r.image) {
+            vkDestroyImage(device, r.image, nullptr);
+            r.image = VK_NULL_HANDLE;
+        }
+        if (r.buffer) {
+            vkDestroyBuffer(device, r.buffer, nullptr);
+            r.buffer = VK_NULL_HANDLE;
+        }
+    }
+    for (MemorySlot& slot : slots) {
+        if (slot.memory) {
+            vkFreeMemory(device, slot.memory, nullptr);
+            slot.memory = VK_NULL_HANDLE;
+        }
+    }
+    slots.clear();
+    passes.clear();
+    finalImageBarriers.clear();
+    finalBufferBarriers.clear();
+    finalSrcStages = 0;
+    finalDstStages = 0;
+    aliasedBytes = 0;
+    unaliasedBytes = 0;
+    resources.clear();
+    compiled = false;
+}
+
+std::string RenderGraph::describe() const
+{
+    std::ostringstream out;
+    for (const Pass& pass : passes) {
+        out << "  " << pass.name;
+        if (!pass.active) {
+            out << ": culled\n";
+            continue;
+        }
+        out << ": " << pass.imageBarriers.size() << " image / "
+            << pass.bufferBarriers.size() << " buffer barriers\n";
+    }
+    out << "  transient memory: " << (aliasedBytes >> 10) << " KiB in " << slots.size()
+        << " blocks (" << (unaliasedBytes >> 10) << " KiB unaliased)";
+    return out.str();
+}
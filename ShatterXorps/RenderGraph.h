@@ -0,0 +1,205 @@
+// RenderGraph.h
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+#include <functional>
+
+class PhysicalDevice;
+
+/*
+  RenderGraph: passes declare which resources they read / write and how
+  (Access), the graph works out everything in between. Used for the
+  compute frame (TLAS build -> trace -> upscale), the shadow frame
+  (cascades -> EVSM -> atlas) and the main frame of every swapchain image
+  ((G-buffer -> deferred lighting ->) main pass -> present).
+
+  Resources are either imported (images / buffers that live elsewhere,
+  the graph only tracks their state) or transient (createImage /
+  createBuffer): created by compile(), owned by the graph and only valid
+  between its passes.
+
+  compile():
+    1) Culling: walking backwards, a pass is kept when it has side effects,
+       writes a resource with a final state (i.e. one read after the
+       graph), or writes something a kept pass reads.
+    2) Transients get a lifetime [first, last kept pass]. Transients whose
+       lifetimes don't overlap share one VkDeviceMemory block (greedy,
+       largest first), so e.g. two full-screen intermediates used in
+       different halves of the frame cost one allocation. A transient
+       only used by culled passes is never created.
+    3) Barriers: per resource the last writer and the readers since are
+       tracked. A barrier is only emitted for RAW / WAR / WAW hazards or a
+       layout change, with the exact stages involved (no TOP_OF_PIPE /
+       ALL_COMMANDS), and a read that the previous barrier already made
+       visible needs none. All barriers of a pass go out in one
+       vkCmdPipelineBarrier.
+
+  execute() replays the precomputed barriers and calls the pass callbacks,
+  so a graph is built + compiled once and executed every frame. Imported
+  resources start every execution in their initial state and can be left
+  in a final one (e.g. SHADER_READ_ONLY for a later submit); a resource
+  read after the graph needs a final state, at least its stage. A
+  transient starts every execution undefined.
+
+    RenderGraph graph;
+    auto img = graph.importImage("trace", image, COLOR, initial, final);
+    auto tmp = graph.createImage("temp", desc);
+    graph.addPass("trace", { { img, RenderGraph::Access::StorageWriteCompute } },
+        [&](VkCommandBuffer cb) { ... });
+    graph.compile(device, physDevice);
+    ...graph.getImageView(tmp) into the descriptor sets...
+    graph.execute(cb);
+
+  Rebuild (graph.destroy(device), then add everything again) when an
+  imported object is recreated.
+*/
+class RenderGraph {
+public:
+    using ResourceId = uint32_t;
+
+    // How a pass touches a resource: stage, access mask, image layout and
+    // whether it counts as a write
+    enum class Access {
+        ColorAttachmentWrite,
+        DepthAttachmentWrite,
+        DepthAttachmentRead,
+        SampledFragment,
+        SampledCompute,
+        StorageReadCompute,
+        StorageWriteCompute,
+        StorageReadWriteCompute,
+        UniformRead,
+        IndirectRead,
+        VertexRead,
+        TransferRead,
+        TransferWrite,
+        // In-place transfer work on one image, e.g. a mip chain built with
+        // blits: the pass moves single levels to TRANSFER_DST itself and
+        // hands every level back in TRANSFER_SRC
+        TransferReadWrite
+    };
+
+    struct Use {
+        ResourceId resource;
+        Access     access;
+    };
+
+    // State of an imported resource before / after the graph. A final
+    // layout of UNDEFINED leaves it wherever the last pass put it.
+    struct ExternalState {
+        VkImageLayout        layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags stage = 0;
+        VkAccessFlags        access = 0;
+    };
+
+    struct ImageDesc {
+        VkFormat           format = VK_FORMAT_UNDEFINED;
+        VkExtent2D         extent{ 0, 0 };
+        VkImageUsageFlags  usage = 0;
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        uint32_t           layers = 1;
+    };
+
+    RenderGraph() = default;
+    ~RenderGraph() = default;
+
+    ResourceId importImage(const std::string& name, VkImage image, VkImageAspectFlags aspect,
+        const ExternalState& initial, const ExternalState& final, uint32_t layers = 1);
+    ResourceId importBuffer(const std::string& name, VkBuffer buffer,
+        const ExternalState& initial, const ExternalState& final);
+
+    // Transient: created (and aliased) by compile(), only valid inside the graph
+    ResourceId createImage(const std::string& name, const ImageDesc& desc);
+    ResourceId createBuffer(const std::string& name, VkDeviceSize size, VkBufferUsageFlags usage);
+
+    // sideEffect: keep the pass even if nothing reads what it writes
+    void addPass(const std::string& name, const std::vector<Use>& uses,
+        std::function<void(VkCommandBuffer)> execute, bool sideEffect = false);
+
+    void compile(VkDevice device, PhysicalDevice& physDevice);
+    void execute(VkCommandBuffer cb) const;
+    // Frees the transients and forgets every pass / resource
+    void destroy(VkDevice device);
+
+    // After compile(): the transient objects (for descriptor writes),
+    // VK_NULL_HANDLE when only culled passes use them
+    VkImage     getImage(ResourceId id) const { return resources[id].image; }
+    VkImageView getImageView(ResourceId id) const { return resources[id].view; }
+    VkBuffer    getBuffer(ResourceId id) const { return resources[id].buffer; }
+
+    bool         isPassActive(const std::string& name) const;
+    uint32_t     getCulledPassCount() const;
+    VkDeviceSize getTransientMemorySize() const { return aliasedBytes; }
+    VkDeviceSize getUnaliasedMemorySize() const { return unaliasedBytes; }
+
+    // One line per pass: kept / culled, barriers; plus transient memory
+    std::string describe() const;
+
+private:
+    struct Resource {
+        std::string name;
+        bool        isImage = true;
+        bool        imported = false;
+
+        VkImage            image = VK_NULL_HANDLE;
+        VkImageView        view = VK_NULL_HANDLE;
+        VkBuffer           buffer = VK_NULL_HANDLE;
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        uint32_t           layers = 1;
+
+        ExternalState initial;
+        ExternalState final;
+
+        // Transient only
+        ImageDesc          desc;
+        VkDeviceSize       bufferSize = 0;
+        VkBufferUsageFlags bufferUsage = 0;
+        int                firstPass = -1;
+        int                lastPass = -1;
+        int                memorySlot = -1;
+    };
+
+    struct Pass {
+        std::string      name;
+        std::vector<Use> uses;
+        std::function<void(VkCommandBuffer)> callback;
+        bool sideEffect = false;
+        bool active = false;
+
+        // Precomputed by compile()
+        VkPipelineStageFlags               srcStages = 0;
+        VkPipelineStageFlags               dstStages = 0;
+        std::vector<VkImageMemoryBarrier>  imageBarriers;
+        std::vector<VkBufferMemoryBarrier> bufferBarriers;
+    };
+
+    struct MemorySlot {
+        VkDeviceMemory   memory = VK_NULL_HANDLE;
+        VkDeviceSize     size = 0;
+        uint32_t         typeBits = ~0u;
+        std::vector<int> occupants;   // resource ids, in lifetime order
+    };
+
+    std::vector<Resource>   resources;
+    std::vector<Pass>       passes;
+    std::vector<MemorySlot> slots;
+
+    VkPipelineStageFlags               finalSrcStages = 0;
+    VkPipelineStageFlags               finalDstStages = 0;
+    std::vector<VkImageMemoryBarrier>  finalImageBarriers;
+    std::vector<VkBufferMemoryBarrier> finalBufferBarriers;
+
+    VkDeviceSize aliasedBytes = 0;
+    VkDeviceSize unaliasedBytes = 0;
+    bool         compiled = false;
+
+    void cullPasses();
+    void computeLifetimes();
+    void allocateTransients(VkDevice device, PhysicalDevice& physDevice);
+    void computeBarriers();
+};
+
+#endif // RENDER_GRAPH_H
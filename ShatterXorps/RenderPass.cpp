@@ -7,15 +7,23 @@
  * Constructor: we still create the regular color pass here, plus we create a
  * separate shadow pass if desired.
  * ------------------------------------------------------------------------------------ */
-RenderPass::RenderPass(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat swapChainImageFormat, bool enableDepth)
+RenderPass::RenderPass(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat swapChainImageFormat, bool enableDepth,
+    bool useDynamicRendering)
     : device(device)
     , physicalDevice(physicalDevice)
     , renderPass(VK_NULL_HANDLE)
     , depthAttachment(enableDepth)
     , shadowRenderPass(VK_NULL_HANDLE)  // <-- ADD for shadow pass
+    , dynamicRendering(useDynamicRendering)
 {
-    // 1) Create the main (color) render pass
-    createRenderPass(swapChainImageFormat, enableDepth);
+    // 1) Create the main (color) render pass, or only describe its
+    //    attachments for dynamic rendering
+    if (dynamicRendering) {
+        createDynamicRendering(swapChainImageFormat, enableDepth);
+    }
+    else {
+        createRenderPass(swapChainImageFormat, enableDepth);
+    }
 
     // 2) Create a separate "shadow" render pass for depth-only
     createShadowRenderPass();
@@ -51,8 +59,11 @@ void RenderPass::createRenderPass(VkFormat swapChainImageFormat, bool enableDept
     colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // No layout changes and no external dependencies: the main RenderGraph
+    // moves the swapchain image into the attachment layout (after the
+    // acquire) and on to PRESENT_SRC, and the depth buffer likewise
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     std::vector<VkAttachmentDescription> attachments;
     attachments.emplace_back(colorAttachment);
@@ -72,7 +83,7 @@ void RenderPass::createRenderPass(VkFormat swapChainImageFormat, bool enableDept
         depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
         depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
         attachments.emplace_back(depthAttachment);
 
@@ -88,39 +99,14 @@ void RenderPass::createRenderPass(VkFormat swapChainImageFormat, bool enableDept
         subpass.pDepthStencilAttachment = &depthAttachmentRef;
     }
 
-    // Dependencies
-    std::vector<VkSubpassDependency> dependencies;
-
-    // Basic external->subpass
-    VkSubpassDependency dep1{};
-    dep1.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dep1.dstSubpass = 0;
-    dep1.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dep1.srcAccessMask = 0;
-    dep1.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dep1.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-    dependencies.push_back(dep1);
-
-    if (enableDepth) {
-        // Basic subpass->external for depth
-        VkSubpassDependency dep2{};
-        dep2.srcSubpass = 0;
-        dep2.dstSubpass = VK_SUBPASS_EXTERNAL;
-        dep2.srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-        dep2.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-        dep2.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        dep2.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        dependencies.push_back(dep2);
-    }
-
     VkRenderPassCreateInfo rpInfo{};
     rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     rpInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
     rpInfo.pAttachments = attachments.data();
     rpInfo.subpassCount = 1;
     rpInfo.pSubpasses = &subpass;
-    rpInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
-    rpInfo.pDependencies = dependencies.data();
+    rpInfo.dependencyCount = 0;
+    rpInfo.pDependencies = nullptr;
 
     if (vkCreateRenderPass(device, &rpInfo, nullptr, &renderPass) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create main render pass!");
@@ -128,6 +114,65 @@ void RenderPass::createRenderPass(VkFormat swapChainImageFormat, bool enableDept
     std::cout << "Main (color) render pass created successfully.\n";
 }
 
+/* ------------------------------------------------------------------------------------
+ * Dynamic rendering: no VkRenderPass, pipelines are created against the formats
+ * and the command buffer begins rendering on the image views directly.
+ * ------------------------------------------------------------------------------------ */
+void RenderPass::createDynamicRendering(VkFormat swapChainImageFormat, bool enableDepth) {
+    colorFormat = swapChainImageFormat;
+    depthFormat = enableDepth ? findDepthFormat() : VK_FORMAT_UNDEFINED;
+
+    pipelineRendering = {};
+    pipelineRendering.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    pipelineRendering.colorAttachmentCount = 1;
+    pipelineRendering.pColorAttachmentFormats = &colorFormat;
+    pipelineRendering.depthAttachmentFormat = depthFormat;
+    pipelineRendering.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+    pfnCmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdBeginRenderingKHR"));
+    pfnCmdEndRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdEndRenderingKHR"));
+    if (!pfnCmdBeginRendering || !pfnCmdEndRendering) {
+        throw std::runtime_error("RenderPass: missing vkCmdBeginRenderingKHR / vkCmdEndRenderingKHR");
+    }
+    std::cout << "Main pass uses dynamic rendering (no render pass / framebuffers).\n";
+}
+
+void RenderPass::beginRendering(VkCommandBuffer cb, VkImageView colorView, VkImageView depthView, VkExtent2D extent,
+    const VkClearValue& colorClear, const VkClearValue& depthClear) const
+{
+    VkRenderingAttachmentInfoKHR color{};
+    color.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    color.imageView = colorView;
+    color.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    color.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color.clearValue = colorClear;
+
+    VkRenderingAttachmentInfoKHR depth{};
+    depth.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    depth.imageView = depthView;
+    depth.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depth.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depth.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    depth.clearValue = depthClear;
+
+    VkRenderingInfoKHR info{};
+    info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    info.renderArea = { { 0, 0 }, extent };
+    info.layerCount = 1;
+    info.colorAttachmentCount = 1;
+    info.pColorAttachments = &color;
+    info.pDepthAttachment = depthAttachment ? &depth : nullptr;
+    pfnCmdBeginRendering(cb, &info);
+}
+
+void RenderPass::endRendering(VkCommandBuffer cb) const
+{
+    pfnCmdEndRendering(cb);
+}
+
 /* ------------------------------------------------------------------------------------
  *  NEW FUNCTION:
  *  Create a *shadow pass* that is depth-only. Usually you want a depth format that
@@ -143,9 +188,11 @@ void RenderPass::createShadowRenderPass()
     depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE; // We want to keep the depth
     depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    // finalLayout depends how you want to read it. If you want to sample as read-only:
-    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    // No layout change and no external dependencies: the shadow frame's
+    // RenderGraph moves the image into the attachment layout before the
+    // pass and on to SHADER_READ_ONLY after it
+    depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference depthRef{};
     depthRef.attachment = 0;
@@ -157,25 +204,6 @@ void RenderPass::createShadowRenderPass()
     subpass.pColorAttachments = nullptr;
     subpass.pDepthStencilAttachment = &depthRef;
 
-    // Dependencies to handle layout transitions
-    std::array<VkSubpassDependency, 2> deps{};
-
-    // EXTERNAL -> SUBPASS
-    deps[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-    deps[0].dstSubpass = 0;
-    deps[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    deps[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    deps[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    deps[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-    // SUBPASS -> EXTERNAL
-    deps[1].srcSubpass = 0;
-    deps[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-    deps[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-    deps[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-    deps[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    deps[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
     // Create the render pass
     VkRenderPassCreateInfo rpInfo{};
     rpInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -183,8 +211,8 @@ void RenderPass::createShadowRenderPass()
     rpInfo.pAttachments = &depthAttachment;
     rpInfo.subpassCount = 1;
     rpInfo.pSubpasses = &subpass;
-    rpInfo.dependencyCount = static_cast<uint32_t>(deps.size());
-    rpInfo.pDependencies = deps.data();
+    rpInfo.dependencyCount = 0;
+    rpInfo.pDependencies = nullptr;
 
     if (vkCreateRenderPass(device, &rpInfo, nullptr, &shadowRenderPass) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create shadow render pass!");
@@ -6,14 +6,35 @@
 #include <stdexcept>
 #include <vector>
 
+// useDynamicRendering (PhysicalDevice::supportsDynamicRendering()): no main
+// VkRenderPass is created, getRenderPass() is VK_NULL_HANDLE and pipelines
+// take getPipelineRenderingInfo() instead. The main pass is then recorded with
+// beginRendering() / endRendering() straight into the swapchain + depth
+// views, no framebuffers.
 class RenderPass {
 public:
-    RenderPass(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat swapChainImageFormat, bool enableDepth = true);
+    RenderPass(VkDevice device, VkPhysicalDevice physicalDevice, VkFormat swapChainImageFormat, bool enableDepth = true,
+        bool useDynamicRendering = false);
     ~RenderPass();
 
     // The *main* color pass
     VkRenderPass getRenderPass() const { return renderPass; }
 
+    bool isDynamic() const { return dynamicRendering; }
+    // Attachment formats for VkGraphicsPipelineCreateInfo::pNext, nullptr
+    // when a real render pass is used
+    const VkPipelineRenderingCreateInfoKHR* getPipelineRenderingInfo() const {
+        return dynamicRendering ? &pipelineRendering : nullptr;
+    }
+
+    // Dynamic main pass: same clears / store ops as the render pass version
+    // (depth discarded). Neither changes layouts: the color / depth images
+    // are in the attachment layouts before and after, the main RenderGraph
+    // moves them there and the color image on to PRESENT_SRC.
+    void beginRendering(VkCommandBuffer cb, VkImageView colorView, VkImageView depthView, VkExtent2D extent,
+        const VkClearValue& colorClear, const VkClearValue& depthClear) const;
+    void endRendering(VkCommandBuffer cb) const;
+
     // The new *shadow* pass
     VkRenderPass getShadowRenderPass() const { return shadowRenderPass; }
 
@@ -28,7 +49,15 @@ private:
 
     bool depthAttachment;
 
+    bool                             dynamicRendering = false;
+    VkFormat                         colorFormat = VK_FORMAT_UNDEFINED;
+    VkFormat                         depthFormat = VK_FORMAT_UNDEFINED;
+    VkPipelineRenderingCreateInfoKHR pipelineRendering{};
+    PFN_vkCmdBeginRenderingKHR       pfnCmdBeginRendering = nullptr;
+    PFN_vkCmdEndRenderingKHR         pfnCmdEndRendering = nullptr;
+
     void createRenderPass(VkFormat swapChainImageFormat, bool enableDepth);
+    void createDynamicRendering(VkFormat swapChainImageFormat, bool enableDepth);
     void createShadowRenderPass(); // new
 
     VkFormat findDepthFormat();
@@ -0,0 +1,128 @@
+// ScenePicker.cpp
+#include "ScenePicker.h"
+#include <cmath>
+
+uint32_t ScenePicker::addMesh(const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices)
+{
+    meshes.emplace_back();
+    Mesh& mesh = meshes.back();
+    mesh.positions.reserve(vertices.size());
+    for (const Vertex& v : vertices) {
+        mesh.positions.push_back(v.position);
+    }
+    mesh.indices.assign(indices.begin(), indices.end());
+
+    for (uint32_t tri = 0; tri + 2 < (uint32_t)indices.size(); tri += 3) {
+        const glm::vec3& a = mesh.positions[indices[tri]];
+        const glm::vec3& b = mesh.positions[indices[tri + 1]];
+        const glm::vec3& c = mesh.positions[indices[tri + 2]];
+        Aabb box{ glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)) };
+        mesh.triangles.createProxy(box, tri / 3);
+    }
+    return (uint32_t)meshes.size() - 1;
+}
+
+void ScenePicker::setObject(uint32_t objectId, uint32_t mesh, const glm::mat4& model)
+{
+    if (objectId >= objects.size()) {
+        objects.resize(objectId + 1);
+    }
+    objects[objectId].mesh = mesh;
+    objects[objectId].worldToObject = glm::inverse(model);
+}
+
+ScenePicker::Ray ScenePicker::rayFromCursor(double x, double y, double width, double height,
+    const glm::mat4& view, const glm::mat4& proj)
+{
+    // Vulkan NDC: y down, depth 0 (near) .. 1 (far). The flipped projection
+    // already maps world up to -y, so window y goes straight in.
+    float ndcX = (float)(2.0 * x / width - 1.0);
+    float ndcY = (float)(2.0 * y / height - 1.0);
+
+    glm::mat4 invViewProj = glm::inverse(proj * view);
+    glm::vec4 nearPoint = invViewProj * glm::vec4(ndcX, ndcY, 0.0f, 1.0f);
+    glm::vec4 farPoint = invViewProj * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    nearPoint /= nearPoint.w;
+    farPoint /= farPoint.w;
+
+    Ray ray;
+    ray.origin = glm::vec3(nearPoint);
+    ray.dir = glm::normalize(glm::vec3(farPoint) - glm::vec3(nearPoint));
+    return ray;
+}
+
+bool ScenePicker::intersectTriangle(const glm::vec3& origin, const glm::vec3& dir,
+    const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float maxT, float& t)
+{
+    const float EPSILON = 1e-8f;
+    glm::vec3 e1 = v1 - v0;
+    glm::vec3 e2 = v2 - v0;
+    glm::vec3 p = glm::cross(dir, e2);
+    float det = glm::dot(e1, p);
+    if (std::fabs(det) < EPSILON) {
+        return false;   // parallel
+    }
+    float invDet = 1.0f / det;
+
+    glm::vec3 s = origin - v0;
+    float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    glm::vec3 q = glm::cross(s, e1);
+    float v = glm::dot(dir, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    t = glm::dot(e2, q) * invDet;
+    return t > 0.0f && t < maxT;
+}
+
+bool ScenePicker::pick(const DynamicAabbTree& scene, const Ray& ray, Hit& hit) const
+{
+    hit = Hit{};
+    float nearest = 1e30f;
+
+    scene.raycast(ray.origin, ray.dir, nearest, [&](int32_t proxy, float maxT) {
+        uint32_t objectId = scene.getUserData(proxy);
+        if (objectId >= objects.size() || objects[objectId].mesh == NO_OBJECT) {
+            return maxT;
+        }
+        const Object& object = objects[objectId];
+        const Mesh& mesh = meshes[object.mesh];
+
+        // Object space, direction left unnormalized so t stays a world distance
+        glm::vec3 origin = glm::vec3(object.worldToObject * glm::vec4(ray.origin, 1.0f));
+        glm::vec3 dir = glm::vec3(object.worldToObject * glm::vec4(ray.dir, 0.0f));
+
+        float best = maxT;
+        uint32_t bestTriangle = NO_OBJECT;
+        mesh.triangles.raycast(origin, dir, best, [&](int32_t triProxy, float triMaxT) {
+            uint32_t tri = mesh.triangles.getUserData(triProxy);
+            const uint32_t* idx = &mesh.indices[tri * 3];
+            float t;
+            if (intersectTriangle(origin, dir, mesh.positions[idx[0]], mesh.positions[idx[1]],
+                mesh.positions[idx[2]], triMaxT, t)) {
+                best = t;
+                bestTriangle = tri;
+                return t;
+            }
+            return triMaxT;
+        });
+
+        if (bestTriangle == NO_OBJECT) {
+            return maxT;
+        }
+        hit.objectId = objectId;
+        hit.triangle = bestTriangle;
+        hit.t = best;
+        nearest = best;
+        return best;
+    });
+
+    if (hit.objectId == NO_OBJECT) {
+        return false;
+    }
+    hit.position = ray.origin + ray.dir * hit.t;
+    return true;
+}
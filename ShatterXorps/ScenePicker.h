@@ -0,0 +1,78 @@
+// ScenePicker.h
+#ifndef SCENE_PICKER_H
+#define SCENE_PICKER_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "Vertex.h"
+#include "DynamicAabbTree.h"
+
+/*
+  CPU ray picking: the scene DynamicAabbTree finds the objects whose world
+  boxes the ray crosses (nearest hit so far clips the ray), then each
+  candidate's mesh is tested triangle by triangle through its own
+  object-space triangle tree (Moller-Trumbore), so a pick touches a handful
+  of boxes and triangles instead of the whole scene.
+
+  Objects are the scene tree's userData ids; setObject() tells the picker
+  which mesh and model matrix belong to one.
+
+    ScenePicker picker;
+    uint32_t cube = picker.addMesh(cubeVertices, cubeIndices);
+    picker.setObject(SceneCube, cube, model);
+    ScenePicker::Ray ray = ScenePicker::rayFromCursor(x, y, w, h, view, proj);
+    ScenePicker::Hit hit;
+    if (picker.pick(sceneTree, ray, hit)) { ... hit.objectId ... }
+*/
+class ScenePicker {
+public:
+    static const uint32_t NO_OBJECT = 0xFFFFFFFFu;
+
+    struct Ray {
+        glm::vec3 origin = glm::vec3(0.0f);
+        glm::vec3 dir = glm::vec3(0.0f, 0.0f, -1.0f);   // normalized
+    };
+
+    struct Hit {
+        uint32_t  objectId = NO_OBJECT;
+        uint32_t  triangle = 0;
+        float     t = 0.0f;                 // world distance along the ray
+        glm::vec3 position = glm::vec3(0.0f);
+    };
+
+    ScenePicker() = default;
+
+    // Triangle list (3 indices per triangle), returns the mesh index
+    uint32_t addMesh(const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices);
+    void     setObject(uint32_t objectId, uint32_t mesh, const glm::mat4& model);
+
+    // Window coordinates (origin top-left) through the camera, for a Vulkan
+    // projection with the y flip already applied (as the UBOs use it)
+    static Ray rayFromCursor(double x, double y, double width, double height,
+        const glm::mat4& view, const glm::mat4& proj);
+
+    // Nearest triangle hit among the objects in the scene tree
+    bool pick(const DynamicAabbTree& scene, const Ray& ray, Hit& hit) const;
+
+    // Ray / triangle (Moller-Trumbore), both faces; t in (0, maxT)
+    static bool intersectTriangle(const glm::vec3& origin, const glm::vec3& dir,
+        const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float maxT, float& t);
+
+private:
+    struct Mesh {
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t>  indices;
+        DynamicAabbTree        triangles{ 0.0f };   // userData = triangle index
+    };
+
+    struct Object {
+        uint32_t  mesh = NO_OBJECT;
+        glm::mat4 worldToObject = glm::mat4(1.0f);
+    };
+
+    std::vector<Mesh>   meshes;
+    std::vector<Object> objects;   // indexed by object id
+};
+
+#endif // SCENE_PICKER_H
@@ -0,0 +1,372 @@
+// ShadowAtlas.cpp
+#include "ShadowAtlas.h"
+#include "PhysicalDevice.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Near plane of every spot light projection
+static const float LIGHT_NEAR = 0.05f;
+
+VkDeviceSize ShadowAtlas::getLightBufferSize() const
+{
+    return sizeof(glm::uvec4) + sizeof(GpuLight) * MAX_LIGHTS;
+}
+
+void ShadowAtlas::create(VkDevice device, PhysicalDevice& physDevice, VkRenderPass pass,
+    uint32_t size, uint32_t minTileSize, uint32_t maxTileSize)
+{
+    auto isPow2 = [](uint32_t v) { return v != 0 && (v & (v - 1)) == 0; };
+    if (!isPow2(size) || !isPow2(minTileSize) || !isPow2(maxTileSize) ||
+        minTileSize > maxTileSize || maxTileSize > size) {
+        throw std::runtime_error("ShadowAtlas: sizes must be powers of two with min <= max <= atlas!");
+    }
+    shadowPass = pass;
+    atlasSize = size;
+    minTile = minTileSize;
+    maxTile = maxTileSize;
+
+    // ------------------------------------------------------------------
+    // 1) Atlas depth image + view + framebuffer
+    // ------------------------------------------------------------------
+    VkImageCreateInfo imgInfo{};
+    imgInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imgInfo.imageType = VK_IMAGE_TYPE_2D;
+    imgInfo.extent = { atlasSize, atlasSize, 1 };
+    imgInfo.mipLevels = 1;
+    imgInfo.arrayLayers = 1;
+    imgInfo.format = VK_FORMAT_D32_SFLOAT;
+    imgInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imgInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imgInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imgInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imgInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateImage(device, &imgInfo, nullptr, &atlasImage) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shadow atlas image!");
+    }
+
+    VkMemoryRequirements memReq;
+    vkGetImageMemoryRequirements(device, atlasImage, &memReq);
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReq.size;
+    allocInfo.memoryTypeIndex = physDevice.findMemoryType(memReq.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &atlasMemory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate shadow atlas memory!");
+    }
+    vkBindImageMemory(device, atlasImage, atlasMemory, 0);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = atlasImage;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_D32_SFLOAT;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+    if (vkCreateImageView(device, &viewInfo, nullptr, &atlasView) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shadow atlas view!");
+    }
+
+    VkFramebufferCreateInfo fbInfo{};
+    fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    fbInfo.renderPass = shadowPass;
+    fbInfo.attachmentCount = 1;
+    fbInfo.pAttachments = &atlasView;
+    fbInfo.width = atlasSize;
+    fbInfo.height = atlasSize;
+    fbInfo.layers = 1;
+    if (vkCreateFramebuffer(device, &fbInfo, nullptr, &framebuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shadow atlas framebuffer!");
+    }
+
+    // ------------------------------------------------------------------
+    // 2) Light SSBO, host-visible and persistently mapped
+    // ------------------------------------------------------------------
+    VkBufferCreateInfo bufInfo{};
+    bufInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufInfo.size = getLightBufferSize();
+    bufInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufInfo, nullptr, &lightBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shadow atlas light buffer!");
+    }
+
+    vkGetBufferMemoryRequirements(device, lightBuffer, &memReq);
+    allocInfo.allocationSize = memReq.size;
+    allocInfo.memoryTypeIndex = physDevice.findMemoryType(memReq.memoryTypeBits,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &lightMemory) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate shadow atlas light memory!");
+    }
+    vkBindBufferMemory(device, lightBuffer, lightMemory, 0);
+    vkMapMemory(device, lightMemory, 0, bufInfo.size, 0, &lightMapped);
+    memset(lightMapped, 0, (size_t)bufInfo.size);
+
+    // ------------------------------------------------------------------
+    // 3) Set for shadow_atlas.vert: binding=0 => light SSBO
+    // ------------------------------------------------------------------
+    VkDescriptorSetLayoutBinding ssboBinding{};
+    ssboBinding.binding = 0;
+    ssboBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    ssboBinding.descriptorCount = 1;
+    ssboBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &ssboBinding;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &shadowSetLayout) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shadow atlas set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 };
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = 1;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &shadowPool) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create shadow atlas descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo setAlloc{};
+    setAlloc.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    setAlloc.descriptorPool = shadowPool;
+    setAlloc.descriptorSetCount = 1;
+    setAlloc.pSetLayouts = &shadowSetLayout;
+    if (vkAllocateDescriptorSets(device, &setAlloc, &shadowSet) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to allocate shadow atlas descriptor set!");
+    }
+
+    VkDescriptorBufferInfo ssboInfo{};
+    ssboInfo.buffer = lightBuffer;
+    ssboInfo.offset = 0;
+    ssboInfo.range = getLightBufferSize();
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = shadowSet;
+    write.dstBinding = 0;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.descriptorCount = 1;
+    write.pBufferInfo = &ssboInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+
+void ShadowAtlas::destroy(VkDevice device)
+{
+    if (shadowPool) {
+        vkDestroyDescriptorPool(device, shadowPool, nullptr);
+        shadowPool = VK_NULL_HANDLE;
+        shadowSet = VK_NULL_HANDLE;
+    }
+    if (shadowSetLayout) {
+        vkDestroyDescriptorSetLayout(device, shadowSetLayout, nullptr);
+        shadowSetLayout = VK_NULL_HANDLE;
+    }
+    if (lightMemory) {
+        vkUnmapMemory(device, lightMemory);
+        lightMapped = nullptr;
+    }
+    if (lightBuffer) {
+        vkDestroyBuffer(device, lightBuffer, nullptr);
+        lightBuffer = VK_NULL_HANDLE;
+    }
+    if (lightMemory) {
+        vkFreeMemory(device, lightMemory, nullptr);
+        lightMemory = VK_NULL_HANDLE;
+    }
+    if (framebuffer) {
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+        framebuffer = VK_NULL_HANDLE;
+    }
+    if (atlasView) {
+        vkDestroyImageView(device, atlasView, nullptr);
+        atlasView = VK_NULL_HANDLE;
+    }
+    if (atlasImage) {
+        vkDestroyImage(device, atlasImage, nullptr);
+        atlasImage = VK_NULL_HANDLE;
+    }
+    if (atlasMemory) {
+        vkFreeMemory(device, atlasMemory, nullptr);
+        atlasMemory = VK_NULL_HANDLE;
+    }
+}
+
+// ----------------------------------------------------------------------
+// Quadtree allocator
+// ----------------------------------------------------------------------
+
+uint32_t ShadowAtlas::levelOf(uint32_t size) const
+{
+    uint32_t level = 0;
+    for (uint32_t s = atlasSize; s > size; s >>= 1) {
+        level++;
+    }
+    return level;
+}
+
+bool ShadowAtlas::allocateTile(uint32_t size, Tile& out)
+{
+    const uint32_t level = levelOf(size);
+
+    // Closest level above with a free square
+    int32_t from = (int32_t)level;
+    while (from >= 0 && freeTiles[from].empty()) {
+        from--;
+    }
+    if (from < 0) {
+        return false;
+    }
+
+    // Split it down to the wanted size, keeping the first child each time
+    Tile t = freeTiles[from].back();
+    freeTiles[from].pop_back();
+    for (uint32_t l = (uint32_t)from; l < level; l++) {
+        uint32_t half = t.size / 2;
+        Tile child;
+        child.size = half;
+        child.x = t.x + half; child.y = t.y;        freeTiles[l + 1].push_back(child);
+        child.x = t.x;        child.y = t.y + half; freeTiles[l + 1].push_back(child);
+        child.x = t.x + half; child.y = t.y + half; freeTiles[l + 1].push_back(child);
+        t.size = half;
+    }
+    out = t;
+    return true;
+}
+
+// ----------------------------------------------------------------------
+// Per frame
+// ----------------------------------------------------------------------
+
+void ShadowAtlas::update(const std::vector<SpotLight>& lights, const glm::mat4& cameraView,
+    const glm::mat4& cameraProj, float viewportHeight)
+{
+    lightCount = std::min((uint32_t)lights.size(), MAX_LIGHTS);
+
+    // ------------------------------------------------------------------
+    // 1) Importance = radius of the light's sphere on screen, in pixels.
+    //    Lights entirely behind the camera get no tile.
+    // ------------------------------------------------------------------
+    struct Ranked {
+        uint32_t light;
+        float    pixels;
+    };
+    std::vector<Ranked> ranked;
+    ranked.reserve(lightCount);
+
+    const float focal = std::fabs(cameraProj[1][1]) * 0.5f * viewportHeight;
+    for (uint32_t i = 0; i < lightCount; i++) {
+        const SpotLight& l = lights[i];
+        float viewZ = -(cameraView * glm::vec4(l.position, 1.0f)).z;
+        if (viewZ + l.range < 0.0f) {
+            continue;
+        }
+        float dist = std::max(glm::length(glm::vec3(cameraView * glm::vec4(l.position, 1.0f))), 1e-3f);
+        float pixels = (dist <= l.range) ? (float)atlasSize : l.range * focal / dist;
+        ranked.push_back({ i, pixels });
+    }
+    std::sort(ranked.begin(), ranked.end(),
+        [](const Ranked& a, const Ranked& b) { return a.pixels > b.pixels; });
+
+    // ------------------------------------------------------------------
+    // 2) Hand out tiles, biggest first so the quadtree never fragments.
+    //    A light that doesn't fit tries smaller sizes down to minTile.
+    // ------------------------------------------------------------------
+    freeTiles.assign(levelOf(minTile) + 1, std::vector<Tile>());
+    Tile root;
+    root.size = atlasSize;
+    freeTiles[0].push_back(root);
+    tiles.clear();
+
+    for (const Ranked& r : ranked) {
+        // Next power of two of the on-screen size, clamped to min..max
+        uint32_t want = minTile;
+        while (want < maxTile && (float)want < r.pixels) {
+            want <<= 1;
+        }
+        for (uint32_t s = want; s >= minTile; s >>= 1) {
+            Tile t;
+            if (allocateTile(s, t)) {
+                t.light = r.light;
+                tiles.push_back(t);
+                break;
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // 3) Light SSBO
+    // ------------------------------------------------------------------
+    glm::uvec4* header = reinterpret_cast<glm::uvec4*>(lightMapped);
+    *header = glm::uvec4(lightCount, (uint32_t)tiles.size(), 0u, 0u);
+    GpuLight* gpu = reinterpret_cast<GpuLight*>(header + 1);
+
+    const float texel = 1.0f / (float)atlasSize;
+    for (uint32_t i = 0; i < lightCount; i++) {
+        const SpotLight& l = lights[i];
+        glm::vec3 dir = glm::normalize(l.direction);
+        glm::vec3 up = (std::fabs(dir.y) > 0.99f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+        glm::mat4 view = glm::lookAt(l.position, l.position + dir, up);
+        glm::mat4 proj = glm::perspectiveRH_ZO(2.0f * l.outerAngle, 1.0f, LIGHT_NEAR, l.range);
+
+        gpu[i].viewProj = proj * view;
+        lightFrusta[i] = Frustum(gpu[i].viewProj);
+        gpu[i].positionRange = glm::vec4(l.position, l.range);
+        gpu[i].directionCos = glm::vec4(dir, std::cos(l.outerAngle));
+        gpu[i].colorCos = glm::vec4(l.color, std::cos(l.innerAngle));
+        gpu[i].atlasRect = glm::vec4(0.0f, 0.0f, 0.0f, texel);
+    }
+    for (const Tile& t : tiles) {
+        gpu[t.light].atlasRect = glm::vec4(t.x * texel, t.y * texel, t.size * texel, texel);
+    }
+}
+
+void ShadowAtlas::record(VkCommandBuffer cb, VkPipeline pipeline,
+    const std::function<void(VkCommandBuffer, uint32_t)>& drawScene) const
+{
+    VkClearValue clearDepth{};
+    clearDepth.depthStencil = { 1.f, 0 };
+
+    VkRenderPassBeginInfo rpBegin{};
+    rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    rpBegin.renderPass = shadowPass;
+    rpBegin.framebuffer = framebuffer;
+    rpBegin.renderArea.offset = { 0, 0 };
+    rpBegin.renderArea.extent = { atlasSize, atlasSize };
+    rpBegin.clearValueCount = 1;
+    rpBegin.pClearValues = &clearDepth;
+
+    vkCmdBeginRenderPass(cb, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdSetDepthBias(cb, 1.25f, 0.f, 1.75f);
+
+    for (const Tile& t : tiles) {
+        // Plain viewport, shader.frag maps light NDC to the tile with ndc * 0.5 + 0.5
+        VkViewport vp{};
+        vp.x = (float)t.x;
+        vp.y = (float)t.y;
+        vp.width = (float)t.size;
+        vp.height = (float)t.size;
+        vp.minDepth = 0.f;
+        vp.maxDepth = 1.f;
+        vkCmdSetViewport(cb, 0, 1, &vp);
+
+        VkRect2D scissor{};
+        scissor.offset = { (int32_t)t.x, (int32_t)t.y };
+        scissor.extent = { t.size, t.size };
+        vkCmdSetScissor(cb, 0, 1, &scissor);
+
+        drawScene(cb, t.light);
+    }
+
+    vkCmdEndRenderPass(cb);
+}
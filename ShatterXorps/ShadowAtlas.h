@@ -0,0 +1,125 @@
+// ShadowAtlas.h
+#ifndef SHADOW_ATLAS_H
+#define SHADOW_ATLAS_H
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <functional>
+#include "Frustum.h"
+
+class PhysicalDevice;
+
+/*
+  Shadow atlas for local (spot) lights.
+
+  One square D32 texture is shared by every local light. Each frame the
+  lights are ranked by how large they are on screen and get a square tile
+  (power of two, minTile..maxTile) from a quadtree split of the atlas:
+  big / close lights get big tiles, far ones small tiles, and when the
+  atlas is full the rest go unshadowed. Memory stays at atlasSize^2 no
+  matter how many lights there are.
+
+  The lights (matrix, tile rect, color, cone) go to an SSBO:
+    - shadow_atlas.vert reads the light matrix from it (set=0, binding=0)
+    - shader.frag loops over it (set=1, binding=3) and samples the atlas
+      (set=1, binding=4) inside each light's tile
+
+  Per frame:
+    atlas.update(lights, cameraView, cameraProj, viewportHeight);
+    atlas.record(cb, atlasPipeline, [&](VkCommandBuffer cb, uint32_t light) { ...draws... });
+*/
+class ShadowAtlas {
+public:
+    static const uint32_t MAX_LIGHTS = 64;
+
+    struct SpotLight {
+        glm::vec3 position;
+        glm::vec3 direction;
+        glm::vec3 color;
+        float     range;
+        float     innerAngle;   // half angles, radians
+        float     outerAngle;
+    };
+
+    // Must match LocalLight in shadow_lighting.glsl / shadow_atlas.vert (std430)
+    struct GpuLight {
+        glm::mat4 viewProj;
+        glm::vec4 positionRange;   // xyz: position, w: range
+        glm::vec4 directionCos;    // xyz: direction, w: cos(outerAngle)
+        glm::vec4 colorCos;        // xyz: color,     w: cos(innerAngle)
+        glm::vec4 atlasRect;       // xy: tile offset (uv), z: tile size (uv, 0 = no shadow), w: 1 / atlasSize
+    };
+
+    ShadowAtlas() = default;
+    ~ShadowAtlas() = default;
+
+    // shadowPass: depth-only pass (RenderPass::getShadowRenderPass)
+    void create(VkDevice device, PhysicalDevice& physDevice, VkRenderPass shadowPass,
+        uint32_t atlasSize, uint32_t minTile, uint32_t maxTile);
+    void destroy(VkDevice device);
+
+    // Rank the lights, hand out tiles and write the light SSBO.
+    // Lights past MAX_LIGHTS are dropped.
+    void update(const std::vector<SpotLight>& lights, const glm::mat4& cameraView,
+        const glm::mat4& cameraProj, float viewportHeight);
+
+    // Caster culling for the draw callback: false when the world box is
+    // outside the light's frustum
+    bool casterVisible(uint32_t light, const Aabb& worldBox) const { return lightFrusta[light].intersects(worldBox); }
+
+    // One render pass over the whole atlas, drawScene is called once per
+    // shadowed light with the viewport/scissor set to its tile. The atlas
+    // is in DEPTH_STENCIL_ATTACHMENT_OPTIMAL before and after (RenderGraph
+    // DepthAttachmentWrite, the graph hands it on to SHADER_READ_ONLY).
+    void record(VkCommandBuffer cb, VkPipeline pipeline,
+        const std::function<void(VkCommandBuffer, uint32_t)>& drawScene) const;
+
+    // Layout of the set used by shadow_atlas.vert (light SSBO at binding=0)
+    VkDescriptorSetLayout getShadowSetLayout() const { return shadowSetLayout; }
+    VkDescriptorSet       getShadowSet() const { return shadowSet; }
+
+    VkImage     getImage() const { return atlasImage; }
+    VkImageView getView() const { return atlasView; }
+    VkBuffer    getLightBuffer() const { return lightBuffer; }
+    VkDeviceSize getLightBufferSize() const;
+
+    uint32_t getLightCount() const { return lightCount; }
+    uint32_t getShadowedCount() const { return (uint32_t)tiles.size(); }
+
+private:
+    struct Tile {
+        uint32_t x = 0, y = 0, size = 0;
+        uint32_t light = 0;
+    };
+
+    // Quadtree allocator: free squares per level (level 0 = whole atlas)
+    bool allocateTile(uint32_t size, Tile& out);
+    uint32_t levelOf(uint32_t size) const;
+
+    VkRenderPass   shadowPass = VK_NULL_HANDLE;
+    VkImage        atlasImage = VK_NULL_HANDLE;
+    VkDeviceMemory atlasMemory = VK_NULL_HANDLE;
+    VkImageView    atlasView = VK_NULL_HANDLE;
+    VkFramebuffer  framebuffer = VK_NULL_HANDLE;
+
+    // Light SSBO: uvec4 header (x = count) + GpuLight[MAX_LIGHTS], persistently mapped
+    VkBuffer       lightBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory lightMemory = VK_NULL_HANDLE;
+    void*          lightMapped = nullptr;
+
+    VkDescriptorSetLayout shadowSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool      shadowPool = VK_NULL_HANDLE;
+    VkDescriptorSet       shadowSet = VK_NULL_HANDLE;
+
+    uint32_t atlasSize = 0;
+    uint32_t minTile = 0;
+    uint32_t maxTile = 0;
+    uint32_t lightCount = 0;
+
+    std::vector<std::vector<Tile>> freeTiles;  // per quadtree level
+    std::vector<Tile>              tiles;      // this frame's allocations
+    Frustum                        lightFrusta[MAX_LIGHTS];
+};
+
+#endif // SHADOW_ATLAS_H
@@ -4,10 +4,11 @@
 #include <fstream>
 #include <stdexcept>
 
-void ShadowPipeline::create(VkDevice device, VkRenderPass shadowPass, VkDescriptorSetLayout uboLayout)
+void ShadowPipeline::create(VkDevice device, VkRenderPass shadowPass, VkDescriptorSetLayout uboLayout,
+    const std::string& vertShader)
 {
     // 1) Load your minimal vertex shader for shadows
-    auto vertCode = readFile("shaders/shadow.vert.spv");
+    auto vertCode = readFile(vertShader);
     VkShaderModule vertModule = createShaderModule(device, vertCode);
 
     // No fragment shader if you only want depth
@@ -18,15 +19,11 @@ void ShadowPipeline::create(VkDevice device, VkRenderPass shadowPass, VkDescript
     stage.pName = "main";
 
     // -----------------------------------------------------------------------
-    // This local attribute array ONLY includes location=0. No "color" attribute.
+    // Position-only stream (12-byte stride), only location=0. Meshes keep it
+    // next to the full Vertex stream, see Vertex::extractPositions.
     // -----------------------------------------------------------------------
-    auto bindingDesc = Vertex::getBindingDescription();
-
-    VkVertexInputAttributeDescription shadowAttr{};
-    shadowAttr.binding = 0;
-    shadowAttr.location = 0;
-    shadowAttr.format = VK_FORMAT_R32G32B32_SFLOAT;
-    shadowAttr.offset = 0; // if Vertex::pos is at offset=0
+    auto bindingDesc = Vertex::getPositionBindingDescription();
+    auto shadowAttr = Vertex::getPositionAttributeDescription();
 
     VkPipelineVertexInputStateCreateInfo vertexInput{};
     vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -87,11 +84,18 @@ void ShadowPipeline::create(VkDevice device, VkRenderPass shadowPass, VkDescript
     dynStateInfo.dynamicStateCount = static_cast<uint32_t>(dynStates.size());
     dynStateInfo.pDynamicStates = dynStates.data();
 
-    // 9) Pipeline layout (UBO set=0)
+    // 9) Pipeline layout (UBO set=0 + model/cascade push constants)
+    VkPushConstantRange pushRange{};
+    pushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushRange.offset = 0;
+    pushRange.size = sizeof(PushConstants);
+
     VkPipelineLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     layoutInfo.setLayoutCount = 1;
     layoutInfo.pSetLayouts = &uboLayout;
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges = &pushRange;
 
     if (vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create shadow pipeline layout!");
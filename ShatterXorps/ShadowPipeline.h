@@ -3,15 +3,25 @@
 #define SHADOW_PIPELINE_H
 
 #include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
 #include <vector>
 #include <string>
 
 class ShadowPipeline {
 public:
+    // Must match the push_constant block in shadow.vert / shadow_atlas.vert
+    struct PushConstants {
+        glm::mat4 model;
+        int32_t   cascade;   // light index for shadow_atlas.vert
+    };
+
     ShadowPipeline() = default;
     ~ShadowPipeline() = default;
 
-    void create(VkDevice device, VkRenderPass shadowPass, VkDescriptorSetLayout uboLayout);
+    // vertShader: shadow.vert.spv (cascades, light UBO at set=0) or
+    // shadow_atlas.vert.spv (ShadowAtlas, light SSBO at set=0)
+    void create(VkDevice device, VkRenderPass shadowPass, VkDescriptorSetLayout uboLayout,
+        const std::string& vertShader = "shaders/shadow.vert.spv");
     void destroy(VkDevice device);
 
     VkPipeline       getPipeline()       const { return pipeline; }
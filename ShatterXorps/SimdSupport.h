@@ -0,0 +1,69 @@
+// SimdSupport.h
+#ifndef SIMD_SUPPORT_H
+#define SIMD_SUPPORT_H
+
+// Runtime CPU feature checks for the SIMD code paths (CpuRayTracer).
+// x64 always has SSE2; AVX2 is checked with cpuid and the OS must save YMM state.
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+namespace simd {
+
+    inline void cpuid(int out[4], int leaf, int subleaf)
+    {
+#if defined(_MSC_VER)
+        __cpuidex(out, leaf, subleaf);
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        unsigned a, b, c, d;
+        __cpuid_count(leaf, subleaf, a, b, c, d);
+        out[0] = (int)a; out[1] = (int)b; out[2] = (int)c; out[3] = (int)d;
+#else
+        out[0] = out[1] = out[2] = out[3] = 0;
+#endif
+    }
+
+    inline unsigned long long xgetbv0()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        unsigned eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return ((unsigned long long)edx << 32) | eax;
+#else
+        return 0;
+#endif
+    }
+
+    inline bool hasSSE2()
+    {
+        int r[4];
+        cpuid(r, 1, 0);
+        return (r[3] & (1 << 26)) != 0;
+    }
+
+    inline bool hasAVX2()
+    {
+        int r[4];
+        cpuid(r, 0, 0);
+        if (r[0] < 7) {
+            return false;
+        }
+        // OSXSAVE + AVX, and the OS enabled XMM|YMM state
+        cpuid(r, 1, 0);
+        bool osxsave = (r[2] & (1 << 27)) != 0;
+        bool avx = (r[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (xgetbv0() & 0x6) != 0x6) {
+            return false;
+        }
+        cpuid(r, 7, 0);
+        return (r[1] & (1 << 5)) != 0;
+    }
+
+} // namespace simd
+
+#endif // SIMD_SUPPORT_H
@@ -8,15 +8,18 @@
 #include <iostream>
 
 // SwapChain constructor
-SwapChain::SwapChain(PhysicalDevice& physicalDeviceRef, VkDevice device, VkSurfaceKHR surface, GLFWwindow* window)
+SwapChain::SwapChain(PhysicalDevice& physicalDeviceRef, VkDevice device, VkSurfaceKHR surface, GLFWwindow* window,
+    bool useDynamicRendering)
     : physicalDevice(&physicalDeviceRef), device(device), surface(surface), swapChain(VK_NULL_HANDLE),
     offscreenImage(VK_NULL_HANDLE), offscreenImageMemory(VK_NULL_HANDLE), offscreenImageView(VK_NULL_HANDLE),
     offscreenFramebuffer(VK_NULL_HANDLE), offscreenRenderPass(nullptr) {
     createSwapChain(window);
     createImageViews();
     createDepthResources();
-    createOffscreenResources();       // Initialize offscreen resources
-    createOffscreenFramebuffer();    // Create framebuffer for offscreen rendering
+    createOffscreenResources(useDynamicRendering);  // Initialize offscreen resources
+    if (!useDynamicRendering) {
+        createOffscreenFramebuffer();    // Create framebuffer for offscreen rendering
+    }
 }
 
 // SwapChain move constructor
@@ -407,13 +410,16 @@ void SwapChain::createFramebuffers(VkRenderPass renderPass) {
 }
 
 // SwapChain createOffscreenResources function
-void SwapChain::createOffscreenResources() {
+void SwapChain::createOffscreenResources(bool useDynamicRendering) {
     // Define the size of the thumbnail
     uint32_t thumbnailWidth = 200;
     uint32_t thumbnailHeight = 150;
 
-    // Create the offscreen render pass without depth
-    offscreenRenderPass = new RenderPass(device, physicalDevice->getPhysicalDevice(), swapChainImageFormat, false);
+    // Create the offscreen render pass without depth (dynamic rendering
+    // renders straight into offscreenImageView instead)
+    if (!useDynamicRendering) {
+        offscreenRenderPass = new RenderPass(device, physicalDevice->getPhysicalDevice(), swapChainImageFormat, false);
+    }
 
     // Create the offscreen image
     createImage(
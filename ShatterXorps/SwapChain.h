@@ -15,8 +15,10 @@
 // Manages Vulkan swap chain and related resources
 class SwapChain {
 public:
-    // Constructor: Initializes swap chain, image views, depth resources, and offscreen resources
-    SwapChain(PhysicalDevice& physicalDevice, VkDevice device, VkSurfaceKHR surface, GLFWwindow* window);
+    // Constructor: Initializes swap chain, image views, depth resources, and offscreen resources.
+    // useDynamicRendering: the offscreen image gets no render pass / framebuffer
+    SwapChain(PhysicalDevice& physicalDevice, VkDevice device, VkSurfaceKHR surface, GLFWwindow* window,
+        bool useDynamicRendering = false);
 
     // Destructor: Cleans up all swap chain resources
     ~SwapChain();
@@ -36,9 +38,12 @@ public:
     VkExtent2D getSwapChainExtent() const { return swapChainExtent; }
     const std::vector<VkImageView>& getSwapChainImageViews() const { return swapChainImageViews; }
     const std::vector<VkFramebuffer>& getSwapChainFramebuffers() const { return swapChainFramebuffers; }
+    VkImage getDepthImage() const { return depthImage; }
+    VkImageView getDepthImageView() const { return depthImageView; }
 
     // Accessors for offscreen resources
-    VkRenderPass getOffscreenRenderPass() const { return offscreenRenderPass->getRenderPass(); }
+    VkRenderPass getOffscreenRenderPass() const { return offscreenRenderPass ? offscreenRenderPass->getRenderPass() : VK_NULL_HANDLE; }
+    VkImageView getOffscreenImageView() const { return offscreenImageView; }
     VkFramebuffer getOffscreenFramebuffer() const { return offscreenFramebuffer; }
 
     // Destroys swap chain and associated resources
@@ -74,7 +79,7 @@ private:
     void createSwapChain(GLFWwindow* window);
     void createImageViews();
     void createDepthResources();
-    void createOffscreenResources();
+    void createOffscreenResources(bool useDynamicRendering);
     void createOffscreenFramebuffer();
     void createRenderPasses();
 
@@ -86,7 +91,6 @@ private:
     VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, GLFWwindow* window);
     VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
-    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
 
     // Declare createImage
     void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling,
@@ -0,0 +1,98 @@
+// ThreadPool.cpp
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    // The calling thread works too, so start one less
+    for (unsigned i = 1; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCv.notify_all();
+    for (auto& t : workers) {
+        t.join();
+    }
+}
+
+void ThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t)>& fn)
+{
+    if (count == 0) {
+        return;
+    }
+    if (workers.empty() || count == 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    // 1) Publish the job
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobFn = &fn;
+        jobCount = count;
+        nextIndex.store(0);
+        generation++;
+    }
+    wakeCv.notify_all();
+
+    // 2) Help out, then wait for workers still inside the job.
+    //    A worker registers (activeWorkers++) under the same lock it reads the
+    //    generation with, so nobody can still be using fn once this returns.
+    runJob();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [&] { return activeWorkers == 0; });
+    jobFn = nullptr;
+    jobCount = 0;
+}
+
+void ThreadPool::runJob()
+{
+    for (;;) {
+        uint32_t i = nextIndex.fetch_add(1);
+        if (i >= jobCount) {
+            break;
+        }
+        (*jobFn)(i);
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    uint64_t seen = 0;
+    for (;;) {
+        std::unique_lock<std::mutex> lock(mutex);
+        wakeCv.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping) {
+            return;
+        }
+        seen = generation;
+        if (jobFn == nullptr) {
+            // Woke up after the job already finished
+            continue;
+        }
+        activeWorkers++;
+        lock.unlock();
+
+        runJob();
+
+        lock.lock();
+        if (--activeWorkers == 0) {
+            doneCv.notify_all();
+        }
+    }
+}
@@ -0,0 +1,51 @@
+// ThreadPool.h
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+/*
+  Fixed set of worker threads for data-parallel loops.
+  parallelFor(count, fn) runs fn(0..count-1) spread over the workers and the
+  calling thread, and returns when every index is done. Indices are handed out
+  one at a time, so uneven work (e.g. image tiles) balances itself.
+  fn must not throw.
+*/
+class ThreadPool {
+public:
+    // 0 = one thread per hardware thread (the caller counts as one)
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    unsigned getThreadCount() const { return (unsigned)workers.size() + 1; }
+
+    void parallelFor(uint32_t count, const std::function<void(uint32_t)>& fn);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    void workerLoop();
+    void runJob();
+
+    std::vector<std::thread> workers;
+    std::mutex               mutex;
+    std::condition_variable  wakeCv;
+    std::condition_variable  doneCv;
+
+    // Current job, published under the mutex by bumping generation
+    const std::function<void(uint32_t)>* jobFn = nullptr;
+    uint32_t              jobCount = 0;
+    std::atomic<uint32_t> nextIndex{ 0 };
+    uint64_t              generation = 0;
+    unsigned              activeWorkers = 0;
+    bool                  stopping = false;
+};
+
+#endif // THREAD_POOL_H
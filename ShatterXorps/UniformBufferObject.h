@@ -4,8 +4,10 @@
 
 #include <glm/glm.hpp>
 
+// Per-frame camera block (set=0, binding=0, one buffer + set per swapchain
+// image). Per-draw data (model matrix, material) is pushed instead, see
+// GraphicsPipeline::PushConstants.
 struct UniformBufferObject {
-    glm::mat4 model;
     glm::mat4 view;
     glm::mat4 proj;
 };
@@ -0,0 +1,59 @@
+// UpscalePass.h
+#ifndef UPSCALE_PASS_H
+#define UPSCALE_PASS_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+
+class PhysicalDevice;
+
+/*
+  UpscalePass is a compute pass (shaders/upscale.comp) that takes the traced
+  sub-rect of the PixelTracer image and writes a display-resolution RGBA16F
+  image: bilinear filtering followed by an edge-aware sharpen.
+
+  The source image must be in SHADER_READ_ONLY_OPTIMAL when record() runs.
+  record() leaves the output in SHADER_READ_ONLY_OPTIMAL for fragment shaders.
+*/
+class UpscalePass {
+public:
+    UpscalePass() = default;
+    ~UpscalePass() = default;
+
+    void create(VkDevice device, PhysicalDevice& physDevice,
+        VkImageView srcView, VkExtent2D srcSize, VkExtent2D dstSize);
+    void destroy(VkDevice device);
+
+    // Upscale the top-left srcExtent region of the source to the full output
+    void record(VkCommandBuffer cb, VkExtent2D srcExtent);
+    // Only the dispatch: the output must already be in GENERAL, the caller
+    // (RenderGraph) owns the barriers
+    void recordDispatch(VkCommandBuffer cb, VkExtent2D srcExtent);
+
+    void setSharpness(float s) { sharpness = s; }
+
+    VkImage     getOutputImage() const { return outputImage; }
+    VkImageView getOutputImageView() const { return outputImageView; }
+
+private:
+    VkPipeline            pipeline = VK_NULL_HANDLE;
+    VkPipelineLayout      pipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool      descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet       descriptorSet = VK_NULL_HANDLE;
+    VkSampler             linearSampler = VK_NULL_HANDLE;
+
+    VkImage        outputImage = VK_NULL_HANDLE;
+    VkDeviceMemory outputMemory = VK_NULL_HANDLE;
+    VkImageView    outputImageView = VK_NULL_HANDLE;
+
+    VkExtent2D srcSize{ 0, 0 };
+    VkExtent2D dstSize{ 0, 0 };
+    float      sharpness = 0.5f;
+
+    VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
+    std::vector<char> readFile(const std::string& filename);
+};
+
+#endif // UPSCALE_PASS_H
@@ -4,6 +4,15 @@
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
 #include <array>
+#include <vector>
+
+// Per-instance data for instanced draws (binding=1, instance rate):
+// the model matrix, read by instanced.vert as 4 vec4 columns, and the
+// MaterialTable index
+struct InstanceData {
+    glm::mat4 model;
+    uint32_t  materialIndex = 0;   // MaterialTable::DEFAULT_MATERIAL
+};
 
 struct Vertex {
     // We now store position, color, AND normal
@@ -48,6 +57,72 @@ struct Vertex {
 
         return ads;
     }
+
+    // Position-only stream for depth-only passes (shadow cascades / atlas,
+    // depth prepass): tightly packed vec3s, 12 bytes per vertex instead of
+    // sizeof(Vertex) = 36, so vertex fetch moves a third of the data.
+    //   location=0 => position
+    static VkVertexInputBindingDescription getPositionBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 0;
+        bindingDescription.stride = sizeof(glm::vec3);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescription;
+    }
+
+    static VkVertexInputAttributeDescription getPositionAttributeDescription() {
+        VkVertexInputAttributeDescription ad{};
+        ad.binding = 0;
+        ad.location = 0;
+        ad.format = VK_FORMAT_R32G32B32_SFLOAT;
+        ad.offset = 0;
+        return ad;
+    }
+
+    // Instanced draws: binding=0 is the vertex stream above, binding=1 steps
+    // once per instance through InstanceData
+    static std::array<VkVertexInputBindingDescription, 2> getInstancedBindingDescriptions() {
+        std::array<VkVertexInputBindingDescription, 2> bindings{};
+        bindings[0] = getBindingDescription();
+
+        bindings[1].binding = 1;
+        bindings[1].stride = sizeof(InstanceData);
+        bindings[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        return bindings;
+    }
+
+    // getAttributeDescriptions() plus
+    //   location=3..6 => InstanceData::model columns 0..3
+    //   location=7    => InstanceData::materialIndex
+    static std::array<VkVertexInputAttributeDescription, 8> getInstancedAttributeDescriptions() {
+        std::array<VkVertexInputAttributeDescription, 8> ads{};
+        auto perVertex = getAttributeDescriptions();
+        for (size_t i = 0; i < perVertex.size(); i++) {
+            ads[i] = perVertex[i];
+        }
+        for (uint32_t column = 0; column < 4; column++) {
+            ads[3 + column].binding = 1;
+            ads[3 + column].location = 3 + column;
+            ads[3 + column].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            ads[3 + column].offset = offsetof(InstanceData, model) + column * sizeof(glm::vec4);
+        }
+        ads[7].binding = 1;
+        ads[7].location = 7;
+        ads[7].format = VK_FORMAT_R32_UINT;
+        ads[7].offset = offsetof(InstanceData, materialIndex);
+        return ads;
+    }
+
+    // Builds the position-only stream of a mesh (same vertex order, so the
+    // index buffer is shared with the full stream)
+    static std::vector<glm::vec3> extractPositions(const std::vector<Vertex>& vertices) {
+        std::vector<glm::vec3> positions;
+        positions.reserve(vertices.size());
+        for (const Vertex& v : vertices) {
+            positions.push_back(v.position);
+        }
+        return positions;
+    }
 };
 
 #endif // VERTEX_H
@@ -105,7 +105,27 @@ void VulkanInstance::createAppInfo(const std::string& appName, uint32_t appVersi
     appInfo.applicationVersion = appVersion;
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+
+    // Ask for 1.2 when the loader has it (ray queries need SPIR-V 1.4 and
+    // buffer device addresses), otherwise stay on what's there
+    apiVersion = queryInstanceApiVersion();
+    if (apiVersion > VK_API_VERSION_1_2) {
+        apiVersion = VK_API_VERSION_1_2;
+    }
+    appInfo.apiVersion = apiVersion;
+}
+
+uint32_t VulkanInstance::queryInstanceApiVersion() {
+    // vkEnumerateInstanceVersion doesn't exist on 1.0 loaders, so look it up
+    auto func = (PFN_vkEnumerateInstanceVersion)
+        vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceVersion");
+
+    uint32_t version = VK_API_VERSION_1_0;
+    if (func != nullptr && func(&version) == VK_SUCCESS) {
+        // Drop the patch number, only major.minor matter here
+        return VK_MAKE_API_VERSION(0, VK_API_VERSION_MAJOR(version), VK_API_VERSION_MINOR(version), 0);
+    }
+    return VK_API_VERSION_1_0;
 }
 
 bool VulkanInstance::checkValidationLayerSupport() {
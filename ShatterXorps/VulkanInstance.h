@@ -13,11 +13,15 @@ public:
 
     VkInstance getInstance() const { return instance; }
 
+    // API version requested in VkApplicationInfo (loader version, capped at 1.2)
+    uint32_t getApiVersion() const { return apiVersion; }
+
 private:
     VkInstance instance;
     VkApplicationInfo appInfo;
     VkInstanceCreateInfo createInfo;
     VkDebugUtilsMessengerEXT debugMessenger;
+    uint32_t apiVersion = VK_API_VERSION_1_0;
 
     std::vector<const char*> requiredExtensions;
     std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" };
@@ -26,6 +30,7 @@ private:
 
     void setupDebugMessenger();
     void createAppInfo(const std::string& appName, uint32_t appVersion);
+    static uint32_t queryInstanceApiVersion();
     void createInstance();
 
     // Debug callback
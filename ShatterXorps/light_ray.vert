@@ -6,18 +6,22 @@ layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormal;
 
-// UBO (set 0, binding 0)
+// Camera UBO (set 0, binding 0): the main pass's per-frame set
 layout(set = 0, binding = 0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
 } ubo;
 
+// LightRayPipeline::PushConstants
+layout(push_constant) uniform LightRayPush {
+    mat4 model;
+} pc;
+
 // Output to fragment shader
 layout(location = 0) out vec3 fragColor;
 
 void main() {
     // Multiply the vertex position by the full MVP matrix
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = ubo.proj * ubo.view * pc.model * vec4(inPosition, 1.0);
     fragColor = inColor; // Pass along the vertex color (or you can compute something else)
 }
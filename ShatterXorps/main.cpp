@@ -12,6 +12,7 @@
 #include "SwapChain.h"
 #include "RenderPass.h"
 #include "GraphicsPipeline.h"
+#include "DepthPrepassPipeline.h"
 #include "ShadowPipeline.h"
 #include "CommandPool.h"
 #include "CommandBuffer.h"
@@ -22,6 +23,26 @@
 #include "PixelTracer.h"
 #include "CylinderMesh.h"
 #include "LightRayPipeline.h"
+#include "DynamicResolution.h"
+#include "UpscalePass.h"
+#include "CpuRayTracer.h"
+#include "ThreadPool.h"
+#include "AccelerationStructure.h"
+#include "CascadedShadowMap.h"
+#include "ShadowAtlas.h"
+#include "EvsmShadowMap.h"
+#include "ClusteredLights.h"
+#include "DeferredRenderer.h"
+#include "RenderGraph.h"
+#include "GpuScene.h"
+#include "Frustum.h"
+#include "FrustumCuller.h"
+#include "DynamicAabbTree.h"
+#include "ScenePicker.h"
+#include "IdBufferPicker.h"
+#include "InstanceBatch.h"
+#include "BindlessDescriptors.h"
+#include "MaterialTable.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -37,6 +58,8 @@
 #include <vector>
 #include <cstdlib>
 #include <set>
+#include <random>
+#include <memory>
 
 // -------------------------------------------------------------------------------------
 // Variables for "selected object" and camera speed, etc.
@@ -108,128 +131,186 @@ static const std::vector<Vertex> planeVertices = {
 };
 static const std::vector<uint16_t> planeIndices = { 0,1,2, 2,3,0 };
 
-// Minimal struct for “shadow pass”
-struct ShadowResources {
-    VkImage        depthImage = VK_NULL_HANDLE;
-    VkDeviceMemory depthMemory = VK_NULL_HANDLE;
-    VkImageView    depthView = VK_NULL_HANDLE;
-    VkFramebuffer  framebuffer = VK_NULL_HANDLE;
-    VkExtent2D     extent;
-};
+// Object-space bounds for shadow caster culling
+static const Aabb cubeBounds = Aabb::fromVertices(cubeVertices);
+static const Aabb planeBounds = Aabb::fromVertices(planeVertices);
+
+// Scene object ids: userData of the scene tree proxies, pick results
+enum SceneObject : uint32_t { SceneCube = 0, ScenePlane = 1 };
+static uint32_t g_selectedObject = SceneCube;
+
+// The cube moves with g_selectedObjectPos, the plane stays where the cube
+// starts: it's the static caster of the shadow cache
+static const glm::mat4 g_planeModel = glm::translate(glm::mat4(1.f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+// Headless path: traces the PixelTracer scene on the CPU (no window, no Vulkan).
+// Checks every SIMD path against the scalar reference, prints timings and
+// writes cpu_trace.ppm / cpu_trace.pfm.
+static int runCpuTrace(uint32_t width, uint32_t height)
+{
+    ThreadPool pool;
+    std::cout << "CPU trace " << width << "x" << height << " on " << pool.getThreadCount() << " threads\n";
+
+    CpuRayTracer reference(width, height);
+    reference.setSimdPath(CpuRayTracer::SimdPath::Scalar);
+
+    const CpuRayTracer::SimdPath paths[] = {
+        CpuRayTracer::SimdPath::Scalar, CpuRayTracer::SimdPath::SSE, CpuRayTracer::SimdPath::AVX2
+    };
+    CpuRayTracer tracer(width, height);
+    for (CpuRayTracer::SimdPath path : paths) {
+        if ((int)path > (int)CpuRayTracer::bestSimdPath()) {
+            continue;
+        }
+        CpuRayTracer& target = (path == CpuRayTracer::SimdPath::Scalar) ? reference : tracer;
+        target.setSimdPath(path);
+
+        // Best of a few runs, the first one also warms up the pool
+        float bestMs = 1e9f;
+        for (int run = 0; run < 5; run++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            target.render(pool);
+            auto end = std::chrono::high_resolution_clock::now();
+            bestMs = std::min(bestMs, std::chrono::duration<float, std::milli>(end - start).count());
+        }
+        std::cout << "  " << CpuRayTracer::simdPathName(path) << ": " << bestMs << " ms";
 
-void recordShadowCommandBuffer(
-    VkCommandBuffer   cmd,
-    VkRenderPass      shadowRenderPass,
-    VkFramebuffer     shadowFramebuffer,
-    VkExtent2D        shadowExtent,
-    VkPipeline        shadowPipeline,
-    VkPipelineLayout  shadowPipelineLayout,
-    VkBuffer          vertexBuffer,
-    VkBuffer          indexBuffer,
-    uint32_t          indexCount,
-    VkDescriptorSet   shadowDescriptorSet,
-    const ShadowResources& shadowRes
-) {
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to begin shadow command buffer!");
+        if (&target != &reference) {
+            CpuRayTracer::CompareResult diff = CpuRayTracer::compare(
+                reference.getPixels().data(), tracer.getPixels().data(), (size_t)width * height, 1e-5f);
+            std::cout << " | max error " << diff.maxError << ", " << diff.mismatches << " mismatched pixels";
+        }
+        std::cout << std::endl;
     }
 
-    VkClearValue clearDepth{};
-    clearDepth.depthStencil = { 1.f, 0 };
-
-    VkRenderPassBeginInfo rpBegin{};
-    rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    rpBegin.renderPass = shadowRenderPass;
-    rpBegin.framebuffer = shadowFramebuffer;
-    rpBegin.renderArea.offset = { 0, 0 };
-    rpBegin.renderArea.extent = shadowExtent;
-    rpBegin.clearValueCount = 1;
-    rpBegin.pClearValues = &clearDepth;
-
-    vkCmdBeginRenderPass(cmd, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
-
-    // Bind shadow pipeline
-    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, shadowPipeline);
-
-    // Flip Y in the viewport
-    VkViewport vp{};
-    vp.x = 0.f;
-    vp.y = (float)shadowExtent.height;
-    vp.width = (float)shadowExtent.width;
-    vp.height = -(float)shadowExtent.height; // negative to flip
-    vp.minDepth = 0.f;
-    vp.maxDepth = 1.f;
-    vkCmdSetViewport(cmd, 0, 1, &vp);
-
-    VkRect2D scissor{};
-    scissor.offset = { 0,0 };
-    scissor.extent = shadowExtent;
-    vkCmdSetScissor(cmd, 0, 1, &scissor);
-
-    // Depth bias
-    vkCmdSetDepthBias(cmd, 1.25f, 0.f, 1.75f);
-
-    // Bind geometry
-    VkDeviceSize offsets[] = { 0 };
-    vkCmdBindVertexBuffers(cmd, 0, 1, &vertexBuffer, offsets);
-    vkCmdBindIndexBuffer(cmd, indexBuffer, 0, VK_INDEX_TYPE_UINT16);
-
-    // Bind the single set=0 for shadow
-    vkCmdBindDescriptorSets(
-        cmd,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
-        shadowPipelineLayout,
-        0, /* firstSet=0 */
-        1, &shadowDescriptorSet,
-        0, nullptr
-    );
-
-    vkCmdDrawIndexed(cmd, indexCount, 1, 0, 0, 0);
-
-    vkCmdEndRenderPass(cmd);
-
-    // Transition depth to SHADER_READ_ONLY_OPTIMAL
-    {
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = shadowRes.depthImage;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        vkCmdPipelineBarrier(
-            cmd,
-            VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier
-        );
+    reference.writePPM("cpu_trace.ppm");
+    reference.writePFM("cpu_trace.pfm");
+    std::cout << "Wrote cpu_trace.ppm / cpu_trace.pfm" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+// Headless path: FrustumCuller over objectCount random boxes / spheres.
+// Checks every SIMD path against the scalar one and prints timings.
+static int runCullBenchmark(uint32_t objectCount)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.1f, 3.0f);
+
+    FrustumCuller culler;
+    for (uint32_t i = 0; i < objectCount; i++) {
+        glm::vec3 c(position(rng), position(rng), position(rng));
+        if (i & 1) {
+            glm::vec3 e(size(rng), size(rng), size(rng));
+            culler.addAabb(Aabb{ c - e, c + e });
+        }
+        else {
+            culler.addSphere(c, size(rng));
+        }
+    }
+
+    // Same camera setup as the main loop, looking down -z from the origin
+    glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    glm::mat4 proj = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 100.f);
+    proj[1][1] *= -1.f;
+    const Frustum frustum(proj * view);
+
+    std::cout << "Frustum culling " << objectCount << " objects\n";
+
+    const FrustumCuller::SimdPath paths[] = {
+        FrustumCuller::SimdPath::Scalar, FrustumCuller::SimdPath::SSE, FrustumCuller::SimdPath::AVX2
+    };
+    std::vector<uint32_t> reference;
+    for (FrustumCuller::SimdPath path : paths) {
+        if ((int)path > (int)FrustumCuller::bestSimdPath()) {
+            continue;
+        }
+        culler.setSimdPath(path);
+
+        float bestMs = 1e9f;
+        for (int run = 0; run < 20; run++) {
+            auto start = std::chrono::high_resolution_clock::now();
+            culler.cull(frustum);
+            auto end = std::chrono::high_resolution_clock::now();
+            bestMs = std::min(bestMs, std::chrono::duration<float, std::milli>(end - start).count());
+        }
+        const std::vector<uint32_t>& visible = culler.getVisible();
+        std::cout << "  " << FrustumCuller::simdPathName(path) << ": " << bestMs << " ms, "
+            << visible.size() << " visible";
+
+        if (path == FrustumCuller::SimdPath::Scalar) {
+            reference = visible;
+        }
+        else {
+            std::cout << (visible == reference ? " | matches scalar" : " | MISMATCH vs scalar");
+        }
+        std::cout << std::endl;
     }
 
-    if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to end shadow command buffer!");
+    // Same objects through the BVH (boxes only, spheres as their bounding box)
+    DynamicAabbTree tree(0.0f);
+    auto buildStart = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < objectCount; i++) {
+        tree.createProxy(culler.getBounds(i), i);
     }
+    auto buildEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "  BVH build: " << std::chrono::duration<float, std::milli>(buildEnd - buildStart).count()
+        << " ms, height " << tree.getHeight() << std::endl;
+
+    std::vector<uint32_t> treeVisible;
+    float bestMs = 1e9f;
+    for (int run = 0; run < 20; run++) {
+        treeVisible.clear();
+        auto start = std::chrono::high_resolution_clock::now();
+        tree.queryFrustum(frustum, [&](int32_t proxy) { treeVisible.push_back(tree.getUserData(proxy)); });
+        auto end = std::chrono::high_resolution_clock::now();
+        bestMs = std::min(bestMs, std::chrono::duration<float, std::milli>(end - start).count());
+    }
+    // The tree tests boxes, so it may keep a few spheres the culler drops,
+    // but must never lose one
+    std::sort(treeVisible.begin(), treeVisible.end());
+    bool superset = std::includes(treeVisible.begin(), treeVisible.end(), reference.begin(), reference.end());
+    std::cout << "  BVH query: " << bestMs << " ms, " << treeVisible.size() << " visible"
+        << (superset ? " | covers scalar" : " | MISSES objects vs scalar") << std::endl;
+    return EXIT_SUCCESS;
 }
 
-
-int main()
+int main(int argc, char** argv)
 {
+    // --cpu-trace [width height] => render on the CPU only and exit
+    // --cull-bench [count]       => time FrustumCuller and exit
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--cull-bench") {
+            uint32_t count = 100000;
+            if (i + 1 < argc) {
+                count = (uint32_t)std::max(1, std::atoi(argv[i + 1]));
+            }
+            return runCullBenchmark(count);
+        }
+        if (std::string(argv[i]) == "--cpu-trace") {
+            uint32_t w = 512, h = 512;
+            if (i + 2 < argc) {
+                w = (uint32_t)std::max(1, std::atoi(argv[i + 1]));
+                h = (uint32_t)std::max(1, std::atoi(argv[i + 2]));
+            }
+            try {
+                return runCpuTrace(w, h);
+            }
+            catch (std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
     GLFWwindow* window = nullptr;
     try {
         // Init window & callbacks
-        if (!glfwInit()) throw std::runtime_error("Failed to init GLFW");
+        if (!glfwInit()) {
+            // No display (headless server): fall back to the CPU tracer
+            std::cerr << "Failed to init GLFW, falling back to the CPU tracer" << std::endl;
+            return runCpuTrace(512, 512);
+        }
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
         glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
         window = glfwCreateWindow(800, 600, "Vulkan Window", nullptr, nullptr);
@@ -240,40 +321,112 @@ int main()
         // Hide cursor for FPS camera by default; toggle with CTRL
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-        // 1) Vulkan instance
-        std::vector<const char*> extensions; // none required externally
-        VulkanInstance vulkanInstance("My Vulkan App", VK_MAKE_VERSION(1, 0, 0), extensions);
-        VkInstance instance = vulkanInstance.getInstance();
+        // 1) Vulkan instance, 2) window surface, 3) physical + logical device.
+        // No Vulkan driver, or no GPU / queue that meets the requirements:
+        // fall back to the CPU tracer like a missing display does.
+        std::unique_ptr<VulkanInstance> vulkanInstancePtr;
+        std::unique_ptr<PhysicalDevice> physicalDevicePtr;
+        VkSurfaceKHR surface = VK_NULL_HANDLE;
+        try {
+            std::vector<const char*> extensions; // none required externally
+            vulkanInstancePtr = std::make_unique<VulkanInstance>("My Vulkan App", VK_MAKE_VERSION(1, 0, 0), extensions);
+
+            if (glfwCreateWindowSurface(vulkanInstancePtr->getInstance(), window, nullptr, &surface) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create window surface!");
+            }
 
-        // 2) Create a window surface
-        VkSurfaceKHR surface;
-        if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create window surface!");
+            physicalDevicePtr = std::make_unique<PhysicalDevice>(vulkanInstancePtr->getInstance(), surface,
+                vulkanInstancePtr->getApiVersion());
         }
-
-        // 3) Physical + logical device
-        PhysicalDevice physicalDevice(instance, surface);
+        catch (std::exception& e) {
+            std::cerr << "No usable Vulkan device (" << e.what() << "), falling back to the CPU tracer" << std::endl;
+            if (surface != VK_NULL_HANDLE) {
+                vkDestroySurfaceKHR(vulkanInstancePtr->getInstance(), surface, nullptr);
+            }
+            vulkanInstancePtr.reset();
+            glfwDestroyWindow(window);
+            window = nullptr;
+            glfwTerminate();
+            return runCpuTrace(512, 512);
+        }
+        VkInstance instance = vulkanInstancePtr->getInstance();
+        PhysicalDevice& physicalDevice = *physicalDevicePtr;
         VkDevice device = physicalDevice.getDevice();
 
+        // Ray-query shadows when the device has them, shadow map / analytic test otherwise
+        const bool useRayQuery = physicalDevice.supportsRayQuery();
+        std::cout << "Ray query shadows: " << (useRayQuery ? "on" : "off (fallback)") << std::endl;
+
+        // Bindless materials when the device has descriptor indexing: one
+        // texture / buffer array at set=3, vertex colors only otherwise
+        const bool useBindless = physicalDevice.supportsDescriptorIndexing();
+        BindlessDescriptors bindless;
+        if (useBindless) {
+            bindless.create(device, physicalDevice);
+        }
+        std::cout << "Bindless materials: " << (useBindless ? "on" : "off (fallback)") << std::endl;
+
+        // Dynamic rendering when the device has it: the main pass renders
+        // straight into the swapchain / depth views, no VkRenderPass or framebuffers
+        const bool useDynamicRendering = physicalDevice.supportsDynamicRendering();
+
         // 4) SwapChain
-        SwapChain swapChain(physicalDevice, device, surface, window);
+        SwapChain swapChain(physicalDevice, device, surface, window, useDynamicRendering);
 
         // 5) Main color & shadow RenderPass
         RenderPass renderPass(device,
             physicalDevice.getPhysicalDevice(),
-            swapChain.getSwapChainImageFormat());
+            swapChain.getSwapChainImageFormat(),
+            true,
+            useDynamicRendering);
 
         // 6) The main GraphicsPipeline (2 sets: set=0=UBO, set=1=sampler)
         GraphicsPipeline graphicsPipeline(
             device,
             swapChain.getSwapChainExtent(),
-            renderPass.getRenderPass()
+            renderPass.getRenderPass(),
+            useRayQuery,
+            renderPass.getPipelineRenderingInfo(),
+            useBindless ? bindless.getSetLayout() : VK_NULL_HANDLE
         );
-        swapChain.createFramebuffers(renderPass.getRenderPass());
+        if (!useDynamicRendering) {
+            swapChain.createFramebuffers(renderPass.getRenderPass());
+        }
 
         // 7) Command pool
         CommandPool commandPool(device, physicalDevice.getGraphicsQueueFamilyIndex());
 
+        VkQueue graphicsQueue;
+        vkGetDeviceQueue(device, physicalDevice.getGraphicsQueueFamilyIndex(), 0, &graphicsQueue);
+
+        // Materials of the scene objects (indexed by SceneObject), pushed as
+        // PushConstants::materialIndex. Two checker textures in the bindless
+        // array; without bindless every object keeps the default material.
+        MaterialTable materials;
+        std::array<uint32_t, 2> sceneMaterials = { MaterialTable::DEFAULT_MATERIAL, MaterialTable::DEFAULT_MATERIAL };
+        if (useBindless) {
+            materials.create(device, physicalDevice, bindless);
+            uint32_t fineChecker = materials.addTexture(device, physicalDevice, bindless,
+                commandPool.getCommandPool(), graphicsQueue,
+                64, 64, MaterialTable::makeChecker(64, 8, 0xFFFFFFFFu, 0xFFA0A0A0u));
+            uint32_t floorChecker = materials.addTexture(device, physicalDevice, bindless,
+                commandPool.getCommandPool(), graphicsQueue,
+                64, 64, MaterialTable::makeChecker(64, 2, 0xFFFFFFFFu, 0xFF806050u));
+
+            MaterialTable::Material cubeMaterial;
+            cubeMaterial.textures.x = fineChecker;
+            cubeMaterial.params.x = 1.0f;
+            sceneMaterials[SceneCube] = materials.addMaterial(cubeMaterial);
+
+            MaterialTable::Material planeMaterial;
+            planeMaterial.baseColor = glm::vec4(0.9f, 0.95f, 1.0f, 1.0f);
+            planeMaterial.textures.x = floorChecker;
+            planeMaterial.params.x = 0.5f;
+            sceneMaterials[ScenePlane] = materials.addMaterial(planeMaterial);
+            std::cout << "Bindless: " << bindless.getTextureCount() << "/" << bindless.getTextureCapacity()
+                << " textures, " << materials.getMaterialCount() << " materials" << std::endl;
+        }
+
         // ----------------------------------------------------------------------
         // Create geometry for the “cube”
         // ----------------------------------------------------------------------
@@ -292,6 +445,23 @@ int main()
             vkUnmapMemory(device, vertexBuffer.getMemory());
         }
 
+        // Position-only stream for the depth-only passes (12 bytes per vertex)
+        auto cubePositions = Vertex::extractPositions(cubeVertices);
+        VkDeviceSize cubePosSize = sizeof(glm::vec3) * cubePositions.size();
+        Buffer cubePositionBuffer(
+            device,
+            physicalDevice,
+            cubePosSize,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        {
+            void* data = nullptr;
+            vkMapMemory(device, cubePositionBuffer.getMemory(), 0, cubePosSize, 0, &data);
+            memcpy(data, cubePositions.data(), (size_t)cubePosSize);
+            vkUnmapMemory(device, cubePositionBuffer.getMemory());
+        }
+
         VkDeviceSize ibSize = sizeof(cubeIndices[0]) * cubeIndices.size();
         Buffer indexBuffer(
             device,
@@ -356,6 +526,20 @@ int main()
             vkUnmapMemory(device, planeVertexBuffer.getMemory());
         }
 
+        auto planePositions = Vertex::extractPositions(planeVertices);
+        VkDeviceSize planePosSize = sizeof(glm::vec3) * planePositions.size();
+        Buffer planePositionBuffer(
+            device, physicalDevice, planePosSize,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        {
+            void* data = nullptr;
+            vkMapMemory(device, planePositionBuffer.getMemory(), 0, planePosSize, 0, &data);
+            memcpy(data, planePositions.data(), planePosSize);
+            vkUnmapMemory(device, planePositionBuffer.getMemory());
+        }
+
         VkDeviceSize planeIBSize = sizeof(uint16_t) * planeIndices.size();
         Buffer planeIndexBuffer(
             device, physicalDevice, planeIBSize,
@@ -369,6 +553,21 @@ int main()
             vkUnmapMemory(device, planeIndexBuffer.getMemory());
         }
 
+        // ----------------------------------------------------------------------
+        // Acceleration structures for ray-query shadows: one BLAS per mesh,
+        // the TLAS is rebuilt each frame in the compute pass (objects move)
+        // ----------------------------------------------------------------------
+        AccelerationStructure sceneAccel;
+        uint32_t cubeMeshIndex = 0;
+        uint32_t planeMeshIndex = 0;
+        if (useRayQuery) {
+            sceneAccel.create(device, physicalDevice);
+            cubeMeshIndex = sceneAccel.addMesh(cubeVertices, cubeIndices);
+            planeMeshIndex = sceneAccel.addMesh(planeVertices, planeIndices);
+            sceneAccel.buildMeshes(device, commandPool.getCommandPool(), graphicsQueue);
+            sceneAccel.createTopLevel(device, 2);
+        }
+
         // ----------------------------------------------------------------------
         // UBO for main pass (set=0 => camera+model, set=1 => sampler)
         // ----------------------------------------------------------------------
@@ -385,10 +584,8 @@ int main()
             );
         }
 
-        // Light UBO: a small struct with a light matrix
-        struct LightData {
-            glm::mat4 lightViewProj;
-        };
+        // Light UBO: cascade matrices + splits + light direction (shader.frag LightUBO)
+        using LightData = CascadedShadowMap::GpuData;
         VkDeviceSize lightUboSize = sizeof(LightData);
 
         std::vector<Buffer> lightBuffers;
@@ -479,15 +676,22 @@ int main()
         VkSampler        samplerCompute;
         VkSampler        samplerShadowMap;
         {
-            // We need 2 combined image samplers: one for compute, one for shadow
-            VkDescriptorPoolSize poolSize{};
-            poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            poolSize.descriptorCount = 2;
+            // We need 4 combined image samplers: compute, shadow cascades, shadow atlas,
+            // EVSM moments + the local light SSBO + the clustered lights (params UBO,
+            // light and cell SSBOs) (+ the scene TLAS at binding=2 with ray queries)
+            std::vector<VkDescriptorPoolSize> poolSizes = {
+                { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 },
+                { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 },
+                { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 }
+            };
+            if (useRayQuery) {
+                poolSizes.push_back({ VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1 });
+            }
 
             VkDescriptorPoolCreateInfo poolInfo{};
             poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-            poolInfo.poolSizeCount = 1;
-            poolInfo.pPoolSizes = &poolSize;
+            poolInfo.poolSizeCount = (uint32_t)poolSizes.size();
+            poolInfo.pPoolSizes = poolSizes.data();
             poolInfo.maxSets = 1;
 
             if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPoolSampler) != VK_SUCCESS) {
@@ -510,15 +714,30 @@ int main()
                 }
             }
             {
+                // Comparison sampler (sampler2DArrayShadow): with LINEAR filtering
+                // every fetch returns a hardware 2x2 PCF result. Linear filtering
+                // of D32 is optional, fall back to NEAREST if the device lacks it.
+                VkFormatProperties depthProps;
+                vkGetPhysicalDeviceFormatProperties(physicalDevice.getPhysicalDevice(),
+                    VK_FORMAT_D32_SFLOAT, &depthProps);
+                bool linearDepth = (depthProps.optimalTilingFeatures &
+                    VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0;
+
                 VkSamplerCreateInfo info{};
                 info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-                info.magFilter = VK_FILTER_NEAREST;
-                info.minFilter = VK_FILTER_NEAREST;
-                info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-                info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+                info.magFilter = linearDepth ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+                info.minFilter = linearDepth ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+                // Outside the cascade => white border => lit
+                info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+                info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
                 info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-                info.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+                info.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+                info.compareEnable = VK_TRUE;
+                info.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL; // lit when ref <= stored
                 info.unnormalizedCoordinates = VK_FALSE;
+                if (!linearDepth) {
+                    std::cout << "D32 linear filtering not supported, shadow taps are unfiltered" << std::endl;
+                }
                 if (vkCreateSampler(device, &info, nullptr, &samplerShadowMap) != VK_SUCCESS) {
                     throw std::runtime_error("Failed to create sampler for shadow map!");
                 }
@@ -535,15 +754,53 @@ int main()
             if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSetSampler) != VK_SUCCESS) {
                 throw std::runtime_error("Failed to allocate set=1 sampler descriptor set!");
             }
+
+            // binding=2 => scene TLAS for the ray query fragment shader
+            if (useRayQuery) {
+                VkAccelerationStructureKHR tlas = sceneAccel.getTopLevel();
+                VkWriteDescriptorSetAccelerationStructureKHR tlasInfo{};
+                tlasInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+                tlasInfo.accelerationStructureCount = 1;
+                tlasInfo.pAccelerationStructures = &tlas;
+
+                VkWriteDescriptorSet write{};
+                write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                write.pNext = &tlasInfo;
+                write.dstSet = descriptorSetSampler;
+                write.dstBinding = 2;
+                write.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+                write.descriptorCount = 1;
+                vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+            }
         }
 
         // Create the compute pass (PixelTracer) and set=1 => binding=0 for its image
+        // Half-float output halves write/sample bandwidth vs RGBA32F. Other options:
+        // VK_FORMAT_B10G11R11_UFLOAT_PACK32 (4 B/px, no alpha), VK_FORMAT_R8G8B8A8_UNORM (4 B/px, LDR)
+        // The image is allocated at display size, DynamicResolution picks how much
+        // of it is traced each frame and UpscalePass stretches that back to display size.
+        VkExtent2D displayExtent = swapChain.getSwapChainExtent();
         PixelTracer pixelTracer;
-        pixelTracer.create(device, physicalDevice, 512, 512);
-        {
+        pixelTracer.create(device, physicalDevice, displayExtent.width, displayExtent.height,
+            VK_FORMAT_R16G16B16A16_SFLOAT, PixelTracer::PipelineConfig(),
+            useRayQuery ? sceneAccel.getTopLevel() : VK_NULL_HANDLE);
+        std::cout << "PixelTracer output format: " << PixelTracer::formatName(pixelTracer.getOutputFormat()) << std::endl;
+
+        // Trace budget in ms of GPU time (timestamps around the trace dispatch)
+        DynamicResolution dynamicResolution;
+        dynamicResolution.create(device, physicalDevice, displayExtent.width, displayExtent.height, 4.0f);
+        if (!dynamicResolution.isSupported()) {
+            std::cout << "Timestamps not supported, tracing at full resolution" << std::endl;
+        }
+
+        UpscalePass upscalePass;
+        upscalePass.create(device, physicalDevice, pixelTracer.getOutputImageView(),
+            pixelTracer.getMaxExtent(), displayExtent);
+        // Again after a resize recreated the upscale output
+        auto writeUpscaleDescriptor = [&]() {
             VkDescriptorImageInfo imgInfo{};
             imgInfo.sampler = samplerCompute;
-            imgInfo.imageView = pixelTracer.getOutputImageView();
+            imgInfo.imageView = upscalePass.getOutputImageView();
             imgInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
             VkWriteDescriptorSet write{};
@@ -555,7 +812,8 @@ int main()
             write.pImageInfo = &imgInfo;
 
             vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
-        }
+        };
+        writeUpscaleDescriptor();
 
         // Shadow pipeline (only 1 set => the “light UBO”)
         ShadowPipeline shadowPipeline;
@@ -563,78 +821,41 @@ int main()
             renderPass.getShadowRenderPass(),
             graphicsPipeline.getDescriptorSetLayoutUBO());
 
-        // Shadow resources: 2k x 2k
-        ShadowResources shadowRes;
+        // Cascaded shadow map: 4 x 1024^2 layers, same memory as the old
+        // single 2048^2 map but the texels are spent where the camera looks
+        CascadedShadowMap shadowCascades;
+        shadowCascades.create(device, physicalDevice, renderPass.getShadowRenderPass(), 1024, 4);
+        // FourTap is the cheapest, Poisson / Gather5x5 give softer edges
+        shadowCascades.setPcfKernel(CascadedShadowMap::PcfKernel::FourTap);
+        // Static casters (the plane) are cached between frames
+        shadowCascades.enableStaticCache(device, physicalDevice, commandPool.getCommandPool(), graphicsQueue);
+
+        // Filterable EVSM version of the cascades (PcfKernel::Evsm)
+        EvsmShadowMap evsmShadows;
+        evsmShadows.create(device, physicalDevice, shadowCascades, commandPool.getCommandPool(), graphicsQueue);
+        shadowCascades.setEvsmParams(evsmShadows.getExponents());
         {
-            shadowRes.extent = { 2048, 2048 };
-
-            VkImageCreateInfo imgInfo{};
-            imgInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-            imgInfo.imageType = VK_IMAGE_TYPE_2D;
-            imgInfo.extent = { shadowRes.extent.width, shadowRes.extent.height, 1 };
-            imgInfo.mipLevels = 1;
-            imgInfo.arrayLayers = 1;
-            imgInfo.format = VK_FORMAT_D32_SFLOAT;
-            imgInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-            imgInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            imgInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-            imgInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-            imgInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-            if (vkCreateImage(device, &imgInfo, nullptr, &shadowRes.depthImage) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to create shadow depth image!");
-            }
+            VkDescriptorImageInfo momentsInfo{};
+            momentsInfo.sampler = evsmShadows.getSampler();
+            momentsInfo.imageView = evsmShadows.getView();
+            momentsInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-            VkMemoryRequirements memReq;
-            vkGetImageMemoryRequirements(device, shadowRes.depthImage, &memReq);
-
-            VkMemoryAllocateInfo allocInfo{};
-            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            allocInfo.allocationSize = memReq.size;
-            allocInfo.memoryTypeIndex = physicalDevice.findMemoryType(
-                memReq.memoryTypeBits,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-            );
-            if (vkAllocateMemory(device, &allocInfo, nullptr, &shadowRes.depthMemory) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to allocate memory for shadow depth!");
-            }
-            vkBindImageMemory(device, shadowRes.depthImage, shadowRes.depthMemory, 0);
-
-            // Depth view
-            VkImageViewCreateInfo viewInfo{};
-            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-            viewInfo.image = shadowRes.depthImage;
-            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-            viewInfo.format = VK_FORMAT_D32_SFLOAT;
-            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-            viewInfo.subresourceRange.baseMipLevel = 0;
-            viewInfo.subresourceRange.levelCount = 1;
-            viewInfo.subresourceRange.baseArrayLayer = 0;
-            viewInfo.subresourceRange.layerCount = 1;
-            if (vkCreateImageView(device, &viewInfo, nullptr, &shadowRes.depthView) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to create shadow depth image view!");
-            }
+            VkWriteDescriptorSet w{};
+            w.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            w.dstSet = descriptorSetSampler;
+            w.dstBinding = 5; // binding=5 => EVSM moments
+            w.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            w.descriptorCount = 1;
+            w.pImageInfo = &momentsInfo;
 
-            // Framebuffer
-            VkImageView attachments[] = { shadowRes.depthView };
-            VkFramebufferCreateInfo fbInfo{};
-            fbInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-            fbInfo.renderPass = renderPass.getShadowRenderPass();
-            fbInfo.attachmentCount = 1;
-            fbInfo.pAttachments = attachments;
-            fbInfo.width = shadowRes.extent.width;
-            fbInfo.height = shadowRes.extent.height;
-            fbInfo.layers = 1;
-
-            if (vkCreateFramebuffer(device, &fbInfo, nullptr, &shadowRes.framebuffer) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to create shadow framebuffer!");
-            }
+            vkUpdateDescriptorSets(device, 1, &w, 0, nullptr);
         }
 
         // Update set=1 => binding=1 with the shadow map
         {
             VkDescriptorImageInfo shadowMapInfo{};
             shadowMapInfo.sampler = samplerShadowMap;
-            shadowMapInfo.imageView = shadowRes.depthView;
+            shadowMapInfo.imageView = shadowCascades.getArrayView();
             shadowMapInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
             VkWriteDescriptorSet w{};
@@ -648,6 +869,97 @@ int main()
             vkUpdateDescriptorSets(device, 1, &w, 0, nullptr);
         }
 
+        // Shadow atlas for the local spot lights: 2048^2, tiles of 64..512
+        // handed out by on-screen size every frame
+        ShadowAtlas shadowAtlas;
+        shadowAtlas.create(device, physicalDevice, renderPass.getShadowRenderPass(), 2048, 64, 512);
+
+        ShadowPipeline atlasPipeline;
+        atlasPipeline.create(device,
+            renderPass.getShadowRenderPass(),
+            shadowAtlas.getShadowSetLayout(),
+            "shaders/shadow_atlas.vert.spv");
+
+        // Update set=1 => binding=3 (light SSBO) and binding=4 (atlas)
+        {
+            VkDescriptorBufferInfo lightsInfo{};
+            lightsInfo.buffer = shadowAtlas.getLightBuffer();
+            lightsInfo.offset = 0;
+            lightsInfo.range = shadowAtlas.getLightBufferSize();
+
+            VkDescriptorImageInfo atlasInfo{};
+            atlasInfo.sampler = samplerShadowMap;
+            atlasInfo.imageView = shadowAtlas.getView();
+            atlasInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+            std::array<VkWriteDescriptorSet, 2> writes{};
+            writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[0].dstSet = descriptorSetSampler;
+            writes[0].dstBinding = 3;
+            writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writes[0].descriptorCount = 1;
+            writes[0].pBufferInfo = &lightsInfo;
+
+            writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[1].dstSet = descriptorSetSampler;
+            writes[1].dstBinding = 4;
+            writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[1].descriptorCount = 1;
+            writes[1].pImageInfo = &atlasInfo;
+
+            vkUpdateDescriptorSets(device, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+        }
+
+        // A ring of colored spot lights around the origin, all aimed at it
+        std::vector<ShadowAtlas::SpotLight> localLights;
+        for (int i = 0; i < 12; i++) {
+            float a = 6.2831853f * (float)i / 12.f;
+            ShadowAtlas::SpotLight l{};
+            l.position = glm::vec3(6.f * cosf(a), 4.f, 6.f * sinf(a));
+            l.direction = -l.position;
+            l.color = 0.5f * glm::vec3(0.5f + 0.5f * cosf(a), 0.5f + 0.5f * cosf(a + 2.1f), 0.5f + 0.5f * cosf(a + 4.2f));
+            l.range = 12.f;
+            l.innerAngle = glm::radians(15.f);
+            l.outerAngle = glm::radians(25.f);
+            localLights.push_back(l);
+        }
+
+        // Clustered forward lights: a 32x32 field of small unshadowed point
+        // lights over the scene, binned into froxels every frame
+        ClusteredLights clusteredLights;
+        clusteredLights.create(device, physicalDevice, 0.1f, 100.f);
+        {
+            std::vector<ClusteredLights::Light> lights;
+            for (int z = 0; z < 32; z++) {
+                for (int x = 0; x < 32; x++) {
+                    float a = 0.37f * (float)(x * 32 + z);
+                    ClusteredLights::Light l{};
+                    l.position = glm::vec3(-12.f + 0.75f * (float)x, 0.5f + 1.5f * sinf(a), -12.f + 0.75f * (float)z);
+                    l.range = 1.5f;
+                    l.color = 0.3f * glm::vec3(0.5f + 0.5f * cosf(a), 0.5f + 0.5f * cosf(a + 2.1f), 0.5f + 0.5f * cosf(a + 4.2f));
+                    lights.push_back(l);
+                }
+            }
+            clusteredLights.setLights(lights);
+
+            // set=1 => binding=6 (params), 7 (lights), 8 (cells + indices)
+            VkDescriptorBufferInfo infos[3]{};
+            infos[0] = { clusteredLights.getParamsBuffer(), 0, clusteredLights.getParamsBufferSize() };
+            infos[1] = { clusteredLights.getLightBuffer(), 0, clusteredLights.getLightBufferSize() };
+            infos[2] = { clusteredLights.getClusterBuffer(), 0, clusteredLights.getClusterBufferSize() };
+
+            std::array<VkWriteDescriptorSet, 3> writes{};
+            for (uint32_t i = 0; i < 3; i++) {
+                writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writes[i].dstSet = descriptorSetSampler;
+                writes[i].dstBinding = 6 + i;
+                writes[i].descriptorType = (i == 0) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writes[i].descriptorCount = 1;
+                writes[i].pBufferInfo = &infos[i];
+            }
+            vkUpdateDescriptorSets(device, (uint32_t)writes.size(), writes.data(), 0, nullptr);
+        }
+
         // Also we need a “shadow descriptor set” for each swapchain image (the shadow pipeline only uses set=0 => light data)
         std::vector<VkDescriptorSet> shadowDescriptorSets(swapCount);
         {
@@ -680,213 +992,455 @@ int main()
             }
         }
 
-        // Create the shadow pass command buffers (one per swap image)
-        CommandBuffer shadowCmdBuffers(device, commandPool.getCommandPool(), (uint32_t)swapCount);
-        {
-            auto& scb = shadowCmdBuffers.getCommandBuffers();
-            for (size_t i = 0; i < scb.size(); i++) {
-                recordShadowCommandBuffer(
-                    scb[i],
-                    renderPass.getShadowRenderPass(),
-                    shadowRes.framebuffer,
-                    shadowRes.extent,
-                    shadowPipeline.getPipeline(),
-                    shadowPipeline.getPipelineLayout(),
-                    vertexBuffer.getBuffer(),
-                    indexBuffer.getBuffer(),
-                    (uint32_t)cubeIndices.size(),
-                    shadowDescriptorSets[i],
-                    shadowRes
-                );
+        // Shadow pass command buffer, re-recorded every frame
+        CommandBuffer shadowCmdBuffer(device, commandPool.getCommandPool(), 1);
+
+        // One caster into a cascade (set=0: light UBO with the cascade
+        // matrices) or an atlas tile (set=0: light SSBO), the layer / light
+        // index picks the matrix. The VBs are the position-only streams
+        // (Vertex::extractPositions), indices are shared with the full streams.
+        auto drawShadowCaster = [&](VkCommandBuffer cb, const ShadowPipeline& pipeline, VkDescriptorSet set,
+            uint32_t layer, const glm::mat4& model, VkBuffer positions, VkBuffer indices, uint32_t indexCount) {
+            vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.getPipelineLayout(),
+                0, 1, &set, 0, nullptr);
+
+            ShadowPipeline::PushConstants pc{};
+            pc.model = model;
+            pc.cascade = (int32_t)layer;
+            vkCmdPushConstants(cb, pipeline.getPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT,
+                0, sizeof(pc), &pc);
+
+            VkDeviceSize offsets[] = { 0 };
+            vkCmdBindVertexBuffers(cb, 0, 1, &positions, offsets);
+            vkCmdBindIndexBuffer(cb, indices, 0, VK_INDEX_TYPE_UINT16);
+            vkCmdDrawIndexed(cb, indexCount, 1, 0, 0, 0);
+        };
+
+        // Shadow frame as a render graph: cascades (static cache copy, then
+        // the dynamic casters) -> EVSM moments / blur / mips -> atlas tiles.
+        // The plane is a static caster and comes from the shadow cache, the
+        // cube is dynamic and is drawn every frame; casters whose bounds miss
+        // a cascade / light frustum are skipped for it. The EVSM blur temp is
+        // a graph transient, and the EVSM passes are culled unless the kernel
+        // samples the moments (P rebuilds the graph). What changes per frame
+        // goes through shadowFrame.
+        struct ShadowFrame {
+            glm::mat4       cubeModel = glm::mat4(1.f);
+            VkDescriptorSet cascadeSet = VK_NULL_HANDLE;   // light UBO of the image being drawn
+        };
+        ShadowFrame shadowFrame;
+        RenderGraph shadowGraph;
+        auto buildShadowGraph = [&]() {
+            // Sampled by last frame's main pass / deferred lighting, and again after the graph
+            RenderGraph::ExternalState sampledInitial{};
+            sampledInitial.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            sampledInitial.stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            RenderGraph::ExternalState sampledFinal = sampledInitial;
+            sampledFinal.access = VK_ACCESS_SHADER_READ_BIT;
+
+            RenderGraph::ExternalState atlasInitial = sampledInitial;   // cleared every frame
+            atlasInitial.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            const bool evsmUsed = shadowCascades.getPcfKernel() == CascadedShadowMap::PcfKernel::Evsm;
+
+            RenderGraph::ResourceId cascades = shadowGraph.importImage("cascades",
+                shadowCascades.getDepthImage(), VK_IMAGE_ASPECT_DEPTH_BIT, sampledInitial, sampledFinal,
+                shadowCascades.getCascadeCount());
+            RenderGraph::ResourceId evsmTemp = shadowGraph.createImage("evsm blur temp", evsmShadows.getTempDesc());
+            RenderGraph::ResourceId moments = shadowGraph.importImage("evsm moments",
+                evsmShadows.getMomentsImage(), VK_IMAGE_ASPECT_COLOR_BIT, sampledInitial,
+                evsmUsed ? sampledFinal : RenderGraph::ExternalState{}, shadowCascades.getCascadeCount());
+            RenderGraph::ResourceId atlas = shadowGraph.importImage("atlas",
+                shadowAtlas.getImage(), VK_IMAGE_ASPECT_DEPTH_BIT, atlasInitial, sampledFinal);
+
+            shadowGraph.addPass("cascades static", { { cascades, RenderGraph::Access::TransferWrite } },
+                [&](VkCommandBuffer cb) {
+                    const Aabb planeBox = planeBounds.transformed(g_planeModel);
+                    const Aabb cubeBox = cubeBounds.transformed(shadowFrame.cubeModel);
+                    shadowCascades.recordCacheCopy(cb, shadowPipeline.getPipeline(), { cubeBox },
+                        [&](VkCommandBuffer ccb, uint32_t cascade) {
+                            if (shadowCascades.casterInCascade(cascade, planeBox)) {
+                                drawShadowCaster(ccb, shadowPipeline, shadowFrame.cascadeSet, cascade, g_planeModel,
+                                    planePositionBuffer.getBuffer(), planeIndexBuffer.getBuffer(),
+                                    (uint32_t)planeIndices.size());
+                            }
+                        });
+                });
+
+            shadowGraph.addPass("cascades dynamic", { { cascades, RenderGraph::Access::DepthAttachmentWrite } },
+                [&](VkCommandBuffer cb) {
+                    const Aabb cubeBox = cubeBounds.transformed(shadowFrame.cubeModel);
+                    shadowCascades.recordDynamic(cb, shadowPipeline.getPipeline(),
+                        [&](VkCommandBuffer ccb, uint32_t cascade) {
+                            if (shadowCascades.casterVisible(cascade, cubeBox)) {
+                                drawShadowCaster(ccb, shadowPipeline, shadowFrame.cascadeSet, cascade,
+                                    shadowFrame.cubeModel, cubePositionBuffer.getBuffer(), indexBuffer.getBuffer(),
+                                    (uint32_t)cubeIndices.size());
+                            }
+                        });
+                });
+
+            shadowGraph.addPass("evsm horizontal", {
+                    { cascades, RenderGraph::Access::SampledCompute },
+                    { evsmTemp, RenderGraph::Access::StorageWriteCompute } },
+                [&](VkCommandBuffer cb) { evsmShadows.recordHorizontal(cb); });
+            shadowGraph.addPass("evsm vertical", {
+                    { evsmTemp, RenderGraph::Access::SampledCompute },
+                    { moments, RenderGraph::Access::StorageWriteCompute } },
+                [&](VkCommandBuffer cb) { evsmShadows.recordVertical(cb); });
+            shadowGraph.addPass("evsm mips", { { moments, RenderGraph::Access::TransferReadWrite } },
+                [&](VkCommandBuffer cb) { evsmShadows.recordMips(cb); });
+
+            shadowGraph.addPass("atlas", { { atlas, RenderGraph::Access::DepthAttachmentWrite } },
+                [&](VkCommandBuffer cb) {
+                    const Aabb planeBox = planeBounds.transformed(g_planeModel);
+                    const Aabb cubeBox = cubeBounds.transformed(shadowFrame.cubeModel);
+                    VkDescriptorSet atlasSet = shadowAtlas.getShadowSet();
+                    shadowAtlas.record(cb, atlasPipeline.getPipeline(), [&](VkCommandBuffer acb, uint32_t light) {
+                        if (shadowAtlas.casterVisible(light, cubeBox)) {
+                            drawShadowCaster(acb, atlasPipeline, atlasSet, light, shadowFrame.cubeModel,
+                                cubePositionBuffer.getBuffer(), indexBuffer.getBuffer(), (uint32_t)cubeIndices.size());
+                        }
+                        if (shadowAtlas.casterVisible(light, planeBox)) {
+                            drawShadowCaster(acb, atlasPipeline, atlasSet, light, g_planeModel,
+                                planePositionBuffer.getBuffer(), planeIndexBuffer.getBuffer(),
+                                (uint32_t)planeIndices.size());
+                        }
+                    });
+                });
+
+            shadowGraph.compile(device, physicalDevice);
+            if (shadowGraph.isPassActive("evsm horizontal")) {
+                evsmShadows.setTempView(device, shadowGraph.getImageView(evsmTemp));
+            }
+        };
+        buildShadowGraph();
+        std::cout << "Shadow render graph:\n" << shadowGraph.describe() << std::endl;
+
+        // Light clustering command buffer, re-recorded every frame (view dependent)
+        CommandBuffer clusterCmdBuffer(device, commandPool.getCommandPool(), 1);
+
+        // Compute frame as a render graph: TLAS refit -> trace -> upscale.
+        // The graph owns the layout transitions / barriers between them and
+        // leaves the upscaled image in SHADER_READ_ONLY for the main pass.
+        // Rebuilt when a resize recreates the traced / upscaled images.
+        RenderGraph computeGraph;
+        auto buildComputeGraph = [&]() {
+            RenderGraph::ExternalState traceInitial{};   // fully rewritten every frame
+            traceInitial.stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            RenderGraph::ResourceId traceImage = computeGraph.importImage("trace output",
+                pixelTracer.getOutputImage(), VK_IMAGE_ASPECT_COLOR_BIT, traceInitial, RenderGraph::ExternalState{});
+
+            RenderGraph::ExternalState upscaleInitial{};  // read by last frame's fragment shaders
+            upscaleInitial.stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            RenderGraph::ExternalState upscaleFinal{};
+            upscaleFinal.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            upscaleFinal.stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            upscaleFinal.access = VK_ACCESS_SHADER_READ_BIT;
+            RenderGraph::ResourceId upscaleImage = computeGraph.importImage("upscale output",
+                upscalePass.getOutputImage(), VK_IMAGE_ASPECT_COLOR_BIT, upscaleInitial, upscaleFinal);
+
+            // Rebuild the TLAS with this frame's transforms. The main pass is
+            // submitted after this one, so the fragment shader sees it too.
+            if (useRayQuery) {
+                computeGraph.addPass("tlas build", {}, [&](VkCommandBuffer cb) {
+                    glm::mat4 model = glm::translate(glm::mat4(1.f), g_selectedObjectPos);
+                    std::vector<AccelerationStructure::Instance> instances = {
+                        { model, cubeMeshIndex },
+                        { g_planeModel, planeMeshIndex }
+                    };
+                    sceneAccel.recordTopLevelBuild(cb, instances);
+                }, true);
             }
-        }
 
-        // Compute pass command buffer
-        CommandBuffer computeCmdBuffer(device, commandPool.getCommandPool(), 1);
-        {
-            VkCommandBuffer cb = computeCmdBuffer.getCommandBuffers()[0];
+            // Bind + dispatch only the traced region, one workgroup per tile (timed)
+            computeGraph.addPass("trace", { { traceImage, RenderGraph::Access::StorageWriteCompute } },
+                [&](VkCommandBuffer cb) {
+                    dynamicResolution.writeBegin(cb);
+                    pixelTracer.recordDispatch(cb);
+                    dynamicResolution.writeEnd(cb);
+                });
+
+            // Bilinear + sharpen up to display resolution
+            computeGraph.addPass("upscale", {
+                    { traceImage, RenderGraph::Access::SampledCompute },
+                    { upscaleImage, RenderGraph::Access::StorageWriteCompute } },
+                [&](VkCommandBuffer cb) {
+                    upscalePass.recordDispatch(cb, pixelTracer.getTraceExtent());
+                });
+
+            computeGraph.compile(device, physicalDevice);
+        };
+        buildComputeGraph();
+        std::cout << "Compute render graph:\n" << computeGraph.describe() << std::endl;
 
+        // Compute pass command buffer.
+        // Re-recorded every frame because the trace extent changes
+        CommandBuffer computeCmdBuffer(device, commandPool.getCommandPool(), 1);
+        auto recordComputePass = [&](VkCommandBuffer cb) {
             VkCommandBufferBeginInfo beginInfo{};
             beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
             if (vkBeginCommandBuffer(cb, &beginInfo) != VK_SUCCESS) {
                 throw std::runtime_error("Failed to begin compute cmd buffer!");
             }
 
-            // Transition compute image to GENERAL
-            {
-                VkImageMemoryBarrier barrier{};
-                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-                barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-                barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                barrier.image = pixelTracer.getOutputImage();
-                barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                barrier.subresourceRange.baseMipLevel = 0;
-                barrier.subresourceRange.levelCount = 1;
-                barrier.subresourceRange.baseArrayLayer = 0;
-                barrier.subresourceRange.layerCount = 1;
-                vkCmdPipelineBarrier(
-                    cb,
-                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                    0,
-                    0, nullptr, 0, nullptr, 1, &barrier
-                );
-            }
-
-            // Bind compute pipeline
-            vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pixelTracer.getPipeline());
-            VkDescriptorSet ds = pixelTracer.getDescriptorSet();
-            vkCmdBindDescriptorSets(
-                cb,
-                VK_PIPELINE_BIND_POINT_COMPUTE,
-                pixelTracer.getPipelineLayout(),
-                0, 1, &ds,
-                0, nullptr
-            );
-
-            // Dispatch
-            vkCmdDispatch(cb, 512, 512, 1);
-
-            // Transition to SHADER_READ_ONLY_OPTIMAL
-            {
-                VkImageMemoryBarrier barrier{};
-                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-                barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-                barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                barrier.image = pixelTracer.getOutputImage();
-                barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                barrier.subresourceRange.baseMipLevel = 0;
-                barrier.subresourceRange.levelCount = 1;
-                barrier.subresourceRange.baseArrayLayer = 0;
-                barrier.subresourceRange.layerCount = 1;
-                barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-                vkCmdPipelineBarrier(
-                    cb,
-                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                    VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                    0,
-                    0, nullptr, 0, nullptr, 1, &barrier
-                );
-            }
+            computeGraph.execute(cb);
 
             if (vkEndCommandBuffer(cb) != VK_SUCCESS) {
                 throw std::runtime_error("Failed to end compute command buffer!");
             }
-        }
-
-        // LightRay pipeline (only 1 set => the cylinder’s UBO)
-        VkDeviceSize cylinderUBOSize = sizeof(UniformBufferObject);
-        Buffer lightRayUBOBuffer(
-            device, physicalDevice, cylinderUBOSize,
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-        );
-
-        VkDescriptorSetLayoutBinding lrBinding{};
-        lrBinding.binding = 0;
-        lrBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        lrBinding.descriptorCount = 1;
-        lrBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-
-        VkDescriptorSetLayoutCreateInfo lrLayoutInfo{};
-        lrLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        lrLayoutInfo.bindingCount = 1;
-        lrLayoutInfo.pBindings = &lrBinding;
-
-        VkDescriptorSetLayout lightRayDescLayout;
-        if (vkCreateDescriptorSetLayout(device, &lrLayoutInfo, nullptr, &lightRayDescLayout) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create light ray descriptor layout!");
-        }
-
-        // Pool for the single set
-        VkDescriptorPoolSize lrPoolSize{};
-        lrPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        lrPoolSize.descriptorCount = 1;
-
-        VkDescriptorPoolCreateInfo lrPoolInfo{};
-        lrPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        lrPoolInfo.poolSizeCount = 1;
-        lrPoolInfo.pPoolSizes = &lrPoolSize;
-        lrPoolInfo.maxSets = 1;
+        };
 
-        VkDescriptorPool lightRayDescriptorPool;
-        if (vkCreateDescriptorPool(device, &lrPoolInfo, nullptr, &lightRayDescriptorPool) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create light ray descriptor pool!");
+        // LightRay pipeline: the main pass's camera set (set=0) + model push constant
+        LightRayPipeline lightRayPipeline;
+        lightRayPipeline.create(device, renderPass.getRenderPass(), graphicsPipeline.getDescriptorSetLayoutUBO(),
+            renderPass.getPipelineRenderingInfo());
+
+        // Depth prepass (Z toggles it, the main command buffers are re-recorded)
+        DepthPrepassPipeline depthPrepassPipeline;
+        depthPrepassPipeline.create(device, renderPass.getRenderPass(), graphicsPipeline.getDescriptorSetLayoutUBO(),
+            renderPass.getPipelineRenderingInfo());
+        bool depthPrepassEnabled = true;
+
+        // Deferred path: G-buffer + tiled compute lighting (G toggles forward / deferred)
+        DeferredRenderer deferredRenderer;
+        deferredRenderer.create(device, physicalDevice, swapChain.getSwapChainExtent(),
+            graphicsPipeline.getDescriptorSetLayoutUBO(), renderPass.getRenderPass(), (uint32_t)swapCount,
+            renderPass.getPipelineRenderingInfo(), useBindless ? bindless.getSetLayout() : VK_NULL_HANDLE);
+        auto setDeferredInputs = [&]() {
+            for (size_t i = 0; i < swapCount; i++) {
+                deferredRenderer.setFrameInputs(device, (uint32_t)i,
+                    uniformBuffers[i].getBuffer(), sizeof(UniformBufferObject),
+                    lightBuffers[i].getBuffer(), sizeof(LightData),
+                    shadowCascades.getArrayView(), samplerShadowMap,
+                    clusteredLights, shadowAtlas, evsmShadows);
+            }
+        };
+        setDeferredInputs();
+        bool deferredEnabled = false;
+
+        // GPU-driven path: one shared vertex / index buffer, compute-culled
+        // indirect draws (I toggles it, O its Hi-Z occlusion culling).
+        // Needs multiDrawIndirect + firstInstance.
+        const VkPhysicalDeviceFeatures& enabledFeatures = physicalDevice.getEnabledFeatures();
+        const bool gpuDrivenSupported =
+            enabledFeatures.multiDrawIndirect && enabledFeatures.drawIndirectFirstInstance;
+        GpuScene gpuScene;
+        uint32_t gpuCubeObject = 0;
+        if (gpuDrivenSupported) {
+            gpuScene.create(device, physicalDevice, graphicsPipeline.getDescriptorSetLayoutObjects(),
+                graphicsPipeline.getPipelineLayout(), swapChain.getSwapChainExtent(), 64);
+            gpuScene.setOcclusionEnabled(true);
+            uint32_t cubeMesh = gpuScene.addMesh(cubeVertices, cubeIndices);
+            uint32_t planeMesh = gpuScene.addMesh(planeVertices, planeIndices);
+            gpuCubeObject = gpuScene.addObject(cubeMesh, glm::mat4(1.f), sceneMaterials[SceneCube]);
+            gpuScene.addObject(planeMesh, g_planeModel, sceneMaterials[ScenePlane]);
+            gpuScene.upload(device, physicalDevice);
+            std::cout << "GPU-driven draws: " << gpuScene.getObjectCount() << " objects, "
+                << (gpuScene.usesDrawCount() ? "draw count" : "fixed slots") << std::endl;
         }
-
-        VkDescriptorSet lightRayDescriptorSet;
+        bool gpuDrivenEnabled = false;
+
+        // Repeated props: a grid of small cube copies under the scene, one
+        // instanced draw in the forward pass (N toggles it). The props
+        // alternate between the cube and the floor material.
+        const uint32_t propGridSize = 16;
+        InstanceBatch propInstances;
+        propInstances.create(device, physicalDevice, propGridSize * propGridSize);
         {
-            VkDescriptorSetAllocateInfo allocInfo{};
-            allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-            allocInfo.descriptorPool = lightRayDescriptorPool;
-            allocInfo.descriptorSetCount = 1;
-            allocInfo.pSetLayouts = &lightRayDescLayout;
-
-            if (vkAllocateDescriptorSets(device, &allocInfo, &lightRayDescriptorSet) != VK_SUCCESS) {
-                throw std::runtime_error("Failed to allocate light ray descriptor set!");
+            std::vector<glm::mat4> propModels;
+            std::vector<uint32_t>  propMaterials;
+            propModels.reserve(propGridSize * propGridSize);
+            propMaterials.reserve(propGridSize * propGridSize);
+            for (uint32_t z = 0; z < propGridSize; z++) {
+                for (uint32_t x = 0; x < propGridSize; x++) {
+                    glm::vec3 pos((x - propGridSize * 0.5f) * 1.2f, -3.5f, (z - propGridSize * 0.5f) * 1.2f);
+                    glm::mat4 model = glm::translate(glm::mat4(1.f), pos);
+                    model = glm::rotate(model, glm::radians(17.f * (x + z)), glm::vec3(0.f, 1.f, 0.f));
+                    propModels.push_back(glm::scale(model, glm::vec3(0.12f)));
+                    propMaterials.push_back(sceneMaterials[((x + z) % 2 == 0) ? SceneCube : ScenePlane]);
+                }
             }
-
-            // binding=0 => the cylinder's MVP
-            VkDescriptorBufferInfo lrBufInfo{};
-            lrBufInfo.buffer = lightRayUBOBuffer.getBuffer();
-            lrBufInfo.offset = 0;
-            lrBufInfo.range = cylinderUBOSize;
-
-            VkWriteDescriptorSet wr{};
-            wr.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            wr.dstSet = lightRayDescriptorSet;
-            wr.dstBinding = 0;
-            wr.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            wr.descriptorCount = 1;
-            wr.pBufferInfo = &lrBufInfo;
-
-            vkUpdateDescriptorSets(device, 1, &wr, 0, nullptr);
+            propInstances.setInstances(propModels, propMaterials);
         }
-
-        // Create that pipeline
-        LightRayPipeline lightRayPipeline;
-        lightRayPipeline.create(device, renderPass.getRenderPass(), lightRayDescLayout);
+        bool propsEnabled = true;
+
+        // World-space scene index (cube + plane proxies, the cube's refit every
+        // frame in step 4). userData = scene object id, shared by the main
+        // pass culling (queryFrustum) and the CPU picking.
+        DynamicAabbTree sceneTree;
+        const int32_t cubeProxy = sceneTree.createProxy(cubeBounds, SceneCube);
+        sceneTree.createProxy(planeBounds.transformed(g_planeModel), ScenePlane);
+        // Click picking (CTRL + left button): CPU ray through the scene tree and
+        // the meshes' triangle trees, or (B) the GPU object-id buffer
+        ScenePicker scenePicker;
+        const uint32_t pickCubeMesh = scenePicker.addMesh(cubeVertices, cubeIndices);
+        const uint32_t pickPlaneMesh = scenePicker.addMesh(planeVertices, planeIndices);
+        scenePicker.setObject(ScenePlane, pickPlaneMesh, g_planeModel);
+        IdBufferPicker idBufferPicker;
+        idBufferPicker.create(device, physicalDevice, swapChain.getSwapChainExtent());
+        bool idBufferPicking = false;
 
         // ----------------------------------------------------------------------
         // Now record the main pass command buffers
         // ----------------------------------------------------------------------
         CommandBuffer mainCmdBuffers(device, commandPool.getCommandPool(), (uint32_t)swapCount);
 
-        auto recordMainPass = [&](CommandBuffer& cbObj) {
-            const auto& cbs = cbObj.getCommandBuffers();
-            for (size_t i = 0; i < cbs.size(); i++) {
-                VkCommandBuffer cmd = cbs[i];
+        // Per-draw transforms the main pass pushes as constants, and which
+        // scene objects are drawn at all. The command buffers are pre-recorded,
+        // so an image is recorded again before its submit when these changed
+        // since it was recorded (a camera move only touches the per-frame UBO,
+        // unless an object enters / leaves the frustum).
+        struct MainPassDraws {
+            glm::mat4 scene = glm::mat4(1.f);      // cube (the plane has g_planeModel)
+            glm::mat4 lightRay = glm::mat4(1.f);
+            uint32_t  visible = ~0u;               // bit per SceneObject inside the camera frustum
+
+            bool operator==(const MainPassDraws& o) const
+            {
+                return scene == o.scene && lightRay == o.lightRay && visible == o.visible;
+            }
+        };
+        MainPassDraws mainPassDraws;
+        std::vector<MainPassDraws> recordedDraws(swapCount);
+        std::vector<RenderGraph> mainGraphs(swapCount);
+
+        auto recordMainImage = [&](VkCommandBuffer cmd, size_t i) {
+            recordedDraws[i] = mainPassDraws;
+
+            // Model + material of one scene object
+            auto pushObject = [&](VkCommandBuffer cb, VkPipelineLayout layout, uint32_t objectId) {
+                GraphicsPipeline::PushConstants pc{};
+                pc.model = (objectId == ScenePlane) ? g_planeModel : mainPassDraws.scene;
+                pc.materialIndex = sceneMaterials[objectId];
+                vkCmdPushConstants(cb, layout, GraphicsPipeline::PUSH_CONSTANT_STAGES, 0, sizeof(pc), &pc);
+            };
+            // Culled objects are not drawn (the GPU-driven path culls itself)
+            auto isVisible = [&](uint32_t objectId) {
+                return (mainPassDraws.visible & (1u << objectId)) != 0;
+            };
 
-                VkCommandBufferBeginInfo bi{};
-                bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-                if (vkBeginCommandBuffer(cmd, &bi) != VK_SUCCESS) {
-                    throw std::runtime_error("Failed to begin main cmd buffer!");
+            // set=3: every texture + the material table, once per pipeline
+            // layout switch instead of a set per material
+            auto bindBindless = [&](VkCommandBuffer cb, VkPipelineLayout layout) {
+                if (!useBindless) {
+                    return;
                 }
+                VkDescriptorSet set = bindless.getDescriptorSet();
+                vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, layout,
+                    BindlessDescriptors::SET_INDEX, 1, &set, 0, nullptr);
+            };
 
-                VkRenderPassBeginInfo rpBegin{};
-                rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-                rpBegin.renderPass = renderPass.getRenderPass();
-                rpBegin.framebuffer = swapChain.getSwapChainFramebuffers()[i];
-                rpBegin.renderArea.offset = { 0,0 };
-                rpBegin.renderArea.extent = swapChain.getSwapChainExtent();
+            VkCommandBufferBeginInfo bi{};
+            bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            if (vkBeginCommandBuffer(cmd, &bi) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to begin main cmd buffer!");
+            }
 
-                std::array<VkClearValue, 2> clears{};
-                clears[0].color = { {0.f, 0.f, 0.f, 1.f} };
-                clears[1].depthStencil = { 1.f, 0 };
-                rpBegin.clearValueCount = (uint32_t)clears.size();
-                rpBegin.pClearValues = clears.data();
+            std::array<VkClearValue, 2> clears{};
+            clears[0].color = { {0.f, 0.f, 0.f, 1.f} };
+            clears[1].depthStencil = { 1.f, 0 };
+
+            // The frame as a render graph: (deferred) G-buffer -> tiled
+            // lighting -> main pass. The graph moves the G-buffer, the lit
+            // image, the swapchain image and the depth buffer between the
+            // passes; the render passes / dynamic rendering keep the
+            // attachment layouts. Rebuilt with every recording, the toggles
+            // change which passes exist.
+            RenderGraph& graph = mainGraphs[i];
+            graph.destroy(device);
+
+            RenderGraph::ExternalState colorInitial{};   // after the acquire semaphore wait
+            colorInitial.stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            RenderGraph::ExternalState colorFinal{};     // the present waits on the submit's semaphore
+            colorFinal.layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+            colorFinal.stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+            RenderGraph::ExternalState depthInitial{};   // cleared, last frame's depth tests done
+            depthInitial.stage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+            RenderGraph::ResourceId swapImage = graph.importImage("swapchain image",
+                swapChain.getSwapChainImages()[i], VK_IMAGE_ASPECT_COLOR_BIT, colorInitial, colorFinal);
+            RenderGraph::ResourceId swapDepth = graph.importImage("depth",
+                swapChain.getDepthImage(), VK_IMAGE_ASPECT_DEPTH_BIT, depthInitial, RenderGraph::ExternalState{});
+            std::vector<RenderGraph::Use> mainUses = {
+                { swapImage, RenderGraph::Access::ColorAttachmentWrite },
+                { swapDepth, RenderGraph::Access::DepthAttachmentWrite }
+            };
 
-                vkCmdBeginRenderPass(cmd, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+            // Deferred path: G-buffer + tiled lighting before the main pass
+            if (deferredEnabled) {
+                RenderGraph::ExternalState gbufferInitial{};   // cleared, last frame's lighting / composite done
+                gbufferInitial.stage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+                RenderGraph::ResourceId gAlbedo = graph.importImage("gbuffer albedo",
+                    deferredRenderer.getAlbedoImage(), VK_IMAGE_ASPECT_COLOR_BIT, gbufferInitial, RenderGraph::ExternalState{});
+                RenderGraph::ResourceId gNormal = graph.importImage("gbuffer normal",
+                    deferredRenderer.getNormalImage(), VK_IMAGE_ASPECT_COLOR_BIT, gbufferInitial, RenderGraph::ExternalState{});
+                RenderGraph::ResourceId gDepth = graph.importImage("gbuffer depth",
+                    deferredRenderer.getDepthImage(), VK_IMAGE_ASPECT_DEPTH_BIT, gbufferInitial, RenderGraph::ExternalState{});
+                RenderGraph::ResourceId lit = graph.importImage("lit",
+                    deferredRenderer.getLitImage(), VK_IMAGE_ASPECT_COLOR_BIT, gbufferInitial, RenderGraph::ExternalState{});
+
+                graph.addPass("gbuffer", {
+                        { gAlbedo, RenderGraph::Access::ColorAttachmentWrite },
+                        { gNormal, RenderGraph::Access::ColorAttachmentWrite },
+                        { gDepth, RenderGraph::Access::DepthAttachmentWrite } },
+                    [&](VkCommandBuffer cmd) {
+                        deferredRenderer.recordGeometry(cmd, descriptorSetsUBO[i], [&](VkCommandBuffer gcb) {
+                            bindBindless(gcb, deferredRenderer.getGeometryLayout());
+                            VkDeviceSize off[] = { 0 };
+                            if (isVisible(SceneCube)) {
+                                VkBuffer cubeVB = vertexBuffer.getBuffer();
+                                vkCmdBindVertexBuffers(gcb, 0, 1, &cubeVB, off);
+                                vkCmdBindIndexBuffer(gcb, indexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT16);
+                                pushObject(gcb, deferredRenderer.getGeometryLayout(), SceneCube);
+                                vkCmdDrawIndexed(gcb, (uint32_t)cubeIndices.size(), 1, 0, 0, 0);
+                            }
+                            if (isVisible(ScenePlane)) {
+                                VkBuffer planeVB = planeVertexBuffer.getBuffer();
+                                vkCmdBindVertexBuffers(gcb, 0, 1, &planeVB, off);
+                                vkCmdBindIndexBuffer(gcb, planeIndexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT16);
+                                pushObject(gcb, deferredRenderer.getGeometryLayout(), ScenePlane);
+                                vkCmdDrawIndexed(gcb, (uint32_t)planeIndices.size(), 1, 0, 0, 0);
+                            }
+                        });
+                    });
+                graph.addPass("deferred lighting", {
+                        { gAlbedo, RenderGraph::Access::SampledCompute },
+                        { gNormal, RenderGraph::Access::SampledCompute },
+                        { gDepth, RenderGraph::Access::SampledCompute },
+                        { lit, RenderGraph::Access::StorageWriteCompute } },
+                    [&](VkCommandBuffer cmd) { deferredRenderer.recordLighting(cmd, (uint32_t)i); });
+
+                // Composite: lit colour + G-buffer depth
+                mainUses.push_back({ lit, RenderGraph::Access::SampledFragment });
+                mainUses.push_back({ gDepth, RenderGraph::Access::SampledFragment });
+            }
+            else if (gpuDrivenEnabled) {
+                // Cull + build the draw list before the pass starts; GpuScene
+                // orders its own cull -> indirect draw
+                graph.addPass("gpu cull", {}, [&](VkCommandBuffer cmd) {
+                    gpuScene.recordCull(cmd, descriptorSetsUBO[i]);
+                }, true);
+            }
 
-                // (A) Bind the main pipeline (2 sets)
-                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline.getPipeline());
+            graph.addPass("main", mainUses, [&](VkCommandBuffer cmd) {
+                if (useDynamicRendering) {
+                    renderPass.beginRendering(cmd,
+                        swapChain.getSwapChainImageViews()[i], swapChain.getDepthImageView(),
+                        swapChain.getSwapChainExtent(), clears[0], clears[1]);
+                }
+                else {
+                    VkRenderPassBeginInfo rpBegin{};
+                    rpBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+                    rpBegin.renderPass = renderPass.getRenderPass();
+                    rpBegin.framebuffer = swapChain.getSwapChainFramebuffers()[i];
+                    rpBegin.renderArea.offset = { 0,0 };
+                    rpBegin.renderArea.extent = swapChain.getSwapChainExtent();
+                    rpBegin.clearValueCount = (uint32_t)clears.size();
+                    rpBegin.pClearValues = clears.data();
+                    vkCmdBeginRenderPass(cmd, &rpBegin, VK_SUBPASS_CONTENTS_INLINE);
+                }
 
                 VkViewport viewport{};
                 viewport.x = 0.f;
@@ -902,49 +1456,119 @@ int main()
                 scissor.extent = swapChain.getSwapChainExtent();
                 vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-                // (1) Bind "cube" geometry
-                VkDeviceSize offz[] = { 0 };
-                VkBuffer vb = vertexBuffer.getBuffer();
-                vkCmdBindVertexBuffers(cmd, 0, 1, &vb, offz);
-
-                vkCmdBindIndexBuffer(cmd, indexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT16);
-
-                // Bind descriptor sets => set=0 => descriptorSetsUBO[i], set=1 => descriptorSetSampler
-                // Notice we do two calls or an array of 2 sets
-                vkCmdBindDescriptorSets(
-                    cmd,
-                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    graphicsPipeline.getPipelineLayout(),
-                    0, // firstSet=0
-                    1, &descriptorSetsUBO[i],
-                    0, nullptr
-                );
-                vkCmdBindDescriptorSets(
-                    cmd,
-                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    graphicsPipeline.getPipelineLayout(),
-                    1, // firstSet=1
-                    1, &descriptorSetSampler,
-                    0, nullptr
-                );
-
-                // Draw the cube
-                vkCmdDrawIndexed(cmd, (uint32_t)cubeIndices.size(), 1, 0, 0, 0);
+                // Deferred: the opaque meshes are already lit, copy them in
+                VkPipeline opaquePipeline = graphicsPipeline.getPipeline();
+                if (deferredEnabled) {
+                    deferredRenderer.recordComposite(cmd);
+                }
+                else if (gpuDrivenEnabled) {
+                    // Cube + plane in one indirect draw, model matrices from the
+                    // object SSBO (set=2)
+                    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline.getGpuDrivenPipeline());
+                    vkCmdBindDescriptorSets(
+                        cmd,
+                        VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        graphicsPipeline.getPipelineLayout(),
+                        0, 1, &descriptorSetsUBO[i],
+                        0, nullptr
+                    );
+                    vkCmdBindDescriptorSets(
+                        cmd,
+                        VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        graphicsPipeline.getPipelineLayout(),
+                        1, 1, &descriptorSetSampler,
+                        0, nullptr
+                    );
+                    bindBindless(cmd, graphicsPipeline.getPipelineLayout());
+                    gpuScene.recordDraw(cmd, graphicsPipeline.getPipelineLayout());
+                }
+                else {
+                    // (0) Optional depth prepass over the opaque meshes (position-only
+                    //     streams), then the main pipeline only shades the visible
+                    //     fragments (EQUAL, no depth writes)
+                    if (depthPrepassEnabled) {
+                        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, depthPrepassPipeline.getPipeline());
+                        vkCmdBindDescriptorSets(
+                            cmd,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            depthPrepassPipeline.getPipelineLayout(),
+                            0, 1, &descriptorSetsUBO[i],
+                            0, nullptr
+                        );
+
+                        VkDeviceSize posOff[] = { 0 };
+                        if (isVisible(SceneCube)) {
+                            VkBuffer cubePos = cubePositionBuffer.getBuffer();
+                            vkCmdBindVertexBuffers(cmd, 0, 1, &cubePos, posOff);
+                            vkCmdBindIndexBuffer(cmd, indexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT16);
+                            pushObject(cmd, depthPrepassPipeline.getPipelineLayout(), SceneCube);
+                            vkCmdDrawIndexed(cmd, (uint32_t)cubeIndices.size(), 1, 0, 0, 0);
+                        }
+                        if (isVisible(ScenePlane)) {
+                            VkBuffer planePos = planePositionBuffer.getBuffer();
+                            vkCmdBindVertexBuffers(cmd, 0, 1, &planePos, posOff);
+                            vkCmdBindIndexBuffer(cmd, planeIndexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT16);
+                            pushObject(cmd, depthPrepassPipeline.getPipelineLayout(), ScenePlane);
+                            vkCmdDrawIndexed(cmd, (uint32_t)planeIndices.size(), 1, 0, 0, 0);
+                        }
+
+                        opaquePipeline = graphicsPipeline.getEqualDepthPipeline();
+                    }
+
+                    // (A) Bind the main pipeline (2 sets)
+                    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, opaquePipeline);
+
+                    // (1) Bind "cube" geometry
+                    VkDeviceSize offz[] = { 0 };
+                    VkBuffer vb = vertexBuffer.getBuffer();
+                    vkCmdBindVertexBuffers(cmd, 0, 1, &vb, offz);
+
+                    vkCmdBindIndexBuffer(cmd, indexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT16);
+
+                    // Bind descriptor sets => set=0 => descriptorSetsUBO[i], set=1 => descriptorSetSampler
+                    // Notice we do two calls or an array of 2 sets
+                    vkCmdBindDescriptorSets(
+                        cmd,
+                        VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        graphicsPipeline.getPipelineLayout(),
+                        0, // firstSet=0
+                        1, &descriptorSetsUBO[i],
+                        0, nullptr
+                    );
+                    vkCmdBindDescriptorSets(
+                        cmd,
+                        VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        graphicsPipeline.getPipelineLayout(),
+                        1, // firstSet=1
+                        1, &descriptorSetSampler,
+                        0, nullptr
+                    );
+                    bindBindless(cmd, graphicsPipeline.getPipelineLayout());
+
+                    // Draw the cube
+                    if (isVisible(SceneCube)) {
+                        pushObject(cmd, graphicsPipeline.getPipelineLayout(), SceneCube);
+                        vkCmdDrawIndexed(cmd, (uint32_t)cubeIndices.size(), 1, 0, 0, 0);
+                    }
+                }
 
                 // (2) Bind the lightRay pipeline for the cylinder
                 vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, lightRayPipeline.getPipeline());
                 vkCmdSetViewport(cmd, 0, 1, &viewport);
                 vkCmdSetScissor(cmd, 0, 1, &scissor);
 
-                // Bind set=0 => lightRay UBO
+                // Bind set=0 => camera UBO, the cylinder's model is pushed
                 vkCmdBindDescriptorSets(
                     cmd,
                     VK_PIPELINE_BIND_POINT_GRAPHICS,
                     lightRayPipeline.getPipelineLayout(),
                     0, // firstSet=0
-                    1, &lightRayDescriptorSet,
+                    1, &descriptorSetsUBO[i],
                     0, nullptr
                 );
+                LightRayPipeline::PushConstants lrPush{ mainPassDraws.lightRay };
+                vkCmdPushConstants(cmd, lightRayPipeline.getPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT,
+                    0, sizeof(lrPush), &lrPush);
 
                 VkDeviceSize cylOff[] = { 0 };
                 VkBuffer lrBuf = lightRayVertexBuffer.getBuffer();
@@ -953,43 +1577,74 @@ int main()
                 vkCmdBindIndexBuffer(cmd, lightRayIndexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT16);
                 vkCmdDrawIndexed(cmd, (uint32_t)cylinderIndices.size(), 1, 0, 0, 0);
 
-                // (3) Switch back to the main pipeline, draw the "plane"
-                vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline.getPipeline());
-                vkCmdSetViewport(cmd, 0, 1, &viewport);
-                vkCmdSetScissor(cmd, 0, 1, &scissor);
-
-                // We can re-bind the same sets or rely on the previous binding for set=0, set=1
-                // but safer to re-bind them
-                vkCmdBindDescriptorSets(
-                    cmd,
-                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    graphicsPipeline.getPipelineLayout(),
-                    0, 1, &descriptorSetsUBO[i],
-                    0, nullptr
-                );
-                vkCmdBindDescriptorSets(
-                    cmd,
-                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    graphicsPipeline.getPipelineLayout(),
-                    1, 1, &descriptorSetSampler,
-                    0, nullptr
-                );
-
-                VkDeviceSize planeOff[] = { 0 };
-                VkBuffer planeBuf = planeVertexBuffer.getBuffer();
-                vkCmdBindVertexBuffers(cmd, 0, 1, &planeBuf, planeOff);
+                if (!deferredEnabled && !gpuDrivenEnabled) {
+                    // (3) Switch back to the main pipeline, draw the "plane"
+                    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, opaquePipeline);
+                    vkCmdSetViewport(cmd, 0, 1, &viewport);
+                    vkCmdSetScissor(cmd, 0, 1, &scissor);
+
+                    // We can re-bind the same sets or rely on the previous binding for set=0, set=1
+                    // but safer to re-bind them
+                    vkCmdBindDescriptorSets(
+                        cmd,
+                        VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        graphicsPipeline.getPipelineLayout(),
+                        0, 1, &descriptorSetsUBO[i],
+                        0, nullptr
+                    );
+                    vkCmdBindDescriptorSets(
+                        cmd,
+                        VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        graphicsPipeline.getPipelineLayout(),
+                        1, 1, &descriptorSetSampler,
+                        0, nullptr
+                    );
+                    bindBindless(cmd, graphicsPipeline.getPipelineLayout());
+
+                    if (isVisible(ScenePlane)) {
+                        VkDeviceSize planeOff[] = { 0 };
+                        VkBuffer planeBuf = planeVertexBuffer.getBuffer();
+                        vkCmdBindVertexBuffers(cmd, 0, 1, &planeBuf, planeOff);
+
+                        vkCmdBindIndexBuffer(cmd, planeIndexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT16);
+                        pushObject(cmd, graphicsPipeline.getPipelineLayout(), ScenePlane);
+                        vkCmdDrawIndexed(cmd, (uint32_t)planeIndices.size(), 1, 0, 0, 0);
+                    }
+
+                    // (4) Every prop in one instanced draw (same sets, depth
+                    // tested normally: the props are not in the prepass)
+                    if (propsEnabled) {
+                        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline.getInstancedPipeline());
+                        vkCmdSetViewport(cmd, 0, 1, &viewport);
+                        vkCmdSetScissor(cmd, 0, 1, &scissor);
+                        propInstances.draw(cmd, vertexBuffer.getBuffer(), indexBuffer.getBuffer(),
+                            VK_INDEX_TYPE_UINT16, (uint32_t)cubeIndices.size());
+                    }
+                }
 
-                vkCmdBindIndexBuffer(cmd, planeIndexBuffer.getBuffer(), 0, VK_INDEX_TYPE_UINT16);
-                vkCmdDrawIndexed(cmd, (uint32_t)planeIndices.size(), 1, 0, 0, 0);
+                if (useDynamicRendering) {
+                    renderPass.endRendering(cmd);
+                }
+                else {
+                    vkCmdEndRenderPass(cmd);
+                }
+            });
 
-                vkCmdEndRenderPass(cmd);
+            graph.compile(device, physicalDevice);
+            graph.execute(cmd);
 
-                if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
-                    throw std::runtime_error("Failed to end main command buffer!");
-                }
+            if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to end main command buffer!");
             }
-            };
+        };
+        auto recordMainPass = [&](CommandBuffer& cbObj) {
+            const auto& cbs = cbObj.getCommandBuffers();
+            for (size_t i = 0; i < cbs.size(); i++) {
+                recordMainImage(cbs[i], i);
+            }
+        };
         recordMainPass(mainCmdBuffers);
+        std::cout << "Main render graph:\n" << mainGraphs[0].describe() << std::endl;
 
         // Create semaphores & fence
         VkSemaphore imageAvailableSem, renderFinishedSem;
@@ -1010,13 +1665,75 @@ int main()
             }
         }
 
-        // Retrieve queues
-        VkQueue graphicsQueue;
-        vkGetDeviceQueue(device, physicalDevice.getGraphicsQueueFamilyIndex(), 0, &graphicsQueue);
-
+        // Retrieve queues (graphicsQueue was fetched after the command pool)
         VkQueue presentQueue;
         vkGetDeviceQueue(device, physicalDevice.getPresentQueueFamilyIndex(), 0, &presentQueue);
 
+        // Pick the fastest PixelTracer workgroup shape on this device (full trace extent)
+        if (pixelTracer.autoTuneWorkgroupSize(device, physicalDevice, graphicsQueue, commandPool.getCommandPool())) {
+            const PixelTracer::PipelineConfig& cfg = pixelTracer.getPipelineConfig();
+            std::cout << "PixelTracer workgroup: " << cfg.groupSizeX << "x" << cfg.groupSizeY << std::endl;
+            dynamicResolution.setGranularity(cfg.groupSizeX, cfg.groupSizeY);
+        }
+        else {
+            std::cout << "PixelTracer auto-tune skipped (no timestamps), using 8x8" << std::endl;
+        }
+
+        // Window resized / swapchain out of date: new swapchain, and every
+        // target sized from it follows (trace + upscale images, dynamic
+        // resolution bounds, G-buffer, id-buffer picker). GpuScene's occlusion
+        // depth has its own fixed size and works in NDC, it stays.
+        auto recreateSwapChain = [&]() {
+            int w = 0, h = 0;
+            glfwGetFramebufferSize(window, &w, &h);
+            while (w == 0 || h == 0) {
+                glfwWaitEvents();
+                glfwGetFramebufferSize(window, &w, &h);
+            }
+            vkDeviceWaitIdle(device);
+            framebufferResized = false;
+
+            swapChain.destroy();
+            swapChain = SwapChain(physicalDevice, device, surface, window, useDynamicRendering);
+            if (!useDynamicRendering) {
+                swapChain.createFramebuffers(renderPass.getRenderPass());
+            }
+            // Per-image UBOs, descriptor sets and command buffers are sized by it
+            if (swapChain.getSwapChainImages().size() != swapCount) {
+                throw std::runtime_error("Swap chain image count changed on recreation!");
+            }
+            VkExtent2D extent = swapChain.getSwapChainExtent();
+
+            // Trace at the new display size, keeping the tuned workgroup shape
+            PixelTracer::PipelineConfig traceConfig = pixelTracer.getPipelineConfig();
+            VkFormat traceFormat = pixelTracer.getOutputFormat();
+            computeGraph.destroy(device);
+            upscalePass.destroy(device);
+            dynamicResolution.destroy(device);
+            pixelTracer.destroy(device);
+
+            pixelTracer.create(device, physicalDevice, extent.width, extent.height, traceFormat, traceConfig,
+                useRayQuery ? sceneAccel.getTopLevel() : VK_NULL_HANDLE);
+            dynamicResolution.create(device, physicalDevice, extent.width, extent.height, 4.0f);
+            dynamicResolution.setGranularity(traceConfig.groupSizeX, traceConfig.groupSizeY);
+            upscalePass.create(device, physicalDevice, pixelTracer.getOutputImageView(),
+                pixelTracer.getMaxExtent(), extent);
+            writeUpscaleDescriptor();
+            buildComputeGraph();
+
+            deferredRenderer.destroy(device);
+            deferredRenderer.create(device, physicalDevice, extent,
+                graphicsPipeline.getDescriptorSetLayoutUBO(), renderPass.getRenderPass(), (uint32_t)swapCount,
+                renderPass.getPipelineRenderingInfo(), useBindless ? bindless.getSetLayout() : VK_NULL_HANDLE);
+            setDeferredInputs();
+
+            idBufferPicker.destroy(device);
+            idBufferPicker.create(device, physicalDevice, extent);
+
+            recordMainPass(mainCmdBuffers);
+            std::cout << "Swap chain recreated: " << extent.width << "x" << extent.height << std::endl;
+        };
+
         auto lastFrameTime = std::chrono::high_resolution_clock::now();
         auto fpsStartTime = std::chrono::high_resolution_clock::now();
         int  frameCount = 0;
@@ -1024,10 +1741,75 @@ int main()
         // We "select" the cube by default
         g_objectIsSelected = true;
 
+        bool pcfKeyWasDown = false;
+        bool prepassKeyWasDown = false;
+        bool deferredKeyWasDown = false;
+        bool gpuDrivenKeyWasDown = false;
+        bool occlusionKeyWasDown = false;
+        bool pickModeKeyWasDown = false;
+        bool propsKeyWasDown = false;
+        bool pickButtonWasDown = false;
+
         // Main loop
         while (!glfwWindowShouldClose(window)) {
             glfwPollEvents();
 
+            // P cycles the shadow filter: FourTap -> Poisson -> Gather5x5 -> EVSM
+            bool pcfKeyDown = (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS);
+            if (pcfKeyDown && !pcfKeyWasDown) {
+                static const char* kernelNames[] = { "4-tap", "Poisson", "gather 5x5", "EVSM" };
+                int next = ((int)shadowCascades.getPcfKernel() + 1) % 4;
+                shadowCascades.setPcfKernel((CascadedShadowMap::PcfKernel)next);
+                // Into / out of EVSM: the moments passes are kept / culled
+                if (next == (int)CascadedShadowMap::PcfKernel::Evsm || next == 0) {
+                    vkDeviceWaitIdle(device);
+                    shadowGraph.destroy(device);
+                    buildShadowGraph();
+                }
+                std::cout << "Shadow PCF: " << kernelNames[next] << std::endl;
+            }
+            pcfKeyWasDown = pcfKeyDown;
+
+            // Z toggles the depth prepass (only worth it with overdraw)
+            bool prepassKeyDown = (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS);
+            if (prepassKeyDown && !prepassKeyWasDown) {
+                depthPrepassEnabled = !depthPrepassEnabled;
+                vkDeviceWaitIdle(device);
+                recordMainPass(mainCmdBuffers);
+                std::cout << "Depth prepass: " << (depthPrepassEnabled ? "on" : "off") << std::endl;
+            }
+            prepassKeyWasDown = prepassKeyDown;
+
+            // G switches forward / deferred shading
+            bool deferredKeyDown = (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS);
+            if (deferredKeyDown && !deferredKeyWasDown) {
+                deferredEnabled = !deferredEnabled;
+                vkDeviceWaitIdle(device);
+                recordMainPass(mainCmdBuffers);
+                std::cout << "Shading: " << (deferredEnabled ? "deferred" : "forward") << std::endl;
+            }
+            deferredKeyWasDown = deferredKeyDown;
+
+            // I switches per-object CPU draws / GPU-culled indirect draws
+            bool gpuDrivenKeyDown = (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS);
+            if (gpuDrivenKeyDown && !gpuDrivenKeyWasDown && gpuDrivenSupported) {
+                gpuDrivenEnabled = !gpuDrivenEnabled;
+                vkDeviceWaitIdle(device);
+                recordMainPass(mainCmdBuffers);
+                std::cout << "Draw path: " << (gpuDrivenEnabled ? "GPU-driven" : "CPU") << std::endl;
+            }
+            gpuDrivenKeyWasDown = gpuDrivenKeyDown;
+
+            // O toggles two-phase Hi-Z occlusion culling on the GPU-driven path
+            bool occlusionKeyDown = (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS);
+            if (occlusionKeyDown && !occlusionKeyWasDown && gpuDrivenSupported) {
+                gpuScene.setOcclusionEnabled(!gpuScene.isOcclusionEnabled());
+                vkDeviceWaitIdle(device);
+                recordMainPass(mainCmdBuffers);
+                std::cout << "Occlusion culling: " << (gpuScene.isOcclusionEnabled() ? "on" : "off") << std::endl;
+            }
+            occlusionKeyWasDown = occlusionKeyDown;
+
             // Toggle cursor if user is pressing LEFT CTRL
             bool ctrlDown = (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS);
             if (ctrlDown && !g_showMouseCursor) {
@@ -1039,11 +1821,72 @@ int main()
                 glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
             }
 
-            // Simple picking
-            if (g_showMouseCursor && glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) {
-                // Stub: we could do real picking. For now, always set the same object:
-                g_objectIsSelected = true;
+            // N shows / hides the instanced props
+            bool propsKeyDown = (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS);
+            if (propsKeyDown && !propsKeyWasDown) {
+                propsEnabled = !propsEnabled;
+                vkDeviceWaitIdle(device);
+                recordMainPass(mainCmdBuffers);
+                std::cout << "Instanced props: " << (propsEnabled ? "on" : "off") << " ("
+                    << propInstances.getInstanceCount() << " instances, 1 draw)" << std::endl;
+            }
+            propsKeyWasDown = propsKeyDown;
+
+            // B switches CPU ray picking / GPU id-buffer picking
+            bool pickModeKeyDown = (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS);
+            if (pickModeKeyDown && !pickModeKeyWasDown) {
+                idBufferPicking = !idBufferPicking;
+                std::cout << "Picking: " << (idBufferPicking ? "GPU id buffer" : "CPU ray") << std::endl;
+            }
+            pickModeKeyWasDown = pickModeKeyDown;
+
+            // Picking: select the object under the cursor (nothing => deselect).
+            // Uses last frame's transforms (step 4 below updates them).
+            bool pickButtonDown = g_showMouseCursor &&
+                glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+            if (pickButtonDown && !pickButtonWasDown) {
+                double cursorX, cursorY;
+                int windowW, windowH;
+                glfwGetCursorPos(window, &cursorX, &cursorY);
+                glfwGetWindowSize(window, &windowW, &windowH);
+
+                VkExtent2D extent = swapChain.getSwapChainExtent();
+                glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+                glm::mat4 proj = glm::perspective(glm::radians(45.f),
+                    extent.width / (float)extent.height, 0.1f, 100.f);
+                proj[1][1] *= -1.f;
+                glm::mat4 model = glm::translate(glm::mat4(1.f), g_selectedObjectPos);
+
+                auto pickStart = std::chrono::high_resolution_clock::now();
+                uint32_t picked = ScenePicker::NO_OBJECT;
+                if (idBufferPicking && windowW > 0 && windowH > 0) {
+                    // Window -> swapchain pixels (they differ on high-DPI displays)
+                    uint32_t px = (uint32_t)(cursorX * extent.width / windowW);
+                    uint32_t py = (uint32_t)(cursorY * extent.height / windowH);
+                    std::vector<IdBufferPicker::Draw> draws = {
+                        { cubePositionBuffer.getBuffer(), indexBuffer.getBuffer(),
+                          (uint32_t)cubeIndices.size(), proj * view * model, SceneCube },
+                        { planePositionBuffer.getBuffer(), planeIndexBuffer.getBuffer(),
+                          (uint32_t)planeIndices.size(), proj * view * g_planeModel, ScenePlane }
+                    };
+                    picked = idBufferPicker.pick(device, commandPool.getCommandPool(), graphicsQueue, px, py, draws);
+                }
+                else if (windowW > 0 && windowH > 0) {
+                    ScenePicker::Ray ray = ScenePicker::rayFromCursor(cursorX, cursorY, windowW, windowH, view, proj);
+                    ScenePicker::Hit hit;
+                    if (scenePicker.pick(sceneTree, ray, hit)) {
+                        picked = hit.objectId;
+                    }
+                }
+                auto pickEnd = std::chrono::high_resolution_clock::now();
+
+                g_objectIsSelected = (picked != ScenePicker::NO_OBJECT);
+                g_selectedObject = picked;
+                static const char* objectNames[] = { "cube", "plane" };
+                std::cout << "Picked: " << (g_objectIsSelected ? objectNames[picked] : "nothing") << " ("
+                    << std::chrono::duration<float, std::micro>(pickEnd - pickStart).count() << " us)" << std::endl;
             }
+            pickButtonWasDown = pickButtonDown;
 
             // Check minimize
             int wWin, hWin;
@@ -1056,13 +1899,19 @@ int main()
             // Wait for the previous frame
             vkWaitForFences(device, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
 
+            if (framebufferResized) {
+                recreateSwapChain();
+            }
+
             // Acquire next swapchain image
             uint32_t imageIndex;
             {
                 VkResult res = vkAcquireNextImageKHR(device, swapChain.getSwapChain(), UINT64_MAX,
                     imageAvailableSem, VK_NULL_HANDLE, &imageIndex);
-                if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR || framebufferResized) {
-                    // Recreate next loop
+                // Suboptimal still presents (the semaphore is signaled), it is
+                // recreated after the present
+                if (res == VK_ERROR_OUT_OF_DATE_KHR) {
+                    recreateSwapChain();
                     continue;
                 }
                 else if (res != VK_SUCCESS && res != VK_SUBOPTIMAL_KHR) {
@@ -1070,25 +1919,19 @@ int main()
                 }
             }
 
-            // Submit shadow pass
-            vkResetFences(device, 1, &inFlightFence);
-            {
-                VkSubmitInfo submitInfo{};
-                submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-                VkCommandBuffer scb = shadowCmdBuffers.getCommandBuffers()[imageIndex];
-                submitInfo.commandBufferCount = 1;
-                submitInfo.pCommandBuffers = &scb;
-                if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
-                    throw std::runtime_error("Failed to submit shadow pass!");
-                }
-                vkQueueWaitIdle(graphicsQueue);
-            }
-
             // Submit compute pass
             {
+                // Last frame's timing decides this frame's trace extent.
+                // The queue is idle here, so the camera UBO and the command buffer are free.
+                dynamicResolution.update(device);
+                VkExtent2D traceExtent = dynamicResolution.getTraceExtent();
+                pixelTracer.setTraceExtent(device, traceExtent.width, traceExtent.height);
+
+                VkCommandBuffer ccb = computeCmdBuffer.getCommandBuffers()[0];
+                recordComputePass(ccb);
+
                 VkSubmitInfo submitInfo{};
                 submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-                VkCommandBuffer ccb = computeCmdBuffer.getCommandBuffers()[0];
                 submitInfo.commandBufferCount = 1;
                 submitInfo.pCommandBuffers = &ccb;
                 if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
@@ -1119,8 +1962,10 @@ int main()
                 }
             }
 
-            // Move selected object with numeric keypad 4,6,8,2,7,9
-            if (g_objectIsSelected) {
+            // Move selected object with numeric keypad 4,6,8,2,7,9. Only the
+            // cube moves: the plane is the static shadow caster (fixed
+            // g_planeModel), picking it selects it without making it movable
+            if (g_objectIsSelected && g_selectedObject == SceneCube) {
                 float objSpeed = 4.f * deltaTime;
                 if (glfwGetKey(window, GLFW_KEY_KP_4) == GLFW_PRESS) {
                     g_selectedObjectPos.x -= objSpeed;
@@ -1142,10 +1987,12 @@ int main()
                 }
             }
 
-            // 4) Update the “cube” UBO (model/view/proj)
+            // 4) Update the camera UBO (view/proj); the model is pushed per draw
             {
+                const glm::mat4 model = glm::translate(glm::mat4(1.f), g_selectedObjectPos);
+                mainPassDraws.scene = model;
+
                 UniformBufferObject ubo{};
-                ubo.model = glm::translate(glm::mat4(1.f), g_selectedObjectPos);
                 ubo.view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
                 ubo.proj = glm::perspective(glm::radians(45.f),
                     swapChain.getSwapChainExtent().width /
@@ -1158,17 +2005,43 @@ int main()
                 vkMapMemory(device, uniformBuffers[imageIndex].getMemory(), 0, sizeof(ubo), 0, &dataPtr);
                 memcpy(dataPtr, &ubo, sizeof(ubo));
                 vkUnmapMemory(device, uniformBuffers[imageIndex].getMemory());
+
+                // Same transforms for the GPU-driven objects + this frame's cull planes
+                if (gpuDrivenSupported) {
+                    gpuScene.setTransform(gpuCubeObject, model);
+                    gpuScene.updateCulling(ubo.proj * ubo.view);
+                }
+
+                sceneTree.moveProxy(cubeProxy, cubeBounds.transformed(model));
+                scenePicker.setObject(SceneCube, pickCubeMesh, model);
+
+                // Visible set of this frame's main pass, from the same tree
+                // (fat boxes, so a little conservative)
+                mainPassDraws.visible = 0;
+                sceneTree.queryFrustum(Frustum(ubo.proj * ubo.view), [&](int32_t proxy) {
+                    mainPassDraws.visible |= 1u << sceneTree.getUserData(proxy);
+                });
             }
 
             // 5) Update Light UBO
             {
-                LightData lData{};
+                // Directional light coming from lightPos(5,10,5) towards the origin
                 glm::vec3 lightPos(5.f, 10.f, 5.f);
-                glm::vec3 lookAt(0.f, 0.f, 0.f);
-                glm::vec3 up(0.f, 1.f, 0.f);
-                glm::mat4 lightView = glm::lookAt(lightPos, lookAt, up);
-                glm::mat4 lightProj = glm::perspective(glm::radians(45.f), 1.f, 0.1f, 100.f);
-                lData.lightViewProj = lightProj * lightView;
+                float aspect = swapChain.getSwapChainExtent().width /
+                    (float)swapChain.getSwapChainExtent().height;
+                glm::mat4 cameraView = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+                shadowCascades.update(cameraView, glm::radians(45.f), aspect, 0.1f, 100.f, lightPos);
+
+                // Local lights: atlas tiles by on-screen size, light SSBO
+                glm::mat4 cameraProj = glm::perspective(glm::radians(45.f), aspect, 0.1f, 100.f);
+                shadowAtlas.update(localLights, cameraView, cameraProj,
+                    (float)swapChain.getSwapChainExtent().height);
+
+                // Clustered lights: same camera as the main pass (Vulkan y flip)
+                glm::mat4 clusterProj = cameraProj;
+                clusterProj[1][1] *= -1.f;
+                clusteredLights.update(cameraView, clusterProj, swapChain.getSwapChainExtent());
+                LightData lData = shadowCascades.getGpuData();
 
                 void* dataPtr = nullptr;
                 vkMapMemory(device, lightBuffers[imageIndex].getMemory(), 0, sizeof(lData), 0, &dataPtr);
@@ -1176,7 +2049,7 @@ int main()
                 vkUnmapMemory(device, lightBuffers[imageIndex].getMemory());
             }
 
-            // 6) Update the “light ray” UBO
+            // 6) Update the “light ray” model
             {
                 // A “light->target” cylinder
                 glm::vec3  lightPos(5.f, 10.f, 5.f);
@@ -1191,31 +2064,72 @@ int main()
                     float angle = acos(glm::dot(upVec, dir));
                     rot = glm::rotate(glm::mat4(1.f), angle, axis);
                 }
-                glm::mat4 modelRay =
+                // Pushed with the draw, the camera comes from the main UBO
+                mainPassDraws.lightRay =
                     glm::translate(glm::mat4(1.f), lightPos) *
                     rot *
                     glm::scale(glm::mat4(1.f), glm::vec3(1.f, length, 1.f));
+            }
 
-                glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-                glm::mat4 proj = glm::perspective(glm::radians(45.f),
-                    swapChain.getSwapChainExtent().width /
-                    (float)swapChain.getSwapChainExtent().height,
-                    0.1f, 100.f);
-                proj[1][1] *= -1.f;
+            // 7) Bin the clustered lights into froxels for this frame's camera
+            //    (forward only, the deferred path culls per tile itself)
+            if (!deferredEnabled) {
+                VkCommandBuffer lcb = clusterCmdBuffer.getCommandBuffers()[0];
 
-                UniformBufferObject lrUBO{};
-                lrUBO.model = modelRay;
-                lrUBO.view = view;
-                lrUBO.proj = proj;
+                VkCommandBufferBeginInfo beginInfo{};
+                beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+                if (vkBeginCommandBuffer(lcb, &beginInfo) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to begin cluster command buffer!");
+                }
+                clusteredLights.record(lcb);
+                if (vkEndCommandBuffer(lcb) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to end cluster command buffer!");
+                }
 
-                void* dataPtr = nullptr;
-                vkMapMemory(device, lightRayUBOBuffer.getMemory(), 0, sizeof(lrUBO), 0, &dataPtr);
-                memcpy(dataPtr, &lrUBO, sizeof(lrUBO));
-                vkUnmapMemory(device, lightRayUBOBuffer.getMemory());
+                VkSubmitInfo submitInfo{};
+                submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submitInfo.commandBufferCount = 1;
+                submitInfo.pCommandBuffers = &lcb;
+                if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to submit light clustering!");
+                }
             }
 
-            // 7) Submit the main pass
+            // 8) Shadow frame (needs this frame's light UBO + model)
             {
+                shadowFrame.cubeModel = glm::translate(glm::mat4(1.f), g_selectedObjectPos);
+                shadowFrame.cascadeSet = shadowDescriptorSets[imageIndex];
+
+                VkCommandBuffer scb = shadowCmdBuffer.getCommandBuffers()[0];
+                VkCommandBufferBeginInfo beginInfo{};
+                beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+                if (vkBeginCommandBuffer(scb, &beginInfo) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to begin shadow command buffer!");
+                }
+                shadowGraph.execute(scb);
+                if (vkEndCommandBuffer(scb) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to end shadow command buffer!");
+                }
+
+                VkSubmitInfo submitInfo{};
+                submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+                submitInfo.commandBufferCount = 1;
+                submitInfo.pCommandBuffers = &scb;
+                if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to submit shadow pass!");
+                }
+            }
+
+            // 9) Submit the main pass
+            {
+                // New per-draw constants => record this image again (the fence
+                // wait above means none of the main command buffers is in flight)
+                if (!(recordedDraws[imageIndex] == mainPassDraws)) {
+                    recordMainImage(mainCmdBuffers.getCommandBuffers()[imageIndex], imageIndex);
+                }
+
                 vkResetFences(device, 1, &inFlightFence);
 
                 // We'll wait on imageAvailableSem
@@ -1254,7 +2168,7 @@ int main()
                     res == VK_SUBOPTIMAL_KHR ||
                     framebufferResized)
                 {
-                    // Recreate next loop
+                    recreateSwapChain();
                 }
                 else if (res != VK_SUCCESS) {
                     throw std::runtime_error("Failed to present swap chain image!");
@@ -1266,7 +2180,9 @@ int main()
             auto fpsNow = std::chrono::high_resolution_clock::now();
             if (std::chrono::duration<float>(fpsNow - fpsStartTime).count() >= 1.f) {
                 float fps = frameCount / std::chrono::duration<float>(fpsNow - fpsStartTime).count();
-                std::cout << "FPS: " << fps << std::endl;
+                std::cout << "FPS: " << fps
+                    << " | trace " << pixelTracer.getTraceExtent().width << "x" << pixelTracer.getTraceExtent().height
+                    << " (" << dynamicResolution.getGpuTimeMs() << " ms)" << std::endl;
                 fpsStartTime = fpsNow;
                 frameCount = 0;
             }
@@ -1276,22 +2192,29 @@ int main()
         std::cout << "Device idle. Cleaning up...\n";
 
         // Destroy plane geometry
+        planePositionBuffer.destroy();
         planeVertexBuffer.destroy();
         planeIndexBuffer.destroy();
 
         // Destroy cylinder
+        gpuScene.destroy(device);
+        idBufferPicker.destroy(device);
+        propInstances.destroy(device);
+        deferredRenderer.destroy(device);
+        depthPrepassPipeline.destroy(device);
         lightRayPipeline.destroy(device);
-        vkDestroyDescriptorPool(device, lightRayDescriptorPool, nullptr);
-        vkDestroyDescriptorSetLayout(device, lightRayDescLayout, nullptr);
-        lightRayUBOBuffer.destroy();
         lightRayVertexBuffer.destroy();
         lightRayIndexBuffer.destroy();
 
         // Shadow pipeline
         shadowPipeline.destroy(device);
+        atlasPipeline.destroy(device);
 
         // Compute
+        upscalePass.destroy(device);
+        dynamicResolution.destroy(device);
         pixelTracer.destroy(device);
+        sceneAccel.destroy(device);
 
         // Samplers
         vkDestroySampler(device, samplerCompute, nullptr);
@@ -1307,13 +2230,21 @@ int main()
         }
         vkDestroyDescriptorPool(device, descriptorPoolUBO, nullptr);
 
+        // Render graphs (transients only, the rest is imported)
+        shadowGraph.destroy(device);
+        computeGraph.destroy(device);
+        for (RenderGraph& graph : mainGraphs) {
+            graph.destroy(device);
+        }
+
         // Shadow
-        vkDestroyFramebuffer(device, shadowRes.framebuffer, nullptr);
-        vkDestroyImageView(device, shadowRes.depthView, nullptr);
-        vkDestroyImage(device, shadowRes.depthImage, nullptr);
-        vkFreeMemory(device, shadowRes.depthMemory, nullptr);
+        evsmShadows.destroy(device);
+        shadowCascades.destroy(device);
+        clusteredLights.destroy(device);
+        shadowAtlas.destroy(device);
 
         // Buffers for the cube
+        cubePositionBuffer.destroy();
         vertexBuffer.destroy();
         indexBuffer.destroy();
 
@@ -1326,6 +2257,10 @@ int main()
         // Graphics pipeline
         graphicsPipeline.destroy(device);
 
+        // Bindless set + the material textures it points at
+        materials.destroy(device, bindless);
+        bindless.destroy(device);
+
         vkDestroySurfaceKHR(instance, surface, nullptr);
         vkDestroyDevice(device, nullptr);
 
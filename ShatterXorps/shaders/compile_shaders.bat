@@ -0,0 +1,61 @@
+@echo off
+REM ------------------------------------------------------------------
+REM Compiles every GLSL shader in this folder to SPIR-V (*.spv).
+REM Needs the Vulkan SDK (VULKAN_SDK env var set by the installer).
+REM Run it from anywhere, outputs are written next to the sources.
+REM ------------------------------------------------------------------
+setlocal
+set GLSLANG="%VULKAN_SDK%\Bin\glslangValidator.exe"
+cd /d "%~dp0"
+
+%GLSLANG% -V shader.vert -o shader.vert.spv || goto :error
+%GLSLANG% -V shader.frag -o shader.frag.spv || goto :error
+%GLSLANG% -V --target-env vulkan1.2 shader.frag -DUSE_RAY_QUERY -o shader_rq.frag.spv || goto :error
+REM Bindless materials (descriptor indexing devices only), with and without ray queries
+%GLSLANG% -V --target-env vulkan1.2 shader.frag -DUSE_BINDLESS -o shader_bindless.frag.spv || goto :error
+%GLSLANG% -V --target-env vulkan1.2 shader.frag -DUSE_RAY_QUERY -DUSE_BINDLESS -o shader_rq_bindless.frag.spv || goto :error
+%GLSLANG% -V depth_prepass.vert -o depth_prepass.vert.spv || goto :error
+%GLSLANG% -V shadow.vert -o shadow.vert.spv || goto :error
+%GLSLANG% -V shadow_atlas.vert -o shadow_atlas.vert.spv || goto :error
+%GLSLANG% -V frustum_static.vert -o frustum_static.vert.spv || goto :error
+%GLSLANG% -V frustum_static.frag -o frustum_static.frag.spv || goto :error
+%GLSLANG% -V quad_vert.vert -o quad_vert.spv || goto :error
+%GLSLANG% -V quad_frag.frag -o quad_frag.spv || goto :error
+%GLSLANG% -V ..\light_ray.vert -o light_ray.vert.spv || goto :error
+%GLSLANG% -V ..\light_ray.frag -o light_ray.frag.spv || goto :error
+
+REM PixelTracer: one variant per output image format
+%GLSLANG% -V raytrace.comp -o raytrace.comp.spv || goto :error
+%GLSLANG% -V raytrace.comp -DOUTPUT_RGBA16F -o raytrace_rgba16f.comp.spv || goto :error
+%GLSLANG% -V raytrace.comp -DOUTPUT_R11G11B10F -o raytrace_r11g11b10f.comp.spv || goto :error
+%GLSLANG% -V raytrace.comp -DOUTPUT_RGBA8 -o raytrace_rgba8.comp.spv || goto :error
+
+REM Same four variants with ray-query shadows (VK_KHR_ray_query devices only)
+%GLSLANG% -V --target-env vulkan1.2 raytrace.comp -DUSE_RAY_QUERY -o raytrace_rq.comp.spv || goto :error
+%GLSLANG% -V --target-env vulkan1.2 raytrace.comp -DUSE_RAY_QUERY -DOUTPUT_RGBA16F -o raytrace_rgba16f_rq.comp.spv || goto :error
+%GLSLANG% -V --target-env vulkan1.2 raytrace.comp -DUSE_RAY_QUERY -DOUTPUT_R11G11B10F -o raytrace_r11g11b10f_rq.comp.spv || goto :error
+%GLSLANG% -V --target-env vulkan1.2 raytrace.comp -DUSE_RAY_QUERY -DOUTPUT_RGBA8 -o raytrace_rgba8_rq.comp.spv || goto :error
+%GLSLANG% -V upscale.comp -o upscale.comp.spv || goto :error
+%GLSLANG% -V cluster_lights.comp -o cluster_lights.comp.spv || goto :error
+%GLSLANG% -V gbuffer.frag -o gbuffer.frag.spv || goto :error
+%GLSLANG% -V --target-env vulkan1.2 gbuffer.frag -DUSE_BINDLESS -o gbuffer_bindless.frag.spv || goto :error
+%GLSLANG% -V fullscreen.vert -o fullscreen.vert.spv || goto :error
+%GLSLANG% -V deferred_composite.frag -o deferred_composite.frag.spv || goto :error
+%GLSLANG% -V deferred_lighting.comp -o deferred_lighting.comp.spv || goto :error
+%GLSLANG% -V gpu_scene.vert -o gpu_scene.vert.spv || goto :error
+%GLSLANG% -V instanced.vert -o instanced.vert.spv || goto :error
+%GLSLANG% -V gpu_cull.comp -o gpu_cull.comp.spv || goto :error
+%GLSLANG% -V hiz_downsample.comp -o hiz_downsample.comp.spv || goto :error
+%GLSLANG% -V pick_id.vert -o pick_id.vert.spv || goto :error
+%GLSLANG% -V pick_id.frag -o pick_id.frag.spv || goto :error
+
+REM EVSM moments + blur, RGBA16F variant for devices without filterable RGBA32F
+%GLSLANG% -V evsm_blur.comp -o evsm_blur.comp.spv || goto :error
+%GLSLANG% -V evsm_blur.comp -DOUTPUT_RGBA16F -o evsm_blur_rgba16f.comp.spv || goto :error
+
+echo All shaders compiled.
+exit /b 0
+
+:error
+echo Shader compilation failed!
+exit /b 1
@@ -0,0 +1,16 @@
+#version 450
+
+// DeferredRenderer composite: lit image to the swapchain, G-buffer depth
+// to the main depth buffer so later forward draws still depth-test.
+
+layout(location = 0) in vec2 fragTexCoord;
+layout(location = 0) out vec4 outColor;
+
+layout(binding = 0) uniform sampler2D litImage;
+layout(binding = 1) uniform sampler2D gbufferDepth;
+
+void main()
+{
+    outColor     = vec4(texture(litImage, fragTexCoord).rgb, 1.0);
+    gl_FragDepth = texture(gbufferDepth, fragTexCoord).r;
+}
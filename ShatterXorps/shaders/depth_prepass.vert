@@ -0,0 +1,27 @@
+#version 450
+
+// Depth prepass for the main render pass (DepthPrepassPipeline):
+// position-only stream, no fragment shader. gl_Position must come out
+// bit-identical to shader.vert for the EQUAL depth test of the main pass,
+// hence the same UBO + push constants, the same expression and "invariant".
+
+layout(location=0) in vec3 inPosition;
+
+// Same blocks as shader.vert (set=0, binding=0 + push constants)
+layout(binding=0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(push_constant) uniform ObjectPush {
+    mat4 model;
+    uint materialIndex;
+} pc;
+
+invariant gl_Position;
+
+void main()
+{
+    vec4 worldPos = pc.model * vec4(inPosition, 1.0);
+    gl_Position   = ubo.proj * ubo.view * worldPos;
+}
@@ -0,0 +1,12 @@
+#version 450
+
+// One triangle covering the screen, no vertex buffer: vkCmdDraw(cb, 3, 1, 0, 0)
+
+layout(location = 0) out vec2 fragTexCoord;
+
+void main()
+{
+    vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    fragTexCoord = uv;
+    gl_Position  = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
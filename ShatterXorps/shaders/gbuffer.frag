@@ -0,0 +1,43 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// DeferredRenderer geometry pass (after shader.vert): albedo + material
+// index, octahedral normal. Depth comes from the depth attachment, no
+// position target. Built with -DUSE_BINDLESS (gbuffer_bindless.frag.spv)
+// the albedo is the material's, same as shader.frag.
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec3 fragWorldPos;
+layout(location = 2) in vec3 fragNorm;
+layout(location = 3) flat in uint fragMaterial;   // MaterialTable index
+
+layout(location = 0) out vec4 outAlbedo;   // RGBA8, a: material index / 255
+layout(location = 1) out vec2 outNormal;   // RG16F, octahedral
+
+#ifdef USE_BINDLESS
+#include "material.glsl"
+#endif
+
+// Unit vector -> [-1,1]^2 (octahedron unfolded onto the square)
+vec2 octEncode(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 p = n.xy;
+    if (n.z < 0.0) {
+        p = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return p;
+}
+
+void main()
+{
+    vec3 normal = normalize(fragNorm);
+#ifdef USE_BINDLESS
+    vec3 albedo = materialColor(fragMaterial, fragColor, fragWorldPos, normal);
+#else
+    vec3 albedo = fragColor;
+#endif
+    // MaterialTable holds at most 256 materials, the index fits the UNORM8
+    outAlbedo = vec4(albedo, float(min(fragMaterial, 255u)) / 255.0);
+    outNormal = octEncode(normal);
+}
@@ -0,0 +1,43 @@
+#version 450
+
+// GpuScene: shader.vert for indirect draws. Every object is one draw with
+// firstInstance = its index, so gl_InstanceIndex picks its model matrix
+// out of the object SSBO instead of the push constants.
+
+layout(location=0) in vec3 inPosition;
+layout(location=1) in vec3 inColor;
+layout(location=2) in vec3 inNormal;
+
+layout(location=0) out vec3 fragColor;
+layout(location=1) out vec3 fragWorldPos;
+layout(location=2) out vec3 fragNorm;
+layout(location=3) flat out uint fragMaterial;   // MaterialTable index
+
+layout(binding=0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// GpuScene::GpuObject (std430)
+struct GpuObject {
+    mat4  model;
+    vec4  boundsMin;   // object space
+    vec4  boundsMax;
+    uvec4 mesh;        // x: index count, y: first index, z: vertex offset, w: material
+};
+
+layout(std430, set=2, binding=0) readonly buffer Objects {
+    GpuObject objects[];
+};
+
+void main()
+{
+    mat4 model       = objects[gl_InstanceIndex].model;
+    vec4 worldPos    = model * vec4(inPosition, 1.0);
+    gl_Position      = ubo.proj * ubo.view * worldPos;
+
+    fragColor        = inColor;
+    fragWorldPos     = worldPos.xyz;
+    fragNorm         = mat3(model) * inNormal;
+    fragMaterial     = objects[gl_InstanceIndex].mesh.w;
+}
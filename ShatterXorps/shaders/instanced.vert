@@ -0,0 +1,33 @@
+#version 450
+
+// Instanced shader.vert: the model matrix and the material come per
+// instance from vertex binding 1 (Vertex::getInstancedAttributeDescriptions,
+// InstanceData), so N copies of a mesh are one vkCmdDrawIndexed (no push
+// constants on this path).
+
+layout(location=0) in vec3 inPosition;
+layout(location=1) in vec3 inColor;
+layout(location=2) in vec3 inNormal;
+layout(location=3) in mat4 inModel;   // locations 3..6
+layout(location=7) in uint inMaterial;
+
+layout(location=0) out vec3 fragColor;
+layout(location=1) out vec3 fragWorldPos;
+layout(location=2) out vec3 fragNorm;
+layout(location=3) flat out uint fragMaterial;   // MaterialTable index
+
+layout(binding=0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+void main()
+{
+    vec4 worldPos    = inModel * vec4(inPosition, 1.0);
+    gl_Position      = ubo.proj * ubo.view * worldPos;
+
+    fragColor        = inColor;
+    fragWorldPos     = worldPos.xyz;
+    fragNorm         = mat3(inModel) * inNormal;
+    fragMaterial     = inMaterial;
+}
@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////
+// FILE: material.glsl
+////////////////////////////////////////////////////////////
+//
+// Bindless materials, shared by shader.frag and gbuffer.frag built with
+// -DUSE_BINDLESS (needs descriptor indexing):
+// set=3 => BindlessDescriptors, binding=0 every texture, binding=1 every
+// storage buffer; buffer 0 is the MaterialTable. The material index comes
+// from the vertex shader (push constant / GPU object), so a draw never
+// binds a per-material set.
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+struct Material {
+    vec4  baseColor;   // multiplies the vertex color
+    uvec4 textures;    // x: albedo texture slot, NO_TEXTURE = none
+    vec4  params;      // x: texture tiles per world unit
+};
+
+const uint NO_TEXTURE = 0xFFFFFFFFu;        // MaterialTable::NO_TEXTURE
+const uint MATERIAL_BUFFER_SLOT = 0u;       // BindlessDescriptors::MATERIAL_BUFFER_SLOT
+
+layout(set = 3, binding = 0) uniform sampler2D bindlessTextures[];
+layout(std430, set = 3, binding = 1) readonly buffer MaterialBuffer {
+    Material materials[];
+} bindlessBuffers[];
+
+// The meshes have no UVs: the albedo is projected along the three world
+// axes and blended by the normal (triplanar)
+vec3 materialColor(uint material, vec3 vertexColor, vec3 worldPos, vec3 normal)
+{
+    Material m = bindlessBuffers[MATERIAL_BUFFER_SLOT].materials[material];
+    vec3 color = vertexColor * m.baseColor.rgb;
+
+    uint albedo = m.textures.x;
+    if (albedo == NO_TEXTURE) {
+        return color;
+    }
+    vec3 w = pow(abs(normal), vec3(4.0));
+    w /= (w.x + w.y + w.z);
+    vec3 p = worldPos * m.params.x;
+    vec3 texel = texture(bindlessTextures[nonuniformEXT(albedo)], p.yz).rgb * w.x
+               + texture(bindlessTextures[nonuniformEXT(albedo)], p.xz).rgb * w.y
+               + texture(bindlessTextures[nonuniformEXT(albedo)], p.xy).rgb * w.z;
+    return color * texel;
+}
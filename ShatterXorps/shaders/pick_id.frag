@@ -0,0 +1,16 @@
+///////////////////////////////////////////
+// FILE: pick_id.frag
+///////////////////////////////////////////
+#version 450
+
+// Writes the object id into the R32_UINT pick target (nearest surface wins
+// through the depth test).
+
+layout(location = 0) flat in uint inObjectId;
+
+layout(location = 0) out uint outId;
+
+void main()
+{
+    outId = inObjectId;
+}
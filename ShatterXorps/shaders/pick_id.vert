@@ -0,0 +1,24 @@
+///////////////////////////////////////////
+// FILE: pick_id.vert
+///////////////////////////////////////////
+#version 450
+
+// Object ID pass for IdBufferPicker: clip position from a full MVP and the
+// object id handed through to pick_id.frag.
+
+// Position-only stream (Vertex::getPositionBindingDescription, 12-byte stride)
+layout(location = 0) in vec3 inPosition;
+
+// IdBufferPicker::PushConstants
+layout(push_constant) uniform PickPush {
+    mat4 mvp;
+    uint objectId;
+} pc;
+
+layout(location = 0) flat out uint outObjectId;
+
+void main()
+{
+    outObjectId = pc.objectId;
+    gl_Position = pc.mvp * vec4(inPosition, 1.0);
+}
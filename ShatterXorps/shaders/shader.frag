@@ -2,7 +2,8 @@
 // FILE: shader.frag (UPDATED)
 ////////////////////////////////////////////////////////////
 
-#version 450
+#version 460
+#extension GL_GOOGLE_include_directive : require
 
 // Inputs from the vertex shader
 layout(location = 0) in vec3 fragColor;
@@ -13,94 +14,149 @@ layout(location = 2) in vec3 fragNorm;
 layout(location = 0) out vec4 outColor;
 
 // ----------------------------
-// UBO for camera & light
-//   set=0, binding=1 => LightUBO
+// Cascades, shadow atlas + local lights, EVSM moments and the
+// shadow filters (shared with deferred_lighting.comp):
+//   set=0, binding=1 => LightUBO (camera split + cascade matrices)
+//   set=1, binding=1 => cascaded shadow map, one layer per cascade
+//   set=1, binding=3 => ShadowAtlas light SSBO
+//   set=1, binding=4 => shadow atlas, each shadowed light owns a square tile
+//   set=1, binding=5 => EVSM moments of every cascade (EvsmShadowMap)
 // ----------------------------
-layout(set = 0, binding = 1) uniform LightUBO {
-    mat4 lightViewProj;
-    vec4 lightPos; // world-space position if needed
-} lightData;
+#define LIGHT_UBO_LAYOUT      set = 0, binding = 1
+#define SHADOW_MAP_LAYOUT     set = 1, binding = 1
+#define LOCAL_LIGHTS_LAYOUT   set = 1, binding = 3
+#define SHADOW_ATLAS_LAYOUT   set = 1, binding = 4
+#define SHADOW_MOMENTS_LAYOUT set = 1, binding = 5
+#include "shadow_lighting.glsl"
 
 // ----------------------------
-// set=1, binding=1 => shadow map sampler
-// (We've updated the binding to '1')
+// -DUSE_RAY_QUERY (shader_rq.frag.spv, needs VK_KHR_ray_query):
+// set=1, binding=2 => scene TLAS, one shadow ray towards the light
+// replaces the shadow map lookup
 // ----------------------------
-layout(set = 1, binding = 1) uniform sampler2D shadowMap;
+#ifdef USE_RAY_QUERY
+#extension GL_EXT_ray_query : require
+layout(set = 1, binding = 2) uniform accelerationStructureEXT sceneTLAS;
+#endif
 
-// Some small bias used in the depth comparison:
-const float bias = 0.001; // tweak as needed
+// ----------------------------
+// Clustered (unshadowed) point / spot lights, ClusteredLights:
+//   set=1, binding=6 => camera / grid params
+//   set=1, binding=7 => light SSBO
+//   set=1, binding=8 => per-froxel (offset, count) + light index list,
+//                       filled by cluster_lights.comp
+// ----------------------------
+const uint CLUSTER_COUNT = 3456u;   // ClusteredLights::CLUSTER_COUNT
+
+layout(std140, set = 1, binding = 6) uniform ClusterParams {
+    mat4  view;
+    vec4  projParams;   // x: 1/proj[0][0], y: 1/proj[1][1], z: near, w: far
+    uvec4 grid;         // xyz: grid size, w: light count
+    vec4  screen;       // xy: framebuffer size, z/w: slice = log(depth) * z + w
+} clusterParams;
+
+struct ClusterLight {
+    vec4 positionRange;   // xyz: position, w: range
+    vec4 directionCos;    // xyz: direction, w: cos(outer angle), -2 for point lights
+    vec4 colorCos;        // xyz: color,     w: cos(inner angle), -1 for point lights
+};
+
+layout(std430, set = 1, binding = 7) readonly buffer ClusterLights {
+    ClusterLight clusterLights[];
+};
+
+layout(std430, set = 1, binding = 8) readonly buffer Clusters {
+    uvec4 clusterHeader;
+    uvec2 clusterCells[CLUSTER_COUNT];
+    uint  clusterIndices[];
+};
+
+// ----------------------------
+// -DUSE_BINDLESS (shader_bindless.frag.spv): materials out of the
+// bindless set=3, see material.glsl
+// ----------------------------
+#ifdef USE_BINDLESS
+layout(location = 3) flat in uint fragMaterial;
+#include "material.glsl"
+#endif
+
+// Lights binned into this fragment's froxel only
+vec3 clusteredLighting(vec3 worldPos, vec3 normal)
+{
+    float depth = -(clusterParams.view * vec4(worldPos, 1.0)).z;
+    uvec2 tile  = uvec2(gl_FragCoord.xy / clusterParams.screen.xy * vec2(clusterParams.grid.xy));
+    int   slice = int(log(max(depth, clusterParams.projParams.z)) * clusterParams.screen.z + clusterParams.screen.w);
+
+    uvec3 c = min(uvec3(tile, uint(max(slice, 0))), clusterParams.grid.xyz - 1u);
+    uvec2 cell = clusterCells[c.x + clusterParams.grid.x * (c.y + clusterParams.grid.y * c.z)];
+
+    vec3 result = vec3(0.0);
+    for (uint i = 0u; i < cell.y; i++) {
+        ClusterLight l = clusterLights[clusterIndices[cell.x + i]];
+        result += l.colorCos.xyz * spotAttenuation(worldPos, normal, l.positionRange,
+            l.directionCos.xyz, l.directionCos.w, l.colorCos.w);
+    }
+    return result;
+}
+
+// Sum of every local light: the atlas-shadowed ones plus the clustered
+// unshadowed ones
+vec3 localLighting(vec3 worldPos, vec3 normal)
+{
+    return shadowedLocalLighting(worldPos, normal) + clusteredLighting(worldPos, normal);
+}
 
 void main()
 {
     ///////////////////////////////////////////
     // 1) Basic shading (Lambert) in world space
     ///////////////////////////////////////////
-    vec3 baseColor = fragColor;
     vec3 normal    = normalize(fragNorm);
+#ifdef USE_BINDLESS
+    vec3 baseColor = materialColor(fragMaterial, fragColor, fragWorldPos, normal);
+#else
+    vec3 baseColor = fragColor;
+#endif
 
-    // Light direction for simple NL shading:
-    vec3 lightDir  = normalize(lightData.lightPos.xyz - fragWorldPos);
+    // Directional light for simple NL shading:
+    vec3 lightDir  = normalize(lightData.lightDir.xyz);
     float ndotl    = max(dot(normal, lightDir), 0.0);
 
+#ifdef USE_RAY_QUERY
     ///////////////////////////////////////////
-    // 2) Compute "shadowUV" and "currentDepth"
-    //    in [0..1] from the light's clip space
+    // 2) Ray-traced hard shadow: any hit between the
+    //    (slightly offset) surface point and the light
     ///////////////////////////////////////////
-    // Project fragment into the light's clip coords:
-    vec4 lightClip = lightData.lightViewProj * vec4(fragWorldPos, 1.0);
-
-    // Convert to normalized device coords:
-    vec3 ndc = lightClip.xyz / lightClip.w; // [-1..1] in X,Y,Z
-
-    // The shadow sampler uses X,Y in [0..1]:
-    vec2 shadowUV = ndc.xy * 0.5 + 0.5;
+    {
+        vec3 origin = fragWorldPos + normal * 0.01;
 
-    // The hardware depth is in [0..1] => do the same:
-    float currentDepth = ndc.z * 0.5 + 0.5;
+        rayQueryEXT rq;
+        rayQueryInitializeEXT(rq, sceneTLAS,
+            gl_RayFlagsTerminateOnFirstHitEXT | gl_RayFlagsOpaqueEXT,
+            0xFF, origin, 0.0, lightDir, 1000.0);
+        while (rayQueryProceedEXT(rq)) {
+        }
+        float shadowFactor =
+            (rayQueryGetIntersectionTypeEXT(rq, true) == gl_RayQueryCommittedIntersectionNoneEXT) ? 1.0 : 0.0;
 
-    ///////////////////////////////////////////
-    // 3) Check if we're outside [0..1]
-    //    If so, skip the shadow test
-    ///////////////////////////////////////////
-    if (shadowUV.x < 0.0 || shadowUV.x > 1.0 ||
-        shadowUV.y < 0.0 || shadowUV.y > 1.0) 
-    {
-        // Outside the shadow map => no shadow
         float ambient = 0.1;
-        outColor = vec4(baseColor * (ndotl + ambient), 1.0);
+        outColor = vec4(baseColor * (ndotl * shadowFactor + ambient + localLighting(fragWorldPos, normal)), 1.0);
         return;
     }
+#endif
 
     ///////////////////////////////////////////
-    // 4) Manual PCF (33) in the shadow map
+    // 2) Cascade shadow, kernel picked by
+    //    CascadedShadowMap::setPcfKernel()
     ///////////////////////////////////////////
-    float shadowSum = 0.0;
-    int samples     = 0;
-
-    // Example 33 PCF with a 20482048 shadow
-    float pcfScale = 1.0 / 2048.0;
-
-    for (int x = -1; x <= 1; x++) {
-        for (int y = -1; y <= 1; y++) {
-            // small offset
-            vec2 offset = vec2(x, y) * pcfScale;
-            float storedDepth = texture(shadowMap, shadowUV + offset).r;
-
-            // Compare
-            float litSample = (currentDepth <= storedDepth + bias) ? 1.0 : 0.0;
-            shadowSum += litSample;
-            samples++;
-        }
-    }
-
-    float shadowFactor = shadowSum / float(samples);
+    float shadowFactor = cascadeShadow(fragWorldPos);
 
     ///////////////////////////////////////////
-    // 5) Final color = (Lambert * shadowFactor) + ambient
+    // 3) Final color = (Lambert * shadowFactor) + ambient + local lights
     ///////////////////////////////////////////
     float ambient      = 0.1;
     float diffuse      = ndotl * shadowFactor;
-    vec3 finalColor    = baseColor * (diffuse + ambient);
+    vec3 finalColor    = baseColor * (diffuse + ambient + localLighting(fragWorldPos, normal));
 
     outColor = vec4(finalColor, 1.0);
 }
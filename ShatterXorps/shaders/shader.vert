@@ -7,21 +7,32 @@ layout(location=2) in vec3 inNormal; // new input
 layout(location=0) out vec3 fragColor;
 layout(location=1) out vec3 fragWorldPos;
 layout(location=2) out vec3 fragNorm; // pass to fragment
+layout(location=3) flat out uint fragMaterial;   // MaterialTable index
 
 layout(binding=0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
 } ubo;
 
+// GraphicsPipeline::PushConstants (per draw)
+layout(push_constant) uniform ObjectPush {
+    mat4 model;
+    uint materialIndex;
+} pc;
+
+// Bit-identical to depth_prepass.vert, the main pass can run with an
+// EQUAL depth test after the prepass
+invariant gl_Position;
+
 void main()
 {
-    vec4 worldPos    = ubo.model * vec4(inPosition, 1.0);
+    vec4 worldPos    = pc.model * vec4(inPosition, 1.0);
     gl_Position      = ubo.proj * ubo.view * worldPos;
 
     fragColor        = inColor;
     fragWorldPos     = worldPos.xyz;
 
     // transform normal if your model can rotate/scale:
-    fragNorm         = mat3(ubo.model) * inNormal;
+    fragNorm         = mat3(pc.model) * inNormal;
+    fragMaterial     = pc.materialIndex;
 }
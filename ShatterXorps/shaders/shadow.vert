@@ -3,19 +3,32 @@
 ///////////////////////////////////////////
 #version 450
 
-// For a minimal shadow pass, we just transform each vertex
-// using the "lightViewProj" matrix, outputting gl_Position.
-// If we don't have a fragment shader, the pipeline does a depth-only pass.
+// Depth-only pass for one cascade of the cascaded shadow map:
+// model matrix + cascade index come in as push constants,
+// the cascade's light view-projection from the light UBO.
+// Without a fragment shader the pipeline does a depth-only pass.
 
-// Suppose you match the same vertex attribute binding
+// Position-only stream (Vertex::getPositionBindingDescription, 12-byte stride)
 layout(location = 0) in vec3 inPosition;
 
+// Same block as shader.frag (CascadedShadowMap::GpuData)
 layout(binding = 0) uniform LightUBO {
-    mat4 lightViewProj;
+    mat4 cascadeViewProj[4];
+    mat4 cameraView;
+    vec4 cascadeSplits;
+    vec4 lightDir;
+    vec4 shadowParams;
+    vec4 evsmParams;
 } ubo;
 
+// ShadowPipeline::PushConstants
+layout(push_constant) uniform ShadowPush {
+    mat4 model;
+    int  cascade;
+} pc;
+
 void main()
 {
-    // Transform the vertex into light clip-space
-    gl_Position = ubo.lightViewProj * vec4(inPosition, 1.0);
+    // Transform the vertex into the cascade's light clip-space
+    gl_Position = ubo.cascadeViewProj[pc.cascade] * pc.model * vec4(inPosition, 1.0);
 }
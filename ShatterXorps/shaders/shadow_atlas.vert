@@ -0,0 +1,36 @@
+///////////////////////////////////////////
+// FILE: shadow_atlas.vert
+///////////////////////////////////////////
+#version 450
+
+// Depth-only pass for one local light's tile of the shadow atlas:
+// model matrix + light index come in as push constants,
+// the light view-projection from the light SSBO (ShadowAtlas).
+// The viewport/scissor select the tile.
+
+layout(location = 0) in vec3 inPosition;
+
+// ShadowAtlas::GpuLight, same block as shader.frag
+struct LocalLight {
+    mat4 viewProj;
+    vec4 positionRange;
+    vec4 directionCos;
+    vec4 colorCos;
+    vec4 atlasRect;
+};
+
+layout(std430, binding = 0) readonly buffer LocalLights {
+    uvec4      header;   // x: light count, y: shadowed count
+    LocalLight lights[];
+} localLights;
+
+// ShadowPipeline::PushConstants (cascade = light index here)
+layout(push_constant) uniform ShadowPush {
+    mat4 model;
+    int  lightIndex;
+} pc;
+
+void main()
+{
+    gl_Position = localLights.lights[pc.lightIndex].viewProj * pc.model * vec4(inPosition, 1.0);
+}
@@ -0,0 +1,238 @@
+////////////////////////////////////////////////////////////
+// FILE: shadow_lighting.glsl
+////////////////////////////////////////////////////////////
+//
+// Directional + local light shadowing shared by the forward (shader.frag)
+// and deferred (deferred_lighting.comp) paths, so both honour the PCF
+// kernel / EVSM selection and the shadow atlas lights.
+//
+// The including shader picks where the resources live, before the
+// #include:
+//   LIGHT_UBO_LAYOUT       LightUBO (CascadedShadowMap::GpuData)
+//   SHADOW_MAP_LAYOUT      cascades, sampler2DArrayShadow
+//   LOCAL_LIGHTS_LAYOUT    ShadowAtlas light SSBO
+//   SHADOW_ATLAS_LAYOUT    shadow atlas, sampler2DShadow
+//   SHADOW_MOMENTS_LAYOUT  EVSM moments (EvsmShadowMap), sampler2DArray
+// e.g. #define SHADOW_MAP_LAYOUT set = 1, binding = 1
+
+layout(LIGHT_UBO_LAYOUT) uniform LightUBO {
+    mat4 cascadeViewProj[4]; // light view-proj per cascade
+    mat4 cameraView;         // to get the view depth for cascade selection
+    vec4 cascadeSplits;      // view-space far distance of each cascade
+    vec4 lightDir;           // xyz: towards the (directional) light, w: cascade count
+    vec4 shadowParams;       // x: texel size, y: PCF kernel, z: depth bias
+    vec4 evsmParams;         // x/y: positive/negative exponent, z: light bleeding reduction, w: min variance
+} lightData;
+
+// Comparison sampler: texture() returns the (bilinear filtered) result of
+// refDepth <= storedDepth, textureGather() the 4 raw results
+layout(SHADOW_MAP_LAYOUT) uniform sampler2DArrayShadow shadowMap;
+
+// Local (spot) lights, each shadowed one owns a square tile of the atlas
+struct LocalLight {
+    mat4 viewProj;
+    vec4 positionRange;   // xyz: position, w: range
+    vec4 directionCos;    // xyz: direction, w: cos(outer angle)
+    vec4 colorCos;        // xyz: color,     w: cos(inner angle)
+    vec4 atlasRect;       // xy: tile offset, z: tile size (0 = no shadow), w: atlas texel size
+};
+
+layout(std430, LOCAL_LIGHTS_LAYOUT) readonly buffer LocalLights {
+    uvec4      header;    // x: light count, y: shadowed count
+    LocalLight lights[];
+} localLights;
+
+layout(SHADOW_ATLAS_LAYOUT) uniform sampler2DShadow shadowAtlas;
+
+// Blurred + mipmapped moments of every cascade, sampled trilinear
+layout(SHADOW_MOMENTS_LAYOUT) uniform sampler2DArray shadowMoments;
+
+// CascadedShadowMap::PcfKernel
+const int PCF_FOUR_TAP  = 0;
+const int PCF_POISSON   = 1;
+const int PCF_GATHER5X5 = 2;
+const int SHADOW_EVSM   = 3;
+
+const vec2 poissonDisk[12] = vec2[](
+    vec2(-0.326, -0.406), vec2(-0.840, -0.074), vec2(-0.696,  0.457),
+    vec2(-0.203,  0.621), vec2( 0.962, -0.195), vec2( 0.473, -0.480),
+    vec2( 0.519,  0.767), vec2( 0.185, -0.893), vec2( 0.507,  0.064),
+    vec2( 0.896,  0.412), vec2(-0.322, -0.933), vec2(-0.792, -0.598)
+);
+
+// 4 filtered taps half a texel off center: covers 3x3 texels
+float pcfFourTap(vec2 uv, float layer, float refDepth, float texel)
+{
+    float sum = 0.0;
+    sum += texture(shadowMap, vec4(uv + vec2(-0.5, -0.5) * texel, layer, refDepth));
+    sum += texture(shadowMap, vec4(uv + vec2( 0.5, -0.5) * texel, layer, refDepth));
+    sum += texture(shadowMap, vec4(uv + vec2(-0.5,  0.5) * texel, layer, refDepth));
+    sum += texture(shadowMap, vec4(uv + vec2( 0.5,  0.5) * texel, layer, refDepth));
+    return sum * 0.25;
+}
+
+// 12 filtered taps on a disk of 1.5 texels
+float pcfPoisson(vec2 uv, float layer, float refDepth, float texel)
+{
+    float sum = 0.0;
+    for (int i = 0; i < 12; i++) {
+        sum += texture(shadowMap, vec4(uv + poissonDisk[i] * 1.5 * texel, layer, refDepth));
+    }
+    return sum / 12.0;
+}
+
+// 5x5 box over the 6x6 texels around uv, 9 gathers. The outer row/column
+// are weighted by the sub-texel position so the kernel slides smoothly.
+float pcfGather5x5(vec2 uv, float layer, float refDepth, float texel)
+{
+    vec2 tc   = uv / texel - 0.5;
+    vec2 base = floor(tc);
+    vec2 f    = tc - base;
+
+    // Weights of texel columns/rows base-2 .. base+3
+    float wx[6] = float[](1.0 - f.x, 1.0, 1.0, 1.0, 1.0, f.x);
+    float wy[6] = float[](1.0 - f.y, 1.0, 1.0, 1.0, 1.0, f.y);
+
+    float sum = 0.0;
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 3; i++) {
+            // Corner shared by texels (base + 2i-2 .. 2i-1, base + 2j-2 .. 2j-1)
+            vec2 corner = (base + vec2(2 * i - 1, 2 * j - 1)) * texel;
+            // Gather order: x=(0,1) y=(1,1) z=(1,0) w=(0,0)
+            vec4 g = textureGather(shadowMap, vec3(corner, layer), refDepth);
+            sum += g.w * wx[2 * i]     * wy[2 * j]
+                 + g.z * wx[2 * i + 1] * wy[2 * j]
+                 + g.x * wx[2 * i]     * wy[2 * j + 1]
+                 + g.y * wx[2 * i + 1] * wy[2 * j + 1];
+        }
+    }
+    return sum / 25.0;
+}
+
+// One-sided Chebyshev upper bound, with light bleeding reduction:
+// the lowest pMax values are cut off and the rest rescaled to 0..1
+float chebyshev(vec2 moments, float mean, float minVariance, float bleeding)
+{
+    if (mean <= moments.x) {
+        return 1.0;
+    }
+    float variance = max(moments.y - moments.x * moments.x, minVariance);
+    float d        = mean - moments.x;
+    float pMax     = variance / (variance + d * d);
+    return clamp((pMax - bleeding) / (1.0 - bleeding), 0.0, 1.0);
+}
+
+// Single filtered fetch; the blur and mips already did the filtering
+// (outside fragment shaders texture() reads the base level)
+float evsmShadow(vec2 uv, float layer, float depth)
+{
+    vec2  exps = lightData.evsmParams.xy;
+    vec4  m    = texture(shadowMoments, vec3(uv, layer));
+
+    // Same warp as evsm_blur.comp
+    float d   = 2.0 * depth - 1.0;
+    float pos = exp(exps.x * d);
+    float neg = -exp(-exps.y * d);
+
+    // Min variance scaled by the warp's derivative
+    float minVar = lightData.evsmParams.w;
+    float pPos = chebyshev(m.xy, pos, minVar * exps.x * exps.x * pos * pos, lightData.evsmParams.z);
+    float pNeg = chebyshev(m.zw, neg, minVar * exps.y * exps.y * neg * neg, lightData.evsmParams.z);
+    return min(pPos, pNeg);
+}
+
+// Directional light visibility: the cascade is the first one whose split is
+// further away than the view depth, past the last split => no shadow. The
+// filter is the one picked by CascadedShadowMap::setPcfKernel().
+float cascadeShadow(vec3 worldPos)
+{
+    float viewDepth    = -(lightData.cameraView * vec4(worldPos, 1.0)).z;
+    int   cascadeCount = int(lightData.lightDir.w);
+    int   cascade      = cascadeCount;
+    for (int i = 0; i < cascadeCount; i++) {
+        if (viewDepth < lightData.cascadeSplits[i]) {
+            cascade = i;
+            break;
+        }
+    }
+    if (cascade >= cascadeCount) {
+        return 1.0;
+    }
+
+    // Cascade light clip space: ortho, 0..1 depth, no remap needed
+    vec4  lightClip = lightData.cascadeViewProj[cascade] * vec4(worldPos, 1.0);
+    vec3  ndc       = lightClip.xyz / lightClip.w;
+    vec2  uv        = ndc.xy * 0.5 + 0.5;
+    float texel     = lightData.shadowParams.x;
+    int   kernel    = int(lightData.shadowParams.y);
+    float refDepth  = ndc.z - lightData.shadowParams.z;
+    float layer     = float(cascade);
+
+    if (kernel == SHADOW_EVSM) {
+        return evsmShadow(uv, layer, refDepth);
+    }
+    if (kernel == PCF_GATHER5X5) {
+        return pcfGather5x5(uv, layer, refDepth, texel);
+    }
+    if (kernel == PCF_POISSON) {
+        return pcfPoisson(uv, layer, refDepth, texel);
+    }
+    return pcfFourTap(uv, layer, refDepth, texel);
+}
+
+// 4 filtered taps inside the light's tile. The uv is kept a texel and a
+// half away from the tile border so no tap reads a neighbouring tile.
+float atlasShadow(LocalLight l, vec3 worldPos)
+{
+    if (l.atlasRect.z <= 0.0) {
+        return 1.0;
+    }
+    vec4 clip = l.viewProj * vec4(worldPos, 1.0);
+    vec3 ndc  = clip.xyz / clip.w;
+
+    float texel  = l.atlasRect.w;
+    float margin = 1.5 * texel / l.atlasRect.z;
+    vec2  uv     = l.atlasRect.xy + clamp(ndc.xy * 0.5 + 0.5, margin, 1.0 - margin) * l.atlasRect.z;
+    float ref    = ndc.z - 0.0005;
+
+    float sum = 0.0;
+    sum += texture(shadowAtlas, vec3(uv + vec2(-0.5, -0.5) * texel, ref));
+    sum += texture(shadowAtlas, vec3(uv + vec2( 0.5, -0.5) * texel, ref));
+    sum += texture(shadowAtlas, vec3(uv + vec2(-0.5,  0.5) * texel, ref));
+    sum += texture(shadowAtlas, vec3(uv + vec2( 0.5,  0.5) * texel, ref));
+    return sum * 0.25;
+}
+
+// N.L x spot cone x smooth range falloff of a point / spot light, 0 out of
+// range. cosOuter / cosInner -2 / -1 make a point light.
+float spotAttenuation(vec3 worldPos, vec3 normal, vec4 positionRange, vec3 direction,
+    float cosOuter, float cosInner)
+{
+    vec3  toLight = positionRange.xyz - worldPos;
+    float dist    = length(toLight);
+    if (dist >= positionRange.w) {
+        return 0.0;
+    }
+    vec3  L     = toLight / dist;
+    float ndotl = max(dot(normal, L), 0.0);
+    float spot  = smoothstep(cosOuter, cosInner, dot(-L, direction));
+    float falloff = clamp(1.0 - (dist * dist) / (positionRange.w * positionRange.w), 0.0, 1.0);
+    return ndotl * spot * falloff * falloff;
+}
+
+// Every ShadowAtlas light, each with its atlas shadow
+vec3 shadowedLocalLighting(vec3 worldPos, vec3 normal)
+{
+    vec3 result = vec3(0.0);
+    uint count  = localLights.header.x;
+    for (uint i = 0u; i < count; i++) {
+        LocalLight l = localLights.lights[i];
+        float a = spotAttenuation(worldPos, normal, l.positionRange, l.directionCos.xyz,
+            l.directionCos.w, l.colorCos.w);
+        if (a <= 0.0) {
+            continue;
+        }
+        result += l.colorCos.xyz * a * atlasShadow(l, worldPos);
+    }
+    return result;
+}